@@ -42,6 +42,21 @@ std::string BroadcastOf(Expected<ArgumentBCast>& bcast) {
   return "<invalid bcast>";
 }
 
+std::string DimsOf(Expected<BinaryBCast>& bcast) {
+  if (static_cast<bool>(bcast)) return ToString(bcast->dims());
+  return "<invalid bcast>";
+}
+
+std::string LhsStridesOf(Expected<BinaryBCast>& bcast) {
+  if (static_cast<bool>(bcast)) return ToString(bcast->lhs_strides());
+  return "<invalid bcast>";
+}
+
+std::string RhsStridesOf(Expected<BinaryBCast>& bcast) {
+  if (static_cast<bool>(bcast)) return ToString(bcast->rhs_strides());
+  return "<invalid bcast>";
+}
+
 std::string ShapeOf(Expected<TensorShape>& shape) {
   if (static_cast<bool>(shape)) {
     SmallVector<Index, 4> dims;
@@ -98,4 +113,40 @@ TEST(BCastTest, GetArgumentBCast) {
   }
 }
 
+TEST(BCastTest, GetBinaryBCast) {
+  {
+    auto bcast = GetBinaryBCast(TensorShape({4, 1, 3}), TensorShape({1, 5, 1}));
+    ASSERT_EQ(DimsOf(bcast), "[4, 5, 3]");
+    ASSERT_EQ(LhsStridesOf(bcast), "[3, 0, 1]");
+    ASSERT_EQ(RhsStridesOf(bcast), "[0, 1, 0]");
+  }
+
+  {
+    auto bcast = GetBinaryBCast(TensorShape({6, 5, 3}),
+                                TensorShape(ArrayRef<Index>{3}));
+    ASSERT_EQ(DimsOf(bcast), "[30, 3]");
+    ASSERT_EQ(LhsStridesOf(bcast), "[3, 1]");
+    ASSERT_EQ(RhsStridesOf(bcast), "[0, 1]");
+  }
+
+  {
+    auto bcast = GetBinaryBCast(TensorShape({6, 5, 1}), TensorShape({6, 5, 3}));
+    ASSERT_EQ(DimsOf(bcast), "[30, 3]");
+    ASSERT_EQ(LhsStridesOf(bcast), "[1, 0]");
+    ASSERT_EQ(RhsStridesOf(bcast), "[3, 1]");
+  }
+
+  {
+    auto bcast = GetBinaryBCast(TensorShape({1, 1}), TensorShape({1, 1}));
+    ASSERT_EQ(DimsOf(bcast), "[1]");
+    ASSERT_EQ(LhsStridesOf(bcast), "[1]");
+    ASSERT_EQ(RhsStridesOf(bcast), "[1]");
+  }
+
+  {
+    auto bcast = GetBinaryBCast(TensorShape({3, 2}), TensorShape({3, 3}));
+    ASSERT_FALSE(static_cast<bool>(bcast));
+  }
+}
+
 }  // namespace tfrt
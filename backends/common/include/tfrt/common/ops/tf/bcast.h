@@ -56,6 +56,39 @@ class ArgumentBCast {
   SmallVector<Index, 8> broadcast_;
 };
 
+// Binary broadcast specification defines how to iterate over the elements of
+// two arguments broadcasted to the result shape, without materializing the
+// broadcasted arguments.
+//
+// Adjacent result dimensions that are broadcasted in the same way in both
+// arguments are collapsed into a single dimension, and dimensions of size 1
+// are dropped. For example `[N, 1, C] + [1, H, 1]` has dims `[N, H, C]` with
+// lhs strides `[C, 0, 1]` and rhs strides `[0, 1, 0]`, and `[N, H, C] + [C]`
+// has dims `[N * H, C]` with lhs strides `[C, 1]` and rhs strides `[0, 1]`.
+//
+// An argument stride is 0 along the dimensions that are broadcasted.
+class BinaryBCast {
+ public:
+  BinaryBCast(ArrayRef<Index> dims, ArrayRef<Index> lhs_strides,
+              ArrayRef<Index> rhs_strides)
+      : dims_(dims.begin(), dims.end()),
+        lhs_strides_(lhs_strides.begin(), lhs_strides.end()),
+        rhs_strides_(rhs_strides.begin(), rhs_strides.end()) {
+    assert(dims.size() == lhs_strides.size());
+    assert(dims.size() == rhs_strides.size());
+  }
+
+  size_t rank() const { return dims_.size(); }
+  ArrayRef<Index> dims() const { return dims_; }
+  ArrayRef<Index> lhs_strides() const { return lhs_strides_; }
+  ArrayRef<Index> rhs_strides() const { return rhs_strides_; }
+
+ private:
+  SmallVector<Index, 8> dims_;
+  SmallVector<Index, 8> lhs_strides_;
+  SmallVector<Index, 8> rhs_strides_;
+};
+
 // Returns a broadcasted result shape if arguments are broadcastible.
 Expected<TensorShape> GetBroadcastedShape(const TensorShape& arg0_shape,
                                           const TensorShape& arg1_shape);
@@ -65,6 +98,11 @@ Expected<TensorShape> GetBroadcastedShape(const TensorShape& arg0_shape,
 Expected<ArgumentBCast> GetArgumentBCast(const TensorShape& argument_shape,
                                          const TensorShape& result_shape);
 
+// Returns a binary broadcast specification for the arguments broadcasted to
+// their broadcasted result shape.
+Expected<BinaryBCast> GetBinaryBCast(const TensorShape& lhs_shape,
+                                     const TensorShape& rhs_shape);
+
 }  // namespace tfrt
 
 #endif  // TFRT_BACKENDS_COMMON_OPS_TF_BCAST_H_
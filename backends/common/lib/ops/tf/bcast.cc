@@ -95,4 +95,57 @@ Expected<ArgumentBCast> GetArgumentBCast(const TensorShape& argument_shape,
   return ArgumentBCast(arg_dims, broadcast);
 }
 
+Expected<BinaryBCast> GetBinaryBCast(const TensorShape& lhs_shape,
+                                     const TensorShape& rhs_shape) {
+  TFRT_ASSIGN_OR_RETURN(auto res_shape,
+                        GetBroadcastedShape(lhs_shape, rhs_shape));
+  TFRT_ASSIGN_OR_RETURN(auto lhs_bcast, GetArgumentBCast(lhs_shape, res_shape));
+  TFRT_ASSIGN_OR_RETURN(auto rhs_bcast, GetArgumentBCast(rhs_shape, res_shape));
+
+  SmallVector<Index, 8> res_dims;
+  res_shape.GetDimensions(&res_dims);
+
+  // Collapse adjacent dimensions broadcasted in the same way in both arguments.
+  SmallVector<Index, 8> dims;
+  SmallVector<bool, 8> lhs_bcasted;
+  SmallVector<bool, 8> rhs_bcasted;
+  for (size_t i = 0; i < res_dims.size(); ++i) {
+    if (res_dims[i] == 1) continue;
+
+    const bool lhs_b = lhs_bcast.reshape()[i] == 1;
+    const bool rhs_b = rhs_bcast.reshape()[i] == 1;
+
+    if (!dims.empty() && lhs_bcasted.back() == lhs_b &&
+        rhs_bcasted.back() == rhs_b) {
+      dims.back() *= res_dims[i];
+    } else {
+      dims.push_back(res_dims[i]);
+      lhs_bcasted.push_back(lhs_b);
+      rhs_bcasted.push_back(rhs_b);
+    }
+  }
+
+  // All dimensions are of size 1.
+  if (dims.empty()) {
+    dims.push_back(1);
+    lhs_bcasted.push_back(false);
+    rhs_bcasted.push_back(false);
+  }
+
+  // Compute argument strides from the collapsed dimensions.
+  const size_t rank = dims.size();
+  SmallVector<Index, 8> lhs_strides(rank);
+  SmallVector<Index, 8> rhs_strides(rank);
+  Index lhs_stride = 1;
+  Index rhs_stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    lhs_strides[i] = lhs_bcasted[i] ? 0 : lhs_stride;
+    rhs_strides[i] = rhs_bcasted[i] ? 0 : rhs_stride;
+    if (!lhs_bcasted[i]) lhs_stride *= dims[i];
+    if (!rhs_bcasted[i]) rhs_stride *= dims[i];
+  }
+
+  return BinaryBCast(dims, lhs_strides, rhs_strides);
+}
+
 }  // namespace tfrt
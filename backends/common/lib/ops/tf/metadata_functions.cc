@@ -67,6 +67,17 @@ static Expected<TensorMetadata> TfBinaryOpMd(const TensorMetadata& lhs,
   return CwiseBinaryOpMd(lhs, rhs);
 }
 
+// The result of fused coefficient wise operations has the broadcasted shape of
+// all operands.
+static Expected<TensorMetadata> TfFusedCwiseOpMd(
+    const TensorMetadata& input, VariadicOpArg<TensorMetadata> fusion_inputs) {
+  TensorMetadata md = input;
+  for (size_t i = 0; i < fusion_inputs.size(); ++i) {
+    TFRT_ASSIGN_OR_RETURN(md, CwiseBinaryOpMd(md, fusion_inputs[i]));
+  }
+  return md;
+}
+
 static Expected<TensorMetadata> TfBinaryComparisonOpMd(
     const TensorMetadata& lhs, const TensorMetadata& rhs) {
   return CwiseBinaryOpMd(lhs, rhs, DType::I1);
@@ -138,6 +149,81 @@ static Expected<TensorMetadata> MatMulMd(const TensorMetadata& a,
                                   b.shape.GetDimensionSize(b_remaining_dim)});
 }
 
+static Expected<TensorMetadata> QuantizedMatMulMd(
+    const TensorMetadata& a, const TensorMetadata& b,
+    VariadicOpArg<TensorMetadata> fusion_inputs, const OpAttrsRef& attrs) {
+  auto is_int8 = [](DType dtype) {
+    return dtype == DType::I8 || dtype == DType::QI8;
+  };
+  if (!is_int8(a.dtype) || !is_int8(b.dtype))
+    return MakeStringError("quantized MatMul requires int8 inputs: In[0]: ",
+                           a.dtype, ", In[1]: ", b.dtype);
+
+  auto out_type = attrs.GetAsserting<OpAttrType>("Toutput");
+  DType dtype = out_type == OpAttrType::UNSUPPORTED_QI8
+                    ? DType(DType::QI8)
+                    : OpAttrTypeToDType(out_type);
+  if (dtype != DType::F32 && !is_int8(dtype))
+    return MakeStringError("Unsupported `Toutput` value: ", dtype);
+
+  TFRT_ASSIGN_OR_RETURN(
+      auto md, MatMulMd(TensorMetadata(b.dtype, a.shape), b, fusion_inputs,
+                        attrs));
+  return TensorMetadata(dtype, md.shape);
+}
+
+static Expected<TensorMetadata> BatchMatMulMd(const TensorMetadata& x,
+                                              const TensorMetadata& y,
+                                              const OpAttrsRef& attrs) {
+  if (x.dtype != y.dtype)
+    return MakeStringError("incompatible dtypes for BatchMatMul: In[0]: ",
+                           x.dtype, ", In[1]: ", y.dtype);
+  if (x.dtype == DType::Complex64 || x.dtype == DType::Complex128)
+    return MakeStringError("BatchMatMul supports only real dtypes, got ",
+                           x.dtype);
+
+  const int x_rank = x.shape.GetRank();
+  const int y_rank = y.shape.GetRank();
+  if (x_rank < 2 || y_rank < 2)
+    return MakeStringError(
+        "arguments of batch matmul op must have a rank of at least 2: In[0]: ",
+        x.shape, ", In[1]: ", y.shape);
+
+  bool adj_x;
+  if (!attrs.Get("adj_x", &adj_x))
+    return MakeStringError(
+        "'adj_x' attribute is not specified for BatchMatMul op");
+  bool adj_y;
+  if (!attrs.Get("adj_y", &adj_y))
+    return MakeStringError(
+        "'adj_y' attribute is not specified for BatchMatMul op");
+
+  auto x_dims = GetDimensions(x.shape);
+  auto y_dims = GetDimensions(y.shape);
+
+  Index x_rows = x_dims[x_rank - 2], x_cols = x_dims[x_rank - 1];
+  Index y_rows = y_dims[y_rank - 2], y_cols = y_dims[y_rank - 1];
+  if (adj_x) std::swap(x_rows, x_cols);
+  if (adj_y) std::swap(y_rows, y_cols);
+
+  if (x_cols != y_rows)
+    return MakeStringError(
+        "batch matmul arguments have incompatible shapes: In[0]: ", x.shape,
+        ", In[1]: ", y.shape, ". adj_x: ", adj_x, ", adj_y: ", adj_y);
+
+  // Batch dimensions are broadcasted.
+  TFRT_ASSIGN_OR_RETURN(
+      auto batch_shape,
+      GetBroadcastedShape(
+          TensorShape(llvm::makeArrayRef(x_dims).drop_back(2)),
+          TensorShape(llvm::makeArrayRef(y_dims).drop_back(2))));
+
+  auto dims = GetDimensions(batch_shape);
+  dims.push_back(x_rows);
+  dims.push_back(y_cols);
+  return TensorMetadata(x.dtype, dims);
+}
+
 static Expected<TensorMetadata> TfConvOpMd(const TensorMetadata& input,
                                            const TensorMetadata& filter,
                                            const OpAttrsRef& attrs) {
@@ -491,6 +577,12 @@ GetAllTFMetadataFunctions() {
     result->emplace_back("tf.Tanh", TFRT_METADATA(UnaryIdentityMd));
     result->emplace_back("tf.MatMul", TFRT_METADATA(MatMulMd));
     result->emplace_back("tf._FusedMatMul", TFRT_METADATA(MatMulMd));
+    result->emplace_back("tf._FusedCwise", TFRT_METADATA(TfFusedCwiseOpMd));
+    result->emplace_back("tf._QuantizedMatMul",
+                         TFRT_METADATA(QuantizedMatMulMd));
+    result->emplace_back("tf._QuantizedFusedMatMul",
+                         TFRT_METADATA(QuantizedMatMulMd));
+    result->emplace_back("tf.BatchMatMulV2", TFRT_METADATA(BatchMatMulMd));
     result->emplace_back("tf.Less", TFRT_METADATA(TfBinaryComparisonOpMd));
     result->emplace_back("tf.Log", TFRT_METADATA(UnaryIdentityMd));
     result->emplace_back("tf.Log1p", TFRT_METADATA(UnaryIdentityMd));
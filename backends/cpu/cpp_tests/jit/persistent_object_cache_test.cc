@@ -0,0 +1,195 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tfrt/cpu/jit/persistent_object_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace tfrt {
+namespace {
+
+using ::tfrt::cpu::jit::PersistentObjectCache;
+
+namespace fs = ::llvm::sys::fs;
+
+class PersistentObjectCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_FALSE(fs::createUniqueDirectory("cpurt-object-cache", directory_));
+  }
+
+  void TearDown() override { fs::remove_directories(directory_); }
+
+  std::unique_ptr<PersistentObjectCache> CreateCache(
+      size_t max_size_bytes = 1024 * 1024) {
+    PersistentObjectCache::Options opts;
+    opts.directory = directory_.str().str();
+    opts.max_size_bytes = max_size_bytes;
+    auto cache = PersistentObjectCache::Create(std::move(opts));
+    EXPECT_TRUE(static_cast<bool>(cache));
+    return std::move(*cache);
+  }
+
+  // Returns the number of files in the cache directory.
+  int NumFiles() {
+    int num_files = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory_, ec), end; it != end && !ec;
+         it.increment(ec))
+      ++num_files;
+    return num_files;
+  }
+
+  // Marks all cache entries as used a long time ago.
+  void AgeEntries() {
+    std::error_code ec;
+    for (fs::directory_iterator it(directory_, ec), end; it != end && !ec;
+         it.increment(ec)) {
+      int fd;
+      ASSERT_FALSE(fs::openFileForWrite(it->path(), fd, fs::CD_OpenExisting));
+      ASSERT_FALSE(fs::setLastAccessAndModificationTime(
+          fd, llvm::sys::TimePoint<>()));
+      fs::file_t file = fs::convertFDToNativeFile(fd);
+      fs::closeFile(file);
+    }
+  }
+
+  llvm::SmallString<128> directory_;
+};
+
+TEST_F(PersistentObjectCacheTest, InsertAndLookup) {
+  auto cache = CreateCache();
+
+  PersistentObjectCache::Key key = {"module", "options", "target"};
+  EXPECT_EQ(cache->Lookup(key), nullptr);
+
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key, "object file")));
+  auto object = cache->Lookup(key);
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(object->getBuffer(), "object file");
+
+  // All parts of the key must be a part of the fingerprint.
+  EXPECT_EQ(cache->Lookup({"module", "options", "other target"}), nullptr);
+  EXPECT_EQ(cache->Lookup({"module", "other options", "target"}), nullptr);
+  EXPECT_EQ(cache->Lookup({"other module", "options", "target"}), nullptr);
+
+  PersistentObjectCache::Stats stats = cache->GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 4);
+  EXPECT_EQ(stats.insertions, 1);
+  EXPECT_EQ(stats.corruptions, 0);
+
+  // Entries are persistent across the cache instances.
+  auto another_cache = CreateCache();
+  EXPECT_NE(another_cache->Lookup(key), nullptr);
+  EXPECT_GT(another_cache->GetStats().size_bytes, 0);
+}
+
+TEST_F(PersistentObjectCacheTest, ReplaceEntry) {
+  auto cache = CreateCache();
+
+  PersistentObjectCache::Key key = {"module", "options", "target"};
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key, "object file")));
+  int64_t size_bytes = cache->GetStats().size_bytes;
+
+  // Replacing an entry with an object of the same size keeps the cache size.
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key, "object FILE")));
+  EXPECT_EQ(cache->GetStats().size_bytes, size_bytes);
+  EXPECT_EQ(NumFiles(), 1);
+
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key, "object")));
+  EXPECT_EQ(cache->GetStats().size_bytes, size_bytes - 5);
+
+  auto object = cache->Lookup(key);
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(object->getBuffer(), "object");
+}
+
+TEST_F(PersistentObjectCacheTest, RejectEmptyObjects) {
+  auto cache = CreateCache();
+
+  PersistentObjectCache::Key key = {"module", "options", "target"};
+  Error err = cache->Insert(key, "");
+  EXPECT_TRUE(static_cast<bool>(err));
+  llvm::consumeError(std::move(err));
+
+  EXPECT_EQ(NumFiles(), 0);
+  EXPECT_EQ(cache->Lookup(key), nullptr);
+  EXPECT_EQ(cache->GetStats().insertions, 0);
+}
+
+TEST_F(PersistentObjectCacheTest, DropCorruptedEntries) {
+  auto cache = CreateCache();
+
+  PersistentObjectCache::Key key = {"module", "options", "target"};
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key, "object file")));
+  ASSERT_EQ(NumFiles(), 1);
+
+  // Flip the last byte of the object file.
+  std::error_code ec;
+  for (fs::directory_iterator it(directory_, ec), end; it != end && !ec;
+       it.increment(ec)) {
+    auto buffer = llvm::MemoryBuffer::getFile(it->path());
+    ASSERT_TRUE(static_cast<bool>(buffer));
+    std::string data = (*buffer)->getBuffer().str();
+    data.back() ^= 0xFF;
+
+    llvm::raw_fd_ostream os(it->path(), ec);
+    ASSERT_FALSE(ec);
+    os << data;
+  }
+
+  EXPECT_EQ(cache->Lookup(key), nullptr);
+  EXPECT_EQ(cache->GetStats().corruptions, 1);
+  EXPECT_EQ(NumFiles(), 0);
+}
+
+TEST_F(PersistentObjectCacheTest, EvictLeastRecentlyUsed) {
+  std::string object(1000, 'x');
+
+  // Cache can fit only two entries.
+  auto cache = CreateCache(/*max_size_bytes=*/2500);
+
+  PersistentObjectCache::Key key0 = {"module0", "options", "target"};
+  PersistentObjectCache::Key key1 = {"module1", "options", "target"};
+  PersistentObjectCache::Key key2 = {"module2", "options", "target"};
+
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key0, object)));
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key1, object)));
+  EXPECT_EQ(NumFiles(), 2);
+
+  AgeEntries();
+  ASSERT_NE(cache->Lookup(key1), nullptr);
+
+  ASSERT_FALSE(static_cast<bool>(cache->Insert(key2, object)));
+  EXPECT_EQ(NumFiles(), 2);
+  EXPECT_EQ(cache->GetStats().evictions, 1);
+  EXPECT_LE(cache->GetStats().size_bytes, 2500);
+
+  // The least recently used entry must be evicted.
+  EXPECT_EQ(cache->Lookup(key0), nullptr);
+  EXPECT_NE(cache->Lookup(key1), nullptr);
+  EXPECT_NE(cache->Lookup(key2), nullptr);
+}
+
+}  // namespace
+}  // namespace tfrt
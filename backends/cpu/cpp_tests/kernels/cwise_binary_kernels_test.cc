@@ -106,4 +106,37 @@ BM_Add_TensorD2_Scalar(4, 1500, 300);
 BM_Add_TensorD2_Scalar(8, 1500, 300);
 BM_Add_TensorD2_Scalar(16, 1500, 300);
 
+void AddTensorTensorBcast(benchmark::State& state, int num_threads,
+                          ArrayRef<Index> lhs_dims, ArrayRef<Index> rhs_dims) {
+  TensorShape lhs_shape(lhs_dims);
+  TensorShape rhs_shape(rhs_dims);
+  BinaryKernel(state, num_threads, lhs_shape, rhs_shape);
+}
+
+#define BM_Add_Bcast(threads, name, lhs_dims, rhs_dims)                   \
+  static void BM_AddBcast_##name##_tpool_##threads(                        \
+      benchmark::State& state) {                                           \
+    AddTensorTensorBcast(state, threads, lhs_dims, rhs_dims);              \
+  }                                                                        \
+  BENCHMARK(BM_AddBcast_##name##_tpool_##threads)
+
+#define DIMS(...) ArrayRef<Index>({__VA_ARGS__})
+
+// [64, 256, 128] + [128] (row broadcast)
+BM_Add_Bcast(4, 64x256x128_128, DIMS(64, 256, 128), DIMS(128));
+BM_Add_Bcast(8, 64x256x128_128, DIMS(64, 256, 128), DIMS(128));
+BM_Add_Bcast(16, 64x256x128_128, DIMS(64, 256, 128), DIMS(128));
+
+// [64, 256, 128] + [64, 256, 1] (column broadcast)
+BM_Add_Bcast(4, 64x256x128_64x256x1, DIMS(64, 256, 128), DIMS(64, 256, 1));
+BM_Add_Bcast(8, 64x256x128_64x256x1, DIMS(64, 256, 128), DIMS(64, 256, 1));
+BM_Add_Bcast(16, 64x256x128_64x256x1, DIMS(64, 256, 128), DIMS(64, 256, 1));
+
+// [64, 1, 128] + [1, 256, 1] (both arguments broadcasted)
+BM_Add_Bcast(4, 64x1x128_1x256x1, DIMS(64, 1, 128), DIMS(1, 256, 1));
+BM_Add_Bcast(8, 64x1x128_1x256x1, DIMS(64, 1, 128), DIMS(1, 256, 1));
+BM_Add_Bcast(16, 64x1x128_1x256x1, DIMS(64, 1, 128), DIMS(1, 256, 1));
+
+#undef DIMS
+
 }  // namespace tfrt
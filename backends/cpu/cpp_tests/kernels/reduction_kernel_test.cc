@@ -0,0 +1,296 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Reduction kernels tests and benchmarks.
+
+#include "../../lib/kernels/reduction_kernel.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "tfrt/dtype/dtype.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/latch.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/tensor_metadata.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace cpu {
+namespace internal {
+
+static bool operator==(const ReductionStep& a, const ReductionStep& b) {
+  return a.outer == b.outer && a.reduced == b.reduced && a.inner == b.inner;
+}
+
+}  // namespace internal
+}  // namespace cpu
+
+namespace {
+
+using ::testing::ElementsAre;
+
+std::unique_ptr<HostContext> CreateTestHostContext(int num_threads) {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(num_threads, num_threads));
+}
+
+ExecutionContext CreateExecutionContext(HostContext* host) {
+  Expected<RCReference<RequestContext>> req_ctx =
+      RequestContextBuilder(host, /*resource_context=*/nullptr).build();
+  assert(req_ctx);
+  return ExecutionContext(std::move(*req_ctx));
+}
+
+cpu::internal::ReductionStep Step(Index outer, Index reduced, Index inner) {
+  return {outer, reduced, inner};
+}
+
+TEST(ReductionKernelTest, NormalizeReduction) {
+  using cpu::internal::NormalizeReduction;
+
+  // Inner, outer and middle reductions.
+  EXPECT_THAT(NormalizeReduction({4, 5}, {1}), ElementsAre(Step(4, 5, 1)));
+  EXPECT_THAT(NormalizeReduction({4, 5}, {0}), ElementsAre(Step(1, 4, 5)));
+  EXPECT_THAT(NormalizeReduction({3, 4, 5}, {1}), ElementsAre(Step(3, 4, 5)));
+
+  // Adjacent dimensions are collapsed.
+  EXPECT_THAT(NormalizeReduction({2, 3, 4, 5}, {2, 3}),
+              ElementsAre(Step(6, 20, 1)));
+  EXPECT_THAT(NormalizeReduction({2, 3, 4, 5}, {0, 1, 2, 3}),
+              ElementsAre(Step(1, 120, 1)));
+
+  // Dimensions of size 1 are dropped.
+  EXPECT_THAT(NormalizeReduction({2, 1, 4, 5}, {0, 2}),
+              ElementsAre(Step(1, 8, 5)));
+  EXPECT_THAT(NormalizeReduction({2, 1, 5}, {1}), ElementsAre());
+
+  // Non adjacent reduced dimensions are reduced in multiple steps.
+  EXPECT_THAT(NormalizeReduction({2, 3, 4, 5}, {0, 2}),
+              ElementsAre(Step(6, 4, 5), Step(1, 2, 15)));
+  EXPECT_THAT(NormalizeReduction({2, 3, 4, 5, 6}, {1, 3}),
+              ElementsAre(Step(24, 5, 6), Step(2, 3, 24)));
+}
+
+// Reduces `input` with `dims` along `axes` and returns the result.
+std::vector<float> Reduce(HostContext* host, cpu::ReductionOp op,
+                          ArrayRef<Index> dims, ArrayRef<int64_t> axes,
+                          ArrayRef<float> input, bool deterministic = false) {
+  ExecutionContext exec_ctx = CreateExecutionContext(host);
+
+  SmallVector<Index, 4> output_dims;
+  for (int64_t d = 0, rank = dims.size(); d < rank; ++d)
+    if (!llvm::is_contained(axes, d)) output_dims.push_back(dims[d]);
+
+  TensorMetadata input_md(GetDType<float>(), dims);
+  TensorMetadata output_md(GetDType<float>(), output_dims);
+
+  auto input_t = DenseHostTensor::CreateUninitialized(input_md, host);
+  auto output_t = DenseHostTensor::CreateUninitialized(output_md, host);
+  std::copy(input.begin(), input.end(),
+            static_cast<float*>(input_t->data()));
+
+  auto done = cpu::Reduce(op, *input_t, axes, deterministic,
+                          output_t.getPointer(), exec_ctx);
+  host->Await(done.CopyRCRef());
+  EXPECT_FALSE(done.IsError());
+
+  const float* data = static_cast<const float*>(output_t->data());
+  return std::vector<float>(data, data + output_t->NumElements());
+}
+
+TEST(ReductionKernelTest, Reduce) {
+  auto host = CreateTestHostContext(4);
+
+  // [[1, 2, 3], [4, 5, 6]]
+  std::vector<float> input = {1, 2, 3, 4, 5, 6};
+
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kSum, {2, 3}, {1}, input),
+              ElementsAre(6, 15));
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kSum, {2, 3}, {0}, input),
+              ElementsAre(5, 7, 9));
+  EXPECT_THAT(
+      Reduce(host.get(), cpu::ReductionOp::kSum, {2, 3}, {0, 1}, input),
+      ElementsAre(21));
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kProd, {2, 3}, {1}, input),
+              ElementsAre(6, 120));
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kMax, {2, 3}, {0}, input),
+              ElementsAre(4, 5, 6));
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kMin, {2, 3}, {1}, input),
+              ElementsAre(1, 4));
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kMean, {2, 3}, {1}, input),
+              ElementsAre(2, 5));
+  EXPECT_THAT(
+      Reduce(host.get(), cpu::ReductionOp::kMean, {2, 3}, {0, 1}, input),
+      ElementsAre(3.5));
+
+  // Empty reductions produce the reducer initial value, or NaN for the mean.
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kSum, {2, 0}, {1}, {}),
+              ElementsAre(0, 0));
+  EXPECT_THAT(Reduce(host.get(), cpu::ReductionOp::kMean, {2, 0}, {1}, {}),
+              ElementsAre(::testing::IsNan(), ::testing::IsNan()));
+}
+
+TEST(ReductionKernelTest, MeanMultipleSteps) {
+  auto host = CreateTestHostContext(4);
+
+  const std::vector<Index> dims = {4, 3, 8, 5};
+  std::vector<float> input(4 * 3 * 8 * 5);
+  for (size_t i = 0; i < input.size(); ++i) input[i] = i % 7;
+
+  // Reduce along axes [0, 2] with a reference loop.
+  std::vector<float> expected(3 * 5, 0.0f);
+  for (int a = 0; a < 4; ++a)
+    for (int b = 0; b < 3; ++b)
+      for (int c = 0; c < 8; ++c)
+        for (int d = 0; d < 5; ++d)
+          expected[b * 5 + d] += input[((a * 3 + b) * 8 + c) * 5 + d];
+  for (float& value : expected) value /= 4 * 8;
+
+  EXPECT_EQ(Reduce(host.get(), cpu::ReductionOp::kMean, dims, {0, 2}, input),
+            expected);
+}
+
+TEST(ReductionKernelTest, ReduceMultipleSteps) {
+  auto host = CreateTestHostContext(4);
+
+  const std::vector<Index> dims = {3, 5, 7, 11};
+  std::vector<float> input(3 * 5 * 7 * 11);
+  for (size_t i = 0; i < input.size(); ++i) input[i] = i % 13;
+
+  // Reduce along axes [0, 2] with a reference loop.
+  std::vector<float> expected(5 * 11, 0.0f);
+  for (int a = 0; a < 3; ++a)
+    for (int b = 0; b < 5; ++b)
+      for (int c = 0; c < 7; ++c)
+        for (int d = 0; d < 11; ++d)
+          expected[b * 11 + d] += input[((a * 5 + b) * 7 + c) * 11 + d];
+
+  EXPECT_EQ(
+      Reduce(host.get(), cpu::ReductionOp::kSum, dims, {0, 2}, input),
+      expected);
+}
+
+TEST(ReductionKernelTest, DeterministicSum) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> input(1 << 20);
+  for (float& value : input) value = dist(rng);
+
+  // Deterministic sums do not depend on the number of threads.
+  std::vector<float> results;
+  for (int num_threads : {1, 3, 8}) {
+    auto host = CreateTestHostContext(num_threads);
+    results.push_back(Reduce(host.get(), cpu::ReductionOp::kSum,
+                             {1 << 20}, {0}, input,
+                             /*deterministic=*/true)[0]);
+  }
+  EXPECT_EQ(results[0], results[1]);
+  EXPECT_EQ(results[0], results[2]);
+}
+
+TEST(ReductionKernelTest, ArgReduce) {
+  auto host = CreateTestHostContext(4);
+  ExecutionContext exec_ctx = CreateExecutionContext(host.get());
+
+  // [[1, 7, 3], [7, 5, 7]]
+  TensorMetadata input_md(GetDType<float>(), {2, 3});
+  auto input = DenseHostTensor::CreateUninitialized(input_md, host.get());
+  float* data = static_cast<float*>(input->data());
+  std::copy_n(std::vector<float>{1, 7, 3, 7, 5, 7}.begin(), 6, data);
+
+  auto arg_reduce = [&](cpu::ArgReductionOp op, int64_t axis,
+                        ArrayRef<Index> output_dims) {
+    TensorMetadata output_md(GetDType<int64_t>(), output_dims);
+    auto output = DenseHostTensor::CreateUninitialized(output_md, host.get());
+    auto done =
+        cpu::ArgReduce(op, *input, axis, output.getPointer(), exec_ctx);
+    host->Await(done.CopyRCRef());
+    EXPECT_FALSE(done.IsError());
+    const int64_t* indices = static_cast<const int64_t*>(output->data());
+    return std::vector<int64_t>(indices, indices + output->NumElements());
+  };
+
+  // Ties resolve to the smallest index.
+  EXPECT_THAT(arg_reduce(cpu::ArgReductionOp::kArgMax, 1, {2}),
+              ElementsAre(1, 0));
+  EXPECT_THAT(arg_reduce(cpu::ArgReductionOp::kArgMax, 0, {3}),
+              ElementsAre(1, 0, 1));
+  EXPECT_THAT(arg_reduce(cpu::ArgReductionOp::kArgMin, 1, {2}),
+              ElementsAre(0, 1));
+  EXPECT_THAT(arg_reduce(cpu::ArgReductionOp::kArgMin, 0, {3}),
+              ElementsAre(0, 1, 0));
+}
+
+void BM_Reduce(benchmark::State& state, int num_threads, ArrayRef<Index> dims,
+               ArrayRef<int64_t> axes, bool deterministic) {
+  auto host = CreateTestHostContext(num_threads);
+  ExecutionContext exec_ctx = CreateExecutionContext(host.get());
+
+  SmallVector<Index, 4> output_dims;
+  for (int64_t d = 0, rank = dims.size(); d < rank; ++d)
+    if (!llvm::is_contained(axes, d)) output_dims.push_back(dims[d]);
+
+  TensorMetadata input_md(GetDType<float>(), dims);
+  TensorMetadata output_md(GetDType<float>(), output_dims);
+
+  auto input = DenseHostTensor::CreateUninitialized(input_md, host.get());
+  auto output = DenseHostTensor::CreateUninitialized(output_md, host.get());
+  std::fill_n(static_cast<float*>(input->data()), input->NumElements(), 1.0f);
+
+  for (auto _ : state) {
+    auto done = cpu::Reduce(cpu::ReductionOp::kSum, *input, axes,
+                            deterministic, output.getPointer(), exec_ctx);
+    host->Await(done.CopyRCRef());
+  }
+
+  state.SetItemsProcessed(input->NumElements() * state.iterations());
+}
+
+#define BM_Sum(threads, name, dims, axes, deterministic)                   \
+  static void BM_Sum_##name##_tpool_##threads(benchmark::State& state) {  \
+    BM_Reduce(state, threads, dims, axes, deterministic);                 \
+  }                                                                       \
+  BENCHMARK(BM_Sum_##name##_tpool_##threads)
+
+#define DIMS(...) ArrayRef<Index>({__VA_ARGS__})
+#define AXES(...) ArrayRef<int64_t>({__VA_ARGS__})
+
+// [1024, 1024] -> [1024] (inner reduction)
+BM_Sum(8, 1024x1024_inner, DIMS(1024, 1024), AXES(1), false);
+// [1024, 1024] -> [1024] (outer reduction)
+BM_Sum(8, 1024x1024_outer, DIMS(1024, 1024), AXES(0), false);
+// [64, 256, 64] -> [64, 64] (middle reduction)
+BM_Sum(8, 64x256x64_middle, DIMS(64, 256, 64), AXES(1), false);
+// [64, 128, 8, 16] -> [128, 16] (two step reduction)
+BM_Sum(8, 64x128x8x16_two_steps, DIMS(64, 128, 8, 16), AXES(0, 2), false);
+// [1024 * 1024] -> [] (full reduction)
+BM_Sum(8, 1M_all, DIMS(1024 * 1024), AXES(0), false);
+BM_Sum(8, 1M_all_deterministic, DIMS(1024 * 1024), AXES(0), true);
+
+#undef AXES
+#undef DIMS
+
+}  // namespace
+}  // namespace tfrt
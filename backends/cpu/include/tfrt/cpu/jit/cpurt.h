@@ -39,6 +39,7 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "tfrt/cpu/jit/async_runtime.h"
 #include "tfrt/cpu/jit/async_runtime_api.h"
+#include "tfrt/cpu/jit/persistent_object_cache.h"
 #include "tfrt/dtype/dtype.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/host_context/task_function.h"
@@ -50,6 +51,13 @@ namespace Eigen {
 class ThreadPoolInterface;
 }  // namespace Eigen
 
+// Forward declare LLVM ORC types.
+namespace llvm {
+namespace orc {
+class LLJIT;
+}  // namespace orc
+}  // namespace llvm
+
 namespace tfrt {
 
 class ExecutionContext;
@@ -213,6 +221,13 @@ struct CompilationOptions {
 #else
   bool math_avx2 = false;
 #endif
+
+  // Persistent cache for the compiled object files. If set, executables are
+  // loaded from the cached object files when possible, and skip lowering to
+  // LLVM and code generation. The cache does not track the `register_dialects`,
+  // `register_pass_pipeline` and `type_converter` options, see
+  // PersistentObjectCache::Options `version`.
+  std::shared_ptr<PersistentObjectCache> object_cache;
 };
 
 //----------------------------------------------------------------------------//
@@ -875,18 +890,25 @@ class Executable {
   struct ExecuteOpts;
   struct KernelContext;
 
+  // Pointer to a compiled kernel function.
+  using KernelFunctionPtr = void (*)(void**);
+
+  // Constructors and the destructor are defined out of line, because LLJIT is
+  // an incomplete type in this header.
   Executable(std::unique_ptr<mlir::ExecutionEngine> engine,
              FunctionType signature, FunctionType runtime_signature,
              string_view entrypoint, ResultsMemoryLayout results_memory_layout,
-             llvm::StringRef name)
-      : engine_(std::move(engine)),
-        signature_(std::move(signature)),
-        runtime_signature_(std::move(runtime_signature)),
-        fptr_(*engine_->lookup(entrypoint)),
-        results_memory_layout_(std::move(results_memory_layout)),
-        name_(name.str()) {
-    assert(fptr_ != nullptr && "entrypoint was not found");
-  }
+             llvm::StringRef name);
+
+  // Constructs an executable from the kernel function loaded into the `jit`
+  // from the object file (see PersistentObjectCache).
+  Executable(std::unique_ptr<llvm::orc::LLJIT> jit, KernelFunctionPtr fptr,
+             FunctionType signature, FunctionType runtime_signature,
+             ResultsMemoryLayout results_memory_layout, llvm::StringRef name);
+
+  Executable(Executable&&);
+  Executable& operator=(Executable&&);
+  ~Executable();
 
   // Initializes call frame by adding all operands as pointers to the arguments
   // vector. Also allocates storage for the returned values. Return values
@@ -1020,10 +1042,11 @@ class Executable {
       const FunctionType& signature);
 
  private:
-  // Pointer to a compiled kernel function.
-  using KernelFunctionPtr = void (*)(void**);
-
+  // Compiled kernel function is owned by the execution engine if it was
+  // compiled from the MLIR module, or by the LLJIT instance if it was loaded
+  // from the object file.
   std::unique_ptr<mlir::ExecutionEngine> engine_;
+  std::unique_ptr<llvm::orc::LLJIT> jit_;
 
   // Signature of the compiled module entrypoint function before lowering to
   // the runtime dialects (see JitExecutable `signature_` for more details).
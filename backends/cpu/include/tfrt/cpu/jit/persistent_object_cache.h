@@ -0,0 +1,135 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// On-disk cache for the object files of the JIT compiled CPURT kernels.
+
+#ifndef TFRT_BACKENDS_CPU_JIT_PERSISTENT_OBJECT_CACHE_H_
+#define TFRT_BACKENDS_CPU_JIT_PERSISTENT_OBJECT_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+namespace cpu {
+namespace jit {
+
+// PersistentObjectCache stores object files produced by the JIT compilation of
+// CPURT kernels in a local directory, so that the next process that compiles
+// the same kernel can skip LLVM code generation and load the object file.
+//
+// Cache entries are keyed by the fingerprint of all the inputs that affect the
+// generated code: the (specialized) MLIR module, compilation options, and the
+// target CPU and its features. Each file stores a crc32c of the object file,
+// and entries that fail the checksum verification are removed from the cache.
+//
+// The total size of all cache entries is bounded by `max_size_bytes`, and the
+// least recently used entries are evicted when the limit is exceeded. The cache
+// directory can be shared by multiple processes: entries are written to a
+// temporary file and atomically renamed into place.
+class PersistentObjectCache {
+ public:
+  struct Options {
+    // Directory for the cache entries, created if it does not exist.
+    std::string directory;
+
+    // The upper bound on the total size of the cache entries.
+    size_t max_size_bytes = 1024 * 1024 * 1024;
+
+    // Version string mixed into every cache key. The generated code also
+    // depends on the user provided pass pipeline and type converter (see
+    // CompilationOptions) which can't be fingerprinted, so this string must be
+    // changed whenever they change.
+    std::string version;
+  };
+
+  // Inputs that determine the object file produced by the compiler.
+  struct Key {
+    // Serialized MLIR module after specialization to the operands.
+    string_view module;
+    // Serialized compilation options that affect the generated code.
+    string_view compilation_options;
+    // Target CPU name and features.
+    string_view target;
+  };
+
+  // Cache statistics. Counters are updated concurrently, so the snapshot is not
+  // guaranteed to be consistent.
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t insertions = 0;
+    int64_t evictions = 0;
+    // Number of cache entries dropped because they failed verification.
+    int64_t corruptions = 0;
+    // Estimated total size of the cache entries in the cache directory.
+    int64_t size_bytes = 0;
+  };
+
+  static Expected<std::unique_ptr<PersistentObjectCache>> Create(
+      Options options);
+
+  // Returns the target CPU name and features of the host.
+  static std::string HostTarget();
+
+  // Returns the object file for the `key`, or nullptr if it is not in the
+  // cache.
+  std::unique_ptr<llvm::MemoryBuffer> Lookup(const Key& key);
+
+  // Adds the `object` file for the `key` to the cache. Evicts the least
+  // recently used entries if the cache size exceeds the limit. Empty objects
+  // are rejected with an error.
+  Error Insert(const Key& key, string_view object);
+
+  Stats GetStats() const;
+
+  const Options& options() const { return options_; }
+
+ private:
+  explicit PersistentObjectCache(Options options, size_t size_bytes);
+
+  // Returns the path to the cache entry for the `key`.
+  std::string EntryPath(const Key& key) const;
+
+  // Removes the least recently used entries until the cache fits into the size
+  // limit.
+  void Evict();
+
+  const Options options_;
+
+  std::atomic<int64_t> num_hits_{0};
+  std::atomic<int64_t> num_misses_{0};
+  std::atomic<int64_t> num_insertions_{0};
+  std::atomic<int64_t> num_evictions_{0};
+  std::atomic<int64_t> num_corruptions_{0};
+  std::atomic<int64_t> size_bytes_;
+
+  // Serializes the eviction of the cache entries.
+  mutex evict_mu_;
+};
+
+}  // namespace jit
+}  // namespace cpu
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_CPU_JIT_PERSISTENT_OBJECT_CACHE_H_
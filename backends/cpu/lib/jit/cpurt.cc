@@ -31,7 +31,12 @@
 #include <utility>
 
 #include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "llvm/ExecutionEngine/Orc/Mangling.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
@@ -91,6 +96,7 @@
 #include "tfrt/host_context/diagnostic.h"
 #include "tfrt/host_context/host_buffer.h"
 #include "tfrt/support/error_util.h"
+#include "tfrt/support/logging.h"
 #include "tfrt/support/string_util.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/tensor.h"
@@ -360,6 +366,42 @@ static void PrependKernelContextType(mlir::FuncOp func) {
   func.insertArguments({0}, {new_type}, {attr}, {});
 }
 
+//----------------------------------------------------------------------------//
+// Executable construction and destruction.
+//----------------------------------------------------------------------------//
+
+Executable::Executable(std::unique_ptr<mlir::ExecutionEngine> engine,
+                       FunctionType signature, FunctionType runtime_signature,
+                       string_view entrypoint,
+                       ResultsMemoryLayout results_memory_layout,
+                       llvm::StringRef name)
+    : engine_(std::move(engine)),
+      signature_(std::move(signature)),
+      runtime_signature_(std::move(runtime_signature)),
+      fptr_(*engine_->lookup(entrypoint)),
+      results_memory_layout_(std::move(results_memory_layout)),
+      name_(name.str()) {
+  assert(fptr_ != nullptr && "entrypoint was not found");
+}
+
+Executable::Executable(std::unique_ptr<llvm::orc::LLJIT> jit,
+                       KernelFunctionPtr fptr, FunctionType signature,
+                       FunctionType runtime_signature,
+                       ResultsMemoryLayout results_memory_layout,
+                       llvm::StringRef name)
+    : jit_(std::move(jit)),
+      signature_(std::move(signature)),
+      runtime_signature_(std::move(runtime_signature)),
+      fptr_(fptr),
+      results_memory_layout_(std::move(results_memory_layout)),
+      name_(name.str()) {
+  assert(fptr_ != nullptr && "entrypoint was not found");
+}
+
+Executable::Executable(Executable&&) = default;
+Executable& Executable::operator=(Executable&&) = default;
+Executable::~Executable() = default;
+
 //----------------------------------------------------------------------------//
 // Get compiled function results memory layout.
 //----------------------------------------------------------------------------//
@@ -1208,6 +1250,124 @@ JitCompilationContext::Instantiate(CompilationOptions opts,
   return {std::move(context)};
 }
 
+//----------------------------------------------------------------------------//
+// Persistent object cache integration.
+//----------------------------------------------------------------------------//
+
+namespace {
+// Serialized inputs of the compilation that are used as a persistent object
+// cache key.
+struct ObjectCacheKey {
+  std::string module;
+  std::string compilation_options;
+  std::string target;
+
+  PersistentObjectCache::Key key() const {
+    return {module, compilation_options, target};
+  }
+};
+}  // namespace
+
+static ObjectCacheKey GetObjectCacheKey(mlir::ModuleOp module,
+                                        const CompilationOptions& opts) {
+  ObjectCacheKey key;
+
+  // Specialized module has all the information about the operands shapes and
+  // values (sunk constants), so it is also a fingerprint of the specialization.
+  llvm::raw_string_ostream module_os(key.module);
+  module.print(module_os);
+  module_os.flush();
+
+  // Only options that affect the lowering and the code generation.
+  llvm::raw_string_ostream opts_os(key.compilation_options);
+  opts_os << "alignment=" << opts.alignment
+          << ";num_worker_threads=" << opts.num_worker_threads
+          << ";math_avx2=" << opts.math_avx2 << ";jit_code_opt_level=";
+  if (opts.jit_code_opt_level.hasValue())
+    opts_os << static_cast<int>(*opts.jit_code_opt_level);
+  opts_os.flush();
+
+  key.target = PersistentObjectCache::HostTarget();
+  return key;
+}
+
+// Loads the object file into the new LLJIT instance, and resolves the kernel
+// function for the `entrypoint`.
+static Expected<std::pair<std::unique_ptr<llvm::orc::LLJIT>,
+                          Executable::KernelFunctionPtr>>
+LoadObjectFile(std::unique_ptr<llvm::MemoryBuffer> object,
+               llvm::StringRef entrypoint) {
+  auto builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!builder) return builder.takeError();
+
+  auto jit = llvm::orc::LLJITBuilder()
+                 .setJITTargetMachineBuilder(std::move(*builder))
+                 .create();
+  if (!jit) return jit.takeError();
+
+  llvm::orc::JITDylib& main = (*jit)->getMainJITDylib();
+  const llvm::DataLayout& data_layout = (*jit)->getDataLayout();
+
+  // Resolve symbols that are not provided by the runtime (e.g. libm functions)
+  // from the current process, the same way as the MLIR execution engine does.
+  auto generator =
+      llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          data_layout.getGlobalPrefix());
+  if (!generator) return generator.takeError();
+  main.addGenerator(std::move(*generator));
+
+  // Register the same runtime intrinsics as for the compiled modules.
+  llvm::orc::MangleAndInterner mangle(main.getExecutionSession(), data_layout);
+  for (auto symbol_map :
+       {AsyncRuntimeApiSymbolMap, runtime::RuntimeApiSymbolMap,
+        AsyncRuntimeMemoryAllocationSymbolMap}) {
+    if (auto err = main.define(llvm::orc::absoluteSymbols(symbol_map(mangle))))
+      return std::move(err);
+  }
+
+  if (auto err = (*jit)->addObjectFile(std::move(object)))
+    return std::move(err);
+
+  // Kernel function is the packed interface function generated by the MLIR
+  // execution engine (see mlir::ExecutionEngine `packFunctionArguments`).
+  auto symbol = (*jit)->lookup(("_mlir_" + entrypoint).str());
+  if (!symbol) return symbol.takeError();
+
+  auto fptr = reinterpret_cast<Executable::KernelFunctionPtr>(
+      static_cast<uintptr_t>(symbol->getAddress()));
+  return std::make_pair(std::move(*jit), fptr);
+}
+
+// Adds the object file compiled by the execution `engine` to the cache.
+static Error AddToObjectCache(mlir::ExecutionEngine& engine,
+                              PersistentObjectCache& cache,
+                              const ObjectCacheKey& key) {
+  // Execution engine can only dump the object file to the file system.
+  llvm::SmallString<128> path;
+  if (std::error_code ec =
+          llvm::sys::fs::createTemporaryFile("cpurt", "o", path))
+    return MakeStringError("failed to create temporary file: ", ec.message());
+  engine.dumpToObjectFile(path);
+
+  auto object = llvm::MemoryBuffer::getFile(path);
+  llvm::sys::fs::remove(path);
+  if (!object)
+    return MakeStringError("failed to read object file: ",
+                           object.getError().message());
+
+  // Execution engine does not report dump failures, and leaves the temporary
+  // file empty. Do not store anything that can't be loaded later.
+  if ((*object)->getBufferSize() == 0)
+    return MakeStringError("execution engine dumped an empty object file");
+  auto object_file =
+      llvm::object::ObjectFile::createObjectFile((*object)->getMemBufferRef());
+  if (!object_file)
+    return MakeStringError("execution engine dumped an invalid object file: ",
+                           llvm::toString(object_file.takeError()));
+
+  return cache.Insert(key.key(), (*object)->getBuffer());
+}
+
 /*static*/ Expected<Executable> JitCompilationContext::Compile(
     std::unique_ptr<JitCompilationContext> ctx) {
   mlir::FuncOp entry_func = ctx->entrypoint();
@@ -1217,6 +1377,12 @@ JitCompilationContext::Instantiate(CompilationOptions opts,
   auto signature = FunctionType::Convert(entry_func.getType());
   if (auto err = signature.takeError()) return std::move(err);
 
+  // Compute the persistent object cache key from the module before lowering.
+  PersistentObjectCache* object_cache = ctx->options().object_cache.get();
+  ObjectCacheKey object_cache_key;
+  if (object_cache)
+    object_cache_key = GetObjectCacheKey(ctx->module(), ctx->options());
+
   // Lower loaded module to dialects supported by the CPURT to LLVM pipeline.
   if (failed(LowerToCpurt(ctx->module(), ctx->options())))
     return ctx->Error("failed to lower module to CPURT dialects");
@@ -1235,6 +1401,24 @@ JitCompilationContext::Instantiate(CompilationOptions opts,
       Executable::GetResultsMemoryLayout(*runtime_signature);
   if (auto err = results_memory_layout.takeError()) return std::move(err);
 
+  // Try to load the compiled kernel from the persistent object cache. Lowering
+  // to the CPURT dialects is still required to get the runtime signature, but
+  // lowering to LLVM and the code generation are skipped.
+  if (object_cache) {
+    if (auto object = object_cache->Lookup(object_cache_key.key())) {
+      auto loaded = LoadObjectFile(std::move(object), entrypoint);
+      if (loaded)
+        return Executable(std::move(loaded->first), loaded->second,
+                          std::move(*signature), std::move(*runtime_signature),
+                          std::move(*results_memory_layout),
+                          ctx->name().str());
+
+      // Fall back on compiling the module if the object file can't be loaded.
+      TFRT_LOG(WARNING) << "Failed to load cached object file: "
+                        << llvm::toString(loaded.takeError());
+    }
+  }
+
   // Lower kernel IR from high level dialects to the MLIR LLVM Dialect.
   if (failed(LowerToLlvm(ctx->module(), ctx->options())))
     return ctx->Error("failed to lower module to LLVM");
@@ -1267,6 +1451,17 @@ JitCompilationContext::Instantiate(CompilationOptions opts,
   // Register memory allocation functions (malloc, free, ...).
   (*engine)->registerSymbols(AsyncRuntimeMemoryAllocationSymbolMap);
 
+  if (object_cache) {
+    // Trigger the code generation by looking up the entrypoint function.
+    auto fptr = (*engine)->lookup(entrypoint);
+    if (!fptr) return ctx->Error(fptr.takeError());
+
+    // Failure to update the cache is not a compilation error.
+    if (auto err = AddToObjectCache(**engine, *object_cache, object_cache_key))
+      TFRT_LOG(WARNING) << "Failed to add object file to the cache: "
+                        << llvm::toString(std::move(err));
+  }
+
   return Executable(std::move(*engine), std::move(*signature),
                     std::move(*runtime_signature), entrypoint,
                     std::move(*results_memory_layout), ctx->name().str());
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- persistent_object_cache.cc - ---------------------------------------===//
+// On-disk cache for the object files of the JIT compiled CPURT kernels.
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/cpu/jit/persistent_object_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/support/crc32c.h"
+#include "tfrt/support/error_util.h"
+
+namespace tfrt {
+namespace cpu {
+namespace jit {
+
+namespace fs = ::llvm::sys::fs;
+
+// Cache entry file starts with a header followed by the object file.
+struct EntryHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t object_crc32c;  // masked crc32c of the object file
+  uint64_t object_size;
+};
+
+static constexpr char kEntryMagic[8] = {'C', 'P', 'U', 'R', 'T', 'O', 'B', 'J'};
+static constexpr char kEntryExtension[] = ".cpurt.o";
+
+// Must be incremented every time the entry format, or the key computation
+// changes.
+static constexpr uint32_t kEntryVersion = 1;
+
+static bool IsCacheEntry(string_view path) {
+  return llvm::StringRef(path).endswith(kEntryExtension);
+}
+
+// Returns the total size of all the cache entries in the `directory`.
+static size_t GetCacheSize(string_view directory) {
+  size_t size = 0;
+  std::error_code ec;
+  for (fs::directory_iterator it(directory, ec), end; it != end && !ec;
+       it.increment(ec)) {
+    if (!IsCacheEntry(it->path())) continue;
+    fs::file_status status;
+    if (!fs::status(it->path(), status)) size += status.getSize();
+  }
+  return size;
+}
+
+/*static*/ Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(Options options) {
+  if (options.directory.empty())
+    return MakeStringError("object cache directory must be not empty");
+
+  if (std::error_code ec = fs::create_directories(options.directory))
+    return MakeStringError("failed to create object cache directory ",
+                           options.directory, ": ", ec.message());
+
+  size_t size_bytes = GetCacheSize(options.directory);
+  return std::unique_ptr<PersistentObjectCache>(
+      new PersistentObjectCache(std::move(options), size_bytes));
+}
+
+PersistentObjectCache::PersistentObjectCache(Options options,
+                                             size_t size_bytes)
+    : options_(std::move(options)), size_bytes_(size_bytes) {}
+
+/*static*/ std::string PersistentObjectCache::HostTarget() {
+  std::string target = llvm::sys::getHostCPUName().str();
+
+  // Sort features to get a deterministic target string.
+  llvm::StringMap<bool> features;
+  llvm::sys::getHostCPUFeatures(features);
+  std::vector<std::string> enabled;
+  for (auto& feature : features)
+    if (feature.getValue()) enabled.push_back(feature.getKey().str());
+  llvm::sort(enabled);
+
+  for (auto& feature : enabled) target.append(",+").append(feature);
+  return target;
+}
+
+std::string PersistentObjectCache::EntryPath(const Key& key) const {
+  std::string fingerprint;
+  llvm::raw_string_ostream os(fingerprint);
+
+  // Prefix all key parts with their size, to make the fingerprint unambiguous.
+  auto append = [&](string_view part) { os << part.size() << ":" << part; };
+  append(LLVM_VERSION_STRING);
+  append(std::to_string(kEntryVersion));
+  append(options_.version);
+  append(key.target);
+  append(key.compilation_options);
+  append(key.module);
+  os.flush();
+
+  std::string name = llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(
+                                     fingerprint)),
+                                 /*LowerCase=*/true);
+
+  llvm::SmallString<128> path(options_.directory);
+  llvm::sys::path::append(path, name + kEntryExtension);
+  return path.str().str();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> PersistentObjectCache::Lookup(
+    const Key& key) {
+  std::string path = EntryPath(key);
+
+  // Drops the corrupted cache entry and reports a cache miss.
+  auto corrupted = [&]() -> std::unique_ptr<llvm::MemoryBuffer> {
+    num_corruptions_.fetch_add(1, std::memory_order_relaxed);
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
+    fs::remove(path);
+    return nullptr;
+  };
+
+  int fd;
+  if (fs::openFileForRead(path, fd)) {
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  fs::file_t file = fs::convertFDToNativeFile(fd);
+  auto buffer = llvm::MemoryBuffer::getOpenFile(
+      file, path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+
+  // Update the modification time to keep track of the recently used entries.
+  fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+  fs::closeFile(file);
+
+  if (!buffer) return corrupted();
+
+  llvm::StringRef data = (*buffer)->getBuffer();
+  if (data.size() < sizeof(EntryHeader)) return corrupted();
+
+  EntryHeader header;
+  std::memcpy(&header, data.data(), sizeof(EntryHeader));
+  llvm::StringRef object = data.drop_front(sizeof(EntryHeader));
+
+  if (std::memcmp(header.magic, kEntryMagic, sizeof(kEntryMagic)) != 0 ||
+      header.version != kEntryVersion || header.object_size != object.size() ||
+      crc32c::Unmask(header.object_crc32c) !=
+          crc32c::Value(object.data(), object.size()))
+    return corrupted();
+
+  num_hits_.fetch_add(1, std::memory_order_relaxed);
+  return llvm::MemoryBuffer::getMemBufferCopy(object, path);
+}
+
+Error PersistentObjectCache::Insert(const Key& key, string_view object) {
+  if (object.empty())
+    return MakeStringError("can't add an empty object file to the cache");
+
+  std::string path = EntryPath(key);
+
+  EntryHeader header;
+  std::memcpy(header.magic, kEntryMagic, sizeof(kEntryMagic));
+  header.version = kEntryVersion;
+  header.object_crc32c =
+      crc32c::Mask(crc32c::Value(object.data(), object.size()));
+  header.object_size = object.size();
+
+  // Write the entry to a temporary file, and then atomically rename it, so that
+  // the concurrent readers never observe partially written entries.
+  int fd;
+  llvm::SmallString<128> tmp_path;
+  if (std::error_code ec =
+          fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, tmp_path))
+    return MakeStringError("failed to create object cache entry: ",
+                           ec.message());
+
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(EntryHeader));
+    os << object;
+    os.close();
+
+    if (os.has_error()) {
+      std::error_code ec = os.error();
+      os.clear_error();
+      fs::remove(tmp_path);
+      return MakeStringError("failed to write object cache entry: ",
+                             ec.message());
+    }
+  }
+
+  // The size of the entry which is replaced by the rename, if any.
+  uint64_t replaced_size = 0;
+  if (fs::file_size(path, replaced_size)) replaced_size = 0;
+
+  if (std::error_code ec = fs::rename(tmp_path, path)) {
+    fs::remove(tmp_path);
+    return MakeStringError("failed to rename object cache entry: ",
+                           ec.message());
+  }
+
+  num_insertions_.fetch_add(1, std::memory_order_relaxed);
+  int64_t size_delta =
+      static_cast<int64_t>(sizeof(EntryHeader) + object.size()) -
+      static_cast<int64_t>(replaced_size);
+  if (size_bytes_.fetch_add(size_delta) + size_delta >
+      static_cast<int64_t>(options_.max_size_bytes))
+    Evict();
+
+  return Error::success();
+}
+
+void PersistentObjectCache::Evict() {
+  mutex_lock lock(evict_mu_);
+
+  struct Entry {
+    std::string path;
+    size_t size;
+    llvm::sys::TimePoint<> last_modified;
+  };
+
+  // Other processes might write to the same directory, so we always rescan it
+  // to find the actual cache size.
+  std::vector<Entry> entries;
+  size_t size = 0;
+
+  std::error_code ec;
+  for (fs::directory_iterator it(options_.directory, ec), end; it != end && !ec;
+       it.increment(ec)) {
+    if (!IsCacheEntry(it->path())) continue;
+    fs::file_status status;
+    if (fs::status(it->path(), status)) continue;
+    entries.push_back(
+        {it->path(), status.getSize(), status.getLastModificationTime()});
+    size += status.getSize();
+  }
+
+  // Remove the least recently used entries first.
+  llvm::sort(entries, [](const Entry& a, const Entry& b) {
+    return a.last_modified < b.last_modified;
+  });
+
+  for (const Entry& entry : entries) {
+    if (size <= options_.max_size_bytes) break;
+    if (fs::remove(entry.path)) continue;
+    size -= entry.size;
+    num_evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  size_bytes_.store(size);
+}
+
+PersistentObjectCache::Stats PersistentObjectCache::GetStats() const {
+  Stats stats;
+  stats.hits = num_hits_.load(std::memory_order_relaxed);
+  stats.misses = num_misses_.load(std::memory_order_relaxed);
+  stats.insertions = num_insertions_.load(std::memory_order_relaxed);
+  stats.evictions = num_evictions_.load(std::memory_order_relaxed);
+  stats.corruptions = num_corruptions_.load(std::memory_order_relaxed);
+  stats.size_bytes = size_bytes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace jit
+}  // namespace cpu
+}  // namespace tfrt
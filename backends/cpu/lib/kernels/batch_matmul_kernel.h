@@ -0,0 +1,180 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Batched MatMul kernel implementation.
+
+#ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_BATCH_MATMUL_KERNEL_H_
+#define TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_BATCH_MATMUL_KERNEL_H_
+
+#include <algorithm>
+#include <memory>
+
+#include "tfrt/common/compat/eigen/contraction_kernel.h"
+#include "tfrt/common/compat/eigen/eigen_evaluator.h"
+#include "tfrt/common/compat/eigen/tensor_types.h"
+#include "tfrt/host_context/async_dispatch.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace cpu {
+namespace internal {
+
+// GEMMs with at least this many multiply-adds are evaluated as separate Eigen
+// contractions, each parallelized by the Eigen thread pool device. Smaller
+// GEMMs are evaluated on a single thread each, and the batch is split across
+// threads.
+constexpr size_t kMinCostForParallelGemm = 128 * 128 * 128;
+
+// The minimum number of multiply-adds evaluated by a task that computes a
+// part of the batch.
+constexpr size_t kMinCostPerBatchTask = 64 * 64 * 64;
+
+// The batch layout of a BatchMatMul operand: `strides[d]` is the stride of its
+// matrices along the output batch dimension `d`, or 0 if it is broadcasted.
+struct BatchMatMulOperandLayout {
+  const void* data;
+  SmallVector<Index, 4> strides;
+
+  BatchMatMulOperandLayout(const DenseHostTensor& tensor, int batch_rank)
+      : data(tensor.data()), strides(batch_rank, 0) {
+    const int rank = tensor.shape().GetRank();
+    Index stride = tensor.shape().GetDimensionSize(rank - 2) *
+                   tensor.shape().GetDimensionSize(rank - 1);
+    for (int d = rank - 3, od = batch_rank - 1; d >= 0; --d, --od) {
+      const Index dim = tensor.shape().GetDimensionSize(d);
+      if (dim != 1) strides[od] = stride;
+      stride *= dim;
+    }
+  }
+
+  // Returns the offset of the matrix for the output batch index `index`.
+  Index Offset(Index index, ArrayRef<Index> batch_dims) const {
+    Index offset = 0;
+    for (int d = batch_dims.size() - 1; d >= 0; --d) {
+      offset += (index % batch_dims[d]) * strides[d];
+      index /= batch_dims[d];
+    }
+    return offset;
+  }
+};
+
+}  // namespace internal
+
+// Batched matrix multiplication kernel:
+//   C[..., :, :] = op(A[..., :, :]) * op(B[..., :, :])
+//
+// where op() transposes the matrix if `adj_a` or `adj_b` is set. The batch
+// dimensions of A and B are broadcasted to the batch dimensions of C, with the
+// usual broadcasting rules. A and B have a rank of at least 2.
+template <typename T>
+AsyncValueRef<Chain> BatchMatMul(const DenseHostTensor& a,
+                                 const DenseHostTensor& b, bool adj_a,
+                                 bool adj_b, DenseHostTensor* c,
+                                 const ExecutionContext& exec_ctx) {
+  using ConstMatrix = Eigen::TensorMap<
+      const Eigen::Tensor<T, 2, Eigen::RowMajor, Eigen::Index>,
+      Eigen::Unaligned>;
+  using Matrix =
+      Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor, Eigen::Index>,
+                       Eigen::Unaligned>;
+
+  const int a_rank = a.shape().GetRank();
+  const int b_rank = b.shape().GetRank();
+  const int c_rank = c->shape().GetRank();
+  const Index a_rows = a.shape().GetDimensionSize(a_rank - 2);
+  const Index a_cols = a.shape().GetDimensionSize(a_rank - 1);
+  const Index b_rows = b.shape().GetDimensionSize(b_rank - 2);
+  const Index b_cols = b.shape().GetDimensionSize(b_rank - 1);
+  const Index m = c->shape().GetDimensionSize(c_rank - 2);
+  const Index n = c->shape().GetDimensionSize(c_rank - 1);
+  const Index k = adj_a ? a_rows : a_cols;
+
+  SmallVector<Index, 4> batch_dims(c_rank - 2);
+  for (int d = 0; d < c_rank - 2; ++d)
+    batch_dims[d] = c->shape().GetDimensionSize(d);
+  Index batch_size = 1;
+  for (Index dim : batch_dims) batch_size *= dim;
+
+  if (batch_size == 0 || m == 0 || n == 0) return GetReadyChain();
+
+  Eigen::array<Eigen::IndexPair<Eigen::Index>, 1> contract_dim;
+  contract_dim[0].first = adj_a ? 0 : 1;
+  contract_dim[0].second = adj_b ? 1 : 0;
+
+  const internal::BatchMatMulOperandLayout a_layout(a, c_rank - 2);
+  const internal::BatchMatMulOperandLayout b_layout(b, c_rank - 2);
+  const T* a_data = static_cast<const T*>(a.data());
+  const T* b_data = static_cast<const T*>(b.data());
+  T* c_data = static_cast<T*>(c->data());
+
+  // Calls `fn(out, expr)` with the Eigen expressions of the `i`-th GEMM of the
+  // batch. Expressions refer to the local tensor maps, and must be evaluated
+  // before `fn` returns.
+  auto with_gemm = [=, batch_dims = batch_dims](Index i, auto fn) {
+    ConstMatrix lhs(a_data + a_layout.Offset(i, batch_dims), a_rows, a_cols);
+    ConstMatrix rhs(b_data + b_layout.Offset(i, batch_dims), b_rows, b_cols);
+    Matrix out(c_data + i * m * n, m, n);
+    return fn(out, lhs.contract(rhs, contract_dim));
+  };
+
+  const size_t gemm_cost = std::max<size_t>(1, m * n * k);
+
+  // Large GEMMs: launch all of them at once, each GEMM is parallelized by the
+  // Eigen contraction.
+  if (batch_size == 1 || gemm_cost >= internal::kMinCostForParallelGemm) {
+    compat::AsyncEigenEvaluator eigen(exec_ctx.host());
+    SmallVector<RCReference<AsyncValue>, 4> gemms;
+    gemms.reserve(batch_size);
+    for (Index i = 0; i < batch_size; ++i) {
+      gemms.push_back(with_gemm(i, [&](Matrix out, auto expr) {
+        return eigen
+            .Evaluate(std::move(out), std::move(expr),
+                      eigen.KeepAlive(&a, &b, c))
+            .ReleaseRCRef();
+      }));
+    }
+    if (gemms.size() == 1) return AsyncValueRef<Chain>(std::move(gemms[0]));
+
+    auto done = MakeUnconstructedAsyncValueRef<Chain>();
+    RunWhenReady(gemms, [done = done.CopyRef()]() { done.emplace(); });
+    return done;
+  }
+
+  // Small GEMMs: split the batch across threads, and evaluate each GEMM on a
+  // single thread.
+  auto done = MakeUnconstructedAsyncValueRef<Chain>();
+  const size_t min_block_size =
+      std::max<size_t>(1, internal::kMinCostPerBatchTask / gemm_cost);
+  ParallelFor(exec_ctx).Execute(
+      batch_size, ParallelFor::BlockSizes::Min(min_block_size),
+      [with_gemm = std::move(with_gemm)](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+          with_gemm(i, [](Matrix out, auto expr) { out = expr; });
+      },
+      [done = done.CopyRef(),
+       buffers = compat::KeepBuffers::alive(&a, &b, c)]() { done.emplace(); });
+  return done;
+}
+
+}  // namespace cpu
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_BATCH_MATMUL_KERNEL_H_
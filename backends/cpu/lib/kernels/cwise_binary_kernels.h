@@ -19,13 +19,18 @@
 #ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CWISE_BINARY_KERNELS_H_
 #define TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CWISE_BINARY_KERNELS_H_
 
+#include <algorithm>
+#include <type_traits>
+
 #include "tfrt/common/compat/eigen/eigen_evaluator.h"
 #include "tfrt/common/compat/eigen/eigen_kernel.h"
 #include "tfrt/common/compat/eigen/tensor_types.h"
 #include "tfrt/common/ops/tf/bcast.h"
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/host_context/parallel_for.h"
 #include "tfrt/support/string_util.h"
 #include "tfrt/tensor/host_tensor.h"
 #include "tfrt/tensor/scalar_host_tensor.h"
@@ -168,8 +173,9 @@ struct BinaryKernelImpl {
   using Input = typename BinaryFunctor::Input;
   using Output = typename BinaryFunctor::Output;
 
-  explicit BinaryKernelImpl(EigenEvaluator eigen_evaluator)
-      : eigen{eigen_evaluator} {}
+  BinaryKernelImpl(EigenEvaluator eigen_evaluator,
+                   const ExecutionContext& exec_ctx)
+      : eigen{eigen_evaluator}, exec_ctx{exec_ctx} {}
 
   template <typename OnDone>
   void ScalarScalar(const HostTensor& lhs, const HostTensor& rhs,
@@ -270,73 +276,119 @@ struct BinaryKernelImpl {
   void TensorTensorBcast(const DenseHostTensor& lhs_tensor,
                          const DenseHostTensor& rhs_tensor,
                          DenseHostTensor* out_tensor, OnDone on_done) {
-    // Get broadcasting specifications for lhs and rhs arguments.
-    auto lhs_bcast = GetArgumentBCast(lhs_tensor.shape(), out_tensor->shape());
-    auto rhs_bcast = GetArgumentBCast(rhs_tensor.shape(), out_tensor->shape());
-
-    if (auto err = lhs_bcast.takeError()) {
-      on_done(std::move(err));
-      return;
-    }
-    if (auto err = rhs_bcast.takeError()) {
+    // Get collapsed broadcasting specification for lhs and rhs arguments.
+    auto bcast = GetBinaryBCast(lhs_tensor.shape(), rhs_tensor.shape());
+    if (auto err = bcast.takeError()) {
       on_done(std::move(err));
       return;
     }
 
-    const int rank = lhs_bcast->rank();
-    assert(lhs_bcast->rank() == rhs_bcast->rank());
-
-    auto lhs_arr_view = DHTArrayView<Input>(&lhs_tensor);
-    auto rhs_arr_view = DHTArrayView<Input>(&rhs_tensor);
+    auto compute = [bcast = std::move(*bcast),
+                    lhs = static_cast<const Input*>(lhs_tensor.data()),
+                    rhs = static_cast<const Input*>(rhs_tensor.data()),
+                    out = static_cast<Output*>(out_tensor->data())](
+                       size_t begin, size_t end) {
+      BinaryBCastBlock(bcast, lhs, rhs, out, begin, end);
+    };
 
-    // Use Rank type defined below to pass rank value via lambda argument.
-    auto dispatch = [&](auto rank_dispatch) -> void {
-      constexpr int rank = decltype(rank_dispatch)::value;
+    const size_t num_elements = out_tensor->NumElements();
 
-      FixedRankShape<rank> lhs_shape(TensorShape(lhs_bcast->reshape()));
-      FixedRankShape<rank> rhs_shape(TensorShape(rhs_bcast->reshape()));
+    // Synchronous evaluation computes all elements in the caller thread.
+    if (std::is_same<EigenEvaluator, compat::SyncEigenEvaluator>::value) {
+      if (num_elements > 0) compute(0, num_elements);
+      on_done(Error::success());
+      return;
+    }
 
-      auto out_view = MutableDHTIndexableView<Output, rank>(out_tensor);
-      auto lhs_t = compat::AsEigenConstTensor(lhs_arr_view, lhs_shape);
-      auto rhs_t = compat::AsEigenConstTensor(rhs_arr_view, rhs_shape);
-      auto out_t = compat::AsEigenTensor(out_view);
+    ParallelFor(exec_ctx).Execute(
+        num_elements, ParallelFor::BlockSizes::Min(kMinBCastBlockSize),
+        std::move(compute),
+        [buffers = eigen.KeepAlive(&lhs_tensor, &rhs_tensor, out_tensor),
+         on_done = std::move(on_done)]() { on_done(Error::success()); });
+  }
 
-      auto lhs_expr = lhs_t.broadcast(lhs_bcast->broadcast());
-      auto rhs_expr = rhs_t.broadcast(rhs_bcast->broadcast());
-      auto expr = lhs_expr.binaryExpr(rhs_expr, Functor());
+  // Computes output elements in the [begin, end) range of the flattened output
+  // tensor. Output is processed in segments along the innermost collapsed
+  // dimension, and each segment is evaluated as a vectorized Eigen expression:
+  //
+  //   (1) both arguments are contiguous: binary expression
+  //   (2) lhs (or rhs) is broadcasted: unary expression with a bound scalar
+  static void BinaryBCastBlock(const BinaryBCast& bcast, const Input* lhs,
+                               const Input* rhs, Output* out, size_t begin,
+                               size_t end) {
+    const int rank = bcast.rank();
+    ArrayRef<Index> dims = bcast.dims();
+    ArrayRef<Index> lhs_strides = bcast.lhs_strides();
+    ArrayRef<Index> rhs_strides = bcast.rhs_strides();
+
+    const Index inner_dim = dims[rank - 1];
+    const Index lhs_inner_stride = lhs_strides[rank - 1];
+    const Index rhs_inner_stride = rhs_strides[rank - 1];
+
+    // Compute outer dimensions coordinates of the first output element.
+    SmallVector<Index, 8> coords(rank - 1, 0);
+    Index lhs_offset = 0;
+    Index rhs_offset = 0;
+    Index outer = begin / inner_dim;
+    for (int d = rank - 2; d >= 0; --d) {
+      coords[d] = outer % dims[d];
+      outer /= dims[d];
+      lhs_offset += coords[d] * lhs_strides[d];
+      rhs_offset += coords[d] * rhs_strides[d];
+    }
 
-      eigen.Evaluate(
-          out_t, std::move(expr),
-          [buffers = eigen.KeepAlive(&lhs_tensor, &rhs_tensor, out_tensor),
-           on_done = std::move(on_done)]() { on_done(Error::success()); });
-    };
+    const Index last = static_cast<Index>(end);
+    Index inner = begin % inner_dim;
+    for (Index i = begin; i < last;) {
+      const Index size = std::min<Index>(inner_dim - inner, last - i);
+      const Input* lhs_segment = lhs + lhs_offset + inner * lhs_inner_stride;
+      const Input* rhs_segment = rhs + rhs_offset + inner * rhs_inner_stride;
+      EvaluateSegment(lhs_segment, lhs_inner_stride, rhs_segment,
+                      rhs_inner_stride, out + i, size);
+      i += size;
+      inner = 0;
+
+      // Move to the next segment.
+      for (int d = rank - 2; d >= 0; --d) {
+        lhs_offset += lhs_strides[d];
+        rhs_offset += rhs_strides[d];
+        if (++coords[d] < dims[d]) break;
+        lhs_offset -= lhs_strides[d] * dims[d];
+        rhs_offset -= rhs_strides[d] * dims[d];
+        coords[d] = 0;
+      }
+    }
+  }
 
-    // Rank 1 (vectors) must have the same number of elements, or one of the
-    // arguments must be a vector of size [1] to be broadcastable. These
-    // combinations are handled by TensorTensor function above, and we need to
-    // dispatch only tensors with rank 2 or higher.
-    if (rank == 2) {
-      dispatch(Rank<2>{});
-    } else if (rank == 3) {
-      dispatch(Rank<3>{});
-    } else if (rank == 4) {
-      dispatch(Rank<4>{});
-    } else if (rank == 5) {
-      dispatch(Rank<5>{});
+  static void EvaluateSegment(const Input* lhs, Index lhs_stride,
+                              const Input* rhs, Index rhs_stride, Output* out,
+                              Index size) {
+    using ConstVector = Eigen::TensorMap<
+        Eigen::Tensor<const Input, 1, Eigen::RowMajor, Eigen::Index>,
+        Eigen::Unaligned>;
+    using Vector = Eigen::TensorMap<
+        Eigen::Tensor<Output, 1, Eigen::RowMajor, Eigen::Index>,
+        Eigen::Unaligned>;
+
+    Vector out_t(out, size);
+
+    if (lhs_stride != 0 && rhs_stride != 0) {
+      out_t = ConstVector(lhs, size).binaryExpr(ConstVector(rhs, size),
+                                                Functor());
+    } else if (rhs_stride == 0) {
+      using BindRight = functor::BindRightScalar<Input, Output, Functor>;
+      out_t = ConstVector(lhs, size).unaryExpr(BindRight(*rhs));
     } else {
-      on_done(MakeStringError(
-          "Unsupported binary kernel broadcasting: lhs=", lhs_tensor.shape(),
-          " rhs=", rhs_tensor.shape(), " out=", out_tensor->shape()));
+      using BindLeft = functor::BindLeftScalar<Input, Output, Functor>;
+      out_t = ConstVector(rhs, size).unaryExpr(BindLeft(*lhs));
     }
   }
 
-  // Helper struct to pass compile time constant to lambda as a value argument.
-  template <int rank>
-  struct Rank {
-    static constexpr int value = rank;
-  };
+  // The minimum number of output elements computed by a single task.
+  static constexpr size_t kMinBCastBlockSize = 16 * 1024;
 
   EigenEvaluator eigen;
+  const ExecutionContext& exec_ctx;
 };
 
 }  // namespace internal
@@ -348,7 +400,7 @@ void BinaryKernel(const HostTensor& lhs, const HostTensor& rhs,
   using T = typename BinaryFunctor::Input;
 
   internal::BinaryKernelImpl<BinaryFunctor, EigenEvaluator> impl(
-      EigenEvaluator{exec_ctx.host()});
+      EigenEvaluator{exec_ctx.host()}, exec_ctx);
 
   if (isa<ScalarHostTensor<T>>(lhs) && isa<ScalarHostTensor<T>>(rhs)) {
     impl.ScalarScalar(lhs, rhs, output, std::move(on_done));
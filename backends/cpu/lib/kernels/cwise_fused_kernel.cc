@@ -0,0 +1,389 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Fused coefficient wise kernel implementation.
+
+#include "./cwise_fused_kernel.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+#include "./cwise_binary_kernels.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "tfrt/common/compat/eigen/eigen_dtype.h"
+#include "tfrt/common/ops/tf/bcast.h"
+#include "tfrt/dtype/dtype.h"
+#include "tfrt/host_context/parallel_for.h"
+
+namespace tfrt {
+namespace cpu {
+namespace {
+
+// Output elements are computed in blocks of this size, so that a block and the
+// broadcasted operands stay in the L1 cache between the fused operations.
+constexpr Index kBlockSize = 1024;
+
+// The minimum number of output elements computed by a parallel task.
+constexpr size_t kMinElementsPerTask = 16 * 1024;
+
+template <typename T>
+using IsFloat = std::integral_constant<bool, !std::is_integral<T>::value>;
+
+template <typename T>
+using ConstVector = Eigen::TensorMap<
+    Eigen::Tensor<const T, 1, Eigen::RowMajor, Eigen::Index>, Eigen::Unaligned>;
+
+template <typename T>
+using Vector =
+    Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor, Eigen::Index>,
+                     Eigen::Unaligned>;
+
+// An operand of the fused operations.
+template <typename T>
+struct Operand {
+  enum class Kind { kDense, kScalar, kBroadcast };
+
+  DenseHostTensor tensor;
+  Kind kind;
+  // Strides of the operand along the output dimensions (rhs strides), if the
+  // operand is broadcasted.
+  llvm::Optional<BinaryBCast> bcast;
+
+  const T* data() const { return static_cast<const T*>(tensor.data()); }
+};
+
+// The state of a FusedCwise shared by its parallel tasks.
+template <typename T>
+struct FusedCwiseState {
+  SmallVector<FusedCwiseOp, 4> ops;
+  SmallVector<Operand<T>, 4> operands;
+  DenseHostTensor output;
+  bool has_broadcast = false;
+};
+
+// Values of an operand for a block of the output: either `data` points to the
+// block values, or all values are equal to `scalar`.
+template <typename T>
+struct Block {
+  const T* data;
+  T scalar;
+};
+
+// Copies values of the broadcasted operand for the output elements in the
+// [begin, begin + size) range to `dst`.
+template <typename T>
+void Gather(const BinaryBCast& bcast, const T* src, Index begin, Index size,
+            T* dst) {
+  const int rank = bcast.rank();
+  ArrayRef<Index> dims = bcast.dims();
+  ArrayRef<Index> strides = bcast.rhs_strides();
+
+  const Index inner_dim = dims[rank - 1];
+  const Index inner_stride = strides[rank - 1];
+
+  // Compute outer dimensions coordinates of the first output element.
+  SmallVector<Index, 8> coords(rank - 1, 0);
+  Index offset = 0;
+  Index outer = begin / inner_dim;
+  for (int d = rank - 2; d >= 0; --d) {
+    coords[d] = outer % dims[d];
+    outer /= dims[d];
+    offset += coords[d] * strides[d];
+  }
+
+  Index inner = begin % inner_dim;
+  for (Index i = 0; i < size;) {
+    const Index n = std::min<Index>(inner_dim - inner, size - i);
+    if (inner_stride == 0) {
+      std::fill_n(dst + i, n, src[offset]);
+    } else {
+      std::copy_n(src + offset + inner, n, dst + i);
+    }
+    i += n;
+    inner = 0;
+
+    // Move to the next segment.
+    for (int d = rank - 2; d >= 0; --d) {
+      offset += strides[d];
+      if (++coords[d] < dims[d]) break;
+      offset -= strides[d] * dims[d];
+      coords[d] = 0;
+    }
+  }
+}
+
+template <typename T>
+Block<T> LoadBlock(const Operand<T>& operand, Index begin, Index size,
+                   T* scratch) {
+  switch (operand.kind) {
+    case Operand<T>::Kind::kDense:
+      return {operand.data() + begin, T()};
+    case Operand<T>::Kind::kScalar:
+      return {nullptr, operand.data()[0]};
+    case Operand<T>::Kind::kBroadcast:
+      Gather(*operand.bcast, operand.data(), begin, size, scratch);
+      return {scratch, T()};
+  }
+  llvm_unreachable("unexpected operand kind");
+}
+
+// Computes `out = f(lhs, rhs)` with vectorized Eigen expressions.
+template <typename T, typename F>
+void EvalBinary(const Block<T>& lhs, const Block<T>& rhs, T* out, Index size) {
+  Vector<T> out_t(out, size);
+
+  if (lhs.data && rhs.data) {
+    out_t = ConstVector<T>(lhs.data, size)
+                .binaryExpr(ConstVector<T>(rhs.data, size), F());
+  } else if (lhs.data) {
+    using BindRight = functor::BindRightScalar<T, T, F>;
+    out_t = ConstVector<T>(lhs.data, size).unaryExpr(BindRight(rhs.scalar));
+  } else if (rhs.data) {
+    using BindLeft = functor::BindLeftScalar<T, T, F>;
+    out_t = ConstVector<T>(rhs.data, size).unaryExpr(BindLeft(lhs.scalar));
+  } else {
+    out_t.setConstant(F()(lhs.scalar, rhs.scalar));
+  }
+}
+
+// Computes `out = f(in)` with vectorized Eigen expressions.
+template <typename T, typename F>
+void EvalUnary(const Block<T>& in, T* out, Index size, F f = F()) {
+  Vector<T> out_t(out, size);
+
+  if (in.data) {
+    out_t = ConstVector<T>(in.data, size).unaryExpr(f);
+  } else {
+    out_t.setConstant(f(in.scalar));
+  }
+}
+
+template <typename T>
+void ApplyBinary(FusedCwiseOp op, const Block<T>& lhs, const Block<T>& rhs,
+                 T* out, Index size) {
+  switch (op) {
+    case FusedCwiseOp::kAdd:
+      return EvalBinary<T, typename functor::Add::Functor<T>::Functor>(
+          lhs, rhs, out, size);
+    case FusedCwiseOp::kSub:
+      return EvalBinary<T, typename functor::Sub::Functor<T>::Functor>(
+          lhs, rhs, out, size);
+    case FusedCwiseOp::kMul:
+      return EvalBinary<T, typename functor::Mul::Functor<T>::Functor>(
+          lhs, rhs, out, size);
+    case FusedCwiseOp::kDiv:
+      return EvalBinary<T, typename functor::Div::Functor<T>::Functor>(
+          lhs, rhs, out, size);
+    default:
+      assert(false && "Unexpected binary operation");
+  }
+}
+
+// Unary operations defined only for floating point types.
+template <typename T>
+void ApplyFloatUnary(FusedCwiseOp op, const Block<T>& in, T* out, Index size,
+                     std::true_type) {
+  switch (op) {
+    case FusedCwiseOp::kSigmoid:
+      return EvalUnary<T, Eigen::internal::scalar_logistic_op<T>>(in, out,
+                                                                  size);
+    case FusedCwiseOp::kLog:
+      return EvalUnary<T, Eigen::internal::scalar_log_op<T>>(in, out, size);
+    case FusedCwiseOp::kLog1p:
+      return EvalUnary<T, Eigen::internal::scalar_log1p_op<T>>(in, out, size);
+    case FusedCwiseOp::kRsqrt:
+      return EvalUnary<T, Eigen::internal::scalar_rsqrt_op<T>>(in, out, size);
+    default:
+      assert(false && "Unexpected unary operation");
+  }
+}
+
+template <typename T>
+void ApplyFloatUnary(FusedCwiseOp op, const Block<T>& in, T* out, Index size,
+                     std::false_type) {
+  assert(false && "Unary operation is not supported for integer types");
+}
+
+template <typename T>
+void ApplyUnary(FusedCwiseOp op, const Block<T>& in, T* out, Index size) {
+  if (op == FusedCwiseOp::kRelu) {
+    using Max = Eigen::internal::scalar_max_op<T, T>;
+    return EvalUnary(in, out, size,
+                     functor::BindRightScalar<T, T, Max>(static_cast<T>(0)));
+  }
+  ApplyFloatUnary(op, in, out, size, IsFloat<T>());
+}
+
+// Computes output elements in the [begin, end) range one block at a time. The
+// output block is the accumulator of the fused operations, so every output
+// element is written to memory once.
+template <typename T>
+void ComputeRange(const FusedCwiseState<T>& state, size_t begin, size_t end) {
+  // Scratch space for the broadcasted operands of a single operation.
+  SmallVector<T, 0> scratch(state.has_broadcast ? 2 * kBlockSize : 0);
+  auto scratch_block = [&](int slot) -> T* {
+    return scratch.empty() ? nullptr : scratch.data() + slot * kBlockSize;
+  };
+
+  T* out = static_cast<T*>(const_cast<void*>(state.output.data()));
+
+  for (Index b = begin; b < static_cast<Index>(end); b += kBlockSize) {
+    const Index size = std::min<Index>(kBlockSize, end - b);
+    T* acc = out + b;
+
+    size_t next = 0;
+    for (size_t i = 0; i < state.ops.size(); ++i) {
+      const FusedCwiseOp op = state.ops[i];
+
+      Block<T> value =
+          i == 0 ? LoadBlock(state.operands[next++], b, size, scratch_block(0))
+                 : Block<T>{acc, T()};
+
+      if (IsBinaryFusedCwiseOp(op)) {
+        Block<T> rhs =
+            LoadBlock(state.operands[next++], b, size, scratch_block(1));
+        ApplyBinary(op, value, rhs, acc, size);
+      } else {
+        ApplyUnary(op, value, acc, size);
+      }
+    }
+  }
+}
+
+template <typename T>
+AsyncValueRef<Chain> FusedCwiseImpl(ArrayRef<FusedCwiseOp> ops,
+                                    ArrayRef<const DenseHostTensor*> operands,
+                                    DenseHostTensor* output,
+                                    const ExecutionContext& exec_ctx) {
+  if (!IsFloat<T>::value) {
+    for (FusedCwiseOp op : ops) {
+      if (IsBinaryFusedCwiseOp(op) || op == FusedCwiseOp::kRelu) continue;
+      return EmitErrorAsync(
+          exec_ctx, StrCat("Unsupported fused operation for dtype: ",
+                           output->dtype()));
+    }
+  }
+
+  const Index num_elements = output->NumElements();
+
+  auto state = std::make_shared<FusedCwiseState<T>>();
+  state->ops.assign(ops.begin(), ops.end());
+  state->output = output->CopyRef();
+
+  for (const DenseHostTensor* tensor : operands) {
+    if (tensor->dtype() != output->dtype())
+      return EmitErrorAsync(exec_ctx,
+                            StrCat("Operand dtype ", tensor->dtype(),
+                                   " doesn't match output dtype ",
+                                   output->dtype()));
+
+    Operand<T> operand;
+    operand.tensor = tensor->CopyRef();
+
+    if (tensor->NumElements() == num_elements) {
+      operand.kind = Operand<T>::Kind::kDense;
+    } else if (tensor->NumElements() == 1) {
+      operand.kind = Operand<T>::Kind::kScalar;
+    } else {
+      auto bcast = GetBinaryBCast(output->shape(), tensor->shape());
+      if (!bcast) return EmitErrorAsync(exec_ctx, bcast.takeError());
+
+      Index bcast_elements = 1;
+      for (Index dim : bcast->dims()) bcast_elements *= dim;
+      if (bcast_elements != num_elements)
+        return EmitErrorAsync(
+            exec_ctx, StrCat("Operand shape ", tensor->shape(),
+                             " is not broadcastable to ", output->shape()));
+
+      operand.kind = Operand<T>::Kind::kBroadcast;
+      operand.bcast = std::move(*bcast);
+      state->has_broadcast = true;
+    }
+
+    state->operands.push_back(std::move(operand));
+  }
+
+  if (num_elements == 0) return GetReadyChain();
+
+  auto chain = MakeUnconstructedAsyncValueRef<Chain>();
+  ParallelFor(exec_ctx).Execute(
+      num_elements, ParallelFor::BlockSizes::Min(kMinElementsPerTask),
+      [state](size_t begin, size_t end) { ComputeRange(*state, begin, end); },
+      [chain = chain.CopyRef(), state]() { chain.emplace(); });
+  return chain;
+}
+
+}  // namespace
+
+Expected<FusedCwiseOp> ParseFusedCwiseOp(string_view name) {
+  auto op = llvm::StringSwitch<llvm::Optional<FusedCwiseOp>>(name)
+                .Case("AddV2", FusedCwiseOp::kAdd)
+                .Case("Sub", FusedCwiseOp::kSub)
+                .Case("Mul", FusedCwiseOp::kMul)
+                .Case("RealDiv", FusedCwiseOp::kDiv)
+                .Case("Relu", FusedCwiseOp::kRelu)
+                .Case("Sigmoid", FusedCwiseOp::kSigmoid)
+                .Case("Log", FusedCwiseOp::kLog)
+                .Case("Log1p", FusedCwiseOp::kLog1p)
+                .Case("Rsqrt", FusedCwiseOp::kRsqrt)
+                .Default(llvm::None);
+  if (!op) return MakeStringError("Unsupported fused operation: ", name);
+  return *op;
+}
+
+size_t GetNumFusedCwiseOperands(ArrayRef<FusedCwiseOp> ops) {
+  if (ops.empty()) return 0;
+  size_t num_operands = IsBinaryFusedCwiseOp(ops[0]) ? 2 : 1;
+  for (FusedCwiseOp op : ops.drop_front())
+    if (IsBinaryFusedCwiseOp(op)) ++num_operands;
+  return num_operands;
+}
+
+AsyncValueRef<Chain> FusedCwise(ArrayRef<FusedCwiseOp> ops,
+                                ArrayRef<const DenseHostTensor*> operands,
+                                DenseHostTensor* output,
+                                const ExecutionContext& exec_ctx) {
+  if (ops.empty())
+    return EmitErrorAsync(exec_ctx, "FusedCwise must specify fused operations");
+
+  if (operands.size() != GetNumFusedCwiseOperands(ops))
+    return EmitErrorAsync(
+        exec_ctx, StrCat("FusedCwise expected ", GetNumFusedCwiseOperands(ops),
+                         " operands, got ", operands.size()));
+
+  switch (output->dtype()) {
+    case DType::F16:
+      return FusedCwiseImpl<EigenTypeForDTypeKind<DType::F16>>(
+          ops, operands, output, exec_ctx);
+    case DType::F32:
+      return FusedCwiseImpl<float>(ops, operands, output, exec_ctx);
+    case DType::F64:
+      return FusedCwiseImpl<double>(ops, operands, output, exec_ctx);
+    case DType::I32:
+      return FusedCwiseImpl<int32_t>(ops, operands, output, exec_ctx);
+    case DType::I64:
+      return FusedCwiseImpl<int64_t>(ops, operands, output, exec_ctx);
+    default:
+      return EmitErrorAsync(
+          exec_ctx, StrCat("Unsupported input dtype: ", output->dtype()));
+  }
+}
+
+}  // namespace cpu
+}  // namespace tfrt
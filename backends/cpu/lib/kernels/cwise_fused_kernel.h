@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Fused coefficient wise kernel implementation.
+
+#ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CWISE_FUSED_KERNEL_H_
+#define TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CWISE_FUSED_KERNEL_H_
+
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace cpu {
+
+// Coefficient wise operations supported by the fused kernel.
+enum class FusedCwiseOp {
+  // Binary operations.
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  // Unary operations.
+  kRelu,
+  kSigmoid,
+  kLog,
+  kLog1p,
+  kRsqrt,
+};
+
+// Returns the fused operation for a Tensorflow operation name without the
+// `tf.` prefix (e.g. "AddV2"), or an error if the operation can't be fused.
+Expected<FusedCwiseOp> ParseFusedCwiseOp(string_view name);
+
+inline bool IsBinaryFusedCwiseOp(FusedCwiseOp op) {
+  return op <= FusedCwiseOp::kDiv;
+}
+
+// Returns the number of operands of the fused operations: the first operation
+// takes all of its operands, and each following binary operation takes one
+// additional operand.
+size_t GetNumFusedCwiseOperands(ArrayRef<FusedCwiseOp> ops);
+
+// Fused coefficient wise kernel:
+//
+//   value = ops[0](operands[0] [, operands[1]])
+//   value = ops[i](value [, operands[next]])   for i in [1, ops.size())
+//   output = value
+//
+// The result of each operation is the lhs of the next binary operation.
+// Operands have the shape of the output, a single element, or a shape that is
+// broadcastable to the output shape. Broadcasted operands are not
+// materialized.
+//
+// The output is computed in a single pass over memory: blocks of the output
+// are computed in parallel, and all operations are applied to a block while it
+// is in the cache, without allocating intermediate tensors.
+AsyncValueRef<Chain> FusedCwise(ArrayRef<FusedCwiseOp> ops,
+                                ArrayRef<const DenseHostTensor*> operands,
+                                DenseHostTensor* output,
+                                const ExecutionContext& exec_ctx);
+
+}  // namespace cpu
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CWISE_FUSED_KERNEL_H_
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Quantized int8 MatMul kernel implementation.
+
+#include "./quantized_matmul_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/Optional.h"
+#include "tfrt/host_context/parallel_for.h"
+
+#if defined(TFRT_EIGEN_USE_MKLDNN_CONTRACTION_KERNEL)
+#include "dnnl.h"  // from @dnnl
+#endif
+
+namespace tfrt {
+namespace cpu {
+namespace {
+
+// The minimum number of multiply-accumulates computed by a parallel task.
+constexpr size_t kMinMacsPerTask = 1 << 18;
+
+// The state of a QuantizedMatMul shared by its parallel tasks.
+struct QuantizedMatMulState {
+  DenseHostTensor a;
+  DenseHostTensor b;
+  llvm::Optional<DenseHostTensor> bias;
+  DenseHostTensor c;
+  bool transpose_a;
+  bool transpose_b;
+  Index m, n, k;
+  // The rhs as a row-major [k, n] matrix, if `b` is transposed.
+  std::vector<int8_t> packed_b;
+  // The scale of each column: a_scale * b_scale[j].
+  std::vector<float> scales;
+  float inv_output_scale;
+  QuantizedActivation activation;
+
+  const int8_t* lhs() const { return static_cast<const int8_t*>(a.data()); }
+  const int8_t* rhs() const {
+    return packed_b.empty() ? static_cast<const int8_t*>(b.data())
+                            : packed_b.data();
+  }
+};
+
+// Computes the int32 products of the rows [begin, end) of the lhs with the
+// rhs into `acc`, a row-major [end - begin, n] matrix.
+void ComputeInt32Products(const QuantizedMatMulState& s, Index begin,
+                          Index end, int32_t* acc) {
+  const Index rows = end - begin;
+#if defined(TFRT_EIGEN_USE_MKLDNN_CONTRACTION_KERNEL)
+  // DNNL gemm takes row-major matrices.
+  const int8_t* a = s.transpose_a ? s.lhs() + begin : s.lhs() + begin * s.k;
+  const int32_t zero_offset = 0;
+  dnnl_status_t st = dnnl_gemm_s8s8s32(
+      s.transpose_a ? 'T' : 'N', 'N', 'F', rows, s.n, s.k, 1.0f, a,
+      s.transpose_a ? s.m : s.k, 0, s.rhs(), s.n, 0, 0.0f, acc, s.n,
+      &zero_offset);
+  if (st == dnnl_success) return;
+  // Fall back to the portable loop below if DNNL fails.
+#endif
+  const int8_t* b = s.rhs();
+  std::fill(acc, acc + rows * s.n, 0);
+  for (Index i = 0; i < rows; ++i) {
+    int32_t* acc_row = acc + i * s.n;
+    for (Index p = 0; p < s.k; ++p) {
+      const int32_t a_ip = s.transpose_a ? s.lhs()[p * s.m + begin + i]
+                                         : s.lhs()[(begin + i) * s.k + p];
+      if (a_ip == 0) continue;
+      // This loop is vectorized by the compiler.
+      const int8_t* b_row = b + p * s.n;
+      for (Index j = 0; j < s.n; ++j) acc_row[j] += a_ip * b_row[j];
+    }
+  }
+}
+
+float Activate(float value, QuantizedActivation activation) {
+  switch (activation) {
+    case QuantizedActivation::kNone:
+      return value;
+    case QuantizedActivation::kRelu:
+      return std::max(value, 0.0f);
+    case QuantizedActivation::kRelu6:
+      return std::min(std::max(value, 0.0f), 6.0f);
+  }
+  return value;
+}
+
+// Computes the rows [begin, end) of the result.
+void ComputeRows(QuantizedMatMulState& s, Index begin, Index end) {
+  std::vector<int32_t> acc((end - begin) * s.n);
+  ComputeInt32Products(s, begin, end, acc.data());
+
+  const float* bias =
+      s.bias ? static_cast<const float*>(s.bias->data()) : nullptr;
+  const bool dequantize = s.c.dtype() == DType::F32;
+  for (Index i = begin; i < end; ++i) {
+    const int32_t* acc_row = acc.data() + (i - begin) * s.n;
+    for (Index j = 0; j < s.n; ++j) {
+      float value = acc_row[j] * s.scales[j];
+      if (bias) value += bias[j];
+      value = Activate(value, s.activation);
+      if (dequantize) {
+        static_cast<float*>(s.c.data())[i * s.n + j] = value;
+      } else {
+        const float q = std::nearbyint(value * s.inv_output_scale);
+        static_cast<int8_t*>(s.c.data())[i * s.n + j] =
+            static_cast<int8_t>(std::min(std::max(q, -128.0f), 127.0f));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+AsyncValueRef<Chain> QuantizedMatMul(const DenseHostTensor& a,
+                                     const DenseHostTensor& b,
+                                     const DenseHostTensor* bias,
+                                     const QuantizedMatMulParams& params,
+                                     bool transpose_a, bool transpose_b,
+                                     DenseHostTensor* c,
+                                     const ExecutionContext& exec_ctx) {
+  auto is_int8 = [](DType dtype) {
+    return dtype == DType::I8 || dtype == DType::QI8;
+  };
+  if (!is_int8(a.dtype()) || !is_int8(b.dtype())) {
+    return EmitErrorAsync(exec_ctx,
+                          StrCat("Unsupported quantized MatMul input dtypes: ",
+                                 a.dtype(), ", ", b.dtype()));
+  }
+  if (c->dtype() != DType::F32 && !is_int8(c->dtype())) {
+    return EmitErrorAsync(
+        exec_ctx,
+        StrCat("Unsupported quantized MatMul output dtype: ", c->dtype()));
+  }
+
+  auto state = std::make_shared<QuantizedMatMulState>();
+  state->m = c->shape().GetDimensionSize(0);
+  state->n = c->shape().GetDimensionSize(1);
+  state->k = a.shape().GetDimensionSize(transpose_a ? 0 : 1);
+
+  if (params.b_scale.size() != 1 &&
+      params.b_scale.size() != static_cast<size_t>(state->n)) {
+    return EmitErrorAsync(
+        exec_ctx, StrCat("The number of rhs scales ", params.b_scale.size(),
+                         " must be 1 or match output inner dimension ",
+                         state->n));
+  }
+  if (bias &&
+      (bias->dtype() != DType::F32 || bias->NumElements() != state->n)) {
+    return EmitErrorAsync(
+        exec_ctx, StrCat("Bias must be a f32 vector of ", state->n,
+                         " elements, got ", bias->metadata()));
+  }
+
+  state->a = a.CopyRef();
+  state->b = b.CopyRef();
+  if (bias) state->bias = bias->CopyRef();
+  state->c = c->CopyRef();
+  state->transpose_a = transpose_a;
+  state->transpose_b = transpose_b;
+  state->activation = params.activation;
+  state->inv_output_scale = 1.0f / params.output_scale;
+  state->scales.resize(state->n);
+  for (Index j = 0; j < state->n; ++j) {
+    state->scales[j] =
+        params.a_scale * params.b_scale[params.b_scale.size() == 1 ? 0 : j];
+  }
+
+  // Transpose the rhs once, so that all row blocks can use it.
+  if (transpose_b) {
+    const auto* b_data = static_cast<const int8_t*>(b.data());
+    state->packed_b.resize(state->k * state->n);
+    for (Index j = 0; j < state->n; ++j) {
+      for (Index p = 0; p < state->k; ++p)
+        state->packed_b[p * state->n + j] = b_data[j * state->k + p];
+    }
+  }
+
+  auto chain = MakeUnconstructedAsyncValueRef<Chain>();
+  const size_t macs_per_row = std::max<size_t>(1, state->n * state->k);
+  ParallelFor(exec_ctx).Execute(
+      state->m,
+      ParallelFor::BlockSizes::Min(
+          std::max<size_t>(1, kMinMacsPerTask / macs_per_row)),
+      [state](size_t begin, size_t end) { ComputeRows(*state, begin, end); },
+      [chain = chain.CopyRef()]() { chain.emplace(); });
+  return chain;
+}
+
+}  // namespace cpu
+}  // namespace tfrt
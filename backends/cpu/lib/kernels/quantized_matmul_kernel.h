@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Quantized int8 MatMul kernel implementation.
+
+#ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_QUANTIZED_MATMUL_KERNEL_H_
+#define TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_QUANTIZED_MATMUL_KERNEL_H_
+
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace cpu {
+
+// Activation function applied to the dequantized result of QuantizedMatMul.
+enum class QuantizedActivation { kNone, kRelu, kRelu6 };
+
+// Symmetric quantization parameters of QuantizedMatMul. The real value of a
+// quantized element `q` is `q * scale`. All scales are positive and finite.
+struct QuantizedMatMulParams {
+  // Scale of the lhs tensor.
+  float a_scale = 1.0;
+  // Scales of the rhs tensor, either a single per-tensor scale or a scale for
+  // each output channel (column of the result).
+  ArrayRef<float> b_scale;
+  // Scale of the result if it is requantized to int8. Unused if the result is
+  // dequantized to f32.
+  float output_scale = 1.0;
+  QuantizedActivation activation = QuantizedActivation::kNone;
+};
+
+// Quantized matrix multiplication kernel:
+//   C = activation(dequantize(A) * dequantize(B) + bias)
+//
+// `a` and `b` are int8 (I8 or QI8) matrices. The products are accumulated in
+// int32, and then dequantized with the scales in `params`. `bias` is an
+// optional f32 vector with one element per column of C. The result `c` is
+// either f32, or is requantized to int8 (I8 or QI8) with `output_scale`.
+//
+// Blocks of rows of C are computed in parallel.
+AsyncValueRef<Chain> QuantizedMatMul(const DenseHostTensor& a,
+                                     const DenseHostTensor& b,
+                                     const DenseHostTensor* bias,
+                                     const QuantizedMatMulParams& params,
+                                     bool transpose_a, bool transpose_b,
+                                     DenseHostTensor* c,
+                                     const ExecutionContext& exec_ctx);
+
+}  // namespace cpu
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_QUANTIZED_MATMUL_KERNEL_H_
@@ -0,0 +1,521 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reduction kernels implementation.
+
+#include "./reduction_kernel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+#include "llvm/Support/ErrorHandling.h"
+#include "tfrt/common/compat/eigen/eigen_dtype.h"
+#include "tfrt/dtype/dtype.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+namespace cpu {
+namespace {
+
+// The minimum number of input elements reduced by a parallel task.
+constexpr size_t kMinElementsPerTask = 16 * 1024;
+
+// The size of the blocks of a deterministic reduction to a single element.
+constexpr size_t kDeterministicBlockSize = 64 * 1024;
+
+template <typename T, int rank>
+using ConstTensor = Eigen::TensorMap<
+    Eigen::Tensor<const T, rank, Eigen::RowMajor, Eigen::Index>,
+    Eigen::Unaligned>;
+
+template <typename T, int rank>
+using Tensor =
+    Eigen::TensorMap<Eigen::Tensor<T, rank, Eigen::RowMajor, Eigen::Index>,
+                     Eigen::Unaligned>;
+
+using internal::ReductionStep;
+
+// Reduces a contiguous range of `size` elements to a single element.
+template <typename T, typename Reducer>
+T ReduceRange(const T* src, Index size) {
+  T result;
+  Tensor<T, 0> out(&result);
+  out = ConstTensor<T, 1>(src, size).reduce(Eigen::array<Index, 1>{0},
+                                            Reducer());
+  return result;
+}
+
+// Computes the [begin, end) rows of the outer dimension of the step output.
+template <typename T, typename Reducer>
+void ReduceOuterRows(const ReductionStep& step, const T* src, T* dst,
+                     Index begin, Index end) {
+  const Index rows = end - begin;
+
+  if (step.inner == 1) {
+    // Inner reduction: Eigen vectorizes the reduction of each row.
+    ConstTensor<T, 2> in(src + begin * step.reduced, rows, step.reduced);
+    Tensor<T, 1> out(dst + begin, rows);
+    out = in.reduce(Eigen::array<Index, 1>{1}, Reducer());
+  } else {
+    // Middle reduction: Eigen vectorizes along the preserved inner dimension.
+    ConstTensor<T, 3> in(src + begin * step.reduced * step.inner, rows,
+                         step.reduced, step.inner);
+    Tensor<T, 2> out(dst + begin * step.inner, rows, step.inner);
+    out = in.reduce(Eigen::array<Index, 1>{1}, Reducer());
+  }
+}
+
+// Computes the [begin, end) columns of the inner dimension of the step output.
+template <typename T, typename Reducer>
+void ReduceInnerColumns(const ReductionStep& step, const T* src, T* dst,
+                        Index begin, Index end) {
+  ConstTensor<T, 3> in(src, step.outer, step.reduced, step.inner);
+  Tensor<T, 2> out(dst, step.outer, step.inner);
+
+  Eigen::DSizes<Index, 3> in_offsets(0, 0, begin);
+  Eigen::DSizes<Index, 3> in_extents(step.outer, step.reduced, end - begin);
+  Eigen::DSizes<Index, 2> out_offsets(0, begin);
+  Eigen::DSizes<Index, 2> out_extents(step.outer, end - begin);
+
+  out.slice(out_offsets, out_extents) =
+      in.slice(in_offsets, in_extents)
+          .reduce(Eigen::array<Index, 1>{1}, Reducer());
+}
+
+// The state of a Reduce shared by its parallel tasks.
+template <typename T>
+struct ReductionState {
+  DenseHostTensor input;
+  DenseHostTensor output;
+  SmallVector<ReductionStep, 2> steps;
+  // Results of all steps but the last one.
+  SmallVector<std::unique_ptr<T[]>, 1> buffers;
+  bool deterministic;
+  // If not 1, the output is divided by this number of reduced elements.
+  Index divisor = 1;
+
+  const T* src(size_t step) const {
+    return step == 0 ? static_cast<const T*>(input.data())
+                     : buffers[step - 1].get();
+  }
+  T* dst(size_t step) {
+    return step + 1 == steps.size() ? static_cast<T*>(output.data())
+                                     : buffers[step].get();
+  }
+};
+
+// Reduces all elements of the step input to a single element.
+template <typename T, typename Reducer>
+void ReduceAll(std::shared_ptr<ReductionState<T>> state, size_t i,
+               const ExecutionContext& exec_ctx,
+               llvm::unique_function<void()> on_done) {
+  const T* src = state->src(i);
+  T* dst = state->dst(i);
+  const Index size = state->steps[i].reduced;
+
+  if (size <= static_cast<Index>(kMinElementsPerTask)) {
+    *dst = ReduceRange<T, Reducer>(src, size);
+    return on_done();
+  }
+
+  if (state->deterministic) {
+    const size_t num_blocks =
+        (size + kDeterministicBlockSize - 1) / kDeterministicBlockSize;
+    auto partials = std::make_shared<std::unique_ptr<T[]>>(new T[num_blocks]);
+
+    ParallelFor(exec_ctx).Execute(
+        size, ParallelFor::BlockSizes::Fixed(kDeterministicBlockSize),
+        [src, partials](size_t begin, size_t end) {
+          (*partials)[begin / kDeterministicBlockSize] =
+              ReduceRange<T, Reducer>(src + begin, end - begin);
+        },
+        [state, dst, partials, num_blocks,
+         on_done = std::move(on_done)]() mutable {
+          Reducer reducer;
+          T accum = reducer.initialize();
+          for (size_t b = 0; b < num_blocks; ++b)
+            reducer.reduce((*partials)[b], &accum);
+          *dst = reducer.finalize(accum);
+          on_done();
+        });
+    return;
+  }
+
+  struct Accumulator {
+    mutex mu;
+    T value = Reducer().initialize();
+  };
+  auto accum = std::make_shared<Accumulator>();
+
+  ParallelFor(exec_ctx).Execute(
+      size, ParallelFor::BlockSizes::Min(kMinElementsPerTask),
+      [src, accum](size_t begin, size_t end) {
+        T partial = ReduceRange<T, Reducer>(src + begin, end - begin);
+        mutex_lock lock(accum->mu);
+        Reducer().reduce(partial, &accum->value);
+      },
+      [state, dst, accum, on_done = std::move(on_done)]() mutable {
+        *dst = Reducer().finalize(accum->value);
+        on_done();
+      });
+}
+
+// Divides all output elements by the state divisor.
+template <typename T>
+void DivideOutput(std::shared_ptr<ReductionState<T>> state,
+                  const ExecutionContext& exec_ctx, AsyncValueRef<Chain> done) {
+  ParallelFor(exec_ctx).Execute(
+      state->output.NumElements(),
+      ParallelFor::BlockSizes::Min(kMinElementsPerTask),
+      [state](size_t begin, size_t end) {
+        Tensor<T, 1> out(static_cast<T*>(state->output.data()) + begin,
+                         end - begin);
+        out = out / static_cast<T>(state->divisor);
+      },
+      [done = std::move(done)]() { done.emplace(); });
+}
+
+// Runs the reduction step `i` and all the steps after it.
+template <typename T, typename Reducer>
+void RunSteps(std::shared_ptr<ReductionState<T>> state, size_t i,
+              ExecutionContext exec_ctx, AsyncValueRef<Chain> done) {
+  if (i == state->steps.size()) {
+    if (state->divisor == 1) return done.emplace();
+    return DivideOutput(std::move(state), exec_ctx, std::move(done));
+  }
+
+  auto next = [state, i, exec_ctx, done = std::move(done)]() mutable {
+    RunSteps<T, Reducer>(std::move(state), i + 1, std::move(exec_ctx),
+                         std::move(done));
+  };
+
+  const ReductionStep& step = state->steps[i];
+  if (step.outer == 1 && step.inner == 1)
+    return ReduceAll<T, Reducer>(std::move(state), i, exec_ctx,
+                                 std::move(next));
+
+  // Split the larger of the preserved dimensions between parallel tasks.
+  const bool split_outer = step.outer >= step.inner;
+  const Index num_rows = split_outer ? step.outer : step.inner;
+  const size_t row_size =
+      step.reduced * (split_outer ? step.inner : step.outer);
+  const size_t min_rows =
+      std::max<size_t>(1, kMinElementsPerTask / std::max<size_t>(1, row_size));
+
+  ParallelFor(exec_ctx).Execute(
+      num_rows, ParallelFor::BlockSizes::Min(min_rows),
+      [state, i, split_outer](size_t begin, size_t end) {
+        const ReductionStep& step = state->steps[i];
+        if (split_outer) {
+          ReduceOuterRows<T, Reducer>(step, state->src(i), state->dst(i),
+                                      begin, end);
+        } else {
+          ReduceInnerColumns<T, Reducer>(step, state->src(i), state->dst(i),
+                                         begin, end);
+        }
+      },
+      std::move(next));
+}
+
+// Reduces `input` along `axes` with the `Reducer`. If `mean` is true, the
+// result is divided by the number of reduced elements.
+template <typename T, typename Reducer>
+AsyncValueRef<Chain> ReduceImpl(const DenseHostTensor& input,
+                                ArrayRef<int64_t> axes, bool deterministic,
+                                bool mean, DenseHostTensor* output,
+                                const ExecutionContext& exec_ctx) {
+  // Reductions of empty dimensions produce the reducer initial value, and the
+  // mean of no elements is NaN (zero for integer types).
+  if (input.NumElements() == 0) {
+    T* dst = static_cast<T*>(output->data());
+    std::fill(dst, dst + output->NumElements(),
+              mean ? Eigen::NumTraits<T>::quiet_NaN() : Reducer().initialize());
+    return GetReadyChain();
+  }
+
+  SmallVector<Index, 4> dims;
+  input.shape().GetDimensions(&dims);
+
+  auto state = std::make_shared<ReductionState<T>>();
+  state->input = input.CopyRef();
+  state->output = output->CopyRef();
+  state->steps = internal::NormalizeReduction(dims, axes);
+  state->deterministic = deterministic;
+  if (mean) {
+    for (int64_t axis : axes) state->divisor *= dims[axis];
+  }
+
+  // Only dimensions of size 1 are reduced.
+  if (state->steps.empty()) {
+    std::memcpy(output->data(), input.data(), input.DataSizeInBytes());
+    return GetReadyChain();
+  }
+
+  for (size_t i = 0; i + 1 < state->steps.size(); ++i) {
+    const ReductionStep& step = state->steps[i];
+    state->buffers.emplace_back(new T[step.outer * step.inner]);
+  }
+
+  auto chain = MakeUnconstructedAsyncValueRef<Chain>();
+  RunSteps<T, Reducer>(std::move(state), 0, exec_ctx, chain.CopyRef());
+  return chain;
+}
+
+// Computes the [outer_begin, outer_end) x [inner_begin, inner_end) block of
+// the [outer, inner] output of an [outer, reduced, inner] arg reduction.
+template <typename T, typename IndexT, typename Compare>
+void ArgReduceBlock(const ReductionStep& step, const T* src, IndexT* dst,
+                    Index outer_begin, Index outer_end, Index inner_begin,
+                    Index inner_end) {
+  Compare better;
+  const Index cols = inner_end - inner_begin;
+  SmallVector<T, 0> best(cols);
+
+  for (Index o = outer_begin; o < outer_end; ++o) {
+    const T* in = src + o * step.reduced * step.inner + inner_begin;
+    IndexT* out = dst + o * step.inner + inner_begin;
+
+    std::copy_n(in, cols, best.begin());
+    std::fill_n(out, cols, 0);
+
+    // Scan the reduced dimension one row at a time, so that the loop over
+    // contiguous inner elements can be vectorized.
+    for (Index r = 1; r < step.reduced; ++r) {
+      const T* row = in + r * step.inner;
+      for (Index j = 0; j < cols; ++j) {
+        if (better(row[j], best[j])) {
+          best[j] = row[j];
+          out[j] = static_cast<IndexT>(r);
+        }
+      }
+    }
+  }
+}
+
+template <typename T, typename IndexT, typename Compare>
+AsyncValueRef<Chain> ArgReduceImpl(const DenseHostTensor& input,
+                                   const ReductionStep& step,
+                                   DenseHostTensor* output,
+                                   const ExecutionContext& exec_ctx) {
+  if (output->NumElements() == 0) return GetReadyChain();
+
+  const bool split_outer = step.outer >= step.inner;
+  const Index num_rows = split_outer ? step.outer : step.inner;
+  const size_t row_size =
+      step.reduced * (split_outer ? step.inner : step.outer);
+  const size_t min_rows =
+      std::max<size_t>(1, kMinElementsPerTask / std::max<size_t>(1, row_size));
+
+  auto chain = MakeUnconstructedAsyncValueRef<Chain>();
+  ParallelFor(exec_ctx).Execute(
+      num_rows, ParallelFor::BlockSizes::Min(min_rows),
+      [input = input.CopyRef(), output = output->CopyRef(), step,
+       split_outer](size_t begin, size_t end) mutable {
+        const T* src = static_cast<const T*>(input.data());
+        IndexT* dst = static_cast<IndexT*>(output.data());
+        if (split_outer) {
+          ArgReduceBlock<T, IndexT, Compare>(step, src, dst, begin, end, 0,
+                                             step.inner);
+        } else {
+          ArgReduceBlock<T, IndexT, Compare>(step, src, dst, 0, step.outer,
+                                             begin, end);
+        }
+      },
+      [chain = chain.CopyRef()]() { chain.emplace(); });
+  return chain;
+}
+
+template <typename T, typename Compare>
+AsyncValueRef<Chain> ArgReduceImpl(const DenseHostTensor& input,
+                                   const ReductionStep& step,
+                                   DenseHostTensor* output,
+                                   const ExecutionContext& exec_ctx) {
+  switch (output->dtype()) {
+    case DType::I32:
+      return ArgReduceImpl<T, int32_t, Compare>(input, step, output, exec_ctx);
+    case DType::I64:
+      return ArgReduceImpl<T, int64_t, Compare>(input, step, output, exec_ctx);
+    default:
+      return EmitErrorAsync(
+          exec_ctx, StrCat("Unsupported output dtype: ", output->dtype()));
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+SmallVector<ReductionStep, 2> NormalizeReduction(ArrayRef<Index> dims,
+                                                 ArrayRef<int64_t> axes) {
+  SmallVector<bool, 4> is_reduced(dims.size(), false);
+  for (int64_t axis : axes) is_reduced[axis] = true;
+
+  // Collapse adjacent dimensions that are both reduced or both preserved.
+  SmallVector<Index, 4> sizes;
+  SmallVector<bool, 4> reduced;
+  for (size_t d = 0; d < dims.size(); ++d) {
+    if (dims[d] == 1) continue;
+    if (!sizes.empty() && reduced.back() == is_reduced[d]) {
+      sizes.back() *= dims[d];
+    } else {
+      sizes.push_back(dims[d]);
+      reduced.push_back(is_reduced[d]);
+    }
+  }
+
+  SmallVector<ReductionStep, 2> steps;
+  while (true) {
+    // Find the innermost group of reduced dimensions.
+    auto it = std::find(reduced.rbegin(), reduced.rend(), true);
+    if (it == reduced.rend()) break;
+    const size_t r = reduced.size() - 1 - (it - reduced.rbegin());
+
+    ReductionStep step = {1, sizes[r], 1};
+    for (size_t d = 0; d < r; ++d) step.outer *= sizes[d];
+    for (size_t d = r + 1; d < sizes.size(); ++d) step.inner *= sizes[d];
+    steps.push_back(step);
+
+    // Preserved groups around the reduced group become adjacent.
+    sizes.erase(sizes.begin() + r);
+    reduced.erase(reduced.begin() + r);
+    if (r > 0 && r < sizes.size()) {
+      sizes[r - 1] *= sizes[r];
+      sizes.erase(sizes.begin() + r);
+      reduced.erase(reduced.begin() + r);
+    }
+  }
+
+  return steps;
+}
+
+}  // namespace internal
+
+AsyncValueRef<Chain> Reduce(ReductionOp op, const DenseHostTensor& input,
+                            ArrayRef<int64_t> axes, bool deterministic,
+                            DenseHostTensor* output,
+                            const ExecutionContext& exec_ctx) {
+  const int rank = input.shape().GetRank();
+  Index num_output_elements = 1;
+  SmallVector<bool, 4> is_reduced(rank, false);
+  for (int64_t axis : axes) {
+    if (axis < 0 || axis >= rank || is_reduced[axis])
+      return EmitErrorAsync(exec_ctx,
+                            StrCat("Invalid reduction axis ", axis,
+                                   " for input shape ", input.shape()));
+    is_reduced[axis] = true;
+  }
+  for (int d = 0; d < rank; ++d) {
+    if (!is_reduced[d])
+      num_output_elements *= input.shape().GetDimensionSize(d);
+  }
+
+  if (output->dtype() != input.dtype() ||
+      output->NumElements() != num_output_elements)
+    return EmitErrorAsync(exec_ctx,
+                          StrCat("Invalid reduction output ",
+                                 output->metadata(), " for input ",
+                                 input.metadata()));
+
+  const bool is_logical = op == ReductionOp::kAll || op == ReductionOp::kAny;
+  if (is_logical != (input.dtype() == DType::I1))
+    return EmitErrorAsync(exec_ctx, StrCat("Unsupported reduction dtype: ",
+                                           input.dtype()));
+
+  if (is_logical) {
+    return op == ReductionOp::kAll
+               ? ReduceImpl<bool, Eigen::internal::AndReducer>(
+                     input, axes, deterministic, /*mean=*/false, output,
+                     exec_ctx)
+               : ReduceImpl<bool, Eigen::internal::OrReducer>(
+                     input, axes, deterministic, /*mean=*/false, output,
+                     exec_ctx);
+  }
+
+  switch (input.dtype()) {
+    default:
+      return EmitErrorAsync(exec_ctx, StrCat("Unsupported reduction dtype: ",
+                                             input.dtype()));
+#define DTYPE_NUMERIC(ENUM)                                                \
+  case DType::ENUM: {                                                      \
+    using T = EigenTypeForDTypeKind<DType::ENUM>;                          \
+    switch (op) {                                                          \
+      case ReductionOp::kSum:                                              \
+        return ReduceImpl<T, Eigen::internal::SumReducer<T>>(              \
+            input, axes, deterministic, /*mean=*/false, output, exec_ctx); \
+      case ReductionOp::kMean:                                             \
+        return ReduceImpl<T, Eigen::internal::SumReducer<T>>(              \
+            input, axes, deterministic, /*mean=*/true, output, exec_ctx);  \
+      case ReductionOp::kProd:                                             \
+        return ReduceImpl<T, Eigen::internal::ProdReducer<T>>(             \
+            input, axes, deterministic, /*mean=*/false, output, exec_ctx); \
+      case ReductionOp::kMax:                                              \
+        return ReduceImpl<T, Eigen::internal::MaxReducer<T>>(              \
+            input, axes, deterministic, /*mean=*/false, output, exec_ctx); \
+      case ReductionOp::kMin:                                              \
+        return ReduceImpl<T, Eigen::internal::MinReducer<T>>(              \
+            input, axes, deterministic, /*mean=*/false, output, exec_ctx); \
+      default:                                                             \
+        llvm_unreachable("unexpected numeric reduction");                  \
+    }                                                                      \
+  }
+#include "tfrt/dtype/dtype.def"  // NOLINT
+  }
+}
+
+AsyncValueRef<Chain> ArgReduce(ArgReductionOp op, const DenseHostTensor& input,
+                               int64_t axis, DenseHostTensor* output,
+                               const ExecutionContext& exec_ctx) {
+  const int rank = input.shape().GetRank();
+  if (axis < 0 || axis >= rank)
+    return EmitErrorAsync(exec_ctx, StrCat("Invalid reduction axis ", axis,
+                                           " for input shape ", input.shape()));
+
+  ReductionStep step = {1, input.shape().GetDimensionSize(axis), 1};
+  for (int d = 0; d < axis; ++d)
+    step.outer *= input.shape().GetDimensionSize(d);
+  for (int d = axis + 1; d < rank; ++d)
+    step.inner *= input.shape().GetDimensionSize(d);
+
+  if (output->NumElements() != step.outer * step.inner)
+    return EmitErrorAsync(exec_ctx,
+                          StrCat("Invalid reduction output ",
+                                 output->metadata(), " for input ",
+                                 input.metadata()));
+  if (step.reduced == 0 && output->NumElements() > 0)
+    return EmitErrorAsync(
+        exec_ctx, StrCat("Can't reduce an empty axis ", axis, " of input ",
+                         input.metadata()));
+
+  switch (input.dtype()) {
+    default:
+      return EmitErrorAsync(exec_ctx, StrCat("Unsupported reduction dtype: ",
+                                             input.dtype()));
+#define DTYPE_NUMERIC(ENUM)                                                    \
+  case DType::ENUM: {                                                          \
+    using T = EigenTypeForDTypeKind<DType::ENUM>;                              \
+    if (op == ArgReductionOp::kArgMax)                                         \
+      return ArgReduceImpl<T, std::greater<T>>(input, step, output, exec_ctx); \
+    return ArgReduceImpl<T, std::less<T>>(input, step, output, exec_ctx);      \
+  }
+#include "tfrt/dtype/dtype.def"  // NOLINT
+  }
+}
+
+}  // namespace cpu
+}  // namespace tfrt
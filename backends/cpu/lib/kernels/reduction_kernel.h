@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reduction kernels implementation.
+
+#ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_REDUCTION_KERNEL_H_
+#define TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_REDUCTION_KERNEL_H_
+
+#include <cstdint>
+
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace cpu {
+
+// Reductions along an arbitrary set of axes. Mean is a Sum divided by the
+// number of reduced elements.
+enum class ReductionOp { kSum, kMean, kProd, kMax, kMin, kAll, kAny };
+
+// Reductions along a single axis that return the index of the selected value.
+enum class ArgReductionOp { kArgMax, kArgMin };
+
+namespace internal {
+
+// Reduction of a row-major [outer, reduced, inner] tensor along the middle
+// dimension into an [outer, inner] tensor.
+struct ReductionStep {
+  Index outer;
+  Index reduced;
+  Index inner;
+};
+
+// Normalizes the reduction of a tensor with dimensions `dims` along `axes` into
+// a sequence of reduction steps. Dimensions of size 1 are dropped, and
+// adjacent dimensions that are both reduced or both preserved are collapsed,
+// so that the inner ([outer, reduced]), outer ([reduced, inner]) and middle
+// ([outer, reduced, inner]) reductions are a single step. Otherwise each step
+// reduces the innermost remaining group of reduced dimensions, and the result
+// of a step is the input of the next one.
+//
+// Example: [2, 3, 4, 5] reduced along axes [0, 2] is the [6, 4, 5] step,
+// followed by the [1, 2, 15] step.
+SmallVector<ReductionStep, 2> NormalizeReduction(ArrayRef<Index> dims,
+                                                 ArrayRef<int64_t> axes);
+
+}  // namespace internal
+
+// Reduces `input` along `axes` into `output`, that has the preserved input
+// dimensions. Axes must be unique and in the [0, rank) range.
+//
+// Each output element is computed by a single parallel task: the innermost
+// input dimension is reduced with Eigen vectorized tree reductions, and
+// preserved dimensions are split between ParallelFor tasks, so the result does
+// not depend on the number of threads.
+//
+// Reductions to a single element are split along the reduced dimension, and
+// partial results are combined as parallel tasks complete. If `deterministic`
+// is true, the reduced dimension is split into blocks of a fixed size and
+// partial results are combined in order, so floating point sums are
+// reproducible bit for bit.
+AsyncValueRef<Chain> Reduce(ReductionOp op, const DenseHostTensor& input,
+                            ArrayRef<int64_t> axes, bool deterministic,
+                            DenseHostTensor* output,
+                            const ExecutionContext& exec_ctx);
+
+// Writes to `output` the index of the largest (ArgMax) or the smallest
+// (ArgMin) value along the `axis` of `input`. Ties resolve to the smallest
+// index. The output dtype must be I32 or I64.
+AsyncValueRef<Chain> ArgReduce(ArgReductionOp op, const DenseHostTensor& input,
+                               int64_t axis, DenseHostTensor* output,
+                               const ExecutionContext& exec_ctx);
+
+}  // namespace cpu
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_REDUCTION_KERNEL_H_
@@ -14,9 +14,15 @@
 
 // This file implements kernels for reading tensors from file.
 
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
 #include "tfrt/cpu/ops/test/cpu_ops_and_kernels.h"
+#include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_registry.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/host_context/shared_context.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 #include "tfrt/tensor/btf_util.h"
 
 namespace tfrt {
@@ -26,38 +32,119 @@ namespace tfrt {
 //===----------------------------------------------------------------------===//
 
 namespace {
-template <typename DType_, size_t Rank_>
-struct ParseDenseHostTensorTraits {
-  using DType = DType_;
-  static constexpr size_t kRank = Rank_;
-  using TensorTy = DenseHostTensor;
-  static constexpr auto kParseTensorFn =
-      ParseDenseHostTensorFromStream<DType_, Rank_>;
+
+// Caches the BTF files which have been mapped by the btf.read_dense_tensor
+// kernels, so that a file is only mapped and its offset table is only parsed
+// once, however many tensors are read from it.
+//
+// A cached mapping is only used while the file at its path has the same inode,
+// size and modification time. A file which is replaced or rewritten is mapped
+// again, so that readers do not see stale data or fault on pages past the end
+// of a truncated file.
+class MappedBTFFileCache : public SharedContext {
+ public:
+  explicit MappedBTFFileCache(HostContext* host) {}
+
+  Expected<MappedBTFFile> GetOrOpen(string_view path) {
+    namespace fs = ::llvm::sys::fs;
+    fs::file_status status;
+    if (std::error_code ec = fs::status(path, status)) {
+      return MakeStringError("failed to stat file ", path, ": ", ec.message());
+    }
+
+    mutex_lock lock(mu_);
+    auto it = files_.find(path);
+    if (it != files_.end() && IsSameFile(it->second.status, status))
+      return it->second.file;
+    auto file = MappedBTFFile::Open(path);
+    if (!file) return file.takeError();
+    // Tensors read from a replaced mapping keep it alive until they are freed.
+    files_.erase(path);
+    files_.try_emplace(path, Entry{status, *file});
+    return std::move(*file);
+  }
+
+ private:
+  struct Entry {
+    // The status of the file when it was mapped.
+    ::llvm::sys::fs::file_status status;
+    MappedBTFFile file;
+  };
+
+  static bool IsSameFile(const ::llvm::sys::fs::file_status& a,
+                         const ::llvm::sys::fs::file_status& b) {
+    return a.getUniqueID() == b.getUniqueID() && a.getSize() == b.getSize() &&
+           a.getLastModificationTime() == b.getLastModificationTime();
+  }
+
+  mutex mu_;
+  llvm::StringMap<Entry> files_ TFRT_GUARDED_BY(mu_);
 };
 
-template <typename DType_, size_t Rank_>
-constexpr size_t ParseDenseHostTensorTraits<DType_, Rank_>::kRank;
+template <typename DType, size_t Rank>
+Expected<DenseHostTensor> ReadDenseTensorFromMappedBTF(string_view path,
+                                                       int32_t index,
+                                                       HostContext* host) {
+  auto file =
+      host->GetOrCreateSharedContext<MappedBTFFileCache>().GetOrOpen(path);
+  if (!file) return file.takeError();
+
+  if (index < 0 || static_cast<size_t>(index) >= file->num_tensors()) {
+    return MakeStringError("invalid tensor index ", index,
+                           " to read tensor from path ", path,
+                           " which contains ", file->num_tensors(),
+                           " tensors");
+  }
+  auto dht = file->ReadDHT(index, host);
+  if (!dht) return dht.takeError();
+
+  if (dht->dtype() != GetDType<DType>()) {
+    return MakeStringError("unexpected tensor dtype ", dht->dtype(),
+                           ". Expected dtype is ", GetDType<DType>());
+  }
+  if (dht->shape().GetRank() != static_cast<int>(Rank)) {
+    return MakeStringError("unexpected tensor rank ", dht->shape().GetRank(),
+                           ". Expected rank is ", Rank);
+  }
+  return dht;
+}
+
+// Kernel to read a tensor from a BTF-file. The tensor shares the memory of the
+// mapped file. See ReadTensorFromBTF() for the arguments and the file format.
+template <typename DType, size_t Rank>
+AsyncValueRef<DenseHostTensor> ReadDenseTensorFromBTF(
+    std::string path, int32_t index, const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  // Mapping the file and faulting in its pages may block.
+  return EnqueueBlockingWork(
+      host, [host, path, index, exec_ctx]() -> Expected<DenseHostTensor> {
+        auto result = ReadDenseTensorFromMappedBTF<DType, Rank>(path, index,
+                                                                host);
+        if (!result) {
+          auto diag = EmitError(exec_ctx, result.takeError());
+          return MakeStringError(diag.message);
+        }
+        return result;
+      });
+}
 
 template <size_t Rank>
 void RegisterDenseTensorReaders(KernelRegistry* registry) {
   registry->AddKernel(
       "btf.read_dense_tensor.f32." + std::to_string(Rank),
-      TFRT_KERNEL(ReadTensorFromBTF<ParseDenseHostTensorTraits<float, Rank>>));
+      TFRT_KERNEL(ReadDenseTensorFromBTF<float, Rank>));
   registry->AddKernel(
       "btf.read_dense_tensor.i32." + std::to_string(Rank),
-      TFRT_KERNEL(
-          ReadTensorFromBTF<ParseDenseHostTensorTraits<int32_t, Rank>>));
+      TFRT_KERNEL(ReadDenseTensorFromBTF<int32_t, Rank>));
   registry->AddKernel(
       "btf.read_dense_tensor.i64." + std::to_string(Rank),
-      TFRT_KERNEL(
-          ReadTensorFromBTF<ParseDenseHostTensorTraits<int64_t, Rank>>));
+      TFRT_KERNEL(ReadDenseTensorFromBTF<int64_t, Rank>));
   registry->AddKernel(
       "btf.read_dense_tensor.i8." + std::to_string(Rank),
-      TFRT_KERNEL(ReadTensorFromBTF<ParseDenseHostTensorTraits<int8_t, Rank>>));
+      TFRT_KERNEL(ReadDenseTensorFromBTF<int8_t, Rank>));
   registry->AddKernel(
       "btf.read_dense_tensor.ui8." + std::to_string(Rank),
-      TFRT_KERNEL(
-          ReadTensorFromBTF<ParseDenseHostTensorTraits<uint8_t, Rank>>));
+      TFRT_KERNEL(ReadDenseTensorFromBTF<uint8_t, Rank>));
 }
 }  // namespace
 
@@ -19,10 +19,13 @@
 #include "../../kernels/cpu_kernels.h"
 #include "concat_op.h"
 #include "constant_ops.h"
+#include "cwise_fused_ops.h"
 #include "cwise_binary_ops.h"
 #include "cwise_unary_ops.h"
 #include "matmul_fusion_ops.h"
 #include "matmul_ops.h"
+#include "quantized_matmul_ops.h"
+#include "reduction_ops.h"
 #include "shape_ops.h"
 #include "softmax_ops.h"
 #include "tfrt/common/compat/eigen/eigen_dtype.h"
@@ -34,7 +37,6 @@
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/tensor/dense_host_tensor.h"
-#include "tfrt/tensor/dense_host_tensor_view.h"
 #include "tfrt/tensor/tensor_serialize_utils.h"
 #include "tile_op.h"
 
@@ -94,108 +96,6 @@ static AsyncValueRef<DenseHostTensor> TfReluOp(
   return ForwardValue(dest.getValue(), std::move(chain));
 }
 
-//===----------------------------------------------------------------------===//
-// tf.Mean op
-//===----------------------------------------------------------------------===//
-
-struct MeanHelper {
-  TensorMetadata output_metadata;
-  TensorMetadata final_output_metadata;
-
-  // Unlike the input reduction_indices, this one contains only positive
-  // numbers.
-  SmallVector<int32_t, 4> positive_reduction_indices;
-};
-
-static Expected<MeanHelper> TfMeanOutputMd(
-    const DenseHostTensor& input, const DenseHostTensor& reduction_indices,
-    bool keep_dims) {
-  MeanHelper helper;
-
-  // Check if an input dimension is reduced or not.
-  // TODO(tfrt-devs): Support i64 reduction_indices.
-  DHTArrayView<int32_t> reduction_indices_view(&reduction_indices);
-  llvm::SmallVector<bool, 4> reduced_dim(input.shape().GetRank(), false);
-  helper.positive_reduction_indices.reserve(reduction_indices.NumElements());
-  for (auto reduction_index : reduction_indices_view.Elements()) {
-    int rank = input.shape().GetRank();
-    if (reduction_index < -rank || reduction_index >= rank) {
-      return MakeStringError(
-          "tf.Mean reduction index must be in [-input_rank, input_rank) range");
-    }
-    // Add the rank to get the corresponding positive index if it is negative.
-    reduction_index = (reduction_index + rank) % rank;
-    if (reduced_dim[reduction_index]) {
-      return MakeStringError("tf.Mean reduction indices must be unique");
-    }
-
-    reduced_dim[reduction_index] = true;
-
-    helper.positive_reduction_indices.push_back(reduction_index);
-  }
-
-  llvm::SmallVector<Index, 4> output_dims;
-  llvm::SmallVector<Index, 4> final_output_dims;
-  output_dims.reserve(input.shape().GetRank());
-  final_output_dims.reserve(input.shape().GetRank());
-  for (int i = 0; i < input.shape().GetRank(); ++i) {
-    if (!reduced_dim[i]) {
-      output_dims.push_back(input.shape().GetDimensionSize(i));
-      final_output_dims.push_back(input.shape().GetDimensionSize(i));
-    } else if (keep_dims) {
-      final_output_dims.push_back(1);
-    }
-  }
-
-  helper.output_metadata = TensorMetadata(input.dtype(), output_dims);
-  helper.final_output_metadata =
-      TensorMetadata(input.dtype(), final_output_dims);
-
-  return helper;
-}
-
-static AsyncValueRef<DenseHostTensor> TfMeanOp(
-    const DenseHostTensor& input, const DenseHostTensor& reduction_indices,
-    const OpAttrsRef& op_attrs, const ExecutionContext& exec_ctx) {
-  HostContext* host = exec_ctx.host();
-
-  bool keep_dims = false;
-  if (auto attr = op_attrs.GetOptional<bool>("keep_dims"))
-    keep_dims = attr.getValue();
-
-  // Compute output tensor metadata from reduction indices.
-  auto helper = TfMeanOutputMd(input, reduction_indices, keep_dims);
-  if (auto err = helper.takeError())
-    return EmitErrorAsync(exec_ctx, std::move(err));
-
-  auto output =
-      DenseHostTensor::CreateUninitialized(helper->output_metadata, host);
-  if (!output) {
-    return EmitErrorAsync(exec_ctx, "out of memory allocating tensor");
-  }
-
-  AsyncValueRef<Chain> chain;
-  switch (input.dtype()) {
-    default:
-      chain = EmitErrorAsync(exec_ctx, "unsupported dtype for TfMeanOp");
-      break;
-#define DTYPE_NUMERIC(ENUM)                                             \
-  case DType::ENUM:                                                     \
-    chain = cpu::Mean<EigenTypeForDTypeKind<DType::ENUM>>(              \
-        input, helper->positive_reduction_indices, output.getPointer(), \
-        exec_ctx);                                                      \
-    break;
-#include "tfrt/dtype/dtype.def"  // NOLINT
-  }
-
-  DenseHostTensor final_output(helper->final_output_metadata,
-                               output->ReleaseBuffer());
-
-  // TODO(tfrt-devs): ForwardValue() should be able to take an rvalue to
-  // indicate the variable cannot be used by caller after this call.
-  return ForwardValue(final_output, std::move(chain));
-}
-
 //===----------------------------------------------------------------------===//
 // tf.BiadAdd op
 //===----------------------------------------------------------------------===//
@@ -253,8 +153,6 @@ void RegisterTfCpuOps(CpuOpRegistry* op_registry) {
                      CpuOpFlags::NoSideEffects, {"value"});
   op_registry->AddOp("tf.Relu", TFRT_CPU_OP(TfReluOp),
                      CpuOpFlags::NoSideEffects);
-  op_registry->AddOp("tf.Mean", TFRT_CPU_OP(TfMeanOp),
-                     CpuOpFlags::NoSideEffects);
   op_registry->AddOp("tf.BiasAdd", TFRT_CPU_OP(TfBiasAddOp),
                      CpuOpFlags::NoSideEffects);
 
@@ -262,10 +160,13 @@ void RegisterTfCpuOps(CpuOpRegistry* op_registry) {
   RegisterTfConstantCpuOps(op_registry);
   RegisterTfUnaryCpuOps(op_registry);
   RegisterTfBinaryCpuOps(op_registry);
+  RegisterTfCwiseFusionCpuOps(op_registry);
   RegisterTfShapeCpuOps(op_registry);
   RegisterTfSofmaxCpuOps(op_registry);
   RegisterTfMatmulFusionCpuOps(op_registry);
   RegisterTfMatmulCpuOps(op_registry);
+  RegisterTfQuantizedMatmulCpuOps(op_registry);
+  RegisterTfReductionCpuOps(op_registry);
   RegisterTfTileCpuOp(op_registry);
 }
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Fused coefficient wise Tensorflow operations.
+
+#include "cwise_fused_ops.h"
+
+#include "../../kernels/cwise_fused_kernel.h"
+#include "buffer_forwarding.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/op_utils.h"
+#include "tfrt/cpu/core_runtime/cpu_op_registry.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace {
+
+// Computes a chain of coefficient wise operations in a single pass over
+// memory. Each fused operation is named by its Tensorflow operation name, and
+// the result of each operation is the lhs of the next binary operation:
+//
+//   tf._FusedCwise(%x, %y, %z) { fused_ops = ["Mul", "AddV2", "Relu"] }
+//
+// computes Relu(AddV2(Mul(%x, %y), %z)).
+static AsyncValueRef<DenseHostTensor> TfFusedCwiseOp(
+    Argument<DenseHostTensor> input,
+    RepeatedArguments<DenseHostTensor> fusion_inputs, const OpAttrsRef& attrs,
+    const TensorMetadata& output_md, const ExecutionContext& exec_ctx) {
+  auto fused_ops_attr = attrs.GetAsserting<AggregateAttr>("fused_ops");
+
+  // Parse the fused operations.
+  SmallVector<cpu::FusedCwiseOp, 4> fused_ops;
+  for (int i = 0; i < fused_ops_attr.GetNumElements(); ++i) {
+    auto op = cpu::ParseFusedCwiseOp(
+        fused_ops_attr.GetAttribute(i).cast<StringAttr>().GetValue());
+    if (!op) return EmitErrorAsync(exec_ctx, op.takeError());
+    fused_ops.push_back(*op);
+  }
+
+  SmallVector<const DenseHostTensor*, 4> operands;
+  operands.push_back(&*input);
+  for (const DenseHostTensor& fusion_input : fusion_inputs)
+    operands.push_back(&fusion_input);
+
+  // Only the first operand can be forwarded to the output: it is consumed by
+  // the first fused operation before any output element is written.
+  AsyncValueRef<DenseHostTensor> output =
+      ForwardInputOrAllocateOutput(exec_ctx, output_md, input);
+  if (output.IsError()) return output;
+
+  auto chain = cpu::FusedCwise(fused_ops, operands, &output.get(), exec_ctx);
+
+  chain.AndThen([output = output.CopyRef(), chain = chain.CopyRef()]() {
+    // Forward errors to the tensor output.
+    chain.IsError() ? output.SetError(chain.GetError())
+                    : output.SetStateConcrete();
+  });
+
+  return output;
+}
+
+}  // namespace
+
+void RegisterTfCwiseFusionCpuOps(CpuOpRegistry* op_registry) {
+  op_registry->AddOp("tf._FusedCwise", TFRT_CPU_OP(TfFusedCwiseOp),
+                     CpuOpFlags::NoSideEffects, {"fused_ops"});
+}
+
+}  // namespace tfrt
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tensorflow quantized MatMul operations.
+
+#include "quantized_matmul_ops.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+#include "../../kernels/quantized_matmul_kernel.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/op_utils.h"
+#include "tfrt/cpu/core_runtime/cpu_op_registry.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace {
+
+// Reads the quantization parameters from the op attributes.
+static Expected<cpu::QuantizedMatMulParams> GetQuantizedMatMulParams(
+    const OpAttrsRef& attrs, const TensorMetadata& output_md) {
+  cpu::QuantizedMatMulParams params;
+  // Scales must be positive and finite, so that the result does not change its
+  // sign or become NaN.
+  auto is_valid_scale = [](float scale) {
+    return std::isfinite(scale) && scale > 0;
+  };
+  params.a_scale = attrs.GetAsserting<float>("a_scale");
+  if (!is_valid_scale(params.a_scale)) {
+    return MakeStringError("'a_scale' must be positive, got ", params.a_scale);
+  }
+  params.b_scale = attrs.GetArrayAsserting<float>("b_scale");
+  for (float b_scale : params.b_scale) {
+    if (!is_valid_scale(b_scale)) {
+      return MakeStringError("'b_scale' must be positive, got ", b_scale);
+    }
+  }
+  if (output_md.dtype != DType::F32) {
+    auto output_scale = attrs.GetOptional<float>("output_scale");
+    if (!output_scale) {
+      return MakeStringError(
+          "'output_scale' attribute is required to requantize the result");
+    }
+    if (!is_valid_scale(*output_scale)) {
+      return MakeStringError("'output_scale' must be positive, got ",
+                             *output_scale);
+    }
+    params.output_scale = *output_scale;
+  }
+  return params;
+}
+
+static AsyncValueRef<DenseHostTensor> TfQuantizedMatMulOp(
+    const DenseHostTensor& a, const DenseHostTensor& b, const OpAttrsRef& attrs,
+    const TensorMetadata& output_md, const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+
+  auto output = DenseHostTensor::CreateUninitialized(output_md, host);
+  if (!output) {
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  }
+
+  bool transpose_a = attrs.GetAsserting<bool>("transpose_a");
+  bool transpose_b = attrs.GetAsserting<bool>("transpose_b");
+
+  auto params = GetQuantizedMatMulParams(attrs, output_md);
+  if (!params) return EmitErrorAsync(exec_ctx, params.takeError());
+
+  return ForwardValue(
+      output.getValue(),
+      cpu::QuantizedMatMul(a, b, /*bias=*/nullptr, *params, transpose_a,
+                           transpose_b, &*output, exec_ctx));
+}
+
+static AsyncValueRef<DenseHostTensor> TfQuantizedFusedMatMulOp(
+    const DenseHostTensor& a, const DenseHostTensor& b,
+    RepeatedArguments<DenseHostTensor> fusion_inputs, const OpAttrsRef& attrs,
+    const TensorMetadata& output_md, const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+
+  auto output = DenseHostTensor::CreateUninitialized(output_md, host);
+  if (!output) {
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  }
+
+  bool transpose_a = attrs.GetAsserting<bool>("transpose_a");
+  bool transpose_b = attrs.GetAsserting<bool>("transpose_b");
+  auto fused_ops_attr = attrs.GetAsserting<AggregateAttr>("fused_ops");
+
+  auto params = GetQuantizedMatMulParams(attrs, output_md);
+  if (!params) return EmitErrorAsync(exec_ctx, params.takeError());
+
+  // Parse the MatMul fusion config.
+  SmallVector<string_view, 4> fused_ops(fused_ops_attr.GetNumElements());
+  for (int i = 0; i < fused_ops_attr.GetNumElements(); ++i) {
+    fused_ops[i] = fused_ops_attr.GetAttribute(i).cast<StringAttr>().GetValue();
+  }
+
+  auto match_fusion = [&](std::initializer_list<string_view> ops) -> bool {
+    return fused_ops.size() == ops.size() &&
+           std::equal(fused_ops.begin(), fused_ops.end(), ops.begin());
+  };
+
+  // The bias is added and the activation is applied to the dequantized
+  // result, before it is requantized.
+  if (match_fusion({"BiasAdd"})) {
+    params->activation = cpu::QuantizedActivation::kNone;
+  } else if (match_fusion({"BiasAdd", "Relu"})) {
+    params->activation = cpu::QuantizedActivation::kRelu;
+  } else if (match_fusion({"BiasAdd", "Relu6"})) {
+    params->activation = cpu::QuantizedActivation::kRelu6;
+  } else {
+    return EmitErrorAsync(exec_ctx, "Unsupported fusion type");
+  }
+
+  if (fusion_inputs.size() != 1) {
+    return EmitErrorAsync(exec_ctx, "BiasAdd fusion requires a bias input");
+  }
+  const DenseHostTensor& bias = fusion_inputs[0];
+  if (bias.shape().GetRank() != 1) {
+    return EmitErrorAsync(exec_ctx, "Bias tensor must a vector");
+  }
+
+  return ForwardValue(
+      output.getValue(),
+      cpu::QuantizedMatMul(a, b, &bias, *params, transpose_a, transpose_b,
+                           &*output, exec_ctx));
+}
+
+}  // namespace
+
+void RegisterTfQuantizedMatmulCpuOps(CpuOpRegistry* op_registry) {
+  op_registry->AddOp("tf._QuantizedMatMul", TFRT_CPU_OP(TfQuantizedMatMulOp),
+                     CpuOpFlags::NoSideEffects,
+                     {"transpose_a", "transpose_b", "a_scale", "b_scale",
+                      "output_scale", "Toutput"});
+  op_registry->AddOp("tf._QuantizedFusedMatMul",
+                     TFRT_CPU_OP(TfQuantizedFusedMatMulOp),
+                     CpuOpFlags::NoSideEffects,
+                     {"transpose_a", "transpose_b", "fused_ops", "a_scale",
+                      "b_scale", "output_scale", "Toutput"});
+}
+
+}  // namespace tfrt
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tensorflow reduction operations.
+
+#include "reduction_ops.h"
+
+#include "../../kernels/reduction_kernel.h"
+#include "llvm/ADT/STLExtras.h"
+#include "tfrt/core_runtime/op_attr_type.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/op_utils.h"
+#include "tfrt/cpu/core_runtime/cpu_op_registry.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+
+namespace tfrt {
+namespace {
+
+template <typename T>
+static Error AppendReductionAxes(const DenseHostTensor& indices, int rank,
+                                 SmallVectorImpl<int64_t>* axes) {
+  for (T index : DHTArrayView<T>(&indices).Elements()) {
+    if (index < -rank || index >= rank)
+      return MakeStringError("Reduction index ", index,
+                             " must be in [-rank, rank) range for rank ",
+                             rank);
+    // Add the rank to get the corresponding positive index if it is negative.
+    const int64_t axis = (index + rank) % rank;
+    if (llvm::is_contained(*axes, axis))
+      return MakeStringError("Reduction indices must be unique");
+    axes->push_back(axis);
+  }
+  return Error::success();
+}
+
+// Returns the non-negative reduction axes of an input of rank `rank`, from a
+// scalar or a vector of i32 or i64 indices in the [-rank, rank) range.
+static Expected<SmallVector<int64_t, 4>> GetReductionAxes(
+    const DenseHostTensor& indices, int rank) {
+  if (indices.shape().GetRank() > 1)
+    return MakeStringError("Reduction indices must be a scalar or a vector");
+
+  SmallVector<int64_t, 4> axes;
+  if (indices.dtype() == DType::I32) {
+    if (auto err = AppendReductionAxes<int32_t>(indices, rank, &axes))
+      return std::move(err);
+  } else if (indices.dtype() == DType::I64) {
+    if (auto err = AppendReductionAxes<int64_t>(indices, rank, &axes))
+      return std::move(err);
+  } else {
+    return MakeStringError("Unsupported reduction indices data type");
+  }
+  return axes;
+}
+
+//===----------------------------------------------------------------------===//
+// tf.Sum, tf.Mean, tf.Prod, tf.Max, tf.Min, tf.All and tf.Any ops
+//===----------------------------------------------------------------------===//
+
+template <cpu::ReductionOp op>
+static AsyncValueRef<DenseHostTensor> TfReductionOp(
+    const DenseHostTensor& input, const DenseHostTensor& reduction_indices,
+    const OpAttrsRef& attrs, const ExecutionContext& exec_ctx) {
+  const int rank = input.shape().GetRank();
+
+  auto axes = GetReductionAxes(reduction_indices, rank);
+  if (!axes) return EmitErrorAsync(exec_ctx, axes.takeError());
+
+  bool keep_dims = false;
+  if (auto attr = attrs.GetOptional<bool>("keep_dims"))
+    keep_dims = attr.getValue();
+
+  // Partial results of floating point reductions are combined in a fixed
+  // order, at the cost of a fixed parallel block size.
+  bool deterministic = false;
+  if (auto attr = attrs.GetOptional<bool>("deterministic"))
+    deterministic = attr.getValue();
+
+  // Reduced dimensions are removed from the output, or kept with size 1.
+  SmallVector<Index, 4> output_dims;
+  for (int d = 0; d < rank; ++d) {
+    if (!llvm::is_contained(*axes, d)) {
+      output_dims.push_back(input.shape().GetDimensionSize(d));
+    } else if (keep_dims) {
+      output_dims.push_back(1);
+    }
+  }
+
+  TensorMetadata output_md(input.dtype(), output_dims);
+  auto output =
+      DenseHostTensor::CreateUninitialized(output_md, exec_ctx.host());
+  if (!output) {
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  }
+
+  return ForwardValue(output.getValue(),
+                      cpu::Reduce(op, input, *axes, deterministic,
+                                  output.getPointer(), exec_ctx));
+}
+
+//===----------------------------------------------------------------------===//
+// tf.ArgMax and tf.ArgMin ops
+//===----------------------------------------------------------------------===//
+
+template <cpu::ArgReductionOp op>
+static AsyncValueRef<DenseHostTensor> TfArgReductionOp(
+    const DenseHostTensor& input, const DenseHostTensor& dimension,
+    const OpAttrsRef& attrs, const ExecutionContext& exec_ctx) {
+  const int rank = input.shape().GetRank();
+
+  if (dimension.NumElements() != 1)
+    return EmitErrorAsync(exec_ctx, "Dimension must be a scalar tensor");
+
+  auto axes = GetReductionAxes(dimension, rank);
+  if (!axes) return EmitErrorAsync(exec_ctx, axes.takeError());
+  const int64_t axis = (*axes)[0];
+
+  DType output_dtype = DType::I64;
+  if (auto output_type = attrs.GetOptional<OpAttrType>("output_type")) {
+    if (*output_type == OpAttrType::I32) {
+      output_dtype = DType::I32;
+    } else if (*output_type != OpAttrType::I64) {
+      return EmitErrorAsync(exec_ctx, "Unsupported output data type");
+    }
+  }
+
+  SmallVector<Index, 4> output_dims;
+  for (int d = 0; d < rank; ++d) {
+    if (d != axis) output_dims.push_back(input.shape().GetDimensionSize(d));
+  }
+
+  TensorMetadata output_md(output_dtype, output_dims);
+  auto output =
+      DenseHostTensor::CreateUninitialized(output_md, exec_ctx.host());
+  if (!output) {
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  }
+
+  return ForwardValue(
+      output.getValue(),
+      cpu::ArgReduce(op, input, axis, output.getPointer(), exec_ctx));
+}
+
+template <cpu::ReductionOp op>
+void RegisterTfReductionOp(CpuOpRegistry* op_registry, string_view op_name) {
+  op_registry->AddOp(op_name, TFRT_CPU_OP(TfReductionOp<op>),
+                     CpuOpFlags::NoSideEffects, {"keep_dims", "deterministic"});
+}
+
+template <cpu::ArgReductionOp op>
+void RegisterTfArgReductionOp(CpuOpRegistry* op_registry, string_view op_name) {
+  op_registry->AddOp(op_name, TFRT_CPU_OP(TfArgReductionOp<op>),
+                     CpuOpFlags::NoSideEffects, {"output_type"});
+}
+
+}  // namespace
+
+void RegisterTfReductionCpuOps(CpuOpRegistry* op_registry) {
+  RegisterTfReductionOp<cpu::ReductionOp::kSum>(op_registry, "tf.Sum");
+  RegisterTfReductionOp<cpu::ReductionOp::kMean>(op_registry, "tf.Mean");
+  RegisterTfReductionOp<cpu::ReductionOp::kProd>(op_registry, "tf.Prod");
+  RegisterTfReductionOp<cpu::ReductionOp::kMax>(op_registry, "tf.Max");
+  RegisterTfReductionOp<cpu::ReductionOp::kMin>(op_registry, "tf.Min");
+  RegisterTfReductionOp<cpu::ReductionOp::kAll>(op_registry, "tf.All");
+  RegisterTfReductionOp<cpu::ReductionOp::kAny>(op_registry, "tf.Any");
+  RegisterTfArgReductionOp<cpu::ArgReductionOp::kArgMax>(op_registry,
+                                                         "tf.ArgMax");
+  RegisterTfArgReductionOp<cpu::ArgReductionOp::kArgMin>(op_registry,
+                                                         "tf.ArgMin");
+}
+
+}  // namespace tfrt
@@ -133,6 +133,44 @@ func @addV2_dense_bcast_dense_bcast_f32() -> !tfrt.chain {
   tfrt.return %ch_print_cpu : !tfrt.chain
 }
 
+// CHECK: --- Running 'addV2_dense_bcast_dense_bcast_3d_f32'
+func @addV2_dense_bcast_dense_bcast_3d_f32() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 1, 3], values = [1.0 : f32, 2.0 : f32, 3.0 : f32, 4.0 : f32, 5.0 : f32, 6.0 : f32] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1, 2, 1], values = [10.0 : f32, 20.0 : f32] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu) "tf.AddV2"(%operand_0, %operand_1) : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2, 2, 3]
+  // CHECK-SAME: values = [1.100000e+01, 1.200000e+01, 1.300000e+01, 2.100000e+01, 2.200000e+01, 2.300000e+01, 1.400000e+01, 1.500000e+01, 1.600000e+01, 2.400000e+01, 2.500000e+01, 2.600000e+01]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'addV2_dense_bcast_dense_bcast_6d_f32'
+func @addV2_dense_bcast_dense_bcast_6d_f32() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 1, 1, 1, 1, 1], values = [1.0 : f32, 2.0 : f32] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1, 1, 1, 1, 1, 2], values = [10.0 : f32, 20.0 : f32] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu) "tf.AddV2"(%operand_0, %operand_1) : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2, 1, 1, 1, 1, 2]
+  // CHECK-SAME: values = [1.100000e+01, 2.100000e+01, 1.200000e+01, 2.200000e+01]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
 // CHECK: --- Running 'addV2_dense_scalar_f32'
 func @addV2_dense_scalar_f32() -> !tfrt.chain{
   %ch_epoch = tfrt.new.chain
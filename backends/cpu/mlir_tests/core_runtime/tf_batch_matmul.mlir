@@ -0,0 +1,68 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor --test_init_function=register_op_handlers_cpu %s.bef | FileCheck %s
+
+func @register_op_handlers_cpu() {
+  %null = "corert.create_null_op_handler"() : () -> !corert.ophandler
+  %cpu = "corert.create_cpu_op_handler"(%null) : (!corert.ophandler) -> !corert.ophandler
+  corert.register_op_handler %cpu "cpu"
+  tfrt.return
+}
+
+// CHECK: --- Running 'batchMatMul_broadcast_f32'
+func @batchMatMul_broadcast_f32() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 2, 3], values = [1.0 : f32, 2.0 : f32, 3.0 : f32, 4.0 : f32,
+                                   5.0 : f32, 6.0 : f32, 7.0 : f32, 8.0 : f32,
+                                   9.0 : f32, 10.0 : f32, 11.0 : f32, 12.0 : f32] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [3, 2], values = [1.0 : f32, 2.0 : f32, 3.0 : f32, 4.0 : f32,
+                                5.0 : f32, 6.0 : f32] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf.BatchMatMulV2"(%operand_0, %operand_1)
+      { adj_x = false, adj_y = false } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2, 2, 2]
+  // CHECK-SAME: values = [2.200000e+01, 2.800000e+01, 4.900000e+01, 6.400000e+01, 7.600000e+01, 1.000000e+02, 1.030000e+02, 1.360000e+02]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'batchMatMul_adjoint_i32'
+func @batchMatMul_adjoint_i32() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1, 2, 2], values = [1 : i32, 2 : i32, 3 : i32, 4 : i32] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 2, 2], values = [1 : i32, 0 : i32, 0 : i32, 1 : i32,
+                                   0 : i32, 1 : i32, 2 : i32, 3 : i32] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf.BatchMatMulV2"(%operand_0, %operand_1)
+      { adj_x = true, adj_y = true } : 1
+
+  // CHECK: DenseHostTensor dtype = i32, shape = [2, 2, 2]
+  // CHECK-SAME: values = [1, 3, 2, 4, 3, 11, 4, 16]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
@@ -0,0 +1,92 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor --test_init_function=register_op_handlers_cpu %s.bef | FileCheck %s
+
+func @register_op_handlers_cpu() {
+  %null = "corert.create_null_op_handler"() : () -> !corert.ophandler
+  %cpu = "corert.create_cpu_op_handler"(%null) : (!corert.ophandler) -> !corert.ophandler
+  corert.register_op_handler %cpu "cpu"
+  tfrt.return
+}
+
+// CHECK: --- Running 'fusedCwise_mul_add_relu_f32'
+func @fusedCwise_mul_add_relu_f32() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 2], values = [1.0 : f32, -2.0 : f32, 3.0 : f32, -4.0 : f32] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2], values = [1.0 : f32, -1.0 : f32] } : 1
+  %operand_2 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1], values = [-2.5 : f32] } : 1
+
+  // Relu(AddV2(Mul(%operand_0, %operand_1), %operand_2))
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._FusedCwise"(%operand_0, %operand_1, %operand_2)
+      { fused_ops = ["Mul", "AddV2", "Relu"] } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2, 2]
+  // CHECK-SAME: values = [0.000000e+00, 0.000000e+00, 5.000000e-01, 1.500000e+00]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'fusedCwise_sub_mul_relu_i32'
+func @fusedCwise_sub_mul_relu_i32() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 2], values = [5 : i32, 6 : i32, 7 : i32, 8 : i32] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2], values = [1 : i32, 2 : i32] } : 1
+  %operand_2 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 1], values = [1 : i32, -1 : i32] } : 1
+
+  // Relu(Mul(Sub(%operand_0, %operand_1), %operand_2))
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._FusedCwise"(%operand_0, %operand_1, %operand_2)
+      { fused_ops = ["Sub", "Mul", "Relu"] } : 1
+
+  // CHECK: DenseHostTensor dtype = i32, shape = [2, 2]
+  // CHECK-SAME: values = [4, 4, 0, 0]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'fusedCwise_div_rsqrt_f32'
+func @fusedCwise_div_rsqrt_f32() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [4], values = [4.0 : f32, 16.0 : f32, 64.0 : f32, 256.0 : f32] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1], values = [4.0 : f32] } : 1
+
+  // Rsqrt(RealDiv(%operand_0, %operand_1))
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._FusedCwise"(%operand_0, %operand_1)
+      { fused_ops = ["RealDiv", "Rsqrt"] } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [4]
+  // CHECK-SAME: values = [1.000000e+00, 5.000000e-01, 2.500000e-01, 1.250000e-01]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
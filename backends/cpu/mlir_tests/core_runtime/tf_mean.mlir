@@ -69,3 +69,18 @@ func @mean_i32() -> !tfrt.chain {
   %ch_2 = corert.executeop.seq(%cpu, %ch_1) "tfrt_test.print"(%output) : 0
   tfrt.return %ch_2 : !tfrt.chain
 }
+
+// CHECK: --- Running 'mean_non_adjacent_axes_i64'
+func @mean_non_adjacent_axes_i64() -> !tfrt.chain {
+  %ch_1 = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_1 "cpu"
+
+  %input_1 = corert.const_dense_tensor dense<[[[1.0, 2.0], [3.0, 4.0]], [[5.0, 6.0], [7.0, 8.0]]]> : tensor<2x2x2xf32>
+  %input_2 = corert.const_dense_tensor dense<[0, 2]> : tensor<2xi64>
+  %output = corert.executeop(%cpu) "tf.Mean"(%input_1, %input_2)
+    { T = f32, Tidx = i64 } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2], values = [3.500000e+00, 5.500000e+00]
+  %ch_2 = corert.executeop.seq(%cpu, %ch_1) "tfrt_test.print"(%output) : 0
+  tfrt.return %ch_2 : !tfrt.chain
+}
@@ -0,0 +1,138 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor --test_init_function=register_op_handlers_cpu %s.bef | FileCheck %s
+
+func @register_op_handlers_cpu() {
+  %null = "corert.create_null_op_handler"() : () -> !corert.ophandler
+  %cpu = "corert.create_cpu_op_handler"(%null) : (!corert.ophandler) -> !corert.ophandler
+  corert.register_op_handler %cpu "cpu"
+  tfrt.return
+}
+
+// CHECK: --- Running 'quantizedMatMul_dequantize_f32'
+func @quantizedMatMul_dequantize_f32() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 3], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [3, 2], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._QuantizedMatMul"(%operand_0, %operand_1)
+      { transpose_a = false, transpose_b = false, Toutput = f32,
+        a_scale = 0.5 : f32, b_scale = [0.25 : f32] } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2, 2]
+  // CHECK-SAME: values = [2.750000e+00, 3.500000e+00, 6.125000e+00, 8.000000e+00]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'quantizedMatMul_per_channel_requantize_i8'
+func @quantizedMatMul_per_channel_requantize_i8() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 3], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [3, 2], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._QuantizedMatMul"(%operand_0, %operand_1)
+      { transpose_a = false, transpose_b = false, Toutput = i8,
+        a_scale = 0.5 : f32, b_scale = [0.25 : f32, 0.5 : f32],
+        output_scale = 1.0 : f32 } : 1
+
+  // CHECK: DenseHostTensor dtype = i8, shape = [2, 2]
+  // CHECK-SAME: values = [3, 7, 6, 16]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'quantizedMatMul_saturate_qi8'
+func @quantizedMatMul_saturate_qi8() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 3], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [3, 2], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._QuantizedMatMul"(%operand_0, %operand_1)
+      { transpose_a = false, transpose_b = false, Toutput = !corert.qint8,
+        a_scale = 0.5 : f32, b_scale = [0.25 : f32],
+        output_scale = 0.03 : f32 } : 1
+
+  // CHECK: DenseHostTensor dtype = qi8, shape = [2, 2]
+  // CHECK-SAME: values = [qi8(92), qi8(117), qi8(127), qi8(127)]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'quantizedFusedMatMul_bias_relu_f32'
+func @quantizedFusedMatMul_bias_relu_f32() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 3], values = [-1 : i8, 2 : i8, -3 : i8, 4 : i8, -5 : i8, 6 : i8] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 3], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+  %operand_2 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2], values = [1.0 : f32, 2.0 : f32] } : 1
+
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._QuantizedFusedMatMul"(%operand_0, %operand_1, %operand_2)
+      { fused_ops = ["BiasAdd", "Relu"], transpose_a = false,
+        transpose_b = true, Toutput = f32, a_scale = 1.0 : f32,
+        b_scale = [0.5 : f32] } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2, 2]
+  // CHECK-SAME: values = [0.000000e+00, 0.000000e+00, 7.000000e+00, 1.550000e+01]
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
+
+// CHECK: --- Running 'quantizedMatMul_invalid_output_scale'
+func @quantizedMatMul_invalid_output_scale() -> !tfrt.chain{
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %operand_0 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2, 3], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+  %operand_1 = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [3, 2], values = [1 : i8, 2 : i8, 3 : i8, 4 : i8, 5 : i8, 6 : i8] } : 1
+
+  // expected-error @+1 {{runtime error: 'output_scale' must be positive, got 0.000000e+00}}
+  %cpu_handle_result = corert.executeop(%cpu)
+      "tf._QuantizedMatMul"(%operand_0, %operand_1)
+      { transpose_a = false, transpose_b = false, Toutput = i8,
+        a_scale = 0.5 : f32, b_scale = [0.25 : f32],
+        output_scale = 0.0 : f32 } : 1
+
+  %ch_print_cpu = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%cpu_handle_result) : 0
+
+  // CHECK: 'quantizedMatMul_invalid_output_scale' returned <<error: 'output_scale' must be positive, got 0.000000e+00>>
+  tfrt.return %ch_print_cpu : !tfrt.chain
+}
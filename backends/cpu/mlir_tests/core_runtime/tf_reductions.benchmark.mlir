@@ -0,0 +1,157 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor --test_init_function=register_op_handlers_cpu %s.bef | FileCheck %s
+
+func @register_op_handlers_cpu() {
+  %null = "corert.create_null_op_handler"() : () -> !corert.ophandler
+  %cpu = "corert.create_cpu_op_handler"(%null) : (!corert.ophandler) -> !corert.ophandler
+  corert.register_op_handler %cpu "cpu"
+  tfrt.return
+}
+
+// CHECK-LABEL: --- Running 'BM_Sum_1024x1024_inner_f32'
+func @BM_Sum_1024x1024_inner_f32() {
+  %ch0 = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch0 "cpu"
+
+  %input = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1024, 1024], values = [1.0 : f32] } : 1
+
+  %axes = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1], values = [1 : i32] } : 1
+
+  tfrt_test.benchmark "BM_Sum_1024x1024_inner_f32"(
+      %cpu     : !corert.ophandler,
+      %input   : !corert.tensorhandle,
+      %axes    : !corert.tensorhandle
+  )
+  duration_secs = 5, max_count = 1000000, num_warmup_runs = 10
+  {
+    %result  = corert.executeop(%cpu)
+      "tf.Sum"(%input, %axes) { deterministic = false } : 1
+
+    tfrt.return %result : !corert.tensorhandle
+  }
+
+  tfrt.return
+}
+
+// CHECK-LABEL: --- Running 'BM_Sum_1024x1024_outer_f32'
+func @BM_Sum_1024x1024_outer_f32() {
+  %ch0 = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch0 "cpu"
+
+  %input = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1024, 1024], values = [1.0 : f32] } : 1
+
+  %axes = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1], values = [0 : i32] } : 1
+
+  tfrt_test.benchmark "BM_Sum_1024x1024_outer_f32"(
+      %cpu     : !corert.ophandler,
+      %input   : !corert.tensorhandle,
+      %axes    : !corert.tensorhandle
+  )
+  duration_secs = 5, max_count = 1000000, num_warmup_runs = 10
+  {
+    %result  = corert.executeop(%cpu)
+      "tf.Sum"(%input, %axes) { deterministic = false } : 1
+
+    tfrt.return %result : !corert.tensorhandle
+  }
+
+  tfrt.return
+}
+
+// CHECK-LABEL: --- Running 'BM_Sum_1024x1024_all_f32'
+func @BM_Sum_1024x1024_all_f32() {
+  %ch0 = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch0 "cpu"
+
+  %input = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1024, 1024], values = [1.0 : f32] } : 1
+
+  %axes = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2], values = [0 : i32, 1 : i32] } : 1
+
+  tfrt_test.benchmark "BM_Sum_1024x1024_all_f32"(
+      %cpu     : !corert.ophandler,
+      %input   : !corert.tensorhandle,
+      %axes    : !corert.tensorhandle
+  )
+  duration_secs = 5, max_count = 1000000, num_warmup_runs = 10
+  {
+    %result  = corert.executeop(%cpu)
+      "tf.Sum"(%input, %axes) { deterministic = false } : 1
+
+    tfrt.return %result : !corert.tensorhandle
+  }
+
+  tfrt.return
+}
+
+// CHECK-LABEL: --- Running 'BM_Sum_1024x1024_all_deterministic_f32'
+func @BM_Sum_1024x1024_all_deterministic_f32() {
+  %ch0 = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch0 "cpu"
+
+  %input = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1024, 1024], values = [1.0 : f32] } : 1
+
+  %axes = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [2], values = [0 : i32, 1 : i32] } : 1
+
+  tfrt_test.benchmark "BM_Sum_1024x1024_all_deterministic_f32"(
+      %cpu     : !corert.ophandler,
+      %input   : !corert.tensorhandle,
+      %axes    : !corert.tensorhandle
+  )
+  duration_secs = 5, max_count = 1000000, num_warmup_runs = 10
+  {
+    %result  = corert.executeop(%cpu)
+      "tf.Sum"(%input, %axes) { deterministic = true } : 1
+
+    tfrt.return %result : !corert.tensorhandle
+  }
+
+  tfrt.return
+}
+
+// CHECK-LABEL: --- Running 'BM_Max_1024x1024_inner_f32'
+func @BM_Max_1024x1024_inner_f32() {
+  %ch0 = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch0 "cpu"
+
+  %input = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1024, 1024], values = [1.0 : f32] } : 1
+
+  %axes = corert.executeop(%cpu) "tfrt_test.create_dense_tensor"()
+    { shape = [1], values = [1 : i32] } : 1
+
+  tfrt_test.benchmark "BM_Max_1024x1024_inner_f32"(
+      %cpu     : !corert.ophandler,
+      %input   : !corert.tensorhandle,
+      %axes    : !corert.tensorhandle
+  )
+  duration_secs = 5, max_count = 1000000, num_warmup_runs = 10
+  {
+    %result  = corert.executeop(%cpu)
+      "tf.Max"(%input, %axes) { deterministic = false } : 1
+
+    tfrt.return %result : !corert.tensorhandle
+  }
+
+  tfrt.return
+}
@@ -0,0 +1,162 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor --test_init_function=register_op_handlers_cpu %s.bef | FileCheck %s
+
+func @register_op_handlers_cpu() {
+  %null = "corert.create_null_op_handler"() : () -> !corert.ophandler
+  %cpu = "corert.create_cpu_op_handler"(%null) : (!corert.ophandler) -> !corert.ophandler
+  corert.register_op_handler %cpu "cpu"
+  tfrt.return
+}
+
+// CHECK: --- Running 'sum_inner_axis'
+func @sum_inner_axis() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]> : tensor<2x3xf32>
+  %axes = corert.const_dense_tensor dense<[1]> : tensor<1xi32>
+  %result = corert.executeop(%cpu) "tf.Sum"(%input, %axes) : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2]
+  // CHECK-SAME: values = [6.000000e+00, 1.500000e+01]
+  %ch_print = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%result) : 0
+  tfrt.return %ch_print : !tfrt.chain
+}
+
+// CHECK: --- Running 'sum_outer_axis_keep_dims'
+func @sum_outer_axis_keep_dims() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]> : tensor<2x3xf32>
+  %axes = corert.const_dense_tensor dense<[0]> : tensor<1xi32>
+  %result = corert.executeop(%cpu) "tf.Sum"(%input, %axes)
+    { keep_dims = true } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [1, 3]
+  // CHECK-SAME: values = [5.000000e+00, 7.000000e+00, 9.000000e+00]
+  %ch_print = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%result) : 0
+  tfrt.return %ch_print : !tfrt.chain
+}
+
+// CHECK: --- Running 'sum_all_axes_deterministic'
+func @sum_all_axes_deterministic() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]> : tensor<2x3xf32>
+  %axes = corert.const_dense_tensor dense<[0, -1]> : tensor<2xi64>
+  %result = corert.executeop(%cpu) "tf.Sum"(%input, %axes)
+    { deterministic = true } : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [], values = [2.100000e+01]
+  %ch_print = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%result) : 0
+  tfrt.return %ch_print : !tfrt.chain
+}
+
+// CHECK: --- Running 'sum_middle_axes'
+func @sum_middle_axes() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[[[1], [2]], [[3], [4]]], [[[5], [6]], [[7], [8]]]]> : tensor<2x2x2x1xi32>
+  %axes = corert.const_dense_tensor dense<[1, 2]> : tensor<2xi32>
+  %result = corert.executeop(%cpu) "tf.Sum"(%input, %axes) : 1
+
+  // CHECK: DenseHostTensor dtype = i32, shape = [2, 1], values = [10, 26]
+  %ch_print = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%result) : 0
+  tfrt.return %ch_print : !tfrt.chain
+}
+
+// CHECK: --- Running 'prod'
+func @prod() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]> : tensor<2x3xf32>
+  %axes = corert.const_dense_tensor dense<[1]> : tensor<1xi32>
+  %result = corert.executeop(%cpu) "tf.Prod"(%input, %axes) : 1
+
+  // CHECK: DenseHostTensor dtype = f32, shape = [2]
+  // CHECK-SAME: values = [6.000000e+00, 1.200000e+02]
+  %ch_print = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%result) : 0
+  tfrt.return %ch_print : !tfrt.chain
+}
+
+// CHECK: --- Running 'max_min'
+func @max_min() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[1, 5, 3], [4, 2, 6]]> : tensor<2x3xi32>
+  %axis_0 = corert.const_dense_tensor dense<0> : tensor<i32>
+  %axis_1 = corert.const_dense_tensor dense<1> : tensor<i32>
+  %max = corert.executeop(%cpu) "tf.Max"(%input, %axis_0) : 1
+  %min = corert.executeop(%cpu) "tf.Min"(%input, %axis_1) : 1
+
+  // CHECK: DenseHostTensor dtype = i32, shape = [3], values = [4, 5, 6]
+  %ch_0 = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%max) : 0
+  // CHECK: DenseHostTensor dtype = i32, shape = [2], values = [1, 2]
+  %ch_1 = corert.executeop.seq(%cpu, %ch_0) "tfrt_test.print"(%min) : 0
+  tfrt.return %ch_1 : !tfrt.chain
+}
+
+// CHECK: --- Running 'all_any'
+func @all_any() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[true, false], [true, true]]> : tensor<2x2xi1>
+  %axes = corert.const_dense_tensor dense<[1]> : tensor<1xi32>
+  %all = corert.executeop(%cpu) "tf.All"(%input, %axes) : 1
+  %any = corert.executeop(%cpu) "tf.Any"(%input, %axes) : 1
+
+  // CHECK: DenseHostTensor dtype = i1, shape = [2], values = [0, 1]
+  %ch_0 = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%all) : 0
+  // CHECK: DenseHostTensor dtype = i1, shape = [2], values = [1, 1]
+  %ch_1 = corert.executeop.seq(%cpu, %ch_0) "tfrt_test.print"(%any) : 0
+  tfrt.return %ch_1 : !tfrt.chain
+}
+
+// CHECK: --- Running 'arg_max'
+func @arg_max() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  // Ties are resolved to the smallest index.
+  %input = corert.const_dense_tensor dense<[[1.0, 3.0, 3.0], [7.0, 2.0, 7.0]]> : tensor<2x3xf32>
+  %dimension = corert.const_dense_tensor dense<1> : tensor<i32>
+  %result = corert.executeop(%cpu) "tf.ArgMax"(%input, %dimension) : 1
+
+  // CHECK: DenseHostTensor dtype = i64, shape = [2], values = [1, 0]
+  %ch_print = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%result) : 0
+  tfrt.return %ch_print : !tfrt.chain
+}
+
+// CHECK: --- Running 'arg_min_i32'
+func @arg_min_i32() -> !tfrt.chain {
+  %ch_epoch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch_epoch "cpu"
+
+  %input = corert.const_dense_tensor dense<[[1.0, 3.0, 3.0], [7.0, 2.0, 0.0]]> : tensor<2x3xf32>
+  %dimension = corert.const_dense_tensor dense<0> : tensor<i32>
+  %result = corert.executeop(%cpu) "tf.ArgMin"(%input, %dimension)
+    { output_type = i32 } : 1
+
+  // CHECK: DenseHostTensor dtype = i32, shape = [3], values = [0, 1, 1]
+  %ch_print = corert.executeop.seq(%cpu, %ch_epoch) "tfrt_test.print"(%result) : 0
+  tfrt.return %ch_print : !tfrt.chain
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for KernelProfile class.
+
+#include "tfrt/bef/kernel_profile.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace tfrt {
+namespace {
+
+TEST(KernelProfileTest, AddAndMerge) {
+  KernelProfile profile;
+  profile.Add("file.mlir:1:2", 1, 100);
+  profile.Add("file.mlir:1:2", 2, 500);
+
+  KernelProfile other;
+  other.Add("file.mlir:1:2", 1, 200);
+  other.Add("op_name", 4, 40);
+  profile.Merge(other);
+
+  ASSERT_EQ(profile.size(), 2);
+
+  const auto* entry = profile.Find("file.mlir:1:2");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->count, 4);
+  EXPECT_EQ(entry->total_ns, 800);
+  EXPECT_EQ(entry->MeanNs(), 200);
+
+  entry = profile.Find("op_name");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->MeanNs(), 10);
+
+  EXPECT_EQ(profile.Find("unknown"), nullptr);
+}
+
+TEST(KernelProfileTest, PrintAndParse) {
+  KernelProfile profile;
+  profile.Add("b.mlir:3:4", 2, 30);
+  profile.Add("callee(name with spaces)<-a.mlir;1;2", 1, 7);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  profile.Print(os);
+  EXPECT_EQ(os.str(),
+            "# tfrt kernel profile v1\n"
+            "2 30 b.mlir:3:4\n"
+            "1 7 callee(name with spaces)<-a.mlir;1;2\n");
+
+  auto parsed = KernelProfile::Parse(text);
+  ASSERT_TRUE(static_cast<bool>(parsed));
+  ASSERT_EQ(parsed->size(), 2);
+
+  const auto* entry = parsed->Find("callee(name with spaces)<-a.mlir;1;2");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->count, 1);
+  EXPECT_EQ(entry->total_ns, 7);
+
+  entry = parsed->Find("b.mlir:3:4");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->count, 2);
+  EXPECT_EQ(entry->total_ns, 30);
+}
+
+TEST(KernelProfileTest, ParseMergesDuplicates) {
+  auto parsed = KernelProfile::Parse("\n# comment\n1 10 op\n\n3 20 op\n");
+  ASSERT_TRUE(static_cast<bool>(parsed));
+  ASSERT_EQ(parsed->size(), 1);
+  EXPECT_EQ(parsed->Find("op")->count, 4);
+  EXPECT_EQ(parsed->Find("op")->total_ns, 30);
+}
+
+TEST(KernelProfileTest, ParseError) {
+  auto parsed = KernelProfile::Parse("1 10 op\n1 x op\n");
+  ASSERT_FALSE(static_cast<bool>(parsed));
+  EXPECT_EQ(llvm::toString(parsed.takeError()),
+            "malformed kernel profile at line 2");
+
+  parsed = KernelProfile::Parse("1 10\n");
+  ASSERT_FALSE(static_cast<bool>(parsed));
+  llvm::consumeError(parsed.takeError());
+}
+
+}  // namespace
+}  // namespace tfrt
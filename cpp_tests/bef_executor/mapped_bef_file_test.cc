@@ -0,0 +1,172 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for BEFFile::OpenMapped().
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../lib/bef_executor/bef_file_impl.h"
+#include "gtest/gtest.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "tfrt/bef/bef_encoding.h"
+#include "tfrt/bef_executor/bef_file.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+// Appends the section `id` with `data` to `file`.
+void AppendSection(std::vector<uint8_t>* file, BEFSectionID id,
+                   const std::vector<uint8_t>& data) {
+  file->push_back(static_cast<uint8_t>(id));
+  // The length is shifted left by one, the low bit indicates that there is no
+  // alignment padding. It is encoded as a VBR integer.
+  size_t length = data.size() << 1;
+  std::vector<uint8_t> vbr = {static_cast<uint8_t>(length & 127)};
+  while (length >>= 7) vbr.push_back(static_cast<uint8_t>(length & 127) | 128);
+  file->insert(file->end(), vbr.rbegin(), vbr.rend());
+  file->insert(file->end(), data.begin(), data.end());
+}
+
+// Returns a BEF file without kernels, types and functions, and with
+// `attributes` in the attributes section.
+std::vector<uint8_t> MakeBEFFile(const std::vector<uint8_t>& attributes) {
+  std::vector<uint8_t> file = {kBEFMagic1, kBEFMagic2, kBEFVersion0};
+  AppendSection(&file, BEFSectionID::kAttributes, attributes);
+  // The sections below contain zero entries.
+  AppendSection(&file, BEFSectionID::kKernels, {0});
+  AppendSection(&file, BEFSectionID::kTypes, {0});
+  AppendSection(&file, BEFSectionID::kFunctionIndex, {0});
+  return file;
+}
+
+// Returns whether the file at `path` is memory mapped by this process.
+bool IsMapped(const std::string& path) {
+  std::ifstream maps("/proc/self/maps");
+  std::string line;
+  while (std::getline(maps, line)) {
+    if (line.find(path) != std::string::npos) return true;
+  }
+  return false;
+}
+
+class MappedBEFFileTest : public ::testing::Test {
+ protected:
+  MappedBEFFileTest() : host_(CreateHostContext()) {
+    llvm::SmallString<128> path;
+    EXPECT_FALSE(llvm::sys::fs::createTemporaryFile("mapped", "bef", path));
+    path_ = std::string(path.str());
+  }
+
+  ~MappedBEFFileTest() override { llvm::sys::fs::remove(path_); }
+
+  void WriteFile(const std::vector<uint8_t>& contents) {
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(contents.data()),
+               contents.size());
+  }
+
+  RCReference<BEFFile> OpenMapped(string_view path,
+                                  const BEFFileMapOptions& options = {}) {
+    auto error_handler = [this](const DecodedDiagnostic& diag) {
+      errors_.push_back(diag.message);
+    };
+    return BEFFile::OpenMapped(path, host_->GetKernelRegistry(), error_handler,
+                               host_->allocator(), options);
+  }
+
+  std::unique_ptr<HostContext> host_;
+  std::string path_;
+  std::vector<std::string> errors_;
+};
+
+TEST_F(MappedBEFFileTest, MissingFile) {
+  llvm::sys::fs::remove(path_);
+  EXPECT_EQ(OpenMapped(path_), nullptr);
+  ASSERT_EQ(errors_.size(), 1);
+  EXPECT_NE(errors_[0].find("failed to open BEF file"), std::string::npos);
+}
+
+TEST_F(MappedBEFFileTest, EmptyFile) {
+  EXPECT_EQ(OpenMapped(path_), nullptr);
+  ASSERT_EQ(errors_.size(), 1);
+  EXPECT_NE(errors_[0].find("is empty"), std::string::npos);
+}
+
+TEST_F(MappedBEFFileTest, MmapFailure) {
+  // A directory can be opened for reading, but it can not be mapped.
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("mapped", dir));
+  EXPECT_EQ(OpenMapped(dir), nullptr);
+  llvm::sys::fs::remove(dir);
+  ASSERT_EQ(errors_.size(), 1);
+  EXPECT_NE(errors_[0].find("failed to mmap BEF file"), std::string::npos);
+}
+
+TEST_F(MappedBEFFileTest, ReleasesMappingOnFailure) {
+  std::vector<uint8_t> file = MakeBEFFile({1, 2, 3});
+  file[0] = 0;  // Corrupt the magic number.
+  WriteFile(file);
+  EXPECT_EQ(OpenMapped(path_), nullptr);
+  ASSERT_EQ(errors_.size(), 1);
+  EXPECT_NE(errors_[0].find("invalid BEF file header"), std::string::npos);
+  EXPECT_FALSE(IsMapped(path_));
+}
+
+TEST_F(MappedBEFFileTest, ReleasesMappingWithBEFFile) {
+  WriteFile(MakeBEFFile({1, 2, 3}));
+  auto bef = OpenMapped(path_);
+  ASSERT_NE(bef, nullptr);
+  EXPECT_TRUE(errors_.empty());
+  EXPECT_TRUE(IsMapped(path_));
+  bef.reset();
+  EXPECT_FALSE(IsMapped(path_));
+}
+
+TEST_F(MappedBEFFileTest, AdvisesSections) {
+  // The attributes section is not page aligned and spans several pages.
+  const size_t page_size = llvm::sys::fs::mapped_file_region::alignment();
+  std::vector<uint8_t> attributes(3 * page_size + 123);
+  for (size_t i = 0; i < attributes.size(); ++i) attributes[i] = i % 251;
+  WriteFile(MakeBEFFile(attributes));
+
+  for (auto hint : {BEFFileAccessHint::kNormal, BEFFileAccessHint::kWillNeed,
+                    BEFFileAccessHint::kRandom}) {
+    BEFFileMapOptions options;
+    options.attributes_hint = hint;
+    options.kernels_hint = hint;
+    auto bef = OpenMapped(path_, options);
+    ASSERT_NE(bef, nullptr);
+    EXPECT_TRUE(errors_.empty());
+
+    // The advice does not change the mapped contents.
+    auto* bef_impl = static_cast<BEFFileImpl*>(bef.get());
+    EXPECT_EQ(std::vector<uint8_t>(bef_impl->attribute_section_.begin(),
+                                   bef_impl->attribute_section_.end()),
+              attributes);
+    EXPECT_EQ(bef_impl->kernels_section_.size(), 1);
+  }
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests and benchmarks for the op caching of the corert.executeop kernel.
+
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/bef/bef_encoding.h"
+#include "tfrt/core_runtime/core_runtime.h"
+#include "tfrt/core_runtime/core_runtime_op.h"
+#include "tfrt/core_runtime/kernels.h"
+#include "tfrt/core_runtime/op_handler.h"
+#include "tfrt/core_runtime/op_invocation.h"
+#include "tfrt/core_runtime/tensor_handle.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/utils/kernel_runner.h"
+
+namespace tfrt {
+namespace {
+
+// CountingOpHandler counts the ops it makes. Its ops return a scalar tensor.
+class CountingOpHandler : public OpHandler {
+ public:
+  CountingOpHandler(CoreRuntime* runtime, const TensorHandle& result)
+      : OpHandler("counting", runtime, /*fallback=*/nullptr),
+        result_(result) {}
+
+  Expected<CoreRuntimeOp> MakeOp(string_view op_name) override {
+    ++num_make_op_calls;
+    return CoreRuntimeOp(
+        [this](const OpInvocation& invocation) {
+          invocation.results[0] = result_.CopyRef();
+        },
+        /*is_fallback=*/false);
+  }
+
+  int num_make_op_calls = 0;
+
+ private:
+  const TensorHandle& result_;
+};
+
+std::unique_ptr<CoreRuntime> CreateCoreRuntime() {
+  auto diag_handler = [](const DecodedDiagnostic& diag) {
+    llvm::errs() << "Encountered runtime error: " << diag.message << "\n";
+  };
+  auto corert = CoreRuntime::Create(
+      diag_handler, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(/*num_threads=*/1,
+                                   /*num_blocking_threads=*/1));
+  assert(corert);
+  auto* host = corert.get()->GetHostContext();
+  RegisterCoreRuntimeKernels(host->GetMutableRegistry());
+  return std::move(*corert);
+}
+
+// Returns the scalar tensor returned by the ops of CountingOpHandler.
+TensorHandle MakeResult(HostContext* host) {
+  TensorMetadata metadata(GetDType<int32_t>(), {});
+  auto dht = DenseHostTensor::MakeConstructedAsyncValueRef(metadata, host);
+  dht.SetStateConcrete();
+  return TensorHandle(host->GetHostDeviceRef(), metadata, std::move(dht));
+}
+
+// Sets up `runner` to run a corert.executeop kernel without op attributes,
+// which executes test.op on `op_handler`.
+void SetUpExecuteOp(KernelRunner* runner, OpHandler* op_handler) {
+  runner->SetArgs(op_handler)
+      .AddAttribute<AttrSizeT>(0)  // op_attrs
+      .AddAttribute<AttrSizeT>(0)  // op_func_attrs
+      .AddStringAttribute("test.op");
+}
+
+class ExecuteOpTest : public ::testing::Test {
+ protected:
+  ExecuteOpTest()
+      : corert_(CreateCoreRuntime()),
+        result_(MakeResult(corert_->GetHostContext())),
+        op_handler_(corert_.get(), result_),
+        other_op_handler_(corert_.get(), result_) {}
+
+  std::unique_ptr<CoreRuntime> corert_;
+  TensorHandle result_;
+  CountingOpHandler op_handler_;
+  CountingOpHandler other_op_handler_;
+};
+
+TEST_F(ExecuteOpTest, CachesOpAcrossExecutions) {
+  KernelRunner runner("corert.executeop", corert_->GetHostContext());
+  SetUpExecuteOp(&runner, &op_handler_);
+  for (int i = 0; i < 3; ++i) {
+    runner.Run(1);
+    EXPECT_FALSE(runner.GetResultAt<TensorHandle>(0).IsError());
+  }
+  EXPECT_EQ(op_handler_.num_make_op_calls, 1);
+}
+
+TEST_F(ExecuteOpTest, KernelsCacheSeparately) {
+  KernelRunner runner("corert.executeop", corert_->GetHostContext());
+  KernelRunner other_runner("corert.executeop", corert_->GetHostContext());
+  SetUpExecuteOp(&runner, &op_handler_);
+  SetUpExecuteOp(&other_runner, &op_handler_);
+  runner.Run(1);
+  other_runner.Run(1);
+  runner.Run(1);
+  EXPECT_EQ(op_handler_.num_make_op_calls, 2);
+}
+
+TEST_F(ExecuteOpTest, OtherOpHandlerDoesNotUseCache) {
+  KernelRunner runner("corert.executeop", corert_->GetHostContext());
+  SetUpExecuteOp(&runner, &op_handler_);
+  runner.Run(1);
+
+  // The op cached for `op_handler_` must not be executed on another op
+  // handler, so these executions resolve their op every time.
+  runner.GetArgAt<OpHandler*>(0) = &other_op_handler_;
+  for (int i = 0; i < 3; ++i) {
+    runner.Run(1);
+    EXPECT_FALSE(runner.GetResultAt<TensorHandle>(0).IsError());
+  }
+  EXPECT_EQ(other_op_handler_.num_make_op_calls, 3);
+
+  runner.GetArgAt<OpHandler*>(0) = &op_handler_;
+  runner.Run(1);
+  EXPECT_EQ(op_handler_.num_make_op_calls, 1);
+}
+
+// The executions of a kernel, which use the op cached by the first execution.
+void BM_ExecuteOpCached(benchmark::State& state) {
+  auto corert = CreateCoreRuntime();
+  auto result = MakeResult(corert->GetHostContext());
+  CountingOpHandler op_handler(corert.get(), result);
+
+  KernelRunner runner("corert.executeop", corert->GetHostContext());
+  SetUpExecuteOp(&runner, &op_handler);
+  for (auto _ : state) runner.Run(1);
+}
+BENCHMARK(BM_ExecuteOpCached);
+
+// The executions of a kernel, which resolve the op every time like the
+// executions without a kernel cache.
+void BM_ExecuteOpUncached(benchmark::State& state) {
+  auto corert = CreateCoreRuntime();
+  auto result = MakeResult(corert->GetHostContext());
+  CountingOpHandler op_handler(corert.get(), result);
+  CountingOpHandler other_op_handler(corert.get(), result);
+
+  KernelRunner runner("corert.executeop", corert->GetHostContext());
+  SetUpExecuteOp(&runner, &other_op_handler);
+  runner.Run(1);
+  runner.GetArgAt<OpHandler*>(0) = &op_handler;
+  for (auto _ : state) runner.Run(1);
+}
+BENCHMARK(BM_ExecuteOpUncached);
+
+}  // namespace
+}  // namespace tfrt
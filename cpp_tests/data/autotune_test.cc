@@ -0,0 +1,185 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for the autotuning model of the data pipeline.
+
+#include "tfrt/data/autotune.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../../lib/data/autotuned_iterator.h"
+#include "../../lib/data/prefetch_dataset.h"
+#include "../../lib/data/range_dataset.h"
+#include "gtest/gtest.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+constexpr auto kPeriod = std::chrono::milliseconds(100);
+
+class AutotuneTest : public ::testing::Test {
+ protected:
+  AutotuneTest()
+      : host_([](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+              CreateSingleThreadedWorkQueue()) {}
+
+  RCReference<AutotuneModel> MakeModel(int64_t cpu_budget,
+                                       int64_t ram_budget) {
+    AutotuneOptions options;
+    options.cpu_budget = cpu_budget;
+    options.ram_budget = ram_budget;
+    // Adjust the parameters only when Optimize() is called by the test.
+    options.period = std::chrono::hours(1);
+    return TakeRef(new AutotuneModel(options));
+  }
+
+  // Returns a parameter registered with `model`.
+  RCReference<TunableParameter> MakeParameter(AutotuneModel* model,
+                                              TunableKind kind, int64_t value,
+                                              int64_t min = 1) {
+    IteratorContext context;
+    context.autotune_model = model;
+    return MakeTunableParameter(context, "parameter", kind, value, min);
+  }
+
+  // Records an output of `parameter` that the consumer waits for.
+  void RecordWaitedOutput(TunableParameter* parameter) {
+    auto value = MakeUnconstructedAsyncValueRef<std::string>(&host_);
+    IterationResult output({value.CopyRCRef()},
+                           MakeAvailableAsyncValueRef<bool>(&host_, false));
+    parameter->RecordOutput(output);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    value.emplace();
+  }
+
+  // Records an output of `parameter` that is available immediately.
+  void RecordAvailableOutput(TunableParameter* parameter) {
+    parameter->RecordOutput(IterationResult::Values(
+        {MakeAvailableAsyncValueRef<std::string>(&host_).CopyRCRef()},
+        &host_));
+  }
+
+  HostContext host_;
+};
+
+TEST_F(AutotuneTest, DisabledWithoutModel) {
+  auto parameter = MakeTunableParameter(IteratorContext(), "parameter",
+                                        TunableKind::kBufferSize, 4, 0);
+  EXPECT_FALSE(parameter);
+  EXPECT_EQ(GetTunableValue(parameter, 4), 4);
+}
+
+TEST_F(AutotuneTest, GrowsWaitedParallelismWithinCpuBudget) {
+  auto model = MakeModel(/*cpu_budget=*/6, /*ram_budget=*/0);
+  auto waited = MakeParameter(model.get(), TunableKind::kParallelism, 1);
+  auto fixed = MakeParameter(model.get(), TunableKind::kParallelism, 2);
+
+  for (int64_t expected : {2, 3, 4, 4}) {
+    RecordWaitedOutput(waited.get());
+    RecordAvailableOutput(fixed.get());
+    model->Optimize(kPeriod);
+    EXPECT_EQ(waited->value(), expected);
+    EXPECT_EQ(fixed->value(), 2);
+  }
+
+  auto stats = model->GetStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].value, 4);
+  EXPECT_EQ(stats[0].kind, TunableKind::kParallelism);
+  EXPECT_GT(stats[0].wait_fraction, 0.01);
+  EXPECT_EQ(stats[1].wait_fraction, 0);
+  EXPECT_DOUBLE_EQ(stats[1].elements_per_second, 10);
+}
+
+TEST_F(AutotuneTest, GrowsWaitedBufferWithinRamBudget) {
+  auto model = MakeModel(/*cpu_budget=*/1, /*ram_budget=*/4000);
+  auto buffer = MakeParameter(model.get(), TunableKind::kBufferSize, 2);
+  auto element = MakeAvailableAsyncValueRef<std::string>(
+      &host_, std::string(1000, 'x'));
+  buffer->RecordProduction(
+      IterationResult::Values({element.CopyRCRef()}, &host_),
+      std::chrono::microseconds(1));
+
+  for (int64_t expected : {3, 4, 4}) {
+    RecordWaitedOutput(buffer.get());
+    model->Optimize(kPeriod);
+    EXPECT_EQ(buffer->value(), expected);
+  }
+  EXPECT_EQ(model->GetStats()[0].mean_element_bytes, 1000);
+}
+
+TEST_F(AutotuneTest, ShrinksIdleParameter) {
+  auto model = MakeModel(/*cpu_budget=*/8, /*ram_budget=*/0);
+  auto parameter = MakeParameter(model.get(), TunableKind::kBufferSize, 4);
+
+  for (int i = 0; i < 7; ++i) {
+    RecordAvailableOutput(parameter.get());
+    model->Optimize(kPeriod);
+    EXPECT_EQ(parameter->value(), 4);
+  }
+  RecordAvailableOutput(parameter.get());
+  model->Optimize(kPeriod);
+  EXPECT_EQ(parameter->value(), 3);
+}
+
+TEST_F(AutotuneTest, UnregistersDestroyedParameter) {
+  auto model = MakeModel(/*cpu_budget=*/8, /*ram_budget=*/0);
+  auto parameter = MakeParameter(model.get(), TunableKind::kBufferSize, 4);
+  EXPECT_EQ(model->GetStats().size(), 1);
+  parameter.reset();
+  EXPECT_TRUE(model->GetStats().empty());
+}
+
+TEST_F(AutotuneTest, AutotunedIteratorPreservesValues) {
+  auto range = TakeRef(
+      host_.Construct<RangeDataset>(0, 100, 1, DType::I64, &host_));
+  auto prefetch = TakeRef(host_.Construct<PrefetchDataset>(
+      std::move(range), /*prefetch_num=*/2, /*is_deterministic=*/true, &host_));
+  auto iterator = TakeRef(host_.Construct<AutotunedIterator>(
+      prefetch.get(), AutotuneOptions(), &host_));
+
+  ExecutionContext exec_ctx(std::move(
+      *RequestContextBuilder(&host_, /*resource_context=*/nullptr).build()));
+  for (int64_t i = 0; i < 100; ++i) {
+    auto result = iterator->GetNext(exec_ctx);
+    ASSERT_FALSE(result.eof.get());
+    EXPECT_EQ(result.values[0]->get<int64_t>(), i);
+  }
+  EXPECT_TRUE(iterator->GetNext(exec_ctx).eof.get());
+
+  auto stats = iterator->model().GetStats();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].name, "prefetch_dataset/prefetch_num");
+
+  std::string printed;
+  llvm::raw_string_ostream os(printed);
+  iterator->model().Print(os);
+  EXPECT_NE(os.str().find("prefetch_dataset/prefetch_num: buffer_size = "),
+            std::string::npos);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
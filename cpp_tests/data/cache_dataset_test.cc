@@ -0,0 +1,153 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for CacheDataset.
+
+#include "../../lib/data/cache_dataset.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../../lib/data/map_dataset.h"
+#include "../../lib/data/range_dataset.h"
+#include "../../lib/data/repeat_dataset.h"
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/native_function.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+constexpr int64_t kNumElements = 16;
+
+class CacheDatasetTest : public ::testing::Test {
+ protected:
+  CacheDatasetTest()
+      : host_(CreateTestHostContext()),
+        i64_(host_->GetKernelRegistry().GetType("i64")),
+        map_fn_("counted_times_two", {i64_}, {i64_}, CountedTimesTwo),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {
+    NumCountedElements() = 0;
+  }
+
+  // Returns a cache of a map dataset with `num_parallel_calls`, so that the
+  // eofs of the input elements might become available asynchronously.
+  RCReference<CacheDataset> MakeCacheDataset(int64_t num_parallel_calls) {
+    auto range = TakeRef(host_->Construct<RangeDataset>(
+        0, kNumElements, 1, DType::I64, host_.get()));
+    auto map = TakeRef(host_->Construct<MapDataset>(
+        std::move(range), RCArray<AsyncValue>(ArrayRef<AsyncValue*>()),
+        FormRef(&map_fn_), num_parallel_calls, /*is_deterministic=*/true,
+        host_.get()));
+    return TakeRef(
+        host_->Construct<CacheDataset>(std::move(map), host_.get()));
+  }
+
+  std::unique_ptr<HostContext> host_;
+  TypeName i64_;
+  NativeFunction map_fn_;
+  ExecutionContext exec_ctx_;
+};
+
+std::vector<int64_t> ExpectedElements(int num_epochs = 1) {
+  std::vector<int64_t> expected;
+  for (int epoch = 0; epoch < num_epochs; ++epoch) {
+    for (int64_t i = 0; i < kNumElements; ++i) expected.push_back(2 * i);
+  }
+  return expected;
+}
+
+TEST_F(CacheDatasetTest, RepeatReadsLaterEpochsFromCache) {
+  for (int64_t num_parallel_calls : {1, 4}) {
+    NumCountedElements() = 0;
+    auto repeat = TakeRef(host_->Construct<RepeatDataset>(
+        MakeCacheDataset(num_parallel_calls), /*count=*/3, host_.get()));
+    auto iterator = repeat->MakeIterator(IteratorContext());
+    EXPECT_EQ(ReadAll(iterator.get(), exec_ctx_),
+              ExpectedElements(/*num_epochs=*/3));
+    EXPECT_EQ(NumCountedElements(), kNumElements);
+  }
+}
+
+TEST_F(CacheDatasetTest, ReaderReturnsEofRepeatedly) {
+  auto cache = MakeCacheDataset(/*num_parallel_calls=*/1);
+  ReadAll(cache.get(), exec_ctx_);
+
+  auto iterator = cache->MakeIterator(IteratorContext());
+  EXPECT_EQ(ReadAll(iterator.get(), exec_ctx_), ExpectedElements());
+  for (int i = 0; i < 2; ++i) {
+    auto result = iterator->GetNext(exec_ctx_);
+    EXPECT_TRUE(result.eof.get());
+    EXPECT_TRUE(result.values[0]->IsError());
+  }
+  EXPECT_EQ(NumCountedElements(), kNumElements);
+}
+
+TEST_F(CacheDatasetTest, ConcurrentIteratorDoesNotCache) {
+  auto cache = MakeCacheDataset(/*num_parallel_calls=*/1);
+  auto writer = cache->MakeIterator(IteratorContext());
+  auto concurrent = cache->MakeIterator(IteratorContext());
+  EXPECT_EQ(ReadAll(concurrent.get(), exec_ctx_), ExpectedElements());
+  EXPECT_EQ(ReadAll(writer.get(), exec_ctx_), ExpectedElements());
+  EXPECT_EQ(NumCountedElements(), 2 * kNumElements);
+
+  EXPECT_EQ(ReadAll(cache.get(), exec_ctx_), ExpectedElements());
+  EXPECT_EQ(NumCountedElements(), 2 * kNumElements);
+}
+
+TEST_F(CacheDatasetTest, AbandonedIterationIsNotCached) {
+  auto cache = MakeCacheDataset(/*num_parallel_calls=*/1);
+  ReadAll(cache->MakeIterator(IteratorContext()).get(), exec_ctx_,
+          kNumElements / 2);
+  EXPECT_EQ(NumCountedElements(), kNumElements / 2);
+
+  EXPECT_EQ(ReadAll(cache.get(), exec_ctx_), ExpectedElements());
+  EXPECT_EQ(ReadAll(cache.get(), exec_ctx_), ExpectedElements());
+  EXPECT_EQ(NumCountedElements(), kNumElements / 2 + kNumElements);
+}
+
+TEST_F(CacheDatasetTest, EofWaitsForPendingElements) {
+  std::vector<IterationResult> pending;
+  auto cache = TakeRef(host_->Construct<CacheDataset>(
+      TakeRef(new PendingDataset(/*num_elements=*/2, &pending)), host_.get()));
+  auto iterator = cache->MakeIterator(IteratorContext());
+  iterator->GetNext(exec_ctx_);
+  iterator->GetNext(exec_ctx_);
+  auto end = iterator->GetNext(exec_ctx_);
+  ASSERT_EQ(pending.size(), 2);
+  // The input returns the end of iteration before the preceding elements are
+  // available, and the cache is not completed yet.
+  EXPECT_FALSE(end.eof.IsAvailable());
+
+  for (int64_t i = 0; i < 2; ++i) {
+    pending[i].values[0]->emplace<int64_t>(2 * i);
+    pending[i].eof.emplace(false);
+  }
+  AwaitResult(host_.get(), end);
+  EXPECT_TRUE(end.eof.get());
+
+  // The next iterator reads from the cache instead of the input.
+  EXPECT_EQ(ReadAll(cache.get(), exec_ctx_), std::vector<int64_t>({0, 2}));
+  EXPECT_EQ(pending.size(), 2);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests and benchmarks for MapDataset.
+
+#include "../../lib/data/map_dataset.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../../lib/data/range_dataset.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/native_function.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+constexpr int64_t kNumElements = 64;
+
+// Returns 2 * x. The amount of busy work is proportional to the value of x, so
+// that invocations for larger elements take longer to complete. Errors, e.g.
+// the end of iteration of the input, are forwarded to the result.
+void TimesTwo(AsyncValue* const* arguments, int num_arguments,
+              RCReference<AsyncValue>* results, int num_results,
+              HostContext* host) {
+  if (arguments[0]->IsError()) {
+    results[0] = FormRef(arguments[0]);
+    return;
+  }
+  int64_t x = arguments[0]->get<int64_t>();
+  volatile int64_t sink = 0;
+  for (int64_t i = 0; i < 1000 * (x + 1); ++i) sink = sink + i;
+  results[0] = MakeAvailableAsyncValueRef<int64_t>(host, 2 * x);
+}
+
+// The result of GatedFirstTimesTwo() for the first element. The test makes it
+// available after the other elements have been returned.
+AsyncValueRef<int64_t> first_result;
+
+// Returns 2 * x like TimesTwo(), but the result for the first element is
+// `first_result`.
+void GatedFirstTimesTwo(AsyncValue* const* arguments, int num_arguments,
+                        RCReference<AsyncValue>* results, int num_results,
+                        HostContext* host) {
+  if (arguments[0]->IsError()) {
+    results[0] = FormRef(arguments[0]);
+    return;
+  }
+  int64_t x = arguments[0]->get<int64_t>();
+  if (x == 0) {
+    results[0] = first_result.CopyRCRef();
+    return;
+  }
+  results[0] = MakeAvailableAsyncValueRef<int64_t>(host, 2 * x);
+}
+
+class MapDatasetTest : public ::testing::Test {
+ protected:
+  MapDatasetTest()
+      : host_(CreateTestHostContext(4)),
+        i64_(host_->GetKernelRegistry().GetType("i64")),
+        map_fn_("times_two", {i64_}, {i64_}, TimesTwo),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {}
+
+  RCReference<Dataset> MakeMapDataset(int64_t num_parallel_calls,
+                                      bool is_deterministic) {
+    return MakeMapDataset(&map_fn_, num_parallel_calls, is_deterministic);
+  }
+
+  RCReference<Dataset> MakeMapDataset(NativeFunction* map_fn,
+                                      int64_t num_parallel_calls,
+                                      bool is_deterministic) {
+    auto range = TakeRef(host_->Construct<RangeDataset>(
+        0, kNumElements, 1, DType::I64, host_.get()));
+    return TakeRef(host_->Construct<MapDataset>(
+        std::move(range), RCArray<AsyncValue>(ArrayRef<AsyncValue*>()),
+        FormRef(map_fn), num_parallel_calls, is_deterministic, host_.get()));
+  }
+
+  std::unique_ptr<HostContext> host_;
+  TypeName i64_;
+  NativeFunction map_fn_;
+  ExecutionContext exec_ctx_;
+};
+
+std::vector<int64_t> ExpectedElements() {
+  std::vector<int64_t> expected;
+  for (int64_t i = 0; i < kNumElements; ++i) expected.push_back(2 * i);
+  return expected;
+}
+
+TEST_F(MapDatasetTest, Sequential) {
+  auto dataset = MakeMapDataset(/*num_parallel_calls=*/1,
+                                /*is_deterministic=*/true);
+  EXPECT_EQ(ReadAll(dataset.get(), exec_ctx_), ExpectedElements());
+}
+
+TEST_F(MapDatasetTest, ParallelPreservesOrder) {
+  auto dataset = MakeMapDataset(/*num_parallel_calls=*/8,
+                                /*is_deterministic=*/true);
+  EXPECT_EQ(ReadAll(dataset.get(), exec_ctx_), ExpectedElements());
+}
+
+TEST_F(MapDatasetTest, ParallelNonDeterministic) {
+  auto dataset = MakeMapDataset(/*num_parallel_calls=*/8,
+                                /*is_deterministic=*/false);
+  auto elements = ReadAll(dataset.get(), exec_ctx_);
+  std::sort(elements.begin(), elements.end());
+  EXPECT_EQ(elements, ExpectedElements());
+}
+
+TEST_F(MapDatasetTest, ParallelNonDeterministicReturnsInCompletionOrder) {
+  first_result = MakeUnconstructedAsyncValueRef<int64_t>();
+  NativeFunction map_fn("gated_first_times_two", {i64_}, {i64_},
+                        GatedFirstTimesTwo);
+  auto dataset = MakeMapDataset(&map_fn, /*num_parallel_calls=*/8,
+                                /*is_deterministic=*/false);
+  auto iterator = dataset->MakeIterator(IteratorContext());
+
+  // The first element is still being mapped while the other elements complete,
+  // so it is returned last.
+  auto elements = ReadAll(iterator.get(), exec_ctx_, kNumElements - 1);
+  EXPECT_EQ(std::count(elements.begin(), elements.end(), 0), 0);
+  first_result.emplace(0);
+  EXPECT_EQ(ReadAll(iterator.get(), exec_ctx_), std::vector<int64_t>({0}));
+  first_result.reset();
+
+  elements.push_back(0);
+  std::sort(elements.begin(), elements.end());
+  EXPECT_EQ(elements, ExpectedElements());
+}
+
+TEST_F(MapDatasetTest, ParallelReturnsEofRepeatedly) {
+  auto dataset = MakeMapDataset(/*num_parallel_calls=*/4,
+                                /*is_deterministic=*/true);
+  auto iterator = dataset->MakeIterator(IteratorContext());
+
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    auto result = iterator->GetNext(exec_ctx_);
+    AwaitResult(host_.get(), result);
+    ASSERT_FALSE(result.eof.get());
+  }
+  for (int i = 0; i < 2; ++i) {
+    auto result = iterator->GetNext(exec_ctx_);
+    AwaitResult(host_.get(), result);
+    EXPECT_TRUE(result.eof.get());
+    EXPECT_TRUE(result.values[0]->IsError());
+  }
+}
+
+// -------------------------------------------------------------------------- //
+// Performance benchmarks.
+// -------------------------------------------------------------------------- //
+
+// Maps over `kNumElements` elements with `state.range(0)` parallel calls.
+void BM_MapDataset(benchmark::State& state) {
+  auto host = CreateTestHostContext(8);
+  auto i64 = host->GetKernelRegistry().GetType("i64");
+  NativeFunction map_fn("times_two", {i64}, {i64}, TimesTwo);
+  auto exec_ctx = CreateTestExecutionContext(host.get());
+
+  for (auto _ : state) {
+    auto range = TakeRef(host->Construct<RangeDataset>(
+        0, kNumElements, 1, DType::I64, host.get()));
+    auto dataset = TakeRef(host->Construct<MapDataset>(
+        std::move(range), RCArray<AsyncValue>(ArrayRef<AsyncValue*>()),
+        FormRef(&map_fn), state.range(0), /*is_deterministic=*/true,
+        host.get()));
+    auto iterator = dataset->MakeIterator(IteratorContext());
+
+    while (true) {
+      auto result = iterator->GetNext(exec_ctx);
+      AwaitResult(host.get(), result);
+      if (result.eof.get()) break;
+    }
+  }
+
+  state.SetItemsProcessed(kNumElements * state.iterations());
+}
+
+BENCHMARK(BM_MapDataset)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for PaddedBatchDataset.
+
+#include "../../lib/data/padded_batch_dataset.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../lib/data/map_dataset.h"
+#include "../../lib/data/range_dataset.h"
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/native_function.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+// Returns the shape of the element made from x by MakeElement().
+std::vector<Index> ElementShape(int64_t x) {
+  // Elements are 2-D for odd x if x is negative, e.g. range(-n, 0).
+  if (x < 0) return {(-x) % 3 + 1, (-x) % 2 + 1};
+  return {x % 8 + 1};
+}
+
+// Returns a tensor whose shape is ElementShape(x) and whose elements are x.
+void MakeElement(AsyncValue* const* arguments, int num_arguments,
+                 RCReference<AsyncValue>* results, int num_results,
+                 HostContext* host) {
+  if (arguments[0]->IsError()) {
+    results[0] = FormRef(arguments[0]);
+    return;
+  }
+  int64_t x = arguments[0]->get<int64_t>();
+  auto tensor = DenseHostTensor::CreateUninitialized(
+      TensorMetadata(DType::I64, ElementShape(x)), host);
+  MutableDHTArrayView<int64_t>(tensor.getPointer()).Fill(x);
+  results[0] =
+      MakeAvailableAsyncValueRef<DenseHostTensor>(host, std::move(*tensor));
+}
+
+class PaddedBatchDatasetTest : public ::testing::Test {
+ protected:
+  PaddedBatchDatasetTest()
+      : host_(CreateTestHostContext()),
+        i64_(host_->GetKernelRegistry().GetType("i64")),
+        tensor_(host_->GetKernelRegistry().GetType("!t.tensor")),
+        map_fn_("make_element", {i64_}, {tensor_}, MakeElement),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {}
+
+  // Returns a padded batch of the elements made from [start, stop).
+  RCReference<PaddedBatchDataset> MakeDataset(
+      int64_t start, int64_t stop, int64_t batch_size,
+      std::vector<int64_t> bucket_boundaries = {}) {
+    auto range = TakeRef(host_->Construct<RangeDataset>(
+        start, stop, 1, DType::I64, host_.get()));
+    auto map = TakeRef(host_->Construct<MapDataset>(
+        std::move(range), RCArray<AsyncValue>(ArrayRef<AsyncValue*>()),
+        FormRef(&map_fn_), /*num_parallel_calls=*/2, /*is_deterministic=*/true,
+        host_.get()));
+    return TakeRef(host_->Construct<PaddedBatchDataset>(
+        std::move(map), batch_size, std::move(bucket_boundaries), host_.get()));
+  }
+
+  // Reads the batches until the end of iteration, checks that each batch is
+  // padded to the maximum shape of its elements, and returns the x of the
+  // elements of each batch.
+  std::vector<std::vector<int64_t>> Read(Dataset* dataset) {
+    auto iterator = dataset->MakeIterator(IteratorContext());
+    std::vector<std::vector<int64_t>> batches;
+    while (true) {
+      auto result = iterator->GetNext(exec_ctx_);
+      AwaitResult(host_.get(), result);
+      EXPECT_FALSE(result.eof.IsError());
+      if (result.eof.IsError() || result.eof.get()) break;
+      EXPECT_FALSE(result.values[0]->IsError());
+      batches.push_back(CheckBatch(result.values[0]->get<DenseHostTensor>()));
+    }
+    return batches;
+  }
+
+  // Checks the padding of `batch` and returns the x of its elements.
+  static std::vector<int64_t> CheckBatch(const DenseHostTensor& batch) {
+    SmallVector<Index, 4> dims;
+    batch.shape().GetDimensions(&dims);
+    const int64_t* data = static_cast<const int64_t*>(batch.data());
+    const Index slot_size = batch.NumElements() / dims[0];
+
+    std::vector<int64_t> elements;
+    std::vector<Index> max_shape(dims.size() - 1, 0);
+    for (Index i = 0; i < dims[0]; ++i) {
+      const int64_t* slot = data + i * slot_size;
+      const int64_t x = slot[0];
+      elements.push_back(x);
+      auto shape = ElementShape(x);
+      EXPECT_EQ(shape.size() + 1, dims.size());
+      if (shape.size() + 1 != dims.size()) break;
+      for (size_t d = 0; d < shape.size(); ++d)
+        max_shape[d] = std::max(max_shape[d], shape[d]);
+      // Check the slot by its row-major index.
+      for (Index j = 0; j < slot_size; ++j) {
+        bool in_element = true;
+        for (int d = shape.size() - 1, rest = j; d >= 0; --d) {
+          in_element &= rest % dims[d + 1] < shape[d];
+          rest /= dims[d + 1];
+        }
+        EXPECT_EQ(slot[j], in_element ? x : 0)
+            << "slot " << i << " index " << j;
+      }
+    }
+    EXPECT_EQ(max_shape, std::vector<Index>(dims.begin() + 1, dims.end()));
+    return elements;
+  }
+
+  std::unique_ptr<HostContext> host_;
+  TypeName i64_;
+  TypeName tensor_;
+  NativeFunction map_fn_;
+  ExecutionContext exec_ctx_;
+};
+
+TEST_F(PaddedBatchDatasetTest, PadToMaxShapeInBatch) {
+  auto dataset = MakeDataset(0, 10, /*batch_size=*/4);
+  EXPECT_EQ(Read(dataset.get()), std::vector<std::vector<int64_t>>(
+                                     {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9}}));
+}
+
+TEST_F(PaddedBatchDatasetTest, PadEachDimension) {
+  auto dataset = MakeDataset(-12, 0, /*batch_size=*/5);
+  EXPECT_EQ(Read(dataset.get()),
+            std::vector<std::vector<int64_t>>({{-12, -11, -10, -9, -8},
+                                               {-7, -6, -5, -4, -3},
+                                               {-2, -1}}));
+}
+
+TEST_F(PaddedBatchDatasetTest, CopyLargeBatchInParallel) {
+  auto dataset = MakeDataset(0, 5000, /*batch_size=*/2000);
+  auto batches = Read(dataset.get());
+  ASSERT_EQ(batches.size(), 3);
+  EXPECT_EQ(batches[2].size(), 1000);
+}
+
+TEST_F(PaddedBatchDatasetTest, IncompatibleRanks) {
+  auto dataset = MakeDataset(-1, 1, /*batch_size=*/2);
+  auto iterator = dataset->MakeIterator(IteratorContext());
+  auto result = iterator->GetNext(exec_ctx_);
+  AwaitResult(host_.get(), result);
+  ASSERT_TRUE(result.values[0]->IsError());
+  EXPECT_NE(StrCat(result.values[0]->GetError()).find("incompatible tensors"),
+            std::string::npos);
+}
+
+TEST_F(PaddedBatchDatasetTest, NonTensorElements) {
+  for (std::vector<int64_t> bucket_boundaries :
+       {std::vector<int64_t>{}, std::vector<int64_t>{4}}) {
+    auto range = TakeRef(
+        host_->Construct<RangeDataset>(0, 4, 1, DType::I64, host_.get()));
+    auto dataset = TakeRef(host_->Construct<PaddedBatchDataset>(
+        std::move(range), /*batch_size=*/2, std::move(bucket_boundaries),
+        host_.get()));
+    auto iterator = dataset->MakeIterator(IteratorContext());
+    auto result = iterator->GetNext(exec_ctx_);
+    AwaitResult(host_.get(), result);
+    ASSERT_TRUE(result.values[0]->IsError());
+    EXPECT_NE(StrCat(result.values[0]->GetError())
+                  .find("must be a DenseHostTensor"),
+              std::string::npos);
+  }
+}
+
+TEST_F(PaddedBatchDatasetTest, BucketByLength) {
+  // The lengths are 1 to 8, and the buckets are [0, 4) and [4, inf).
+  auto dataset = MakeDataset(0, 50, /*batch_size=*/3, {4});
+  auto batches = Read(dataset.get());
+
+  std::vector<int64_t> all_elements;
+  bool partial_batches = false;
+  for (const auto& batch : batches) {
+    const bool short_bucket = ElementShape(batch[0])[0] < 4;
+    for (int64_t x : batch) {
+      EXPECT_EQ(ElementShape(x)[0] < 4, short_bucket);
+      all_elements.push_back(x);
+    }
+    // Only the last batches of the buckets can be partial.
+    EXPECT_TRUE(!partial_batches || batch.size() < 3);
+    partial_batches |= batch.size() < 3;
+  }
+  std::sort(all_elements.begin(), all_elements.end());
+  std::vector<int64_t> expected(50);
+  for (int64_t i = 0; i < 50; ++i) expected[i] = i;
+  EXPECT_EQ(all_elements, expected);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
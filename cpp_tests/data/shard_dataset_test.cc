@@ -0,0 +1,121 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for ShardDataset.
+
+#include "../../lib/data/shard_dataset.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../../lib/data/map_dataset.h"
+#include "../../lib/data/range_dataset.h"
+#include "../../lib/data/skip_dataset.h"
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/native_function.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+constexpr int64_t kNumElements = 20;
+
+class ShardDatasetTest : public ::testing::Test {
+ protected:
+  ShardDatasetTest()
+      : host_(CreateTestHostContext()),
+        i64_(host_->GetKernelRegistry().GetType("i64")),
+        map_fn_("counted_times_two", {i64_}, {i64_}, CountedTimesTwo),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {
+    NumCountedElements() = 0;
+  }
+
+  RCReference<RangeDataset> MakeRangeDataset() {
+    return TakeRef(host_->Construct<RangeDataset>(0, kNumElements, 1,
+                                                  DType::I64, host_.get()));
+  }
+
+  RCReference<MapDataset> MakeMapDataset(int64_t num_parallel_calls) {
+    return TakeRef(host_->Construct<MapDataset>(
+        MakeRangeDataset(), RCArray<AsyncValue>(ArrayRef<AsyncValue*>()),
+        FormRef(&map_fn_), num_parallel_calls, /*is_deterministic=*/true,
+        host_.get()));
+  }
+
+  RCReference<ShardDataset> MakeShardDataset(RCReference<Dataset> input,
+                                             int64_t num_shards,
+                                             int64_t index) {
+    return TakeRef(host_->Construct<ShardDataset>(std::move(input), num_shards,
+                                                  index, host_.get()));
+  }
+
+  std::unique_ptr<HostContext> host_;
+  TypeName i64_;
+  NativeFunction map_fn_;
+  ExecutionContext exec_ctx_;
+};
+
+// Returns the elements `factor * i` for i in [index, kNumElements) with a
+// stride of `num_shards`.
+std::vector<int64_t> ExpectedElements(int64_t num_shards, int64_t index,
+                                      int64_t factor = 1) {
+  std::vector<int64_t> expected;
+  for (int64_t i = index; i < kNumElements; i += num_shards)
+    expected.push_back(factor * i);
+  return expected;
+}
+
+TEST_F(ShardDatasetTest, ShardRange) {
+  for (int64_t num_shards : {1, 3, 7, 30}) {
+    for (int64_t index = 0; index < num_shards; ++index) {
+      auto shard = MakeShardDataset(MakeRangeDataset(), num_shards, index);
+      EXPECT_EQ(ReadAll(shard.get(), exec_ctx_),
+                ExpectedElements(num_shards, index));
+    }
+  }
+}
+
+TEST_F(ShardDatasetTest, SkippedElementsAreNotMapped) {
+  auto shard = MakeShardDataset(MakeMapDataset(/*num_parallel_calls=*/1),
+                                /*num_shards=*/4, /*index=*/1);
+  EXPECT_EQ(ReadAll(shard.get(), exec_ctx_),
+            ExpectedElements(4, 1, /*factor=*/2));
+  EXPECT_EQ(NumCountedElements(), kNumElements / 4);
+}
+
+TEST_F(ShardDatasetTest, ShardParallelMap) {
+  auto shard = MakeShardDataset(MakeMapDataset(/*num_parallel_calls=*/3),
+                                /*num_shards=*/4, /*index=*/2);
+  EXPECT_EQ(ReadAll(shard.get(), exec_ctx_),
+            ExpectedElements(4, 2, /*factor=*/2));
+}
+
+TEST_F(ShardDatasetTest, SkipShardElements) {
+  auto skip = TakeRef(host_->Construct<SkipDataset>(
+      MakeShardDataset(MakeRangeDataset(), /*num_shards=*/3, /*index=*/2),
+      /*count=*/2, host_.get()));
+  auto expected = ExpectedElements(3, 2);
+  expected.erase(expected.begin(), expected.begin() + 2);
+  EXPECT_EQ(ReadAll(skip.get(), exec_ctx_), expected);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for SnapshotDataset.
+
+#include "../../lib/data/snapshot_dataset.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../lib/data/map_dataset.h"
+#include "../../lib/data/range_dataset.h"
+#include "../../lib/data/repeat_dataset.h"
+#include "gtest/gtest.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/native_function.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+constexpr int64_t kNumElements = 10;
+
+// The number of elements produced by the input of the snapshot.
+std::atomic<int64_t> num_input_elements{0};
+
+// The element whose first value is a bool, which can not be written to a
+// snapshot, or -1.
+std::atomic<int64_t> unsupported_element{-1};
+
+// Returns the element (x, "element_x", [[x, x + 0.5]]) with a scalar, a string
+// and a tensor value. Errors, e.g. the end of iteration of the input, are
+// forwarded to the results.
+void MakeElement(AsyncValue* const* arguments, int num_arguments,
+                 RCReference<AsyncValue>* results, int num_results,
+                 HostContext* host) {
+  if (arguments[0]->IsError()) {
+    for (int i = 0; i < num_results; ++i) results[i] = FormRef(arguments[0]);
+    return;
+  }
+  num_input_elements.fetch_add(1);
+  int64_t x = arguments[0]->get<int64_t>();
+  auto dht =
+      DenseHostTensor::CreateUninitialized<float>(TensorShape({1, 2}), host);
+  MutableDHTArrayView<float> view(dht.getPointer());
+  view[0] = x;
+  view[1] = x + 0.5f;
+
+  if (x == unsupported_element) {
+    results[0] = MakeAvailableAsyncValueRef<bool>(host, true);
+  } else {
+    results[0] = MakeAvailableAsyncValueRef<int64_t>(host, x);
+  }
+  results[1] =
+      MakeAvailableAsyncValueRef<std::string>(host, StrCat("element_", x));
+  results[2] =
+      MakeAvailableAsyncValueRef<DenseHostTensor>(host, std::move(*dht));
+}
+
+class SnapshotDatasetTest : public ::testing::Test {
+ protected:
+  SnapshotDatasetTest()
+      : host_(CreateTestHostContext()),
+        map_fn_("make_element", {host_->GetKernelRegistry().GetType("i64")},
+                {host_->GetKernelRegistry().GetType("i64"),
+                 host_->GetKernelRegistry().GetType("!tfrt.string"),
+                 host_->GetKernelRegistry().GetType("!t.tensor")},
+                MakeElement),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {
+    num_input_elements = 0;
+    unsupported_element = -1;
+    llvm::SmallString<128> path;
+    EXPECT_FALSE(llvm::sys::fs::createUniqueDirectory("snapshot", path));
+    path_ = std::string(path.str());
+  }
+
+  ~SnapshotDatasetTest() override { llvm::sys::fs::remove_directories(path_); }
+
+  RCReference<SnapshotDataset> MakeSnapshotDataset(
+      int64_t num_shards, string_view fingerprint = "pipeline") {
+    auto range = TakeRef(host_->Construct<RangeDataset>(
+        0, kNumElements, 1, DType::I64, host_.get()));
+    auto map = TakeRef(host_->Construct<MapDataset>(
+        std::move(range), RCArray<AsyncValue>(ArrayRef<AsyncValue*>()),
+        FormRef(&map_fn_), host_.get()));
+    return TakeRef(host_->Construct<SnapshotDataset>(
+        std::move(map), path_, fingerprint, num_shards,
+        /*max_prefetch_num=*/4, /*prefetch_threshold=*/2, host_.get()));
+  }
+
+  // Reads all elements from `iterator` and checks their values. Returns the
+  // number of elements.
+  int64_t ReadAndCheck(Iterator* iterator) {
+    int64_t num_elements = 0;
+    while (true) {
+      auto result = iterator->GetNext(exec_ctx_);
+      AwaitResult(host_.get(), result);
+      EXPECT_FALSE(result.eof.IsError());
+      if (result.eof.IsError() || result.eof.get()) break;
+
+      const int64_t x = num_elements % kNumElements;
+      EXPECT_EQ(result.values.size(), 3);
+      EXPECT_EQ(result.values[0]->get<int64_t>(), x);
+      EXPECT_EQ(result.values[1]->get<std::string>(), StrCat("element_", x));
+      DHTArrayView<float> view(&result.values[2]->get<DenseHostTensor>());
+      EXPECT_EQ(view.NumElements(), 2);
+      EXPECT_EQ(view[0], x);
+      EXPECT_EQ(view[1], x + 0.5f);
+      ++num_elements;
+    }
+    return num_elements;
+  }
+
+  // Returns the number of files in the snapshot directory.
+  int64_t NumSnapshotFiles() {
+    int64_t num_files = 0;
+    std::error_code ec;
+    for (llvm::sys::fs::directory_iterator it(path_, ec), end;
+         !ec && it != end; it.increment(ec)) {
+      ++num_files;
+    }
+    EXPECT_FALSE(ec);
+    return num_files;
+  }
+
+  std::unique_ptr<HostContext> host_;
+  NativeFunction map_fn_;
+  ExecutionContext exec_ctx_;
+  std::string path_;
+};
+
+TEST_F(SnapshotDatasetTest, LaterRunReadsFromSnapshot) {
+  for (int64_t num_shards : {1, 3}) {
+    llvm::sys::fs::remove_directories(path_);
+    num_input_elements = 0;
+    EXPECT_EQ(ReadAndCheck(MakeSnapshotDataset(num_shards)
+                               ->MakeIterator(IteratorContext())
+                               .get()),
+              kNumElements);
+    EXPECT_EQ(num_input_elements, kNumElements);
+
+    // A new dataset with the same path, e.g. in a later run of the program,
+    // reads the elements from the snapshot.
+    EXPECT_EQ(ReadAndCheck(MakeSnapshotDataset(num_shards)
+                               ->MakeIterator(IteratorContext())
+                               .get()),
+              kNumElements);
+    EXPECT_EQ(num_input_elements, kNumElements);
+  }
+}
+
+TEST_F(SnapshotDatasetTest, RepeatReadsLaterEpochsFromSnapshot) {
+  auto repeat = TakeRef(host_->Construct<RepeatDataset>(
+      MakeSnapshotDataset(/*num_shards=*/2), /*count=*/3, host_.get()));
+  EXPECT_EQ(ReadAndCheck(repeat->MakeIterator(IteratorContext()).get()),
+            3 * kNumElements);
+  EXPECT_EQ(num_input_elements, kNumElements);
+}
+
+TEST_F(SnapshotDatasetTest, AbandonedSnapshotIsNotRead) {
+  auto snapshot = MakeSnapshotDataset(/*num_shards=*/2);
+  {
+    auto iterator = snapshot->MakeIterator(IteratorContext());
+    for (int i = 0; i < kNumElements / 2; ++i) {
+      AwaitResult(host_.get(), iterator->GetNext(exec_ctx_));
+    }
+  }
+  // Wait for the pending writes of the abandoned iterator.
+  host_->Quiesce();
+  EXPECT_EQ(ReadAndCheck(snapshot->MakeIterator(IteratorContext()).get()),
+            kNumElements);
+  EXPECT_EQ(ReadAndCheck(snapshot->MakeIterator(IteratorContext()).get()),
+            kNumElements);
+  EXPECT_EQ(num_input_elements, kNumElements / 2 + kNumElements);
+}
+
+TEST_F(SnapshotDatasetTest, SnapshotOfAnotherPipelineIsOverwritten) {
+  EXPECT_EQ(ReadAndCheck(MakeSnapshotDataset(/*num_shards=*/2, "old")
+                             ->MakeIterator(IteratorContext())
+                             .get()),
+            kNumElements);
+  EXPECT_EQ(num_input_elements, kNumElements);
+
+  // The snapshot written by the "old" pipeline is ignored and overwritten.
+  EXPECT_EQ(ReadAndCheck(MakeSnapshotDataset(/*num_shards=*/2, "new")
+                             ->MakeIterator(IteratorContext())
+                             .get()),
+            kNumElements);
+  EXPECT_EQ(num_input_elements, 2 * kNumElements);
+
+  EXPECT_EQ(ReadAndCheck(MakeSnapshotDataset(/*num_shards=*/2, "new")
+                             ->MakeIterator(IteratorContext())
+                             .get()),
+            kNumElements);
+  EXPECT_EQ(num_input_elements, 2 * kNumElements);
+}
+
+TEST_F(SnapshotDatasetTest, WriteFailureForwardsElementsAndRemovesSnapshot) {
+  unsupported_element = kNumElements / 2;
+  auto snapshot = MakeSnapshotDataset(/*num_shards=*/2);
+  for (int epoch = 1; epoch <= 2; ++epoch) {
+    auto iterator = snapshot->MakeIterator(IteratorContext());
+    int64_t num_elements = 0;
+    while (true) {
+      auto result = iterator->GetNext(exec_ctx_);
+      AwaitResult(host_.get(), result);
+      ASSERT_FALSE(result.eof.IsError());
+      if (result.eof.get()) break;
+      ++num_elements;
+    }
+    EXPECT_EQ(num_elements, kNumElements);
+    // The snapshot is not read, because writing it failed.
+    EXPECT_EQ(num_input_elements, epoch * kNumElements);
+    iterator.reset();
+    host_->Quiesce();
+    EXPECT_EQ(NumSnapshotFiles(), 0);
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
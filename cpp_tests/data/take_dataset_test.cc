@@ -0,0 +1,109 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for TakeDataset.
+
+#include "../../lib/data/take_dataset.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../../lib/data/map_dataset.h"
+#include "../../lib/data/range_dataset.h"
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/native_function.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+constexpr int64_t kNumElements = 10;
+
+class TakeDatasetTest : public ::testing::Test {
+ protected:
+  TakeDatasetTest()
+      : host_(CreateTestHostContext()),
+        i64_(host_->GetKernelRegistry().GetType("i64")),
+        map_fn_("counted_times_two", {i64_}, {i64_}, CountedTimesTwo),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {
+    NumCountedElements() = 0;
+  }
+
+  // Returns a TakeDataset of a map dataset which counts its elements.
+  RCReference<TakeDataset> MakeTakeDataset(int64_t count) {
+    auto range = TakeRef(host_->Construct<RangeDataset>(
+        0, kNumElements, 1, DType::I64, host_.get()));
+    auto map = TakeRef(host_->Construct<MapDataset>(
+        std::move(range), RCArray<AsyncValue>(ArrayRef<AsyncValue*>()),
+        FormRef(&map_fn_), host_.get()));
+    return TakeRef(host_->Construct<TakeDataset>(std::move(map), count,
+                                                 /*arity=*/1, host_.get()));
+  }
+
+  std::unique_ptr<HostContext> host_;
+  TypeName i64_;
+  NativeFunction map_fn_;
+  ExecutionContext exec_ctx_;
+};
+
+TEST_F(TakeDatasetTest, TakeFirstElements) {
+  auto take = MakeTakeDataset(/*count=*/3);
+  auto iterator = take->MakeIterator(IteratorContext());
+  EXPECT_EQ(ReadAll(iterator.get(), exec_ctx_),
+            std::vector<int64_t>({0, 2, 4}));
+  for (int i = 0; i < 2; ++i) {
+    auto result = iterator->GetNext(exec_ctx_);
+    EXPECT_TRUE(result.eof.get());
+    EXPECT_EQ(result.values.size(), 1);
+  }
+  // The input is not iterated after the taken elements.
+  EXPECT_EQ(NumCountedElements(), 3);
+}
+
+TEST_F(TakeDatasetTest, TakeMoreThanInput) {
+  for (int64_t count : {int64_t{-1}, 2 * kNumElements}) {
+    auto take = MakeTakeDataset(count);
+    auto elements = ReadAll(take.get(), exec_ctx_);
+    EXPECT_EQ(elements.size(), kNumElements);
+  }
+}
+
+TEST_F(TakeDatasetTest, TakeNothing) {
+  auto take = MakeTakeDataset(/*count=*/0);
+  auto iterator = take->MakeIterator(IteratorContext());
+  auto result = iterator->GetNext(exec_ctx_);
+  EXPECT_TRUE(result.eof.get());
+  EXPECT_EQ(result.values.size(), 1);
+  // The input is not iterated at all.
+  EXPECT_EQ(NumCountedElements(), 0);
+}
+
+TEST_F(TakeDatasetTest, SkipTakenElements) {
+  auto take = MakeTakeDataset(/*count=*/5);
+  auto iterator = take->MakeIterator(IteratorContext());
+  iterator->Skip(3, exec_ctx_);
+  EXPECT_EQ(ReadAll(iterator.get(), exec_ctx_), std::vector<int64_t>({6, 8}));
+  // The skipped elements are not mapped.
+  EXPECT_EQ(NumCountedElements(), 2);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
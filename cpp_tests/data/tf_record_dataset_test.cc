@@ -0,0 +1,410 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests and benchmarks for TFRecordDataset.
+
+#include "../../lib/data/tf_record_dataset.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../lib/data/shard_dataset.h"
+#include "../../lib/data/skip_dataset.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/crc32c.h"
+#include "tfrt/support/string_util.h"
+#include "zlib.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+using ::tfrt::io::CompressionType;
+using ::tfrt::io::ParseCompressionType;
+
+void AppendFixed32(std::string* dst, uint32_t value) {
+  for (int i = 0; i < 4; ++i) dst->push_back((value >> (8 * i)) & 0xff);
+}
+
+void AppendFixed64(std::string* dst, uint64_t value) {
+  for (int i = 0; i < 8; ++i) dst->push_back((value >> (8 * i)) & 0xff);
+}
+
+// Appends `record` to `dst` in the TFRecord format.
+void AppendRecord(std::string* dst, string_view record) {
+  std::string header;
+  AppendFixed64(&header, record.size());
+  dst->append(header);
+  AppendFixed32(dst, crc32c::Mask(crc32c::Value(header.data(), 8)));
+  dst->append(record.data(), record.size());
+  AppendFixed32(dst,
+                crc32c::Mask(crc32c::Value(record.data(), record.size())));
+}
+
+// Compresses `data` in the ZLIB or GZIP format.
+std::string Compress(string_view data, CompressionType compression_type) {
+  z_stream stream = {};
+  const int window_bits = compression_type == CompressionType::kGzip
+                              ? MAX_WBITS + 16
+                              : MAX_WBITS;
+  EXPECT_EQ(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         window_bits, /*memLevel=*/8, Z_DEFAULT_STRATEGY),
+            Z_OK);
+  std::string result(deflateBound(&stream, data.size()), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+  stream.avail_out = result.size();
+  EXPECT_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+  result.resize(stream.total_out);
+  deflateEnd(&stream);
+  return result;
+}
+
+std::string MakeRecord(int64_t index, size_t size) {
+  std::string record = StrCat("record_", index, "_");
+  record.resize(size, 'a' + index % 26);
+  return record;
+}
+
+std::string GetRecord(const AsyncValue& value, bool zero_copy) {
+  if (!zero_copy) return value.get<std::string>();
+  const auto& buffer = value.get<RCReference<HostBuffer>>();
+  return std::string(static_cast<const char*>(buffer->data()),
+                     buffer->size());
+}
+
+class TFRecordDatasetTest : public ::testing::Test {
+ protected:
+  TFRecordDatasetTest()
+      : host_(CreateTestHostContext()),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {
+    llvm::SmallString<128> path;
+    EXPECT_FALSE(llvm::sys::fs::createTemporaryFile("tf_record", "", path));
+    path_ = std::string(path.str());
+  }
+
+  ~TFRecordDatasetTest() override { llvm::sys::fs::remove(path_); }
+
+  void WriteFile(const std::string& contents) {
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+  }
+
+  RCReference<TFRecordDataset> MakeDataset(
+      int64_t buffer_size, bool zero_copy, int64_t max_read_batch_size,
+      CompressionType compression_type = CompressionType::kNone) {
+    return TakeRef(host_->Construct<TFRecordDataset>(
+        path_, buffer_size, /*max_prefetch_num=*/8, /*prefetch_threshold=*/2,
+        zero_copy, max_read_batch_size, compression_type, host_.get()));
+  }
+
+  // Reads the records until the end of iteration or an error, which is
+  // returned in `error`.
+  std::vector<std::string> Read(Dataset* dataset, bool zero_copy,
+                                std::string* error = nullptr) {
+    auto iterator = dataset->MakeIterator(IteratorContext());
+    std::vector<std::string> records;
+    while (true) {
+      auto result = iterator->GetNext(exec_ctx_);
+      AwaitResult(host_.get(), result);
+      if (result.eof.IsError()) {
+        if (error) *error = StrCat(result.eof.GetError());
+        break;
+      }
+      if (result.eof.get()) break;
+      records.push_back(GetRecord(*result.values[0], zero_copy));
+    }
+    return records;
+  }
+
+  std::unique_ptr<HostContext> host_;
+  ExecutionContext exec_ctx_;
+  std::string path_;
+};
+
+TEST_F(TFRecordDatasetTest, ReadRecords) {
+  std::vector<std::string> expected;
+  std::string contents;
+  for (int64_t i = 0; i < 100; ++i) {
+    expected.push_back(MakeRecord(i, 10 + i % 50));
+    AppendRecord(&contents, expected.back());
+  }
+  AppendRecord(&contents, "");
+  expected.push_back("");
+  WriteFile(contents);
+
+  for (bool zero_copy : {false, true}) {
+    for (int64_t max_read_batch_size : {1, 16}) {
+      auto dataset = MakeDataset(/*buffer_size=*/256, zero_copy,
+                                 max_read_batch_size);
+      EXPECT_EQ(Read(dataset.get(), zero_copy), expected);
+    }
+  }
+}
+
+TEST_F(TFRecordDatasetTest, ZeroCopyRecordLargerThanChunk) {
+  std::vector<std::string> expected = {MakeRecord(0, 10), MakeRecord(1, 1000),
+                                       MakeRecord(2, 10)};
+  std::string contents;
+  for (const auto& record : expected) AppendRecord(&contents, record);
+  WriteFile(contents);
+
+  for (int64_t buffer_size : {0, 64}) {
+    auto dataset = MakeDataset(buffer_size, /*zero_copy=*/true,
+                               /*max_read_batch_size=*/4);
+    EXPECT_EQ(Read(dataset.get(), /*zero_copy=*/true), expected);
+  }
+}
+
+TEST_F(TFRecordDatasetTest, DetectsCorruption) {
+  std::string contents;
+  AppendRecord(&contents, MakeRecord(0, 20));
+  const size_t second_record_pos = contents.size();
+  AppendRecord(&contents, MakeRecord(1, 20));
+  // Flip a byte in the body of the second record.
+  contents[second_record_pos + 12 + 5] ^= 1;
+  WriteFile(contents);
+
+  for (bool zero_copy : {false, true}) {
+    auto dataset = MakeDataset(/*buffer_size=*/256, zero_copy,
+                               /*max_read_batch_size=*/8);
+    std::string error;
+    EXPECT_EQ(Read(dataset.get(), zero_copy, &error).size(), 1);
+    EXPECT_NE(error.find(StrCat("data corruption at position ",
+                                second_record_pos)),
+              std::string::npos)
+        << error;
+  }
+}
+
+TEST_F(TFRecordDatasetTest, DetectsTruncatedRecord) {
+  std::string contents;
+  AppendRecord(&contents, MakeRecord(0, 20));
+  AppendRecord(&contents, MakeRecord(1, 20));
+  contents.resize(contents.size() - 3);
+  WriteFile(contents);
+
+  for (bool zero_copy : {false, true}) {
+    auto dataset = MakeDataset(/*buffer_size=*/256, zero_copy,
+                               /*max_read_batch_size=*/8);
+    std::string error;
+    EXPECT_EQ(Read(dataset.get(), zero_copy, &error).size(), 1);
+    EXPECT_NE(error.find("truncated record"), std::string::npos) << error;
+  }
+}
+
+TEST_F(TFRecordDatasetTest, DetectsTruncatedRecordWhenSkipping) {
+  std::string contents;
+  for (int64_t i = 0; i < 3; ++i) AppendRecord(&contents, MakeRecord(i, 20));
+  contents.resize(contents.size() - 3);
+  WriteFile(contents);
+
+  for (bool zero_copy : {false, true}) {
+    auto skip = TakeRef(host_->Construct<SkipDataset>(
+        MakeDataset(/*buffer_size=*/256, zero_copy, /*max_read_batch_size=*/8),
+        /*count=*/5, host_.get()));
+    std::string error;
+    EXPECT_TRUE(Read(skip.get(), zero_copy, &error).empty());
+    EXPECT_NE(error.find("truncated record"), std::string::npos) << error;
+  }
+}
+
+TEST_F(TFRecordDatasetTest, ReadCompressedRecords) {
+  std::vector<std::string> expected;
+  std::string contents;
+  for (int64_t i = 0; i < 100; ++i) {
+    expected.push_back(MakeRecord(i, 10 + i % 50));
+    AppendRecord(&contents, expected.back());
+  }
+
+  for (auto compression_type :
+       {CompressionType::kZlib, CompressionType::kGzip}) {
+    // Split the file into two compressed streams, e.g. concatenated GZIP
+    // members.
+    const size_t half = contents.size() / 2;
+    WriteFile(Compress(string_view(contents).substr(0, half),
+                       compression_type) +
+              Compress(string_view(contents).substr(half), compression_type));
+    for (bool zero_copy : {false, true}) {
+      for (int64_t buffer_size : {0, 64}) {
+        auto dataset = MakeDataset(buffer_size, zero_copy,
+                                   /*max_read_batch_size=*/8, compression_type);
+        EXPECT_EQ(Read(dataset.get(), zero_copy), expected);
+      }
+    }
+  }
+}
+
+TEST_F(TFRecordDatasetTest, ShardAndSkipRecords) {
+  std::vector<std::string> records;
+  std::string contents;
+  for (int64_t i = 0; i < 300; ++i) {
+    records.push_back(MakeRecord(i, 10 + i % 150));
+    AppendRecord(&contents, records.back());
+  }
+
+  for (auto compression_type :
+       {CompressionType::kNone, CompressionType::kGzip}) {
+    WriteFile(compression_type == CompressionType::kNone
+                  ? contents
+                  : Compress(contents, compression_type));
+    for (bool zero_copy : {false, true}) {
+      for (int64_t buffer_size : {0, 64}) {
+        for (int64_t index : {0, 3}) {
+          std::vector<std::string> expected;
+          for (size_t i = index; i < records.size(); i += 4)
+            expected.push_back(records[i]);
+          auto shard = TakeRef(host_->Construct<ShardDataset>(
+              MakeDataset(buffer_size, zero_copy, /*max_read_batch_size=*/8,
+                          compression_type),
+              /*num_shards=*/4, index, host_.get()));
+          EXPECT_EQ(Read(shard.get(), zero_copy), expected);
+        }
+
+        auto skip = TakeRef(host_->Construct<SkipDataset>(
+            MakeDataset(buffer_size, zero_copy, /*max_read_batch_size=*/8,
+                        compression_type),
+            /*count=*/250, host_.get()));
+        EXPECT_EQ(Read(skip.get(), zero_copy),
+                  std::vector<std::string>(records.begin() + 250,
+                                           records.end()));
+      }
+    }
+  }
+}
+
+TEST_F(TFRecordDatasetTest, DetectsTruncatedCompressedStream) {
+  std::string contents;
+  for (int64_t i = 0; i < 100; ++i) AppendRecord(&contents, MakeRecord(i, 50));
+  auto compressed = Compress(contents, CompressionType::kGzip);
+  compressed.resize(compressed.size() - 20);
+  WriteFile(compressed);
+
+  for (bool zero_copy : {false, true}) {
+    auto dataset =
+        MakeDataset(/*buffer_size=*/256, zero_copy, /*max_read_batch_size=*/8,
+                    CompressionType::kGzip);
+    std::string error;
+    EXPECT_LT(Read(dataset.get(), zero_copy, &error).size(), 100);
+    EXPECT_FALSE(error.empty());
+  }
+}
+
+TEST_F(TFRecordDatasetTest, ParseCompressionType) {
+  EXPECT_EQ(*ParseCompressionType(""), CompressionType::kNone);
+  EXPECT_EQ(*ParseCompressionType("ZLIB"), CompressionType::kZlib);
+  EXPECT_EQ(*ParseCompressionType("GZIP"), CompressionType::kGzip);
+  auto error = ParseCompressionType("LZ4");
+  EXPECT_FALSE(static_cast<bool>(error));
+  llvm::consumeError(error.takeError());
+}
+
+// -------------------------------------------------------------------------- //
+// Performance benchmarks.
+// -------------------------------------------------------------------------- //
+
+constexpr size_t kBenchmarkRecordSize = 100;
+
+// Writes a synthetic TFRecord file with `file_mb` MB of records of
+// `kBenchmarkRecordSize` bytes to a new temporary file, and returns its path.
+// Returns an empty path if the file cannot be written completely.
+std::string WriteBenchmarkFile(int64_t file_mb) {
+  llvm::SmallString<128> path;
+  if (llvm::sys::fs::createTemporaryFile("tf_record_benchmark", "", path))
+    return "";
+
+  std::string chunk;
+  for (int64_t i = 0; chunk.size() < (1 << 20); ++i) {
+    AppendRecord(&chunk, MakeRecord(i, kBenchmarkRecordSize));
+  }
+  {
+    std::ofstream file(std::string(path.str()),
+                       std::ios::binary | std::ios::trunc);
+    for (int64_t i = 0; i < file_mb; ++i)
+      file.write(chunk.data(), chunk.size());
+  }
+
+  uint64_t size = 0;
+  if (llvm::sys::fs::file_size(path, size) || size != file_mb * chunk.size()) {
+    llvm::sys::fs::remove(path);
+    return "";
+  }
+  return std::string(path.str());
+}
+
+// Reads a `state.range(0)` MB file. If `state.range(1)` is 0, the records are
+// read into strings. Otherwise, they are read without copying, in batches of
+// `state.range(1)` records.
+void BM_TFRecordDataset(benchmark::State& state) {
+  const std::string path = WriteBenchmarkFile(state.range(0));
+  if (path.empty()) {
+    state.SkipWithError("failed to write the benchmark file");
+    return;
+  }
+  const bool zero_copy = state.range(1) > 0;
+  auto host = CreateTestHostContext(4);
+  auto exec_ctx = CreateTestExecutionContext(host.get());
+
+  int64_t num_records = 0;
+  int64_t num_bytes = 0;
+  for (auto _ : state) {
+    auto dataset = TakeRef(host->Construct<TFRecordDataset>(
+        path, /*buffer_size=*/256 * 1024, /*max_prefetch_num=*/1024,
+        /*prefetch_threshold=*/256, zero_copy,
+        std::max<int64_t>(1, state.range(1)), CompressionType::kNone,
+        host.get()));
+    auto iterator = dataset->MakeIterator(IteratorContext());
+    while (true) {
+      auto result = iterator->GetNext(exec_ctx);
+      AwaitResult(host.get(), result);
+      if (result.eof.IsError() || result.eof.get()) break;
+      ++num_records;
+      num_bytes += kBenchmarkRecordSize;
+    }
+  }
+
+  state.SetItemsProcessed(num_records);
+  state.SetBytesProcessed(num_bytes);
+  llvm::sys::fs::remove(path);
+}
+
+BENCHMARK(BM_TFRecordDataset)
+    ->Args({64, 0})
+    ->Args({64, 1})
+    ->Args({64, 64})
+    ->Args({2048, 0})
+    ->Args({2048, 1})
+    ->Args({2048, 64})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for ZipDataset.
+
+#include "../../lib/data/zip_dataset.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../../lib/data/range_dataset.h"
+#include "../../lib/data/skip_dataset.h"
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/data/test_util.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace data {
+namespace {
+
+class ZipDatasetTest : public ::testing::Test {
+ protected:
+  ZipDatasetTest()
+      : host_(CreateTestHostContext()),
+        exec_ctx_(CreateTestExecutionContext(host_.get())) {}
+
+  RCReference<RangeDataset> MakeRangeDataset(int64_t start, int64_t stop) {
+    return TakeRef(host_->Construct<RangeDataset>(start, stop, 1, DType::I64,
+                                                  host_.get()));
+  }
+
+  RCReference<ZipDataset> MakeZipDataset(
+      SmallVector<RCReference<Dataset>, 4> inputs) {
+    return TakeRef(
+        host_->Construct<ZipDataset>(std::move(inputs), host_.get()));
+  }
+
+  // Reads the elements of `dataset` until the end of iteration or an error.
+  std::vector<std::vector<int64_t>> Read(Dataset* dataset) {
+    auto iterator = dataset->MakeIterator(IteratorContext());
+    std::vector<std::vector<int64_t>> elements;
+    while (true) {
+      auto result = iterator->GetNext(exec_ctx_);
+      AwaitResult(host_.get(), result);
+      EXPECT_FALSE(result.eof.IsError());
+      if (result.eof.IsError() || result.eof.get()) break;
+      std::vector<int64_t> element;
+      for (auto& value : result.values)
+        element.push_back(value->get<int64_t>());
+      elements.push_back(std::move(element));
+    }
+    return elements;
+  }
+
+  std::unique_ptr<HostContext> host_;
+  ExecutionContext exec_ctx_;
+};
+
+TEST_F(ZipDatasetTest, ZipUntilShortestInputEnds) {
+  auto zip = MakeZipDataset(
+      {MakeRangeDataset(0, 10), MakeRangeDataset(100, 105),
+       MakeRangeDataset(200, 208)});
+  std::vector<std::vector<int64_t>> expected;
+  for (int64_t i = 0; i < 5; ++i) expected.push_back({i, 100 + i, 200 + i});
+  EXPECT_EQ(Read(zip.get()), expected);
+}
+
+TEST_F(ZipDatasetTest, DoesNotWaitForInputElements) {
+  std::vector<IterationResult> pending;
+  auto zip = MakeZipDataset(
+      {TakeRef(new PendingDataset(/*num_elements=*/2, &pending)),
+       MakeRangeDataset(100, 110)});
+  auto iterator = zip->MakeIterator(IteratorContext());
+
+  auto first = iterator->GetNext(exec_ctx_);
+  auto second = iterator->GetNext(exec_ctx_);
+  ASSERT_EQ(pending.size(), 2);
+  EXPECT_FALSE(first.eof.IsAvailable());
+  EXPECT_FALSE(first.values[0]->IsAvailable());
+
+  // Resolve the elements of the pending input out of order.
+  for (int64_t i : {1, 0}) {
+    pending[i].values[0]->emplace<int64_t>(i);
+    pending[i].eof.emplace(false);
+  }
+  for (auto* result : {&first, &second}) AwaitResult(host_.get(), *result);
+  EXPECT_FALSE(first.eof.get());
+  EXPECT_EQ(first.values[0]->get<int64_t>(), 0);
+  EXPECT_EQ(first.values[1]->get<int64_t>(), 100);
+  EXPECT_FALSE(second.eof.get());
+  EXPECT_EQ(second.values[0]->get<int64_t>(), 1);
+  EXPECT_EQ(second.values[1]->get<int64_t>(), 101);
+
+  auto end = iterator->GetNext(exec_ctx_);
+  AwaitResult(host_.get(), end);
+  EXPECT_TRUE(end.eof.get());
+}
+
+TEST_F(ZipDatasetTest, SkipElements) {
+  auto skip = TakeRef(host_->Construct<SkipDataset>(
+      MakeZipDataset({MakeRangeDataset(0, 10), MakeRangeDataset(100, 110)}),
+      /*count=*/7, host_.get()));
+  EXPECT_EQ(Read(skip.get()),
+            std::vector<std::vector<int64_t>>(
+                {{7, 107}, {8, 108}, {9, 109}}));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tfrt
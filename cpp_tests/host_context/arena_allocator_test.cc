@@ -0,0 +1,115 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for TFRT ArenaAllocator.
+
+#include "tfrt/host_context/arena_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/profiled_allocator.h"
+
+namespace tfrt {
+namespace {
+
+bool IsAligned(void* ptr, size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+TEST(ArenaAllocatorTest, AllocateWithAlignment) {
+  auto fallback = CreateMallocAllocator();
+  ArenaAllocator arena(fallback.get(), /*block_size=*/1024,
+                       /*max_allocation_size=*/512);
+
+  for (size_t alignment : {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024}) {
+    void* buffer = arena.AllocateBytes(100, alignment);
+    ASSERT_NE(nullptr, buffer);
+    EXPECT_TRUE(IsAligned(buffer, alignment));
+    memset(buffer, 0, 100);
+    arena.DeallocateBytes(buffer, 100);
+  }
+}
+
+TEST(ArenaAllocatorTest, BumpAllocation) {
+  auto fallback = CreateMallocAllocator();
+  ArenaAllocator arena(fallback.get(), /*block_size=*/4096,
+                       /*max_allocation_size=*/1024);
+
+  char* first = static_cast<char*>(arena.AllocateBytes(16, 16));
+  char* second = static_cast<char*>(arena.AllocateBytes(16, 16));
+  EXPECT_EQ(first + 16, second);
+  EXPECT_EQ(arena.GetNumBlockBytes(), 4096);
+
+  // Allocate enough memory to require a second block.
+  for (int i = 0; i < 4; ++i) arena.AllocateBytes(1024, 8);
+  EXPECT_EQ(arena.GetNumBlockBytes(), 2 * 4096);
+}
+
+TEST(ArenaAllocatorTest, LargeAllocationsUseFallback) {
+  // The leak check allocator exits the process if the arena does not return
+  // all of the blocks and large allocations to the fallback allocator.
+  auto fallback = CreateLeakCheckAllocator(CreateMallocAllocator());
+  {
+    ArenaAllocator arena(fallback.get(), /*block_size=*/1024,
+                         /*max_allocation_size=*/256);
+
+    void* large = arena.AllocateBytes(10000, 64);
+    ASSERT_NE(nullptr, large);
+    memset(large, 0, 10000);
+    EXPECT_EQ(arena.GetNumBlockBytes(), 0);
+    arena.DeallocateBytes(large, 10000);
+
+    for (int i = 0; i < 100; ++i) arena.AllocateBytes(200, 8);
+    EXPECT_GT(arena.GetNumBlockBytes(), 0);
+  }
+}
+
+TEST(ArenaAllocatorTest, ConcurrentAllocations) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumAllocations = 1000;
+
+  auto fallback = CreateMallocAllocator();
+  ArenaAllocator arena(fallback.get(), /*block_size=*/4096,
+                       /*max_allocation_size=*/256);
+
+  std::vector<std::vector<uint64_t*>> allocations(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumAllocations; ++i) {
+        uint64_t* ptr = arena.Allocate<uint64_t>(4);
+        for (int j = 0; j < 4; ++j) ptr[j] = t * kNumAllocations + i;
+        allocations[t].push_back(ptr);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // Allocations must not overlap.
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (int i = 0; i < kNumAllocations; ++i) {
+      for (int j = 0; j < 4; ++j)
+        ASSERT_EQ(allocations[t][i][j], t * kNumAllocations + i);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tfrt
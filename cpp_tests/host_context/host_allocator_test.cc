@@ -14,13 +14,19 @@
  * limitations under the License.
  */
 
-// Unit tests for TFRT HostAllocator and HostArray classes.
+// Unit tests and benchmarks for TFRT HostAllocator and HostArray classes.
 
 #include "tfrt/host_context/host_allocator.h"
 
 #include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
+#include "tfrt/host_context/thread_caching_allocator.h"
 
 namespace tfrt {
 namespace {
@@ -53,6 +59,112 @@ TEST_F(HostAllocatorTest, AllocateDeallocate) {
   allocator_->Deallocate<uint64_t>(entries, kTestAllocateEntryCount);
 }
 
+// Tests for ThreadCachingAllocator class.
+class ThreadCachingAllocatorTest : public ::testing::Test {
+ protected:
+  ThreadCachingAllocatorTest() : allocator_(CreateThreadCachingAllocator()) {}
+
+  const ThreadCachingAllocator::SizeClassStats& GetStats(size_t block_size) {
+    stats_ = allocator_->GetSizeClassStats();
+    for (const auto& stats : stats_)
+      if (stats.block_size == block_size) return stats;
+    ADD_FAILURE() << "Unknown size class " << block_size;
+    return stats_.front();
+  }
+
+  std::unique_ptr<ThreadCachingAllocator> allocator_;
+  std::vector<ThreadCachingAllocator::SizeClassStats> stats_;
+};
+
+TEST_F(ThreadCachingAllocatorTest, AllocateDeallocateBytesWithAlignment) {
+  auto is_aligned = [](void* ptr, size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+  };
+
+  for (size_t size : {1, 8, 24, 40, 100, 1000, 4096, 10000}) {
+    for (size_t alignment : {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024}) {
+      void* buffer = allocator_->AllocateBytes(size, alignment);
+      ASSERT_NE(nullptr, buffer);
+      EXPECT_TRUE(is_aligned(buffer, alignment));
+      memset(buffer, 0, size);
+      allocator_->DeallocateBytes(buffer, size);
+    }
+  }
+}
+
+TEST_F(ThreadCachingAllocatorTest, ReusesFreedBlocks) {
+  void* first = allocator_->AllocateBytes(40, 8);
+  allocator_->DeallocateBytes(first, 40);
+  void* second = allocator_->AllocateBytes(48, 8);
+  EXPECT_EQ(first, second);
+  allocator_->DeallocateBytes(second, 48);
+
+  const auto& stats = GetStats(48);
+  EXPECT_EQ(stats.num_allocations, 2);
+  EXPECT_EQ(stats.num_deallocations, 2);
+  EXPECT_EQ(stats.num_chunks, 1);
+  EXPECT_EQ(allocator_->GetNumLargeAllocations(), 0);
+}
+
+TEST_F(ThreadCachingAllocatorTest, LargeAllocations) {
+  void* buffer = allocator_->AllocateBytes(1 << 20, 64);
+  ASSERT_NE(nullptr, buffer);
+  memset(buffer, 0, 1 << 20);
+  allocator_->DeallocateBytes(buffer, 1 << 20);
+  EXPECT_EQ(allocator_->GetNumLargeAllocations(), 1);
+}
+
+TEST_F(ThreadCachingAllocatorTest, NoOverlappingBlocks) {
+  constexpr int kNumBlocks = 10000;
+
+  std::vector<uint64_t*> blocks;
+  for (int i = 0; i < kNumBlocks; ++i) {
+    uint64_t* block = allocator_->Allocate<uint64_t>(2);
+    block[0] = block[1] = i;
+    blocks.push_back(block);
+  }
+
+  std::set<uint64_t*> unique_blocks(blocks.begin(), blocks.end());
+  EXPECT_EQ(unique_blocks.size(), kNumBlocks);
+
+  for (int i = 0; i < kNumBlocks; ++i) {
+    EXPECT_EQ(blocks[i][0], i);
+    EXPECT_EQ(blocks[i][1], i);
+    allocator_->Deallocate<uint64_t>(blocks[i], 2);
+  }
+}
+
+TEST_F(ThreadCachingAllocatorTest, DeallocateInAnotherThread) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumBlocks = 1000;
+
+  // Every thread allocates blocks that are freed by the next thread.
+  std::vector<std::vector<void*>> blocks(kNumThreads);
+  for (int round = 0; round < 10; ++round) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (void* block : blocks[t]) allocator_->DeallocateBytes(block, 64);
+        blocks[t].clear();
+        auto& next = blocks[(t + 1) % kNumThreads];
+        for (int i = 0; i < kNumBlocks; ++i) {
+          void* block = allocator_->AllocateBytes(64, 16);
+          memset(block, t, 64);
+          next.push_back(block);
+        }
+      });
+      threads.back().join();
+    }
+  }
+  for (auto& thread_blocks : blocks)
+    for (void* block : thread_blocks) allocator_->DeallocateBytes(block, 64);
+
+  const auto& stats = GetStats(64);
+  EXPECT_EQ(stats.num_allocations, stats.num_deallocations);
+  EXPECT_GT(stats.num_batches_from_pool, 0);
+  EXPECT_GT(stats.num_batches_to_pool, 0);
+}
+
 // Tests for HostArray class.
 constexpr size_t kTestArraySize = 16;
 class HostArrayTest : public ::testing::Test {
@@ -94,5 +206,48 @@ TEST_F(HostArrayTest, Move) {
   EXPECT_EQ(0, host_array_.size());
 }
 
+// -------------------------------------------------------------------------- //
+// Performance benchmarks.
+// -------------------------------------------------------------------------- //
+
+// Allocates and deallocates `state.range(0)` blocks of `state.range(1)` bytes.
+void AllocateDeallocate(HostAllocator* allocator, benchmark::State& state) {
+  const int num_blocks = state.range(0);
+  const size_t size = state.range(1);
+
+  std::vector<void*> blocks(num_blocks);
+  for (auto _ : state) {
+    for (int i = 0; i < num_blocks; ++i)
+      blocks[i] = allocator->AllocateBytes(size, alignof(std::max_align_t));
+    for (int i = 0; i < num_blocks; ++i)
+      allocator->DeallocateBytes(blocks[i], size);
+  }
+
+  state.SetItemsProcessed(num_blocks * state.iterations());
+}
+
+std::unique_ptr<HostAllocator> malloc_allocator = CreateMallocAllocator();
+std::unique_ptr<HostAllocator> thread_caching_allocator =
+    CreateThreadCachingAllocator();
+
+void BM_MallocAllocator(benchmark::State& state) {
+  AllocateDeallocate(malloc_allocator.get(), state);
+}
+
+void BM_ThreadCachingAllocator(benchmark::State& state) {
+  AllocateDeallocate(thread_caching_allocator.get(), state);
+}
+
+BENCHMARK(BM_MallocAllocator)
+    ->ArgPair(100, 64)
+    ->ArgPair(100, 1024)
+    ->Threads(1)
+    ->Threads(8);
+BENCHMARK(BM_ThreadCachingAllocator)
+    ->ArgPair(100, 64)
+    ->ArgPair(100, 1024)
+    ->Threads(1)
+    ->Threads(8);
+
 }  // namespace
 }  // namespace tfrt
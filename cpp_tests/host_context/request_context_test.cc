@@ -16,6 +16,8 @@
 
 // Unit test for TFRT RequestContext.
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "tfrt/host_context/concurrent_work_queue.h"
 #include "tfrt/host_context/execution_context.h"
@@ -60,5 +62,31 @@ TEST(RequestContextTest, ContextData) {
   EXPECT_EQ(expected_request_context.get()->GetDataIfExists<int>(), nullptr);
 }
 
+TEST(RequestContextTest, Allocator) {
+  auto host = CreateTestHostContext();
+  ResourceContext resource_context;
+
+  auto default_request_context =
+      RequestContextBuilder(host.get(), &resource_context).build();
+  ASSERT_FALSE(!default_request_context);
+  EXPECT_EQ(default_request_context.get()->allocator(), host->allocator());
+
+  RequestOptions request_options;
+  request_options.enable_arena = true;
+  auto arena_request_context =
+      RequestContextBuilder(host.get(), &resource_context)
+          .set_request_options(request_options)
+          .build();
+  ASSERT_FALSE(!arena_request_context);
+
+  HostAllocator* allocator = arena_request_context.get()->allocator();
+  EXPECT_NE(allocator, host->allocator());
+
+  // Memory allocated from the arena is released with the request context.
+  void* ptr = allocator->AllocateBytes(64, 8);
+  ASSERT_NE(ptr, nullptr);
+  memset(ptr, 0, 64);
+}
+
 }  // namespace
 }  // namespace tfrt
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file defines utilities shared by the unit tests of the data library.
+#ifndef TFRT_CPP_TESTS_DATA_TEST_UTIL_H_
+#define TFRT_CPP_TESTS_DATA_TEST_UTIL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tfrt/data/dataset.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace data {
+
+// Returns a HostContext with `num_threads` worker threads, which ignores the
+// diagnostics of the errors returned by the datasets under test.
+inline std::unique_ptr<HostContext> CreateTestHostContext(int num_threads = 2) {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(num_threads, num_threads));
+}
+
+inline ExecutionContext CreateTestExecutionContext(HostContext* host) {
+  return ExecutionContext(std::move(
+      *RequestContextBuilder(host, /*resource_context=*/nullptr).build()));
+}
+
+// Blocks until the values and the eof of `result` are available.
+inline void AwaitResult(HostContext* host, const IterationResult& result) {
+  SmallVector<RCReference<AsyncValue>, 4> values(result.values.begin(),
+                                                 result.values.end());
+  values.push_back(result.eof.CopyRCRef());
+  host->Await(values);
+}
+
+// Reads up to `max_elements` elements from `iterator`, or until the end of
+// iteration or an error, and returns the first value of each element.
+inline std::vector<int64_t> ReadAll(Iterator* iterator,
+                                    const ExecutionContext& exec_ctx,
+                                    int64_t max_elements = INT64_MAX) {
+  std::vector<int64_t> elements;
+  while (static_cast<int64_t>(elements.size()) < max_elements) {
+    auto result = iterator->GetNext(exec_ctx);
+    AwaitResult(exec_ctx.host(), result);
+    EXPECT_FALSE(result.eof.IsError());
+    if (result.eof.IsError() || result.eof.get()) break;
+    elements.push_back(result.values[0]->get<int64_t>());
+  }
+  return elements;
+}
+
+// Reads all elements of a new iterator of `dataset` like above.
+inline std::vector<int64_t> ReadAll(Dataset* dataset,
+                                    const ExecutionContext& exec_ctx) {
+  return ReadAll(dataset->MakeIterator(IteratorContext()).get(), exec_ctx);
+}
+
+// Returns the number of elements produced by CountedTimesTwo(). Tests reset it
+// when they start.
+inline std::atomic<int64_t>& NumCountedElements() {
+  static std::atomic<int64_t> num_counted_elements{0};
+  return num_counted_elements;
+}
+
+// Returns 2 * x, and counts the produced elements. Errors, e.g. the end of
+// iteration of the input, are forwarded to the result.
+inline void CountedTimesTwo(AsyncValue* const* arguments, int num_arguments,
+                            RCReference<AsyncValue>* results, int num_results,
+                            HostContext* host) {
+  if (arguments[0]->IsError()) {
+    results[0] = FormRef(arguments[0]);
+    return;
+  }
+  NumCountedElements().fetch_add(1);
+  int64_t x = arguments[0]->get<int64_t>();
+  results[0] = MakeAvailableAsyncValueRef<int64_t>(host, 2 * x);
+}
+
+// PendingDataset yields `num_elements` elements with one int64_t value, whose
+// value and eof are not available when GetNext() returns, followed by the end
+// of iteration. The test resolves them through `pending`.
+class PendingDataset : public Dataset {
+ public:
+  PendingDataset(int64_t num_elements, std::vector<IterationResult>* pending)
+      : num_elements_(num_elements), pending_(pending) {}
+
+  RCReference<Iterator> MakeIterator(const IteratorContext& context) override {
+    return TakeRef(new PendingIterator(FormRef(this)));
+  }
+
+ private:
+  class PendingIterator : public Iterator {
+   public:
+    explicit PendingIterator(RCReference<PendingDataset> dataset)
+        : dataset_(std::move(dataset)) {}
+
+    IterationResult GetNext(const ExecutionContext& exec_ctx) override {
+      auto* host = exec_ctx.host();
+      if (next_++ >= dataset_->num_elements_)
+        return IterationResult::Eof(host, 1);
+      SmallVector<RCReference<AsyncValue>, 4> values;
+      values.push_back(MakeUnconstructedAsyncValueRef<int64_t>(host));
+      auto result = IterationResult::Pending(
+          std::move(values), MakeUnconstructedAsyncValueRef<bool>(host));
+      dataset_->pending_->push_back(result.CopyRef());
+      return result;
+    }
+
+   private:
+    void Destroy() override { delete this; }
+
+    RCReference<PendingDataset> dataset_;
+    int64_t next_ = 0;
+  };
+
+  void Destroy() override { delete this; }
+
+  const int64_t num_elements_;
+  std::vector<IterationResult>* pending_;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_CPP_TESTS_DATA_TEST_UTIL_H_
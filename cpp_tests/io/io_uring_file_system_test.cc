@@ -0,0 +1,170 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Unit tests for IoUringFileSystem.
+
+#include "../../lib/io/io_uring_file_system.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace io {
+namespace {
+
+constexpr size_t kFileSize = 1 << 20;
+
+class IoUringFileSystemTest : public ::testing::Test {
+ protected:
+  IoUringFileSystemTest()
+      : host_([](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+              CreateMultiThreadedWorkQueue(2, 2)) {
+    llvm::SmallString<128> path;
+    EXPECT_FALSE(llvm::sys::fs::createTemporaryFile("io_uring", "", path));
+    path_ = std::string(path.str());
+
+    contents_.resize(kFileSize);
+    for (size_t i = 0; i < kFileSize; ++i) contents_[i] = (i * 7 + i / 13);
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    file.write(contents_.data(), contents_.size());
+  }
+
+  ~IoUringFileSystemTest() override { llvm::sys::fs::remove(path_); }
+
+  HostContext host_;
+  std::string path_;
+  std::string contents_;
+};
+
+TEST_F(IoUringFileSystemTest, ConcurrentReads) {
+  IoUringFileSystem file_system(/*max_in_flight=*/64);
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_FALSE(file_system.NewRandomAccessFile(path_, &file));
+  if (!file_system.GetRing()) {
+    // The reads below fall back to pread.
+    std::cerr << "io_uring is not supported by the kernel\n";
+  }
+
+  // More reads than the ring allows in flight at a time.
+  constexpr int kNumReads = 512;
+  constexpr size_t kReadSize = 4096;
+  std::vector<std::string> buffers(kNumReads, std::string(kReadSize, '\0'));
+  std::vector<RCReference<AsyncValue>> results;
+  for (int i = 0; i < kNumReads; ++i) {
+    const size_t offset = (i * 7919 * kReadSize / 3) % (kFileSize - kReadSize);
+    results.push_back(
+        file->ReadAsync(&buffers[i][0], kReadSize, offset, &host_)
+            .ReleaseRCRef());
+  }
+  host_.Await(results);
+
+  for (int i = 0; i < kNumReads; ++i) {
+    const size_t offset = (i * 7919 * kReadSize / 3) % (kFileSize - kReadSize);
+    ASSERT_FALSE(results[i]->IsError());
+    EXPECT_EQ(results[i]->get<size_t>(), kReadSize);
+    EXPECT_EQ(buffers[i], contents_.substr(offset, kReadSize));
+  }
+}
+
+TEST_F(IoUringFileSystemTest, ReadsFromResultWaiters) {
+  // The waiters run in the completion thread, whose reads must not exceed the
+  // two reads allowed in flight.
+  IoUringFileSystem file_system(/*max_in_flight=*/2);
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_FALSE(file_system.NewRandomAccessFile(path_, &file));
+
+  constexpr int kNumReads = 2;
+  constexpr int kNumNestedReads = 16;
+  constexpr size_t kReadSize = 4096;
+  auto offset = [](int i) {
+    return (i * 7919 * kReadSize / 3) % (kFileSize - kReadSize);
+  };
+  std::vector<std::string> buffers(kNumReads * (kNumNestedReads + 1),
+                                   std::string(kReadSize, '\0'));
+  std::vector<AsyncValueRef<size_t>> nested;
+  for (int i = 0; i < kNumReads * kNumNestedReads; ++i)
+    nested.push_back(MakeUnconstructedAsyncValueRef<size_t>(&host_));
+
+  std::vector<RCReference<AsyncValue>> results;
+  for (int i = 0; i < kNumReads; ++i) {
+    auto result = file->ReadAsync(&buffers[i][0], kReadSize, offset(i), &host_);
+    result.AndThen([&, i]() {
+      for (int j = kNumReads + i * kNumNestedReads;
+           j < kNumReads + (i + 1) * kNumNestedReads; ++j) {
+        auto read =
+            file->ReadAsync(&buffers[j][0], kReadSize, offset(j), &host_);
+        read.AndThen([read = read.CopyRef(),
+                      done = nested[j - kNumReads].CopyRef()]() {
+          done.emplace(read.get());
+        });
+      }
+    });
+    results.push_back(result.ReleaseRCRef());
+  }
+  for (auto& result : nested) results.push_back(result.CopyRCRef());
+  host_.Await(results);
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    ASSERT_FALSE(results[i]->IsError());
+    EXPECT_EQ(results[i]->get<size_t>(), kReadSize);
+    EXPECT_EQ(buffers[i], contents_.substr(offset(i), kReadSize));
+  }
+}
+
+TEST_F(IoUringFileSystemTest, ReadAtEndOfFile) {
+  IoUringFileSystem file_system;
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_FALSE(file_system.NewRandomAccessFile(path_, &file));
+
+  std::string buffer(100, '\0');
+  auto partial = file->ReadAsync(&buffer[0], 100, kFileSize - 10, &host_);
+  host_.Await(partial.CopyRCRef());
+  EXPECT_EQ(partial.get(), 10);
+  EXPECT_EQ(buffer.substr(0, 10), contents_.substr(kFileSize - 10));
+
+  auto eof = file->ReadAsync(&buffer[0], 100, kFileSize, &host_);
+  host_.Await(eof.CopyRCRef());
+  EXPECT_EQ(eof.get(), 0);
+}
+
+TEST_F(IoUringFileSystemTest, OpenMissingFile) {
+  IoUringFileSystem file_system;
+  std::unique_ptr<RandomAccessFile> file;
+  auto error = file_system.NewRandomAccessFile(path_ + ".missing", &file);
+  EXPECT_TRUE(static_cast<bool>(error));
+  llvm::consumeError(std::move(error));
+  EXPECT_FALSE(file);
+}
+
+TEST_F(IoUringFileSystemTest, RegisteredWithHighPriority) {
+  auto* file_system = FileSystemRegistry::Default()->Lookup("");
+  ASSERT_NE(file_system, nullptr);
+  EXPECT_EQ(file_system->GetPriority(), FileSystemPriority::kHigh);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tfrt
@@ -0,0 +1,112 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Unit tests for InProcessMetricsRegistry.
+
+#include "tfrt/metrics/in_process_metrics_registry.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace tfrt {
+namespace metrics {
+namespace {
+
+TEST(InProcessMetricsRegistryTest, Counter) {
+  InProcessMetricsRegistry registry;
+  Counter* counter = registry.NewCounter("/test/counter");
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j) counter->Increment();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // Metrics with the same name are shared.
+  EXPECT_EQ(registry.NewCounter("/test/counter"), counter);
+  counter->IncrementBy(5);
+
+  EXPECT_EQ(registry.GetSnapshot().counters["/test/counter"], 8005);
+}
+
+TEST(InProcessMetricsRegistryTest, Gauges) {
+  InProcessMetricsRegistry registry;
+  registry.NewIntGauge("/test/int")->Set(42);
+  registry.NewStringGauge("/test/string")->Set("value");
+
+  auto snapshot = registry.GetSnapshot();
+  EXPECT_EQ(snapshot.int_gauges["/test/int"], 42);
+  EXPECT_EQ(snapshot.string_gauges["/test/string"], "value");
+}
+
+TEST(InProcessMetricsRegistryTest, ExplicitBucketsHistogram) {
+  InProcessMetricsRegistry registry;
+  Histogram* histogram = registry.NewHistogram(
+      "/test/histogram", Buckets::Explicit({1.0, 10.0, 100.0}));
+  for (double value : {0.5, 1.0, 5.0, 50.0, 500.0, 1000.0})
+    histogram->Record(value);
+
+  auto snapshot = registry.GetSnapshot().histograms["/test/histogram"];
+  EXPECT_EQ(snapshot.count, 6);
+  EXPECT_DOUBLE_EQ(snapshot.sum, 1556.5);
+  EXPECT_EQ(snapshot.bucket_counts, (std::vector<int64_t>{1, 2, 1, 2}));
+}
+
+TEST(InProcessMetricsRegistryTest, ExponentialBucketsHistogram) {
+  Buckets buckets = Buckets::Exponential(1.0, 2.0, 4);
+  EXPECT_EQ(buckets.explicit_bounds(),
+            (std::vector<double>{1.0, 2.0, 4.0, 8.0}));
+
+  InProcessMetricsRegistry registry;
+  Histogram* histogram = registry.NewHistogram("/test/histogram", buckets);
+  for (double value : {3.0, 3.5, 16.0}) histogram->Record(value);
+
+  auto snapshot = registry.GetSnapshot().histograms["/test/histogram"];
+  EXPECT_EQ(snapshot.bucket_counts, (std::vector<int64_t>{0, 0, 2, 0, 1}));
+}
+
+TEST(InProcessMetricsRegistryTest, PrintSnapshot) {
+  InProcessMetricsRegistry registry;
+  registry.NewCounter("/test/counter")->IncrementBy(3);
+  registry.NewHistogram("/test/histogram", Buckets::Explicit({1.0}))
+      ->Record(2.0);
+
+  std::string text;
+  llvm::raw_string_ostream text_os(text);
+  registry.GetSnapshot().PrintText(text_os);
+  EXPECT_EQ(text_os.str(),
+            "/test/counter: 3\n"
+            "/test/histogram: count=1 sum=2 [1, inf):1\n");
+
+  std::string json;
+  llvm::raw_string_ostream json_os(json);
+  registry.GetSnapshot().PrintJson(json_os);
+
+  auto parsed = llvm::json::parse(json_os.str());
+  ASSERT_TRUE(static_cast<bool>(parsed)) << llvm::toString(parsed.takeError());
+  auto* counters = parsed->getAsObject()->getObject("counters");
+  ASSERT_NE(counters, nullptr);
+  EXPECT_EQ(*counters->getInteger("/test/counter"), 3);
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace tfrt
@@ -18,7 +18,11 @@
 
 #include "tfrt/tensor/btf.h"
 
+#include <fstream>
+
 #include "gtest/gtest.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/cpp_tests/test_util.h"
 #include "tfrt/tensor/btf_util.h"
@@ -103,6 +107,106 @@ TEST(BTFTest, BTFWriteAndRead) {
   }
 }
 
+TEST(BTFTest, MappedBTFRead) {
+  auto context = CreateHostContext();
+  const auto a = CreateDummyTensor<int>({3, 2}, context.get());
+  const auto b = CreateDummyTensor<uint8_t>({63}, context.get());
+  const auto c = CreateDummyTensor<uint64_t>({}, context.get());
+  std::vector<const Tensor*> tensors{&a, &b, &c};
+
+  llvm::SmallString<128> path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("btf_test", "btf", path));
+  {
+    std::ofstream os(path.c_str(), std::ios_base::binary);
+    EXPECT_FALSE(WriteTensorsToBTF(&os, tensors));
+  }
+
+  llvm::Optional<DenseHostTensor> first;
+  {
+    auto file = MappedBTFFile::Open(path);
+    ASSERT_TRUE(!!file);
+    EXPECT_EQ(file->num_tensors(), tensors.size());
+    for (int i = 0; i < tensors.size(); i++) {
+      const auto& expected =
+          reinterpret_cast<const DenseHostTensor&>(*tensors[i]);
+      auto out = file->ReadDHT(i, context.get());
+      ASSERT_TRUE(!!out);
+      EXPECT_EQ(*out, expected);
+      if (i == 0) first = std::move(*out);
+    }
+    EXPECT_FALSE(!!file->ReadDHT(tensors.size(), context.get()));
+  }
+
+  // The tensor keeps the mapping alive after the file is closed and deleted.
+  llvm::sys::fs::remove(path);
+  EXPECT_EQ(*first, a);
+}
+
+TEST(BTFTest, ParallelWriteWithChecksums) {
+  auto context = CreateHostContext();
+  std::vector<DenseHostTensor> tensors;
+  tensors.push_back(CreateDummyTensor<int>({3, 2}, context.get()));
+  tensors.push_back(CreateDummyTensor<uint8_t>({63}, context.get()));
+  tensors.push_back(CreateDummyTensor<uint64_t>({}, context.get()));
+  std::vector<DenseHostTensor> expected;
+  for (const auto& tensor : tensors) expected.push_back(tensor.CopyRef());
+
+  llvm::SmallString<128> path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("btf_test", "btf", path));
+  auto done = WriteTensorsToBTFFile(path.str().str(), std::move(tensors),
+                                    context.get());
+  context->Await(done.CopyRCRef());
+  ASSERT_FALSE(done.IsError()) << done.GetError().message;
+
+  {
+    auto file = MappedBTFFile::Open(path);
+    ASSERT_TRUE(!!file);
+    EXPECT_TRUE(file->has_checksums());
+    ASSERT_EQ(file->num_tensors(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      auto out = file->ReadDHT(i, context.get(), /*verify_checksum=*/true);
+      ASSERT_TRUE(!!out);
+      EXPECT_EQ(*out, expected[i]);
+    }
+  }
+
+  // Readers which do not know about checksums can read the file.
+  {
+    std::ifstream is(path.c_str(), std::ios_base::binary);
+    auto offsets = ReadBTFOffsets(&is).get();
+    ASSERT_EQ(offsets.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      auto out = ReadDHTFromBTF(&is, offsets[i], context.get());
+      EXPECT_EQ(*out, expected[i]);
+    }
+  }
+
+  // Corrupt the last byte of the first tensor.
+  uint64_t offset;
+  {
+    std::fstream fs(path.c_str(),
+                    std::ios_base::binary | std::ios_base::in |
+                        std::ios_base::out);
+    fs.seekg(sizeof(uint64_t));
+    ASSERT_TRUE(ReadStream(&fs, &offset));
+    offset += sizeof(TensorHeader) + 2 * sizeof(uint64_t) +
+              expected[0].DataSizeInBytes() - 1;
+    fs.seekp(offset);
+    const char byte = 42;
+    ASSERT_TRUE(WriteStream(&fs, &byte));
+  }
+  {
+    auto file = MappedBTFFile::Open(path);
+    ASSERT_TRUE(!!file);
+    auto corrupted = file->ReadDHT(0, context.get(), /*verify_checksum=*/true);
+    EXPECT_FALSE(!!corrupted);
+    llvm::consumeError(corrupted.takeError());
+    EXPECT_TRUE(!!file->ReadDHT(0, context.get()));
+    EXPECT_TRUE(!!file->ReadDHT(1, context.get(), /*verify_checksum=*/true));
+  }
+  llvm::sys::fs::remove(path);
+}
+
 }  // namespace
 }  // namespace btf
 }  // namespace tfrt
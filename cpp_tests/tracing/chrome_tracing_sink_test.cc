@@ -0,0 +1,160 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Unit tests for ChromeTracingSink.
+
+#include "tfrt/tracing/chrome_tracing_sink/chrome_tracing_sink.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace tfrt {
+namespace tracing {
+namespace {
+
+// Flushes the `sink` and returns the exported trace events.
+llvm::json::Array FlushEvents(ChromeTracingSink& sink) {
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  sink.Flush(os);
+
+  auto json = llvm::json::parse(os.str());
+  EXPECT_TRUE(static_cast<bool>(json)) << llvm::toString(json.takeError());
+  llvm::json::Array* events = json->getAsObject()->getArray("traceEvents");
+  EXPECT_NE(events, nullptr);
+  return std::move(*events);
+}
+
+std::string GetPhase(const llvm::json::Value& event) {
+  return event.getAsObject()->getString("ph")->str();
+}
+
+std::string GetName(const llvm::json::Value& event) {
+  auto name = event.getAsObject()->getString("name");
+  return name ? name->str() : "";
+}
+
+TEST(ChromeTracingSinkTest, EventsAndScopes) {
+  ChromeTracingSink sink;
+  sink.PushTracingScope([] { return "outer"; });
+  sink.RecordTracingEvent([] { return "event \"quoted\""; });
+  sink.PushTracingScope([] { return "inner"; });
+  sink.PopTracingScope();
+  sink.PopTracingScope();
+
+  llvm::json::Array events = FlushEvents(sink);
+  ASSERT_EQ(events.size(), 5);
+
+  EXPECT_EQ(GetPhase(events[0]), "B");
+  EXPECT_EQ(GetName(events[0]), "outer");
+  EXPECT_EQ(GetPhase(events[1]), "i");
+  EXPECT_EQ(GetName(events[1]), "event \"quoted\"");
+  EXPECT_EQ(GetPhase(events[2]), "B");
+  EXPECT_EQ(GetName(events[2]), "inner");
+  EXPECT_EQ(GetPhase(events[3]), "E");
+  EXPECT_EQ(GetPhase(events[4]), "E");
+
+  // Timestamps are monotonic.
+  for (size_t i = 1; i < events.size(); ++i)
+    EXPECT_LE(*events[i - 1].getAsObject()->getNumber("ts"),
+              *events[i].getAsObject()->getNumber("ts"));
+
+  // Flushed events are not exported again.
+  EXPECT_TRUE(FlushEvents(sink).empty());
+}
+
+TEST(ChromeTracingSinkTest, RingBufferOverwritesOldestEntries) {
+  ChromeTracingSink::Options options;
+  options.buffer_size = 5;
+  ChromeTracingSink sink(options);
+
+  sink.PushTracingScope([] { return "scope"; });
+  for (int i = 0; i < 3; ++i)
+    sink.RecordTracingEvent([i] { return "event" + std::to_string(i); });
+  sink.PopTracingScope();
+
+  // The begin event was overwritten, so the unmatched end event is dropped.
+  llvm::json::Array events = FlushEvents(sink);
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(GetName(events[0]), "event0");
+  EXPECT_EQ(GetName(events[2]), "event2");
+}
+
+TEST(ChromeTracingSinkTest, LongNamesAreTruncated) {
+  ChromeTracingSink sink;
+  sink.RecordTracingEvent([] { return std::string(1000, 'x'); });
+
+  llvm::json::Array events = FlushEvents(sink);
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(GetName(events[0]),
+            std::string(ChromeTracingSink::kMaxNameSize, 'x'));
+}
+
+TEST(ChromeTracingSinkTest, PerThreadBuffers) {
+  ChromeTracingSink sink;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 100; ++j) {
+        sink.PushTracingScope([] { return "scope"; });
+        sink.PopTracingScope();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  llvm::json::Array events = FlushEvents(sink);
+  ASSERT_EQ(events.size(), 4 * 200);
+
+  // Events of every thread are exported together and have the same tid.
+  for (size_t i = 0; i < events.size(); i += 200) {
+    auto tid = events[i].getAsObject()->getInteger("tid");
+    for (size_t j = i; j < i + 200; ++j)
+      EXPECT_EQ(events[j].getAsObject()->getInteger("tid"), tid);
+  }
+}
+
+TEST(ChromeTracingSinkTest, AlternatingSinks) {
+  ChromeTracingSink sink_a;
+  ChromeTracingSink sink_b;
+
+  // The thread keeps writing into the same buffer of each sink, so scopes
+  // stay matched when the thread records into another sink in between.
+  sink_a.PushTracingScope([] { return "scope_a"; });
+  sink_b.PushTracingScope([] { return "scope_b"; });
+  sink_a.RecordTracingEvent([] { return "event_a"; });
+  sink_b.PopTracingScope();
+  sink_a.PopTracingScope();
+
+  llvm::json::Array events_a = FlushEvents(sink_a);
+  ASSERT_EQ(events_a.size(), 3);
+  EXPECT_EQ(GetName(events_a[0]), "scope_a");
+  EXPECT_EQ(GetName(events_a[1]), "event_a");
+  EXPECT_EQ(GetPhase(events_a[2]), "E");
+
+  llvm::json::Array events_b = FlushEvents(sink_b);
+  ASSERT_EQ(events_b.size(), 2);
+  EXPECT_EQ(GetName(events_b[0]), "scope_b");
+  EXPECT_EQ(GetPhase(events_b[1]), "E");
+}
+
+}  // namespace
+}  // namespace tracing
+}  // namespace tfrt
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measured kernel execution times, keyed by the kernel location.
+
+#ifndef TFRT_BEF_KERNEL_PROFILE_H_
+#define TFRT_BEF_KERNEL_PROFILE_H_
+
+#include <cstdint>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Error.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+// KernelProfile is the wall time of kernel executions aggregated per kernel
+// location. It is collected by the BEF executor (see KernelProfiler) and
+// consumed by the compiler, which uses the measured kernel costs instead of the
+// static ones when assigning kernels to streams.
+//
+// Kernels are identified by their location as printed in the diagnostics of
+// the BEF executor: "file:line:col" for file locations, and the printed form of
+// the opaque location for all other location kinds (e.g. the op name for name
+// locations). Kernels without a location are not profiled.
+//
+// The profile file is a text file with one kernel per line:
+//
+//   # tfrt kernel profile v1
+//   <count> <total_ns> <location>
+//
+// where `count` is the number of executions of the kernel and `total_ns` the
+// total wall time of these executions in nanoseconds. The location is the rest
+// of the line, so it can contain spaces. Empty lines and lines starting with
+// `#` are ignored.
+class KernelProfile {
+ public:
+  struct Entry {
+    int64_t count = 0;
+    int64_t total_ns = 0;
+
+    // Returns the mean wall time of one kernel execution.
+    int64_t MeanNs() const { return count == 0 ? 0 : total_ns / count; }
+  };
+
+  // Adds `count` executions that took `total_ns` in total to the kernel at
+  // `location`.
+  void Add(string_view location, int64_t count, int64_t total_ns);
+
+  // Adds all entries of `other` to this profile.
+  void Merge(const KernelProfile& other);
+
+  // Returns the entry for the kernel at `location`, or nullptr if the kernel
+  // was not profiled.
+  const Entry* Find(string_view location) const;
+
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+  // Prints the profile in the text format described above, sorted by location.
+  void Print(raw_ostream& os) const;
+
+  // Writes the profile to the file at `path`.
+  Error WriteToFile(string_view path) const;
+
+  // Parses a profile in the text format described above.
+  static Expected<KernelProfile> Parse(string_view text);
+
+  // Reads and parses the profile file at `path`.
+  static Expected<KernelProfile> ReadFromFile(string_view path);
+
+ private:
+  llvm::StringMap<Entry> entries_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_BEF_KERNEL_PROFILE_H_
@@ -30,14 +30,19 @@ class ModuleOp;
 
 namespace tfrt {
 
+class KernelProfile;
+
 // This function converts the specified MLIR module containing a host executor
 // compatible program to the BinaryExecutableFormat (BEF) format, which is the
 // low level format that the executor takes.
 //
+// If `kernel_profile` is not nullptr, the kernel costs measured by a previous
+// run of the program are used for the stream assignment of the kernels.
+//
 // On error, this emits the error message through the MLIR error handler, and
 // returns an empty AlignedBuffer.
-BefBuffer ConvertMLIRToBEF(mlir::ModuleOp module,
-                           bool disable_optional_sections);
+BefBuffer ConvertMLIRToBEF(mlir::ModuleOp module, bool disable_optional_sections,
+                           const KernelProfile* kernel_profile = nullptr);
 
 }  // namespace tfrt
 
@@ -23,6 +23,7 @@
 #include <functional>
 #include <memory>
 
+#include "llvm/ADT/FunctionExtras.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/ref_count.h"
 
@@ -35,6 +36,23 @@ class HostAllocator;
 class KernelRegistry;
 class LocationHandler;
 
+// Access pattern hints for the sections of a memory mapped BEF file.
+enum class BEFFileAccessHint {
+  // No special treatment.
+  kNormal,
+  // The section will be accessed soon, read it ahead.
+  kWillNeed,
+  // The section is accessed in random order, do not read ahead.
+  kRandom,
+};
+
+struct BEFFileMapOptions {
+  // The attributes section is read by the kernels on every execution.
+  BEFFileAccessHint attributes_hint = BEFFileAccessHint::kWillNeed;
+  // The kernels section is read by the executor on every execution.
+  BEFFileAccessHint kernels_hint = BEFFileAccessHint::kWillNeed;
+};
+
 // Instances of this class represent a BEF file in memory.  The in-memory
 // representation of BEF files is HostContext independent, allowing reuse across
 // multiple contexts if desired.
@@ -48,14 +66,31 @@ class BEFFile : public ReferenceCounted<BEFFile> {
   // pointer to our initialized object on success.  On failure, an error
   // message is emitted to the error_handler and nullptr is returned.
   //
-  // TODO: This should (optionally) manage ownership of the underlying data
-  // passed in, taking a closure to run when the lifetime of the BEFFile is
-  // done.
+  // The caller must keep the `file` data alive while the BEFFile is alive.
   static RCReference<BEFFile> Open(ArrayRef<uint8_t> file,
                                    const KernelRegistry& registry,
                                    ErrorHandler error_handler,
                                    HostAllocator* host_allocator);
 
+  // Same as above, but the BEFFile manages the lifetime of the `file` data:
+  // `release_file` is called when the BEFFile is destroyed, or when it fails
+  // to open.
+  static RCReference<BEFFile> Open(ArrayRef<uint8_t> file,
+                                   const KernelRegistry& registry,
+                                   ErrorHandler error_handler,
+                                   HostAllocator* host_allocator,
+                                   llvm::unique_function<void()> release_file);
+
+  // Memory maps the BEF file at `path` read-only and opens it. The file is not
+  // copied, and the mapping is released when the BEFFile is destroyed, so the
+  // BEF file pages are loaded lazily and shared with other processes that map
+  // the same file.
+  static RCReference<BEFFile> OpenMapped(string_view path,
+                                         const KernelRegistry& registry,
+                                         ErrorHandler error_handler,
+                                         HostAllocator* host_allocator,
+                                         const BEFFileMapOptions& options = {});
+
   // Get a list of functions out of the BEF file.
   void GetFunctionList(SmallVectorImpl<const Function*>* result) const;
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Profiling of the kernels executed by the BEF executor.
+
+#ifndef TFRT_BEF_EXECUTOR_KERNEL_PROFILER_H_
+#define TFRT_BEF_EXECUTOR_KERNEL_PROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tfrt/bef/kernel_profile.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+
+class BEFFile;
+
+// KernelProfiler records the wall time of every kernel executed by the BEF
+// executor while the profiler is installed with SetKernelProfiler(). The
+// recorded times are keyed by the kernel location, see KernelProfile.
+//
+// Only the synchronous part of a kernel is measured: the time from the kernel
+// invocation until it returns, which for asynchronous kernels does not include
+// the work they enqueue. Each thread records into its own table, so recording
+// does not contend with other threads.
+class KernelProfiler {
+ public:
+  KernelProfiler();
+  ~KernelProfiler();
+
+  // Records one execution of the kernel at `location_offset` in `bef_file`.
+  // Called by the BEF executor.
+  void Record(const BEFFile& bef_file, size_t location_offset,
+              std::chrono::nanoseconds duration);
+
+  // Returns the profile of all kernels recorded so far. Can be called
+  // concurrently with the recording threads.
+  KernelProfile GetProfile() const;
+
+ private:
+  struct ThreadTable;
+
+  // Returns the table of the calling thread.
+  ThreadTable* GetThreadTable();
+
+  const uint64_t id_;
+
+  mutable mutex mu_;
+  std::vector<std::unique_ptr<ThreadTable>> tables_ TFRT_GUARDED_BY(mu_);
+};
+
+// Installs `profiler` for all BEF executors in the process, or disables the
+// kernel profiling if `profiler` is nullptr. The profiler is not owned and must
+// outlive all executions that started while it was installed.
+void SetKernelProfiler(KernelProfiler* profiler);
+
+// Returns the installed kernel profiler, or nullptr if profiling is disabled.
+KernelProfiler* GetKernelProfiler();
+
+}  // namespace tfrt
+
+#endif  // TFRT_BEF_EXECUTOR_KERNEL_PROFILER_H_
@@ -45,6 +45,9 @@ enum class HostAllocatorType {
   // Allocator wrapped around profiled malloc and exit(1) on detecting memory
   // leak.
   kLeakCheckMalloc,
+
+  // Allocator with per-thread caches of size classed blocks.
+  kThreadCaching,
 };
 
 struct RunBefConfig {
@@ -44,6 +44,12 @@
 //    2.3 Choose the child with the highest cost and merge it with the current
 //        stream.
 //
+// Kernel Profile: The static costs of operations can be replaced with the
+// wall times measured by the BEF executor (see KernelProfiler). When a profile
+// is provided, the cost of each operation found in the profile is its mean
+// execution time in nanoseconds, and the cost thresholds should be set in
+// nanoseconds as well.
+//
 // TODO(chky): Add g3doc and link it here.
 
 #ifndef TFRT_COMPILER_STREAM_ANALYSIS_H_
@@ -52,6 +58,7 @@
 #include "mlir/IR/Block.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Operation.h"
+#include "tfrt/bef/kernel_profile.h"
 
 namespace tfrt {
 namespace compiler {
@@ -91,8 +98,17 @@ class Stream {
 // function.
 class StreamAnalysis {
  public:
-  explicit StreamAnalysis(mlir::FuncOp op) : StreamAnalysis(op.front()) {}
-  explicit StreamAnalysis(mlir::Block& block) { AnalyzeBlock(block); }
+  // If `profile` is not nullptr, the measured costs of operations in the
+  // profile are used instead of their static costs. The profile is only used
+  // during the construction.
+  explicit StreamAnalysis(mlir::FuncOp op,
+                          const KernelProfile* profile = nullptr)
+      : StreamAnalysis(op.front(), profile) {}
+  explicit StreamAnalysis(mlir::Block& block,
+                          const KernelProfile* profile = nullptr)
+      : profile_(profile) {
+    AnalyzeBlock(block);
+  }
 
   // Return the stream that contains `op`. An operation can only belong to one
   // stream.
@@ -190,6 +206,7 @@ class StreamAnalysis {
 
   BuildInfo build_info_;
   Options options_;
+  const KernelProfile* profile_ = nullptr;
 
   // `streams_` contains the finalized Stream objects that contain information
   // for users to query.
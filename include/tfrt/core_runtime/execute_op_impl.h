@@ -29,6 +29,7 @@ class ExecutionContext;
 class AsyncValue;
 class CoreRuntimeOp;
 class OpAttrs;
+class OpAttrsRef;
 class Value;
 class TensorHandle;
 template <typename T>
@@ -55,12 +56,26 @@ void ExecuteOpImpl(CoreRuntimeOp op, ArrayRef<AsyncValue *> args,
                    AggregateAttr op_func_attr_array,
                    const ExecutionContext &exec_ctx);
 
+// A version of ExecuteOpImpl that takes already prepared `op_attrs`.
+void ExecuteOpImpl(const CoreRuntimeOp &op, ArrayRef<AsyncValue *> args,
+                   AsyncValueRef<Chain> *op_chain,
+                   MutableArrayRef<RCReference<AsyncValue>> results,
+                   const OpAttrsRef &op_attrs,
+                   const ExecutionContext &exec_ctx);
+
 void ExecuteOpImplSync(const CoreRuntimeOp &op,
                        RepeatedSyncArguments<TensorHandle> args,
                        AsyncValueRef<Chain> *op_chain, SyncKernelFrame *frame,
                        AggregateAttr op_attr_array,
                        const ExecutionContext &exec_ctx);
 
+// A version of ExecuteOpImplSync that takes already prepared `op_attrs`.
+void ExecuteOpImplSync(const CoreRuntimeOp &op,
+                       RepeatedSyncArguments<TensorHandle> args,
+                       AsyncValueRef<Chain> *op_chain, SyncKernelFrame *frame,
+                       const OpAttrsRef &op_attrs,
+                       const ExecutionContext &exec_ctx);
+
 void AsyncWaitForResultsFromTensorHandles(
     MutableArrayRef<RCReference<AsyncValue>> results,
     MutableArrayRef<TensorHandle> result_ths);
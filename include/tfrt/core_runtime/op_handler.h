@@ -19,6 +19,8 @@
 #ifndef TFRT_CORE_RUNTIME_OP_HANDLER_H_
 #define TFRT_CORE_RUNTIME_OP_HANDLER_H_
 
+#include <cstdint>
+
 #include "llvm/Support/Error.h"
 #include "tfrt/core_runtime/core_runtime_op.h"
 #include "tfrt/support/error_util.h"
@@ -52,6 +54,11 @@ class OpHandler {
 
   OpHandler *GetFallback() const { return fallback_; }
 
+  // Return the id of this op_handler that is unique in the process. Unlike the
+  // address of the op_handler, it is never reused after the op_handler is
+  // destroyed.
+  uint64_t id() const { return id_; }
+
   virtual Expected<CoreRuntimeOp> MakeOp(string_view op_name) = 0;
 
   virtual ~OpHandler();
@@ -60,16 +67,9 @@ class OpHandler {
   const std::string name_;
   CoreRuntime *const runtime_;
   OpHandler *const fallback_;
+  const uint64_t id_;
 };
 
-//===----------------------------------------------------------------------===//
-// Inline implementation details of OpHandler
-//===----------------------------------------------------------------------===//
-
-inline OpHandler::OpHandler(string_view name, CoreRuntime *runtime,
-                            OpHandler *fallback)
-    : name_(name), runtime_(runtime), fallback_(fallback) {}
-
 }  // namespace tfrt
 
 #endif  // TFRT_CORE_RUNTIME_OP_HANDLER_H_
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares the autotuning model of the data pipeline, which adjusts
+// the buffer sizes and the parallelism of the iterators at runtime.
+
+#ifndef TFRT_DATA_AUTOTUNE_H_
+#define TFRT_DATA_AUTOTUNE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tfrt/data/dataset.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/ref_count.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace data {
+
+class AutotuneModel;
+
+// The resource that is consumed by a tunable parameter.
+enum class TunableKind {
+  // The number of elements produced concurrently, e.g. the number of parallel
+  // calls of a map function. Bounded by the CPU budget of the model.
+  kParallelism,
+  // The number of elements buffered ahead of the consumer, e.g. the size of a
+  // prefetch buffer. Bounded by the RAM budget of the model.
+  kBufferSize,
+};
+
+// TunableParameter is a value of an iterator which is adjusted at runtime by
+// an AutotuneModel, e.g. the prefetch buffer size. The iterator owns the
+// parameter, reads its current value whenever it decides how much work to
+// start, and reports the statistics of the elements it produces.
+//
+// The parameter is registered with the model on construction and unregistered
+// on destruction. It is reference counted, so that the statistics of elements
+// which become available after the iterator is destroyed can still be
+// recorded. All methods are thread-safe.
+class TunableParameter : public ReferenceCounted<TunableParameter> {
+ public:
+  TunableParameter(AutotuneModel* model, string_view name, TunableKind kind,
+                   int64_t value, int64_t min, int64_t max);
+  ~TunableParameter();
+
+  // This class is not copyable or movable.
+  TunableParameter(const TunableParameter&) = delete;
+  TunableParameter& operator=(const TunableParameter&) = delete;
+
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+  // Records that producing the available `element` took `duration`.
+  void RecordProduction(const IterationResult& element,
+                        std::chrono::nanoseconds duration);
+
+  // Records the production of `element`, which was requested at `start`, once
+  // it becomes available.
+  void RecordProduction(const IterationResult& element,
+                        std::chrono::steady_clock::time_point start);
+
+  // Records that `output` is returned to the consumer. If `output` is not
+  // available yet, the time until it becomes available is recorded as the
+  // time the consumer waits for this iterator.
+  void RecordOutput(const IterationResult& output);
+
+ private:
+  friend class AutotuneModel;
+
+  RCReference<AutotuneModel> model_;
+  const std::string name_;
+  const TunableKind kind_;
+  const int64_t min_;
+  const int64_t max_;
+  std::atomic<int64_t> value_;
+
+  // Statistics reported by the iterator since the parameter was created.
+  std::atomic<int64_t> num_outputs_{0};
+  std::atomic<int64_t> num_productions_{0};
+  std::atomic<int64_t> production_ns_{0};
+  std::atomic<int64_t> wait_ns_{0};
+  std::atomic<int64_t> element_bytes_{0};
+  std::atomic<int64_t> num_sized_elements_{0};
+
+  // State of the model, guarded by the mutex of the model.
+  int64_t last_num_outputs_ = 0;
+  int64_t last_num_productions_ = 0;
+  int64_t last_production_ns_ = 0;
+  int64_t last_wait_ns_ = 0;
+  int64_t idle_periods_ = 0;
+  double elements_per_second_ = 0;
+  double wait_fraction_ = 0;
+  int64_t mean_production_ns_ = 0;
+};
+
+struct AutotuneOptions {
+  // The maximum total parallelism of all kParallelism parameters.
+  int64_t cpu_budget = 1;
+  // The maximum number of bytes buffered by all kBufferSize parameters, or 0
+  // if unlimited. The size of the elements is estimated from the elements
+  // produced by the iterators. Elements of unknown size, i.e. elements which
+  // are not strings or dense host tensors, are not accounted for.
+  int64_t ram_budget = 0;
+  // The minimum time between two adjustments of the parameters.
+  std::chrono::nanoseconds period = std::chrono::milliseconds(100);
+};
+
+// Values chosen by the model, and the performance they achieved during the
+// last period.
+struct AutotuneStats {
+  std::string name;
+  TunableKind kind;
+  int64_t value;
+  double elements_per_second;
+  // The fraction of the period during which the consumer waited for elements.
+  double wait_fraction;
+  int64_t mean_production_ns;
+  int64_t mean_element_bytes;
+};
+
+// AutotuneModel is shared by all iterators of an input pipeline. Periodically,
+// it grows the parameters of the iterators that the consumer waits for, and
+// shrinks the parameters of the iterators that are ahead of the consumer, as
+// long as the total parallelism and the total buffered bytes stay within the
+// budgets.
+class AutotuneModel : public ReferenceCounted<AutotuneModel> {
+ public:
+  explicit AutotuneModel(AutotuneOptions options);
+
+  // This class is not copyable or movable.
+  AutotuneModel(const AutotuneModel&) = delete;
+  AutotuneModel& operator=(const AutotuneModel&) = delete;
+
+  // Records that an element is returned by the pipeline, and adjusts the
+  // parameters if the period has elapsed since the last adjustment.
+  void RecordPipelineOutput();
+
+  // Adjusts the parameters based on the statistics recorded during the last
+  // `elapsed` time.
+  void Optimize(std::chrono::nanoseconds elapsed) TFRT_EXCLUDES(mu_);
+
+  // Returns the stats of all registered parameters, in registration order.
+  std::vector<AutotuneStats> GetStats() const TFRT_EXCLUDES(mu_);
+
+  // Returns the number of elements returned by the pipeline per second during
+  // the last period.
+  double GetElementsPerSecond() const TFRT_EXCLUDES(mu_);
+
+  // Prints the stats in a human readable format.
+  void Print(raw_ostream& os) const;
+
+ private:
+  friend class TunableParameter;
+
+  void AddParameter(TunableParameter* parameter) TFRT_EXCLUDES(mu_);
+  void RemoveParameter(TunableParameter* parameter) TFRT_EXCLUDES(mu_);
+
+  const AutotuneOptions options_;
+
+  // Time of the last adjustment in nanoseconds since the steady clock epoch.
+  std::atomic<int64_t> last_optimization_ns_;
+  std::atomic<int64_t> num_pipeline_outputs_{0};
+
+  mutable mutex mu_;
+  std::vector<TunableParameter*> parameters_ TFRT_GUARDED_BY(mu_);
+  int64_t last_num_pipeline_outputs_ TFRT_GUARDED_BY(mu_) = 0;
+  double elements_per_second_ TFRT_GUARDED_BY(mu_) = 0;
+};
+
+// The maximum value of a tunable parameter, in addition to the budgets of the
+// model. The RAM budget can not bound the buffers of elements of unknown size.
+constexpr int64_t kMaxTunableValue = 256;
+
+// Returns a parameter registered with the autotuning model of `context`, or an
+// empty reference if autotuning is disabled.
+inline RCReference<TunableParameter> MakeTunableParameter(
+    const IteratorContext& context, string_view name, TunableKind kind,
+    int64_t value, int64_t min) {
+  if (!context.autotune_model) return {};
+  return TakeRef(new TunableParameter(context.autotune_model, name, kind, value,
+                                      min, std::max(value, kMaxTunableValue)));
+}
+
+// Returns the current value of `parameter`, or `value` if autotuning is
+// disabled.
+inline int64_t GetTunableValue(const RCReference<TunableParameter>& parameter,
+                               int64_t value) {
+  return parameter ? parameter->value() : value;
+}
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_DATA_AUTOTUNE_H_
@@ -40,6 +40,8 @@
 namespace tfrt {
 namespace data {
 
+class AutotuneModel;
+
 struct IterationResult {
   // Construct IterationResult with valid values and eof = false.
   static IterationResult Values(SmallVector<RCReference<AsyncValue>, 4> values,
@@ -133,7 +135,13 @@ static void AllocateTupleResult(
 }  // namespace internal
 
 // This struct provides parameters specific to iterator creation.
-struct IteratorContext {};
+struct IteratorContext {
+  // If set, the iterators register their buffer sizes and parallelism with
+  // this model, which adjusts them at runtime. Otherwise, the iterators use
+  // the fixed values of their datasets. The model is kept alive by the
+  // iterators which registered with it.
+  AutotuneModel* autotune_model = nullptr;
+};
 
 class Iterator : public ReferenceCounted<Iterator> {
  public:
@@ -143,6 +151,15 @@ class Iterator : public ReferenceCounted<Iterator> {
 
   virtual IterationResult GetNext(const ExecutionContext& exec_ctx) = 0;
 
+  // Skips the next `count` elements, as if GetNext() was called `count` times
+  // and the results were dropped. The end of iteration is reported by the next
+  // GetNext() call, and errors in the skipped elements might be dropped.
+  //
+  // The default implementation calls GetNext(). Iterators which can skip
+  // elements without computing their values, e.g. by skipping the records of
+  // a file, override it.
+  virtual void Skip(int64_t count, const ExecutionContext& exec_ctx);
+
  protected:
   // For access to Destroy().
   friend class ReferenceCounted<Iterator>;
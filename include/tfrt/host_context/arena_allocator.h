@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Arena Memory Allocator
+//
+// This file declares ArenaAllocator, a bump-pointer HostAllocator that releases
+// all of its memory at once when it is destroyed.
+
+#ifndef TFRT_HOST_CONTEXT_ARENA_ALLOCATOR_H_
+#define TFRT_HOST_CONTEXT_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+
+// ArenaAllocator serves allocations up to `max_allocation_size` bytes by
+// bumping a pointer in a block of memory obtained from the `fallback`
+// allocator. DeallocateBytes() for such allocations is a no-op, and all the
+// blocks are returned to the `fallback` allocator when the arena is destroyed.
+// Allocations larger than `max_allocation_size` are forwarded to `fallback`.
+//
+// ArenaAllocator is thread-safe. Allocations from the current block are
+// lock-free, a mutex is taken only to allocate a new block.
+//
+// Objects allocated from the arena must not outlive it.
+class ArenaAllocator : public HostAllocator {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+  static constexpr size_t kDefaultMaxAllocationSize = 4 * 1024;
+
+  explicit ArenaAllocator(
+      HostAllocator* fallback, size_t block_size = kDefaultBlockSize,
+      size_t max_allocation_size = kDefaultMaxAllocationSize);
+  ~ArenaAllocator() override;
+
+  void* AllocateBytes(size_t size, size_t alignment) override;
+  void DeallocateBytes(void* ptr, size_t size) override;
+
+  // Returns the number of bytes allocated from the `fallback` allocator for the
+  // arena blocks.
+  size_t GetNumBlockBytes() const {
+    return num_block_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Block;
+
+  // Allocates a new block that can fit `size` bytes with `alignment`, unless
+  // the `current` block was already replaced by another thread. Returns false
+  // if the `fallback` allocator failed to allocate a block.
+  bool AddBlock(Block* current, size_t size, size_t alignment);
+
+  HostAllocator* const fallback_;
+  const size_t block_size_;
+  const size_t max_allocation_size_;
+
+  std::atomic<Block*> current_{nullptr};
+  std::atomic<size_t> num_block_bytes_{0};
+
+  mutex mu_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_ARENA_ALLOCATOR_H_
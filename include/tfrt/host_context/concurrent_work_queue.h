@@ -158,6 +158,16 @@ std::unique_ptr<ConcurrentWorkQueue> CreateSingleThreadedWorkQueue();
 std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedWorkQueue(
     int num_threads, int num_blocking_threads);
 
+// Create a multi-threaded non-blocking thread pool that schedules non-blocking
+// tasks submitted with an ExecutionContext according to the request priority
+// (see RequestContext::priority()). Higher priority tasks are executed ahead of
+// the pending lower priority tasks, and low priority tasks are periodically
+// executed out of order to prevent their starvation.
+//
+// Arguments are the same as for CreateMultiThreadedWorkQueue().
+std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedPriorityWorkQueue(
+    int num_threads, int num_blocking_threads);
+
 // A factory function for creating ConcurrentWorkQueue objects. The factory
 // function defines the semantics of the argument string.
 // TODO(pgavin): Consider using a configuration object or other data structure
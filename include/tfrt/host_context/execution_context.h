@@ -19,6 +19,9 @@
 #ifndef TFRT_HOST_CONTEXT_EXECUTION_CONTEXT_H_
 #define TFRT_HOST_CONTEXT_EXECUTION_CONTEXT_H_
 
+#include <memory>
+
+#include "tfrt/host_context/arena_allocator.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/resource_context.h"
 #include "tfrt/support/map_by_type.h"
@@ -30,6 +33,20 @@ class HostContext;
 class ErrorAsyncValue;
 class ConcurrentWorkQueue;
 
+struct RequestOptions {
+  using RequestPriority = int;
+
+  RequestPriority priority = 0;
+
+  // If true, the request gets its own ArenaAllocator (see
+  // RequestContext::allocator()) that is released at once when the request
+  // completes. Allocations larger than `arena_max_allocation_size` are served
+  // by the HostContext allocator.
+  bool enable_arena = false;
+  size_t arena_block_size = ArenaAllocator::kDefaultBlockSize;
+  size_t arena_max_allocation_size = ArenaAllocator::kDefaultMaxAllocationSize;
+};
+
 // A request refers to either a BEFFunction execution or an op execution.
 // RequestContext holds per request information, such as the cancellation status
 // and request priority. A RequestContext object is reference counted and is
@@ -50,6 +67,11 @@ class RequestContext : public ReferenceCounted<RequestContext> {
   HostContext* host() const { return host_; }
   ResourceContext* resource_context() const { return resource_context_; }
 
+  // Returns the allocator for the memory that does not outlive the request,
+  // e.g. BEFExecutor state. This is the per-request arena if it was enabled in
+  // RequestOptions, and the HostContext allocator otherwise.
+  HostAllocator* allocator() const;
+
   // If the request has been canceled, return an ErrorAsyncValue for
   // the cancellation. Otherwise, return nullptr.
   ErrorAsyncValue* GetCancelAsyncValue() const {
@@ -78,17 +100,26 @@ class RequestContext : public ReferenceCounted<RequestContext> {
 
   int64_t id() const { return id_; }
 
+  // The priority of the request. ConcurrentWorkQueue implementations may use it
+  // to schedule the tasks of the request ahead of lower priority work.
+  RequestOptions::RequestPriority priority() const { return priority_; }
+
  private:
   friend class RequestContextBuilder;
 
   RequestContext(HostContext* host, ResourceContext* resource_context,
-                 ContextData ctx_data, int64_t id)
+                 ContextData ctx_data, int64_t id,
+                 RequestOptions::RequestPriority priority,
+                 std::unique_ptr<ArenaAllocator> arena)
       : id_{id},
+        priority_{priority},
         host_{host},
         resource_context_{resource_context},
-        context_data_{std::move(ctx_data)} {}
+        context_data_{std::move(ctx_data)},
+        arena_{std::move(arena)} {}
 
   int64_t id_;
+  RequestOptions::RequestPriority priority_;
   HostContext* const host_ = nullptr;
   // Both ResourceContext and ContextData manages data used during the request
   // execution. ResourceContext is more flexible than ContextData at the cost of
@@ -100,16 +131,12 @@ class RequestContext : public ReferenceCounted<RequestContext> {
   // synchronization overhead.
   ResourceContext* const resource_context_ = nullptr;
   ContextData context_data_;
+  // Per-request arena, released when the request context is destroyed.
+  std::unique_ptr<ArenaAllocator> arena_;
 
   std::atomic<ErrorAsyncValue*> cancel_value_{nullptr};
 };
 
-struct RequestOptions {
-  using RequestPriority = int;
-
-  RequestPriority priority = 0;
-};
-
 // A builder class for RequestContext.
 // Sample usage:
 // auto request_context = RequestContextBuilder(host, resource_context)
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares the KernelCache class, which lets a kernel keep a value
+// derived from its attributes across executions.
+
+#ifndef TFRT_HOST_CONTEXT_KERNEL_CACHE_H_
+#define TFRT_HOST_CONTEXT_KERNEL_CACHE_H_
+
+#include <atomic>
+#include <memory>
+
+namespace tfrt {
+
+// KernelCache holds a value which a kernel computes from its attributes, e.g. a
+// resolved op, so that later executions of the same kernel reuse it. The
+// executors keep one KernelCache for each kernel of a function, which lives as
+// long as the function, and pass it to the kernel through the kernel frame.
+//
+// The value is set at most once. Reading it does not take any lock.
+class KernelCache {
+ public:
+  // The base class of the cached values.
+  class CachedValue {
+   public:
+    virtual ~CachedValue() = default;
+  };
+
+  KernelCache() = default;
+  ~KernelCache() { delete value_.load(std::memory_order_relaxed); }
+
+  // This class is not copyable or movable.
+  KernelCache(const KernelCache&) = delete;
+  KernelCache& operator=(const KernelCache&) = delete;
+
+  // Returns the cached value, or nullptr if no value is cached yet. A kernel
+  // always caches values of the same type T.
+  template <typename T>
+  T* Get() const {
+    return static_cast<T*>(value_.load(std::memory_order_acquire));
+  }
+
+  // Caches `value` and returns it, or returns the value cached concurrently by
+  // another execution of the kernel and drops `value`.
+  template <typename T>
+  T* Set(std::unique_ptr<T> value) {
+    CachedValue* cached = nullptr;
+    if (value_.compare_exchange_strong(cached, value.get(),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      return value.release();
+    }
+    return static_cast<T*>(cached);
+  }
+
+ private:
+  std::atomic<CachedValue*> value_{nullptr};
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_KERNEL_CACHE_H_
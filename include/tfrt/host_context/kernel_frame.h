@@ -32,6 +32,7 @@
 #include "tfrt/host_context/attribute_utils.h"
 #include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_cache.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/string_util.h"
@@ -81,6 +82,10 @@ class AsyncKernelFrame {
   // Get the location.
   Location GetLocation() const { return exec_ctx_.location(); }
 
+  // Get the cache of this kernel, or nullptr if the caller does not provide
+  // one.
+  KernelCache* GetKernelCache() const { return kernel_cache_; }
+
   ArrayRef<uint8_t> GetAttributeSection() const { return attribute_section_; }
 
   // Get the number of arguments.
@@ -273,6 +278,7 @@ class AsyncKernelFrame {
   ArrayRef<uint32_t> attribute_offsets_;
   ArrayRef<uint32_t> function_indices_;
   ArrayRef<std::unique_ptr<Function>> functions_;
+  KernelCache* kernel_cache_ = nullptr;
   ExecutionContext exec_ctx_;
 };
 
@@ -289,6 +295,7 @@ inline void AsyncKernelFrame::AssignFields(const AsyncKernelFrame& other) {
   attribute_offsets_ = other.attribute_offsets_;
   function_indices_ = other.function_indices_;
   functions_ = other.functions_;
+  kernel_cache_ = other.kernel_cache_;
 }
 
 inline void AsyncKernelFrame::AssignFields(AsyncKernelFrame&& other) {
@@ -300,6 +307,7 @@ inline void AsyncKernelFrame::AssignFields(AsyncKernelFrame&& other) {
   attribute_offsets_ = other.attribute_offsets_;
   function_indices_ = other.function_indices_;
   functions_ = other.functions_;
+  kernel_cache_ = other.kernel_cache_;
 }
 
 // KernelFrameBuilder is used by the kernel caller to construct a
@@ -357,6 +365,11 @@ class KernelFrameBuilder : public AsyncKernelFrame {
   void SetLocation(const Location& location) {
     exec_ctx_.set_location(location);
   }
+
+  // Set the cache of the kernel.
+  void SetKernelCache(KernelCache* kernel_cache) {
+    kernel_cache_ = kernel_cache;
+  }
 };
 
 // Implementation details
@@ -30,6 +30,7 @@
 #include "tfrt/host_context/attribute_utils.h"
 #include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_cache.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/value.h"
 #include "tfrt/support/forward_decls.h"
@@ -51,6 +52,10 @@ class SyncKernelFrame {
   // Get the location.
   Location GetLocation() const { return exec_ctx_.location(); }
 
+  // Get the cache of this kernel, or nullptr if the caller does not provide
+  // one.
+  KernelCache* GetKernelCache() const { return kernel_cache_; }
+
   ArrayRef<Value*> GetRegisters() const { return registers_; }
 
   // Get the number of arguments.
@@ -143,6 +148,7 @@ class SyncKernelFrame {
   ArrayRef<const void*> attributes_;
   // These are indices into `registers_`.
   ArrayRef<uint32_t> result_indices_;
+  KernelCache* kernel_cache_ = nullptr;
 
   const ArrayRef<Value*> registers_;
 
@@ -177,6 +183,9 @@ class SyncKernelFrameBuilder : public SyncKernelFrame {
   void SetResults(ArrayRef<uint32_t> result_indices) {
     result_indices_ = result_indices;
   }
+  void SetKernelCache(KernelCache* kernel_cache) {
+    kernel_cache_ = kernel_cache;
+  }
 };
 
 // Implementation details
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Thread Caching Memory Allocator
+//
+// This file declares a host memory allocator that serves small allocations
+// from per-thread caches of fixed size blocks.
+
+#ifndef TFRT_HOST_CONTEXT_THREAD_CACHING_ALLOCATOR_H_
+#define TFRT_HOST_CONTEXT_THREAD_CACHING_ALLOCATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+// ThreadCachingAllocator rounds small allocations up to one of a fixed set of
+// size classes (16 bytes to 4KB, tuned for AsyncValues, kernel frames and small
+// tensor buffers) and serves them from a per-thread free list without any
+// synchronization. Free lists exchange batches of blocks with a lock-free
+// global pool shared by all threads, so memory freed by one thread is reused by
+// the others. New blocks are carved from large chunks obtained from
+// AlignedAlloc, which are released only when the allocator is destroyed.
+//
+// Allocations larger than the largest size class, or with an alignment that no
+// size class can satisfy, are forwarded to AlignedAlloc.
+class ThreadCachingAllocator : public HostAllocator {
+ public:
+  // Statistics for a single size class.
+  struct SizeClassStats {
+    // Size of the blocks in this size class.
+    size_t block_size = 0;
+    // Number of allocations and deallocations served by this size class.
+    int64_t num_allocations = 0;
+    int64_t num_deallocations = 0;
+    // Number of batches of blocks moved between thread caches and the global
+    // pool.
+    int64_t num_batches_from_pool = 0;
+    int64_t num_batches_to_pool = 0;
+    // Number of batches carved from chunks, and number of chunks allocated.
+    int64_t num_batches_carved = 0;
+    int64_t num_chunks = 0;
+  };
+
+  // Returns a snapshot of the statistics for all size classes. Counters are
+  // updated concurrently, so the snapshot is not guaranteed to be consistent.
+  virtual std::vector<SizeClassStats> GetSizeClassStats() const = 0;
+
+  // Returns the number of allocations forwarded to AlignedAlloc.
+  virtual int64_t GetNumLargeAllocations() const = 0;
+
+  // Prints the statistics for all size classes that have been used.
+  void PrintStats(raw_ostream& os) const;
+
+ protected:
+  ThreadCachingAllocator() = default;
+};
+
+// Create an allocator with per-thread caches of size classed blocks.
+std::unique_ptr<ThreadCachingAllocator> CreateThreadCachingAllocator();
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_THREAD_CACHING_ALLOCATOR_H_
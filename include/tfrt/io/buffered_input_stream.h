@@ -49,6 +49,10 @@ class BufferedInputStream : public InputStream {
 
   llvm::Expected<size_t> Tell() override;
 
+  // Skips the buffered bytes first, and the rest of the bytes in the
+  // underlying stream without buffering them.
+  llvm::Expected<size_t> Skip(size_t count) override;
+
  private:
   std::unique_ptr<InputStream> input_stream_;
   HostAllocator* allocator_;
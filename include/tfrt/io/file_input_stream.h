@@ -38,6 +38,10 @@ class FileInputStream : public InputStream {
 
   llvm::Expected<size_t> Tell() override;
 
+  // Moves the offset without reading the skipped bytes, except for the last one
+  // which tells whether the file is long enough.
+  llvm::Expected<size_t> Skip(size_t count) override;
+
  private:
   std::unique_ptr<RandomAccessFile> file_;
   size_t offset_ = 0;
@@ -20,6 +20,7 @@
 #define TFRT_IO_FILE_SYSTEM_H_
 
 #include "llvm/ADT/StringMap.h"
+#include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/support/error_util.h"
 #include "tfrt/support/mutex.h"
 #include "tfrt/support/thread_annotations.h"
@@ -51,6 +52,16 @@ class RandomAccessFile {
   // On error, llvm::Error is returned.
   virtual llvm::Expected<size_t> Read(char* buf, size_t max_count,
                                       size_t offset) const = 0;
+
+  // Same as Read(), except that the bytes are read asynchronously. The
+  // returned value holds the number of bytes read or the error. The file and
+  // the buffer must stay alive until the returned value is available.
+  //
+  // The default implementation calls Read() in a blocking task, or in the
+  // caller thread if the task cannot be enqueued.
+  virtual AsyncValueRef<size_t> ReadAsync(char* buf, size_t max_count,
+                                          size_t offset,
+                                          HostContext* host) const;
 };
 
 // An interface that declares operations to manage files in a file system.
@@ -19,6 +19,8 @@
 #ifndef TFRT_IO_INPUT_STREAM_H_
 #define TFRT_IO_INPUT_STREAM_H_
 
+#include <algorithm>
+
 #include "tfrt/support/error_util.h"
 
 namespace tfrt {
@@ -45,6 +47,27 @@ class InputStream {
   // If the stream does not support the operation, or if it fails, the function
   // returns llvm::Error.
   virtual llvm::Expected<size_t> Tell() = 0;
+
+  // This method skips up to `count` bytes of the input stream.
+  //
+  // On success, the number of bytes skipped is returned. If this number is
+  // smaller than `count`, it indicates that the stream has reached EOF.
+  // On error, llvm::Error is returned.
+  //
+  // The default implementation reads the bytes into a scratch buffer. Streams
+  // which can seek override it.
+  virtual llvm::Expected<size_t> Skip(size_t count) {
+    char scratch[4096];
+    size_t skipped = 0;
+    while (skipped < count) {
+      const size_t max_count = std::min(sizeof(scratch), count - skipped);
+      auto count_or_error = Read(scratch, max_count);
+      if (!count_or_error) return count_or_error.takeError();
+      skipped += *count_or_error;
+      if (*count_or_error < max_count) break;
+    }
+    return skipped;
+  }
 };
 
 }  // namespace io
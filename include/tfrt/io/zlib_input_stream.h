@@ -0,0 +1,84 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares the ZlibInputStream class which decompresses data from
+// another input stream in the ZLIB or GZIP format.
+
+#ifndef TFRT_IO_ZLIB_INPUT_STREAM_H_
+#define TFRT_IO_ZLIB_INPUT_STREAM_H_
+
+#include <memory>
+#include <string>
+
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/io/input_stream.h"
+#include "tfrt/support/forward_decls.h"
+
+struct z_stream_s;
+
+namespace tfrt {
+namespace io {
+
+enum class CompressionType { kNone, kZlib, kGzip };
+
+// Parses the compression type names used by TFRecord files, i.e. "" for no
+// compression, "ZLIB" and "GZIP".
+llvm::Expected<CompressionType> ParseCompressionType(string_view name);
+
+class ZlibInputStream : public InputStream {
+ public:
+  // `compression_type` must be kZlib or kGzip. The compressed data is read from
+  // `input_stream` in blocks of `input_buffer_size` bytes.
+  explicit ZlibInputStream(std::unique_ptr<InputStream> input_stream,
+                           CompressionType compression_type,
+                           size_t input_buffer_size, HostAllocator* allocator);
+
+  ~ZlibInputStream() override;
+
+  // This class is not copyable or movable.
+  ZlibInputStream(const ZlibInputStream&) = delete;
+  ZlibInputStream& operator=(const ZlibInputStream&) = delete;
+
+  // Reads up to `max_count` decompressed bytes. Concatenated compressed
+  // streams, e.g. the members of a GZIP file, are decompressed one after the
+  // other. Returns an error if the compressed data is invalid or truncated.
+  llvm::Expected<size_t> Read(char* buf, size_t max_count) override;
+
+  // Returns the position in the decompressed data.
+  llvm::Expected<size_t> Tell() override;
+
+ private:
+  std::unique_ptr<InputStream> input_stream_;
+  HostAllocator* allocator_;
+  // The buffer of compressed bytes read from input_stream_.
+  char* input_buffer_ = nullptr;
+  size_t input_buffer_size_ = 0;
+  std::unique_ptr<z_stream_s> z_stream_;
+  // The error returned by zlib when the stream was initialized, if any.
+  std::string init_error_;
+  // Whether input_stream_ has reached EOF.
+  bool input_eof_ = false;
+  // Whether bytes of a compressed stream were consumed since the start of the
+  // last stream, i.e. the end of the input is unexpected.
+  bool in_stream_ = false;
+  // Current position in the decompressed data.
+  size_t stream_pos_ = 0;
+};
+
+}  // namespace io
+}  // namespace tfrt
+
+#endif  // TFRT_IO_ZLIB_INPUT_STREAM_H_
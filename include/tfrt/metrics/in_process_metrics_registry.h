@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares a MetricsRegistry that keeps all metrics in memory.
+
+#ifndef TFRT_METRICS_IN_PROCESS_METRICS_REGISTRY_H_
+#define TFRT_METRICS_IN_PROCESS_METRICS_REGISTRY_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "tfrt/metrics/metrics_registry.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+namespace metrics {
+
+// InProcessMetricsRegistry owns all the metrics it creates, and exports their
+// current values with GetSnapshot(). Metrics with the same name are shared:
+// creating a metric that already exists returns the existing one.
+//
+// Updating the metrics never takes a lock: counters are sharded across
+// cache-line aligned atomics to avoid contention between threads, and
+// histograms keep an atomic count per bucket.
+class InProcessMetricsRegistry : public MetricsRegistry {
+ public:
+  struct HistogramSnapshot {
+    // Lower bounds of the buckets, except for the underflow bucket.
+    std::vector<double> bounds;
+    // The number of recorded values per bucket, `bounds.size() + 1` entries.
+    std::vector<int64_t> bucket_counts;
+    int64_t count = 0;
+    double sum = 0;
+  };
+
+  // Metric values at the time of the snapshot, sorted by the metric name.
+  // Metrics are updated concurrently, so values of different metrics are not
+  // guaranteed to be consistent with each other.
+  struct Snapshot {
+    std::map<std::string, int64_t> counters;
+    std::map<std::string, int64_t> int_gauges;
+    std::map<std::string, std::string> string_gauges;
+    std::map<std::string, HistogramSnapshot> histograms;
+
+    // Prints the snapshot one metric per line.
+    void PrintText(raw_ostream& os) const;
+
+    // Prints the snapshot as a JSON object with a member per metric type.
+    void PrintJson(raw_ostream& os) const;
+  };
+
+  InProcessMetricsRegistry();
+  ~InProcessMetricsRegistry() override;
+
+  Gauge<std::string>* NewStringGauge(std::string name) override;
+  Gauge<int64_t>* NewIntGauge(std::string name) override;
+  Counter* NewCounter(std::string name) override;
+  Histogram* NewHistogram(std::string name, const Buckets& buckets) override;
+
+  Snapshot GetSnapshot() const;
+
+ private:
+  class StringGauge;
+  class IntGauge;
+  class ShardedCounter;
+  class AtomicHistogram;
+
+  mutable mutex mu_;
+  llvm::StringMap<std::unique_ptr<StringGauge>> string_gauges_
+      TFRT_GUARDED_BY(mu_);
+  llvm::StringMap<std::unique_ptr<IntGauge>> int_gauges_ TFRT_GUARDED_BY(mu_);
+  llvm::StringMap<std::unique_ptr<ShardedCounter>> counters_
+      TFRT_GUARDED_BY(mu_);
+  llvm::StringMap<std::unique_ptr<AtomicHistogram>> histograms_
+      TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace metrics
+}  // namespace tfrt
+
+#endif  // TFRT_METRICS_IN_PROCESS_METRICS_REGISTRY_H_
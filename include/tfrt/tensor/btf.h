@@ -89,6 +89,11 @@ static_assert(offsetof(TensorHeader, dtype) == 8,
 static_assert(offsetof(TensorHeader, layout) == 9,
               "layout does not start at the correct offset.");
 
+// Magic number which starts the optional CHECKSUM_TABLE that follows the
+// TENSOR_RECORD_OFFSETs in the file header. It reads "BTFCRC32" in little
+// endian byte order.
+constexpr uint64_t kChecksumTableMagic = 0x3233435243465442;
+
 }  // namespace btf
 }  // namespace tfrt
 
@@ -28,6 +28,8 @@
 #include "llvm/Support/Error.h"
 #include "tfrt/dtype/dtype.h"
 #include "tfrt/host_context/async_dispatch.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/host_buffer.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/support/error_util.h"
 #include "tfrt/support/forward_decls.h"
@@ -193,10 +195,64 @@ Expected<std::vector<uint64_t>> ReadBTFOffsets(std::istream* stream);
 Expected<DenseHostTensor> ReadDHTFromBTF(std::istream* stream, uint64_t offset,
                                          HostContext* host);
 
+// MappedBTFFile provides random access to the tensors of a memory mapped
+// BTF-file. The file is mapped and its offset table is parsed once in Open().
+//
+// The DenseHostTensors returned by ReadDHT() point directly into the mapping
+// when their data is suitably aligned, and keep the mapping alive for as long
+// as they do. The mapping is private, so writes to such a tensor are not
+// visible in the file. They are visible in every other tensor read from the
+// same record of this MappedBTFFile, before or after the write, since all of
+// them share the mapping. Copy a tensor before writing to it if that matters.
+class MappedBTFFile {
+ public:
+  static Expected<MappedBTFFile> Open(string_view path);
+
+  size_t num_tensors() const { return offsets_.size(); }
+
+  // Returns true if the file header has a checksum table.
+  bool has_checksums() const { return !checksums_.empty(); }
+
+  // Returns the tensor at `index` as a DHT. The data is copied into a buffer
+  // allocated by `host` only if it is not aligned for its dtype.
+  //
+  // If `verify_checksum` is true and the file has checksums, the record of the
+  // tensor is checked against its checksum before it is returned. Only the
+  // record which is read is checked.
+  Expected<DenseHostTensor> ReadDHT(size_t index, HostContext* host,
+                                    bool verify_checksum = false) const;
+
+ private:
+  MappedBTFFile(RCReference<HostBuffer> buffer, ArrayRef<uint64_t> offsets,
+                ArrayRef<uint32_t> checksums)
+      : buffer_(std::move(buffer)), offsets_(offsets), checksums_(checksums) {}
+
+  // The whole file. The tensors returned by ReadDHT() share this buffer.
+  RCReference<HostBuffer> buffer_;
+  // The TENSOR_RECORD_OFFSETs and TENSOR_CHECKSUMs, which point into
+  // `buffer_`. `checksums_` is empty if the file has no checksum table.
+  ArrayRef<uint64_t> offsets_;
+  ArrayRef<uint32_t> checksums_;
+};
+
 // Writes a BTF-file, with file header (offsets) and tensor records. Currently
 // only supports DenseHostTensors.
 Error WriteTensorsToBTF(std::ostream* stream, ArrayRef<const Tensor*> tensors);
 
+// Writes `tensors` to a BTF-file at `path`. The offsets of all tensor records
+// are computed upfront, and the records are written in parallel with pwrite()
+// by blocking work queue tasks, directly from the tensor buffers.
+//
+// The file header has a checksum table with the masked crc32c of each tensor
+// record, which MappedBTFFile can verify. Readers which do not know about the
+// checksum table skip it, since they only follow the offsets.
+//
+// The returned chain becomes available when the file is completely written,
+// or is set to an error if any record fails to be written.
+AsyncValueRef<Chain> WriteTensorsToBTFFile(std::string path,
+                                           std::vector<DenseHostTensor> tensors,
+                                           HostContext* host);
+
 }  // namespace tfrt
 
 #endif  // TFRT_TENSOR_BTF_UTIL_H_
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Chrome Tracing Consumer
+//
+// This file declares a tracing sink that records activities into per-thread
+// ring buffers and exports them in the Chrome trace event format.
+
+#ifndef TFRT_TRACING_CHROME_TRACING_SINK_H_
+#define TFRT_TRACING_CHROME_TRACING_SINK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/tracing/tracing.h"
+
+namespace tfrt {
+namespace tracing {
+
+// ChromeTracingSink records events and scopes into fixed size per-thread ring
+// buffers. Recording is lock-free and does not allocate memory (besides the
+// name generation): each thread writes only to its own buffer, and when the
+// buffer is full the oldest entries are overwritten.
+//
+// Recorded activities are exported with Flush() as Chrome trace event JSON
+// (https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU)
+// that can be loaded into chrome://tracing or https://ui.perfetto.dev.
+// Tracing events are exported as instant events, and tracing scopes as nested
+// begin/end events of the thread that recorded them.
+class ChromeTracingSink : public TracingSink {
+ public:
+  struct Options {
+    // The number of entries in each per-thread ring buffer. Every event takes
+    // one entry, and every scope takes two. The most recent `buffer_size - 1`
+    // entries of every thread are available for the export.
+    size_t buffer_size = 64 * 1024;
+
+    // If not empty, the recorded activities are written to this file when the
+    // tracing is disabled.
+    std::string output_file;
+  };
+
+  // Activity names longer than this are truncated.
+  static constexpr size_t kMaxNameSize = 110;
+
+  ChromeTracingSink();
+  explicit ChromeTracingSink(Options options);
+  ~ChromeTracingSink() override;
+
+  Error RequestTracing(bool enable) override;
+  void RecordTracingEvent(NameGenerator gen_name) override;
+  void PushTracingScope(NameGenerator gen_name) override;
+  void PopTracingScope() override;
+
+  // Writes all activities recorded since the previous flush to `os` as Chrome
+  // trace event JSON. Can be called concurrently with the recording threads:
+  // entries overwritten while they are being exported are dropped.
+  void Flush(llvm::raw_ostream& os);
+
+  // Writes all activities recorded since the previous flush to `path`.
+  Error Flush(string_view path);
+
+ private:
+  struct Entry;
+  struct ThreadBuffer;
+
+  // Returns the ring buffer of the calling thread.
+  ThreadBuffer* GetThreadBuffer();
+  ThreadBuffer* AddThreadBuffer();
+
+  void Record(char phase, NameGenerator gen_name);
+
+  const Options options_;
+  const uint64_t id_;
+  const std::chrono::steady_clock::time_point start_;
+
+  mutex mu_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace tracing
+}  // namespace tfrt
+
+#endif  // TFRT_TRACING_CHROME_TRACING_SINK_H_
@@ -27,6 +27,7 @@
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/attribute_utils.h"
 #include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/kernel_cache.h"
 #include "tfrt/host_context/kernel_frame.h"
 #include "tfrt/host_context/resource_context.h"
 #include "tfrt/support/forward_decls.h"
@@ -135,6 +136,10 @@ class KernelRunner {
   SmallVector<RCReference<AsyncValue>, 8> arguments_;
   SmallVector<RCReference<AsyncValue>, 8> results_;
 
+  // The runs of the runner are executions of the same kernel, which share the
+  // cache like the executions of a kernel in a BEF function.
+  KernelCache kernel_cache_;
+
   ResourceContext resource_ctx_;
   RequestContextBuilder req_ctx_builder_;
   RCReference<RequestContext> req_ctx_;
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements reading and writing of kernel profiles.
+
+#include "tfrt/bef/kernel_profile.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/support/error_util.h"
+
+namespace tfrt {
+
+static constexpr char kProfileHeader[] = "# tfrt kernel profile v1";
+
+void KernelProfile::Add(string_view location, int64_t count,
+                        int64_t total_ns) {
+  Entry& entry = entries_[location];
+  entry.count += count;
+  entry.total_ns += total_ns;
+}
+
+void KernelProfile::Merge(const KernelProfile& other) {
+  for (const auto& it : other.entries_)
+    Add(it.getKey(), it.getValue().count, it.getValue().total_ns);
+}
+
+const KernelProfile::Entry* KernelProfile::Find(string_view location) const {
+  auto it = entries_.find(location);
+  return it == entries_.end() ? nullptr : &it->getValue();
+}
+
+void KernelProfile::Print(raw_ostream& os) const {
+  std::vector<string_view> locations;
+  locations.reserve(entries_.size());
+  for (const auto& it : entries_) locations.push_back(it.getKey());
+  std::sort(locations.begin(), locations.end());
+
+  os << kProfileHeader << "\n";
+  for (string_view location : locations) {
+    const Entry& entry = entries_.find(location)->getValue();
+    os << entry.count << " " << entry.total_ns << " " << location << "\n";
+  }
+}
+
+Error KernelProfile::WriteToFile(string_view path) const {
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path, ec);
+  if (ec)
+    return MakeStringError("failed to open kernel profile ", path, ": ",
+                           ec.message());
+
+  Print(os);
+  os.close();
+  if (os.has_error()) {
+    ec = os.error();
+    os.clear_error();
+    return MakeStringError("failed to write kernel profile ", path, ": ",
+                           ec.message());
+  }
+  return Error::success();
+}
+
+Expected<KernelProfile> KernelProfile::Parse(string_view text) {
+  KernelProfile profile;
+
+  int line_number = 0;
+  while (!text.empty()) {
+    string_view line;
+    std::tie(line, text) = text.split('\n');
+    ++line_number;
+
+    line = line.trim();
+    if (line.empty() || line.startswith("#")) continue;
+
+    string_view count, total_ns;
+    std::tie(count, line) = line.split(' ');
+    std::tie(total_ns, line) = line.ltrim().split(' ');
+    string_view location = line.ltrim();
+
+    Entry entry;
+    if (count.getAsInteger(10, entry.count) ||
+        total_ns.getAsInteger(10, entry.total_ns) || entry.count < 0 ||
+        entry.total_ns < 0 || location.empty())
+      return MakeStringError("malformed kernel profile at line ", line_number);
+
+    profile.Add(location, entry.count, entry.total_ns);
+  }
+
+  return std::move(profile);
+}
+
+Expected<KernelProfile> KernelProfile::ReadFromFile(string_view path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (!buffer)
+    return MakeStringError("failed to read kernel profile ", path, ": ",
+                           buffer.getError().message());
+
+  auto profile = Parse((*buffer)->getBuffer());
+  if (!profile)
+    return MakeStringError(path, ": ", toString(profile.takeError()));
+  return profile;
+}
+
+}  // namespace tfrt
@@ -45,6 +45,7 @@
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/OperationSupport.h"
 #include "tfrt/bef/bef_encoding.h"
+#include "tfrt/bef/kernel_profile.h"
 #include "tfrt/bef_converter/bef_emitter.h"
 #include "tfrt/compiler/stream_analysis.h"
 #include "tfrt/core_runtime/opdefs/attributes.h"
@@ -609,7 +610,8 @@ constexpr uint32_t BEFFileEmitter::kDummyPseudoKernelLocation;
 // This is the emitter that builds a BEF into an std::vector.
 class BEFModuleEmitter : public BEFFileEmitter {
  public:
-  explicit BEFModuleEmitter(mlir::ModuleOp module) : module_(module) {}
+  BEFModuleEmitter(mlir::ModuleOp module, const KernelProfile* kernel_profile)
+      : module_(module), kernel_profile_(kernel_profile) {}
 
   LogicalResult CollectEntities(bool collect_attribute_types_and_names) {
     return entities_.Collect(module_, collect_attribute_types_and_names);
@@ -627,6 +629,7 @@ class BEFModuleEmitter : public BEFFileEmitter {
 
  private:
   mlir::ModuleOp module_;
+  const KernelProfile* kernel_profile_;
   EntityTable entities_;
   EntityIndex entity_index_;
 };
@@ -731,8 +734,11 @@ void BEFModuleEmitter::EmitTypes() {
 class BEFFunctionEmitter : public BEFFileEmitter {
  public:
   BEFFunctionEmitter(const EntityTable& entities,
-                     const EntityIndex& entity_index)
-      : entities_(entities), entity_index_(entity_index) {}
+                     const EntityIndex& entity_index,
+                     const KernelProfile* kernel_profile)
+      : entities_(entities),
+        entity_index_(entity_index),
+        kernel_profile_(kernel_profile) {}
 
   void EmitFunction(mlir::Region* region, BefLocationEmitter* locations,
                     BEFFileEmitter* attribute_names,
@@ -769,6 +775,7 @@ class BEFFunctionEmitter : public BEFFileEmitter {
 
   const EntityTable& entities_;
   const EntityIndex& entity_index_;
+  const KernelProfile* kernel_profile_;
 };
 
 void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
@@ -810,7 +817,7 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
   // choice to integrate with BEF executor is to perform analysis in MLIRToBEF.
   // Once we make asynchrony explicit at compile-time, we should be able to move
   // this analysis out.
-  compiler::StreamAnalysis stream_analysis(block);
+  compiler::StreamAnalysis stream_analysis(block, kernel_profile_);
 
   // Before we emit all the kernels, we always emit a pseudo kernel (with no
   // kernel_code) that is the entry to the other kernels. Specifically, its
@@ -1046,7 +1053,8 @@ void BEFFunctionEmitter::EmitKernel(mlir::Operation* op,
 void BEFModuleEmitter::EmitFunctions(BefLocationEmitter* locations,
                                      BEFFileEmitter* attribute_names,
                                      BEFFileEmitter* register_types) {
-  BEFFunctionEmitter functions_section(entities_, entity_index_);
+  BEFFunctionEmitter functions_section(entities_, entity_index_,
+                                       kernel_profile_);
 
   if (attribute_names != nullptr)
     attribute_names->EmitVbrInt(entities_.functions.size());
@@ -1101,9 +1109,9 @@ void BEFModuleEmitter::EmitFunctions(BefLocationEmitter* locations,
 //
 // On error, this emits the error message through the MLIR error handler, and
 // returns an empty std:vector.
-BefBuffer ConvertMLIRToBEF(mlir::ModuleOp module,
-                           bool disable_optional_sections) {
-  BEFModuleEmitter emitter(module);
+BefBuffer ConvertMLIRToBEF(mlir::ModuleOp module, bool disable_optional_sections,
+                           const KernelProfile* kernel_profile) {
+  BEFModuleEmitter emitter(module, kernel_profile);
 
   // Build the entities table.
   if (emitter.CollectEntities(!disable_optional_sections) ==
@@ -17,9 +17,14 @@
 // This file implements the registration for the mlir-to-bef converter in MLIR
 // Translate infrastructure.  It opens up an mlir file specified on the command
 // line and converts it to a bef file at specified location.
+#include <string>
+
+#include "llvm/ADT/Optional.h"
 #include "llvm/Support/CommandLine.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
 #include "tfrt/bef/bef_buffer.h"
+#include "tfrt/bef/kernel_profile.h"
 #include "tfrt/bef_converter/mlir_to_bef.h"
 
 static llvm::cl::opt<bool> disable_optional_sections(  // NOLINT
@@ -28,12 +33,30 @@ static llvm::cl::opt<bool> disable_optional_sections(  // NOLINT
                    "types and attribute names."),
     llvm::cl::init(false));
 
+static llvm::cl::opt<std::string> kernel_profile(  // NOLINT
+    "kernel-profile",
+    llvm::cl::desc("Use the kernel costs from the specified kernel profile "
+                   "for the stream assignment."),
+    llvm::cl::init(""));
+
 namespace tfrt {
 
 mlir::LogicalResult MLIRToBEFTranslate(mlir::ModuleOp module,
                                        llvm::raw_ostream& output) {
-  BefBuffer bef_file =
-      tfrt::ConvertMLIRToBEF(module, disable_optional_sections);
+  llvm::Optional<KernelProfile> profile;
+  if (!kernel_profile.empty()) {
+    auto profile_or = KernelProfile::ReadFromFile(kernel_profile);
+    if (!profile_or) {
+      mlir::emitError(module.getLoc())
+          << llvm::toString(profile_or.takeError());
+      return mlir::failure();
+    }
+    profile = std::move(*profile_or);
+  }
+
+  BefBuffer bef_file = tfrt::ConvertMLIRToBEF(
+      module, disable_optional_sections,
+      profile ? profile.getPointer() : nullptr);
   if (bef_file.empty()) return mlir::failure();
 
   // Success!
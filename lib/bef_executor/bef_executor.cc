@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 
@@ -24,11 +25,13 @@
 #include "llvm/ADT/SmallVector.h"
 #include "tfrt/bef/bef_encoding.h"
 #include "tfrt/bef/bef_reader.h"
+#include "tfrt/bef_executor/kernel_profiler.h"
 #include "tfrt/host_context/async_dispatch.h"
 #include "tfrt/host_context/async_value.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_frame.h"
 #include "tfrt/host_context/location.h"
+#include "tfrt/metrics/metrics.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/ref_count.h"
 
@@ -46,6 +49,23 @@ namespace tfrt {
 
 namespace {
 
+// The number of kernels executed by all BEF executors.
+metrics::Counter* GetKernelsExecutedCounter() {
+  static metrics::Counter* counter =
+      metrics::NewCounter("/tfrt/bef_executor/kernels_executed");
+  return counter;
+}
+
+// The time from the start of a BEF function execution until all of its
+// kernels are completed, in microseconds.
+metrics::Histogram* GetFunctionLatencyHistogram() {
+  static metrics::Histogram* histogram = metrics::NewHistogram(
+      "/tfrt/bef_executor/function_latency_us",
+      metrics::Buckets::Exponential(/*scale=*/1, /*growth_factor=*/2,
+                                    /*bucket_count=*/32));
+  return histogram;
+}
+
 // Take one reference to `new_value` and set it in the register. The final
 // AsyncValue inside this register may be different from `new_value` in case
 // that there is an existing indirect async value.
@@ -186,12 +206,16 @@ class BEFExecutor final : public ReferenceCounted<BEFExecutor> {
                       MutableArrayRef<RCReference<AsyncValue>> results);
 
   /// When the last reference to the BEFExecutor is dropped, we deallocate
-  /// ourself.  The memory for this class is managed through the HostAllocator
-  /// managed by the HostContext.
+  /// ourself.  The memory for this class is managed through the request
+  /// allocator (see RequestContext::allocator()).
   void Destroy() {
-    auto host = this->GetHost();
+    // Keep the request context alive until the executor memory is released,
+    // because it might own the allocator.
+    RCReference<RequestContext> request_ctx =
+        FormRef(exec_ctx_.request_ctx());
+    HostAllocator* allocator = request_ctx->allocator();
     this->~BEFExecutor();
-    host->Deallocate<BEFExecutor>(this);
+    allocator->Deallocate<BEFExecutor>(this);
   }
 
  private:
@@ -243,6 +267,8 @@ class BEFExecutor final : public ReferenceCounted<BEFExecutor> {
     return function_info_.kernel_infos.mutable_array();
   }
 
+  KernelCache* kernel_caches() { return function_info_.kernel_caches; }
+
   void DebugPrintError(const BEFKernel& kernel, unsigned kernel_id,
                        AsyncValue* result);
 
@@ -255,6 +281,9 @@ class BEFExecutor final : public ReferenceCounted<BEFExecutor> {
   /// Decoded BEFFunction
   BEFFileImpl::FunctionInfo function_info_;
 
+  /// The time when the function execution started.
+  const std::chrono::steady_clock::time_point start_time_;
+
   RCReference<BEFFileImpl> bef_file_;
 };
 
@@ -441,10 +470,18 @@ void BEFExecutor::ProcessReadyKernel(unsigned kernel_id,
     // error.
     kernel_frame->SetLocation(
         {BefFile()->location_handler(), kernel.kernel_location()});
+    kernel_frame->SetKernelCache(&kernel_caches()[kernel_id]);
 
     // kernel_fn should populate results in kernel_frame with pointers to
     // AsyncValue before it returns.
-    kernel_fn(kernel_frame);
+    if (KernelProfiler* profiler = GetKernelProfiler()) {
+      auto start = std::chrono::steady_clock::now();
+      kernel_fn(kernel_frame);
+      profiler->Record(*BefFile(), kernel.kernel_location(),
+                       std::chrono::steady_clock::now() - start);
+    } else {
+      kernel_fn(kernel_frame);
+    }
   } else {
     // Otherwise, automatically propagate errors to the result values.
     for (size_t i = 0, e = kernel_frame->GetNumResults(); i != e; ++i) {
@@ -554,11 +591,13 @@ void BEFExecutor::ProcessReadyKernels(ReadyKernelQueue& ready_kernel_queue) {
   // The loop below process inline kernels in a LIFO order for cache locality.
   // Outline kernels are enqueued to the concurrent work queue immediately.
 
+  int64_t num_kernels = 0;
   while (!ready_kernel_queue.inline_kernel_ids().empty()) {
     auto kernel_id = ready_kernel_queue.inline_kernel_ids().back();
     ready_kernel_queue.inline_kernel_ids().pop_back();
 
     ProcessReadyKernel(kernel_id, &kernel_frame, ready_kernel_queue);
+    ++num_kernels;
 
     // Switch stream id if there are no inline kernels to process.
     if (ready_kernel_queue.inline_kernel_ids().empty())
@@ -569,6 +608,9 @@ void BEFExecutor::ProcessReadyKernels(ReadyKernelQueue& ready_kernel_queue) {
       EnqueueReadyKernels(ready_kernel_queue.outline_kernel_ids());
     assert(ready_kernel_queue.outline_kernel_ids().empty());
   }
+
+  // Update the counter once per batch of kernels to keep it off the hot path.
+  if (num_kernels > 0) GetKernelsExecutedCounter()->IncrementBy(num_kernels);
 }
 
 //===----------------------------------------------------------------------===//
@@ -576,9 +618,16 @@ void BEFExecutor::ProcessReadyKernels(ReadyKernelQueue& ready_kernel_queue) {
 //===----------------------------------------------------------------------===//
 
 BEFExecutor::BEFExecutor(ExecutionContext exec_ctx, BEFFileImpl* bef_file)
-    : exec_ctx_(std::move(exec_ctx)), bef_file_(FormRef(bef_file)) {}
-
-BEFExecutor::~BEFExecutor() {}
+    : exec_ctx_(std::move(exec_ctx)),
+      start_time_(std::chrono::steady_clock::now()),
+      bef_file_(FormRef(bef_file)) {}
+
+BEFExecutor::~BEFExecutor() {
+  // The executor is destroyed when all the kernels are completed.
+  auto latency = std::chrono::steady_clock::now() - start_time_;
+  GetFunctionLatencyHistogram()->Record(
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
 
 void BEFExecutor::Execute(ArrayRef<AsyncValue*> arguments) {
   // Each KernelInfo::arguments_not_ready to the number of arguments (or one for
@@ -616,16 +665,17 @@ void BEFExecutor::Execute(ExecutionContext exec_ctx, const BEFFunction& fn,
   assert(results.size() == fn.result_types().size() &&
          "incorrect number of results passed to function call");
 
-  HostContext* host = exec_ctx.host();
-  auto* exec_ptr = host->Allocate<BEFExecutor>();
+  // The executor and its per-execution state do not outlive the request, so
+  // they are allocated from the request allocator.
+  HostAllocator* allocator = exec_ctx.request_ctx()->allocator();
+  auto* exec_ptr = allocator->Allocate<BEFExecutor>();
   auto* exec = new (exec_ptr) BEFExecutor(std::move(exec_ctx), bef_file);
 
-  size_t location_offset;
-  SmallVector<size_t, 4> result_regs;
-  bool success = bef_file->ReadFunction(fn.function_offset(), fn.result_types(),
-                                        &location_offset, &exec->function_info_,
-                                        &result_regs, host->allocator());
-  if (!success) return;
+  // The kernel and register information is decoded when the BEF file is
+  // opened, so we only need to initialize the per-execution state here.
+  const BEFFunctionTemplate& function_template = fn.function_template();
+  exec->function_info_.Initialize(function_template, allocator);
+  ArrayRef<size_t> result_regs = function_template.result_regs;
   assert(result_regs.size() == fn.result_types().size());
 
   MutableArrayRef<BEFFileImpl::RegisterInfo> register_array =
@@ -19,6 +19,8 @@
 
 #include "tfrt/bef_executor/bef_file.h"
 
+#include <atomic>
+
 #include "bef_file_impl.h"
 #include "tfrt/bef/bef_encoding.h"
 #include "tfrt/bef/bef_location.h"
@@ -59,15 +61,14 @@ class BEFFileReader : public BEFReader {
       : BEFReader(file), registry_(registry), bef_file_(bef_file) {}
 
   bool ReadNextSection();
-  bool ReadKernelsSection(HostAllocator* host_allocator);
+  bool ReadKernelsSection();
   bool ReadTypesSection();
   bool ReadFunctionIndexSection();
 
  private:
   bool ReadFunctionIndexSectionInternal(
       SmallVectorImpl<FunctionIndex>* function_indices);
-  bool DiagnoseUnknownKernel(size_t kernel_idx, const char* kernel_name,
-                             HostAllocator* host_allocator);
+  bool DiagnoseUnknownKernel(size_t kernel_idx, const char* kernel_name);
 
   // These are things set up at construction time.
   const KernelRegistry& registry_;
@@ -157,8 +158,7 @@ bool BEFFileReader::ReadNextSection() {
 //
 // If we can't find a nice location, we can fallback to a poor location.
 bool BEFFileReader::DiagnoseUnknownKernel(size_t kernel_idx,
-                                          const char* kernel_name,
-                                          HostAllocator* host_allocator) {
+                                          const char* kernel_name) {
   std::string error_message =
       "unknown kernel name '" + std::string(kernel_name) + "'";
 
@@ -173,27 +173,20 @@ bool BEFFileReader::DiagnoseUnknownKernel(size_t kernel_idx,
   // The unknown kernel must be referenced by some function in the program,
   // and each kernel record has location info.  Scan through to see if we can
   // figure out where the reference is coming from.
-  SmallVector<size_t, 4> result_regs;
-
   for (const auto& function_index : function_indices) {
     if (function_index.kind == FunctionKind::kNativeFunction) continue;
 
-    BEFFileImpl::FunctionInfo function_info;
-
-    result_regs.clear();
-    size_t location_offset;
-    bool success = bef_file_->ReadFunction(
-        function_index.function_offset, function_index.results,
-        &location_offset, &function_info, &result_regs, host_allocator);
+    BEFFunctionTemplate function_template;
+    bool success = bef_file_->ReadFunction(function_index.function_offset,
+                                           function_index.results,
+                                           &function_template);
     if (!success) continue;
 
     // Decode all of the kernels to see if any refers to our unknown kernel.
-    MutableArrayRef<BEFFileImpl::KernelInfo> kernel_infos_array =
-        function_info.kernel_infos.mutable_array();
-    for (const auto& kernel_info : kernel_infos_array) {
-      assert(kernel_info.offset % kKernelEntryAlignment == 0);
-      BEFKernel kernel(function_info.kernels.data() +
-                       kernel_info.offset / kKernelEntryAlignment);
+    for (const auto& kernel_template : function_template.kernel_templates) {
+      assert(kernel_template.offset % kKernelEntryAlignment == 0);
+      BEFKernel kernel(function_template.kernels.data() +
+                       kernel_template.offset / kKernelEntryAlignment);
 
       // Okay, we decoded the kernel.  See if this is referring to the
       // current kernel_idx.  If so, we can use its location.  We know that the
@@ -214,7 +207,7 @@ bool BEFFileReader::DiagnoseUnknownKernel(size_t kernel_idx,
 
 // Read the Kernels section from a BEF file, resolving the kernels and
 // returning true on success.  Emit an error and return false on failure.
-bool BEFFileReader::ReadKernelsSection(HostAllocator* host_allocator) {
+bool BEFFileReader::ReadKernelsSection() {
   auto format_error = [&]() -> bool {
     bef_file_->EmitFormatError("invalid Kernels section in BEF file");
     return false;
@@ -250,8 +243,7 @@ bool BEFFileReader::ReadKernelsSection(HostAllocator* host_allocator) {
 
     auto kernel = registry_.GetKernel(kernel_name);
     if (kernel.is<Monostate>()) {
-      return DiagnoseUnknownKernel(bef_file_->kernels_.size(), kernel_name,
-                                   host_allocator);
+      return DiagnoseUnknownKernel(bef_file_->kernels_.size(), kernel_name);
     }
 
     // Otherwise remember it.
@@ -385,6 +377,8 @@ bool BEFFileReader::ReadFunctionIndexSection() {
         auto bef_function = std::make_unique<BEFFunction>(
             name, function_index.arguments, function_index.results,
             function_index.function_offset, bef_file_);
+        // The error has been emitted by BEFFileImpl::ReadFunction().
+        if (!bef_function->Init()) return false;
         bef_file_->functions_.push_back(std::move(bef_function));
         break;
       }
@@ -459,14 +453,30 @@ RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
 
   // Now that we've figured out the contents of the sections, resolve some
   // things.
-  if (!reader.ReadKernelsSection(host_allocator) ||
-      !reader.ReadTypesSection() || !reader.ReadFunctionIndexSection())
+  if (!reader.ReadKernelsSection() || !reader.ReadTypesSection() ||
+      !reader.ReadFunctionIndexSection())
     return {};
 
   // Now that we decoded the whole thing, return the BEFFile to the caller.
   return bef_rc;
 }
 
+RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
+                                   const KernelRegistry& registry,
+                                   ErrorHandler error_handler,
+                                   tfrt::HostAllocator* host_allocator,
+                                   llvm::unique_function<void()> release_file) {
+  auto bef_rc = Open(file, registry, std::move(error_handler), host_allocator);
+  if (!bef_rc) {
+    release_file();
+    return {};
+  }
+
+  static_cast<BEFFileImpl*>(bef_rc.get())->release_file_ =
+      std::move(release_file);
+  return bef_rc;
+}
+
 DecodedLocation BEFLocationHandler::DecodeLocation(Location loc) const {
   return bef_file_->DecodeLocation(loc.data);
 }
@@ -475,11 +485,19 @@ Optional<DebugInfo> BEFLocationHandler::GetDebugInfo(Location loc) const {
   return bef_file_->GetDebugInfo(loc.data);
 }
 
+static uint64_t NextBEFFileId() {
+  static std::atomic<uint64_t> id{0};
+  return id.fetch_add(1, std::memory_order_relaxed);
+}
+
 BEFFileImpl::BEFFileImpl(std::function<void(DecodedDiagnostic)> error_handler)
     : BEFFile(std::make_unique<BEFLocationHandler>(this)),
+      id_(NextBEFFileId()),
       error_handler_(error_handler) {}
 
-BEFFileImpl::~BEFFileImpl() {}
+BEFFileImpl::~BEFFileImpl() {
+  if (release_file_) release_file_();
+}
 
 void BEFFileImpl::EmitFormatError(string_view message) {
   error_handler_(DecodedDiagnostic(message));
@@ -489,10 +507,7 @@ void BEFFileImpl::EmitFormatError(string_view message) {
 // reporting error via EmitFormatError to make the API more natural.
 bool BEFFileImpl::ReadFunction(size_t function_offset,
                                ArrayRef<TypeName> results,
-                               size_t* location_offset,
-                               FunctionInfo* function_info,
-                               SmallVectorImpl<size_t>* result_regs,
-                               HostAllocator* host_allocator) {
+                               BEFFunctionTemplate* function_template) {
   auto format_error = [&]() -> bool {
     EmitFormatError("invalid Function section in BEF file");
     return false;
@@ -504,57 +519,79 @@ bool BEFFileImpl::ReadFunction(size_t function_offset,
 
   // First we have the location info and register info table.
   size_t num_registers;
-  if (!reader.ReadVbrInt(location_offset) || !reader.ReadVbrInt(&num_registers))
+  if (!reader.ReadVbrInt(&function_template->location_offset) ||
+      !reader.ReadVbrInt(&num_registers))
     return format_error();
 
-  function_info->register_infos.resize(num_registers, host_allocator);
-  auto* register_info_ptr =
-      function_info->register_infos.mutable_array().data();
-  unsigned register_idx = 0;
-  while (num_registers--) {
+  auto& register_user_counts = function_template->register_user_counts;
+  register_user_counts.reserve(num_registers);
+  for (size_t register_idx = 0; register_idx < num_registers; ++register_idx) {
     size_t user_count;
     if (!reader.ReadVbrInt(&user_count)) return format_error();
-    new (register_info_ptr + register_idx) RegisterInfo(user_count);
-    ++register_idx;
+    register_user_counts.push_back(user_count);
   }
 
   // Next we have the kernel index table.
   size_t num_kernels;
   if (!reader.ReadVbrInt(&num_kernels)) return format_error();
 
-  function_info->kernel_infos.resize(num_kernels, host_allocator);
-  auto* kernel_info_ptr = function_info->kernel_infos.mutable_array().data();
-  unsigned kernel_idx = 0;
-  while (num_kernels--) {
+  auto& kernel_templates = function_template->kernel_templates;
+  kernel_templates.reserve(num_kernels);
+  for (size_t kernel_idx = 0; kernel_idx < num_kernels; ++kernel_idx) {
     size_t offset, num_operands, stream_id;
     if (!reader.ReadVbrInt(&offset) || !reader.ReadVbrInt(&num_operands) ||
         !reader.ReadVbrInt(&stream_id))
       return format_error();
-    new (kernel_info_ptr + kernel_idx)
-        KernelInfo(offset, stream_id, num_operands);
-    ++kernel_idx;
+    kernel_templates.push_back(
+        {static_cast<unsigned>(offset), static_cast<unsigned>(stream_id),
+         static_cast<unsigned>(num_operands)});
   }
+  function_template->kernel_caches.reset(new KernelCache[num_kernels]);
 
   // Read the result registers.
-  result_regs->reserve(results.size());
+  auto& result_regs = function_template->result_regs;
+  result_regs.reserve(results.size());
   for (unsigned i = 0, e = results.size(); i != e; ++i) {
     size_t result_reg;
     if (!reader.ReadVbrInt(&result_reg) || result_reg >= num_registers)
       return format_error();
-    result_regs->push_back(result_reg);
+    result_regs.push_back(result_reg);
   }
 
   // Kernels are aligned to kKernelEntryAlignment.
   if (!reader.ReadAlignment(kKernelEntryAlignment)) return format_error();
 
   // We found the start of our kernel section.
-  function_info->kernels = llvm::makeArrayRef(
+  function_template->kernels = llvm::makeArrayRef(
       reinterpret_cast<const uint32_t*>(reader.file().begin()),
       reader.file().size() / kKernelEntryAlignment);
 
   return true;
 }
 
+void BEFFileImpl::FunctionInfo::Initialize(
+    const BEFFunctionTemplate& function_template,
+    HostAllocator* host_allocator) {
+  kernels = function_template.kernels;
+
+  const auto& register_user_counts = function_template.register_user_counts;
+  register_infos.resize(register_user_counts.size(), host_allocator);
+  auto* register_info_ptr = register_infos.mutable_array().data();
+  for (size_t i = 0, e = register_user_counts.size(); i != e; ++i)
+    new (register_info_ptr + i) RegisterInfo(register_user_counts[i]);
+
+  const auto& kernel_templates = function_template.kernel_templates;
+  kernel_infos.resize(kernel_templates.size(), host_allocator);
+  auto* kernel_info_ptr = kernel_infos.mutable_array().data();
+  for (size_t i = 0, e = kernel_templates.size(); i != e; ++i) {
+    const auto& kernel_template = kernel_templates[i];
+    new (kernel_info_ptr + i)
+        KernelInfo(kernel_template.offset, kernel_template.stream_id,
+                   kernel_template.num_operands);
+  }
+  kernel_caches = function_template.kernel_caches.get();
+}
+
 // Given an offset into locations_section_, decode it and return
 // a DecodedDiagnostic.
 DecodedLocation BEFFileImpl::DecodeLocation(size_t location_position_offset) {
@@ -596,6 +633,12 @@ const Function* BEFFile::GetFunction(string_view function_name) const {
   return impl->functions_[it->second].get();
 }
 
+bool BEFFunction::Init() {
+  assert(function_template_.kernels.empty());
+  return bef_file_->ReadFunction(function_offset_, result_types(),
+                                 &function_template_);
+}
+
 Expected<std::unique_ptr<SyncBEFFunction>> SyncBEFFunction::Create(
     string_view name, ArrayRef<TypeName> arguments, ArrayRef<TypeName> results,
     size_t function_offset, BEFFileImpl* bef_file) {
@@ -671,6 +714,7 @@ Error SyncBEFFunction::Init() {
 
     kernel_offsets_.push_back(offset);
   }
+  kernel_caches_.reset(new KernelCache[kernel_offsets_.size()]);
 
   // Read the result registers.
   size_t num_results = result_types().size();
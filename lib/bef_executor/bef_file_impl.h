@@ -19,6 +19,7 @@
 #ifndef TFRT_LIB_BEF_EXECUTOR_BEF_FILE_IMPL_H_
 #define TFRT_LIB_BEF_EXECUTOR_BEF_FILE_IMPL_H_
 
+#include <memory>
 #include <type_traits>
 
 #include "llvm/ADT/ArrayRef.h"
@@ -28,6 +29,7 @@
 #include "llvm/Support/Error.h"
 #include "tfrt/bef_executor/bef_file.h"
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/kernel_cache.h"
 #include "tfrt/host_context/kernel_registry.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/native_function.h"
@@ -98,6 +100,33 @@ class BEFInfoArray {
   HostArray<InfoT> host_array_;
 };
 
+// Immutable information about a BEFFunction decoded from the Functions section
+// of a BEF file. It is decoded once when the BEF file is opened and cached in
+// the BEFFunction, and every execution initializes its mutable state (see
+// BEFFileImpl::FunctionInfo) from it instead of re-reading the BEF file.
+struct BEFFunctionTemplate {
+  struct KernelTemplate {
+    unsigned offset;
+    unsigned stream_id;
+    unsigned num_operands;
+  };
+
+  // The offset of the function location in the LocationPositions section.
+  size_t location_offset = 0;
+  // This ArrayRef contains kernel entries of all kernels of this function.
+  ArrayRef<uint32_t> kernels;
+  // The number of uses of each register, indexed by the register number.
+  SmallVector<unsigned, 24> register_user_counts;
+  // The offset, stream id and number of operands of each kernel, indexed by
+  // the kernel number.
+  SmallVector<KernelTemplate, 8> kernel_templates;
+  // This is an array of register index for the result registers.
+  SmallVector<size_t, 4> result_regs;
+  // The caches of the kernels, indexed by the kernel number. Unlike the rest of
+  // the template, they are filled in by the executions.
+  std::unique_ptr<KernelCache[]> kernel_caches;
+};
+
 // This class implements Function for BEF files.
 class BEFFunction : public Function {
  public:
@@ -110,11 +139,23 @@ class BEFFunction : public Function {
   BEFFunction(BEFFunction&& other)
       : Function(std::move(other)),
         function_offset_(other.function_offset_),
-        bef_file_(other.bef_file_) {}
+        bef_file_(other.bef_file_),
+        function_template_(std::move(other.function_template_)) {}
 
   size_t function_offset() const { return function_offset_; }
   BEFFileImpl* bef_file() const { return bef_file_; }
 
+  // Return the decoded kernel and register information of this function. It
+  // is only valid after a successful call to Init().
+  const BEFFunctionTemplate& function_template() const {
+    return function_template_;
+  }
+
+  // Read the register and kernel information for the function and cache it in
+  // function_template_. On error, an error is emitted through the BEF file
+  // error handler and false is returned.
+  bool Init();
+
   void Execute(const ExecutionContext& exec_ctx,
                ArrayRef<AsyncValue*> arguments,
                MutableArrayRef<RCReference<AsyncValue>> results) const override;
@@ -131,6 +172,10 @@ class BEFFunction : public Function {
 
   size_t function_offset_;
   BEFFileImpl* bef_file_;
+
+  // Decoded kernel and register information, populated by Init(). This is not
+  // used by SyncBEFFunction, which decodes its own information.
+  BEFFunctionTemplate function_template_;
 };
 
 // This class implements SyncFunction for BEF files.
@@ -176,6 +221,11 @@ class SyncBEFFunction final : public BEFFunction {
   // Return an array of register index for the result registers.
   ArrayRef<uint32_t> result_regs() const { return result_regs_; }
 
+  // Return the cache of the kernel with the given kernel number.
+  KernelCache* kernel_cache(size_t kernel_id) const {
+    return &kernel_caches_[kernel_id];
+  }
+
  private:
   SyncBEFFunction(string_view name, ArrayRef<TypeName> arguments,
                   ArrayRef<TypeName> results, size_t function_offset,
@@ -202,6 +252,10 @@ class SyncBEFFunction final : public BEFFunction {
 
   // This is an array of register index for the result registers.
   SmallVector<uint32_t, 4> result_regs_;
+
+  // The caches of the kernels, indexed by the kernel number like
+  // kernel_offsets_.
+  std::unique_ptr<KernelCache[]> kernel_caches_;
 };
 
 class BEFFileImpl;
@@ -249,7 +303,8 @@ class BEFFileImpl : public BEFFile {
   // where to find each kernel in the kernels section, and to know how many
   // arguments are still waiting to come in before the kernel can start.
   //
-  // This struct is defined here, because ReadFunction() below will populate it.
+  // This struct is defined here, because FunctionInfo::Initialize() below will
+  // populate it.
   struct KernelInfo {
     unsigned offset;
     unsigned stream_id;
@@ -269,34 +324,37 @@ class BEFFileImpl : public BEFFile {
   using RegisterInfoArray = BEFInfoArray<BEFFileImpl::RegisterInfo, 24>;
   using KernelInfoArray = BEFInfoArray<BEFFileImpl::KernelInfo, 8>;
 
-  // Decoded BEFFunction information.
+  // Per-execution state of a BEFFunction.
   struct FunctionInfo {
     // This ArrayRef contains kernel entries of all kernels of this function.
     ArrayRef<uint32_t> kernels;
-    // This is an array of descriptors for all of the kernels in this function,
-    // indexed by the kernel number.
-    RegisterInfoArray register_infos;
     // This is an array of descriptors for all of our registers, indexed by
     // their register number.
+    RegisterInfoArray register_infos;
+    // This is an array of descriptors for all of the kernels in this function,
+    // indexed by the kernel number.
     KernelInfoArray kernel_infos;
+    // The caches of the kernels, which are owned by the BEFFunction and shared
+    // by all its executions.
+    KernelCache* kernel_caches = nullptr;
+
+    // Initialize the info arrays from the decoded `function_template`.
+    // `host_allocator` is used for the heap-allocated buffer that backs info
+    // arrays if they are too large to be inlined.
+    void Initialize(const BEFFunctionTemplate& function_template,
+                    HostAllocator* host_allocator);
   };
 
-  // Decode the specified BEFFunction into the FunctionInfo. `host_allocator` is
-  // used for the heap-allocated buffer that backs info arrays in FunctionInfo.
+  // Decode the BEFFunction at `function_offset` in the Functions section into
+  // `function_template`.
   //
   // On error, an error is emitted and false is returned.
   //
-  // ReadFunction is invoked for every BEFFunction execution. We can consider
-  // caching the kernel and register information in the BEFFunction object to
-  // avoid repeadly reading the same information from the BEF file. However, in
-  // the current implementation, we couple BEFExecutor states, e.g. AsyncValue
-  // for RegisterInfo, with the function reading. Caching kernel and register
-  // information would require us to avoid such coupling which can adversely
-  // affect the performance.
+  // This is invoked once per BEFFunction when the BEF file is opened. The
+  // decoded template is immutable and shared by all executions of the
+  // function, which only copy the initial register and kernel states from it.
   bool ReadFunction(size_t function_offset, ArrayRef<TypeName> results,
-                    size_t* location_offset, FunctionInfo* function_info,
-                    SmallVectorImpl<size_t>* result_regs,
-                    HostAllocator* host_allocator);
+                    BEFFunctionTemplate* function_template);
 
   // Given an offset into the LocationPositions section, decode it and return
   // a DecodedDiagnostic.
@@ -324,8 +382,16 @@ class BEFFileImpl : public BEFFile {
 
   ArrayRef<uint8_t> function_section() const { return function_section_; }
 
+  // The id of the BEF file that is unique in the process. Unlike the address of
+  // the BEF file, it is never reused after the BEF file is destroyed.
+  const uint64_t id_;
+
   ErrorHandler error_handler_;
 
+  // Releases the BEF file data when the BEFFile is destroyed, if the BEFFile
+  // owns it.
+  llvm::unique_function<void()> release_file_;
+
   ArrayRef<uint8_t> string_section_;
   ArrayRef<uint8_t> attribute_section_;
   ArrayRef<uint8_t> kernels_section_;
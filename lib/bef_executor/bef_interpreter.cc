@@ -60,6 +60,7 @@ class BEFInterpreterImpl final {
     // Registers that are retired after the execution of this kernel.
     // This refers to a segment in retired_register_pool_.
     ArrayRef<Value*> retired_regs;
+    KernelCache* kernel_cache;
   };
 
   // Set up the data for each kernel.
@@ -160,6 +161,7 @@ void BEFInterpreterImpl::SetupKernelEntries() {
     kernel_entry.kernel_fn =
         func_.bef_file()->GetSyncKernel(kernel.kernel_code());
     assert(kernel_entry.kernel_fn != nullptr);
+    kernel_entry.kernel_cache = func_.kernel_cache(kernel_entries_.size() - 1);
 
     int retired_reg_start = retired_register_pool_.size();
 
@@ -256,6 +258,7 @@ Error BEFInterpreterImpl::Execute(const ExecutionContext& exec_ctx,
         attribute_pool_.data() + kernel_entry.attribute_start,
         kernel_entry.num_attributes));
     kernel_frame.SetResults(kernel.GetResults());
+    kernel_frame.SetKernelCache(kernel_entry.kernel_cache);
 
     kernel_entry.kernel_fn(&kernel_frame);
 
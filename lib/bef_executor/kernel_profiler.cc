@@ -0,0 +1,132 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_profiler.cc - Kernel Profiler for the BEF Executor ----------===//
+//
+// This file implements the per-kernel wall time profiler of the BEF executor.
+
+#include "tfrt/bef_executor/kernel_profiler.h"
+
+#include <atomic>
+#include <string>
+#include <utility>
+
+#include "bef_file_impl.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/bef/bef_location.h"
+#include "tfrt/host_context/location.h"
+
+namespace tfrt {
+
+// Profile of the kernels executed by one thread. The table is written only by
+// its owning thread, and the mutex is contended only by GetProfile().
+struct KernelProfiler::ThreadTable {
+  struct Entry {
+    std::string location;
+    KernelProfile::Entry profile;
+  };
+
+  mutex mu;
+  // Entries indexed by the BEF file id and the location offset in the file.
+  // Locations are decoded once, when a kernel is recorded for the first time.
+  llvm::DenseMap<std::pair<uint64_t, size_t>, Entry> entries
+      TFRT_GUARDED_BY(mu);
+};
+
+static uint64_t NextProfilerId() {
+  static std::atomic<uint64_t> id{0};
+  return id.fetch_add(1, std::memory_order_relaxed);
+}
+
+KernelProfiler::KernelProfiler() : id_(NextProfilerId()) {}
+
+KernelProfiler::~KernelProfiler() = default;
+
+KernelProfiler::ThreadTable* KernelProfiler::GetThreadTable() {
+  // Cache the table of the last used profiler. Profilers are identified by a
+  // unique id rather than by address, so that a stale table of a destroyed
+  // profiler is never used by a new profiler allocated at the same address.
+  struct CachedTable {
+    uint64_t profiler_id = ~uint64_t{0};
+    ThreadTable* table = nullptr;
+  };
+  static thread_local CachedTable cached;
+
+  if (cached.profiler_id != id_) {
+    mutex_lock lock(mu_);
+    tables_.push_back(std::make_unique<ThreadTable>());
+    cached.table = tables_.back().get();
+    cached.profiler_id = id_;
+  }
+  return cached.table;
+}
+
+// Returns the location of the kernel as printed by the BEF executor
+// diagnostics, or an empty string if the kernel location is unknown.
+static std::string GetKernelLocation(const BEFFileImpl& bef_file,
+                                     size_t location_offset) {
+  if (location_offset >= bef_file.locations_section_.size()) return {};
+
+  BefLocation loc(bef_file.locations_section_.data() + location_offset);
+  if (loc.isa<BefUnknownLocation>()) return {};
+
+  std::string location;
+  llvm::raw_string_ostream os(location);
+  os << DecodeBefLocation(bef_file.location_strings_section_, loc);
+  return os.str();
+}
+
+void KernelProfiler::Record(const BEFFile& bef_file, size_t location_offset,
+                            std::chrono::nanoseconds duration) {
+  const auto& bef_file_impl = static_cast<const BEFFileImpl&>(bef_file);
+  ThreadTable* table = GetThreadTable();
+
+  mutex_lock lock(table->mu);
+  auto it = table->entries.try_emplace({bef_file_impl.id_, location_offset});
+  ThreadTable::Entry& entry = it.first->second;
+  if (it.second)
+    entry.location = GetKernelLocation(bef_file_impl, location_offset);
+
+  entry.profile.count += 1;
+  entry.profile.total_ns += duration.count();
+}
+
+KernelProfile KernelProfiler::GetProfile() const {
+  KernelProfile profile;
+
+  mutex_lock lock(mu_);
+  for (const auto& table : tables_) {
+    mutex_lock table_lock(table->mu);
+    for (const auto& it : table->entries) {
+      const ThreadTable::Entry& entry = it.second;
+      if (entry.location.empty()) continue;
+      profile.Add(entry.location, entry.profile.count, entry.profile.total_ns);
+    }
+  }
+
+  return profile;
+}
+
+static std::atomic<KernelProfiler*> kernel_profiler{nullptr};
+
+void SetKernelProfiler(KernelProfiler* profiler) {
+  kernel_profiler.store(profiler, std::memory_order_release);
+}
+
+KernelProfiler* GetKernelProfiler() {
+  return kernel_profiler.load(std::memory_order_acquire);
+}
+
+}  // namespace tfrt
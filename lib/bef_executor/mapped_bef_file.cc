@@ -0,0 +1,110 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- mapped_bef_file.cc - Memory mapped BEF files -----------------------===//
+//
+// This file implements BEFFile::OpenMapped().
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <system_error>
+
+#include "bef_file_impl.h"
+#include "llvm/Support/FileSystem.h"
+#include "tfrt/bef/bef_buffer.h"
+#include "tfrt/bef_executor/bef_file.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/support/string_util.h"
+
+namespace tfrt {
+
+namespace fs = ::llvm::sys::fs;
+
+// Passes the access pattern `hint` for the `section` memory to the kernel.
+static void AdviseSection(ArrayRef<uint8_t> section, BEFFileAccessHint hint) {
+#ifndef _WIN32
+  if (section.empty() || hint == BEFFileAccessHint::kNormal) return;
+
+  // madvise() requires a page aligned address.
+  const uintptr_t page_size = fs::mapped_file_region::alignment();
+  uintptr_t begin = reinterpret_cast<uintptr_t>(section.data());
+  uintptr_t end = begin + section.size();
+  begin &= ~(page_size - 1);
+
+  int advice =
+      hint == BEFFileAccessHint::kWillNeed ? MADV_WILLNEED : MADV_RANDOM;
+  // The advice is only a hint, ignore errors.
+  (void)madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+#endif
+}
+
+RCReference<BEFFile> BEFFile::OpenMapped(string_view path,
+                                         const KernelRegistry& registry,
+                                         ErrorHandler error_handler,
+                                         HostAllocator* host_allocator,
+                                         const BEFFileMapOptions& options) {
+  auto emit_error = [&](string_view message, std::error_code ec) {
+    error_handler(DecodedDiagnostic(
+        StrCat("failed to ", message, " BEF file ", path, ": ", ec.message())));
+    return RCReference<BEFFile>();
+  };
+
+  int fd;
+  if (std::error_code ec = fs::openFileForRead(path, fd))
+    return emit_error("open", ec);
+  fs::file_t file = fs::convertFDToNativeFile(fd);
+
+  fs::file_status status;
+  if (std::error_code ec = fs::status(fd, status)) {
+    fs::closeFile(file);
+    return emit_error("stat", ec);
+  }
+
+  if (status.getSize() == 0) {
+    fs::closeFile(file);
+    error_handler(DecodedDiagnostic(StrCat("BEF file ", path, " is empty")));
+    return {};
+  }
+
+  // The mapping stays valid after the file is closed.
+  std::error_code ec;
+  auto region = std::make_unique<fs::mapped_file_region>(
+      file, fs::mapped_file_region::readonly, status.getSize(), /*offset=*/0,
+      ec);
+  fs::closeFile(file);
+  if (ec) return emit_error("mmap", ec);
+
+  // Mappings are page aligned, which satisfies the BEF alignment requirement.
+  static_assert(GetRequiredBefAlignment() <= 4096,
+                "BEF alignment must not exceed the page size");
+
+  ArrayRef<uint8_t> data(reinterpret_cast<const uint8_t*>(region->const_data()),
+                         region->size());
+  auto bef_rc =
+      Open(data, registry, std::move(error_handler), host_allocator,
+           [region = std::move(region)]() mutable { region.reset(); });
+  if (!bef_rc) return {};
+
+  auto* bef_impl = static_cast<BEFFileImpl*>(bef_rc.get());
+  AdviseSection(bef_impl->attribute_section_, options.attributes_hint);
+  AdviseSection(bef_impl->kernels_section_, options.kernels_hint);
+
+  return bef_rc;
+}
+
+}  // namespace tfrt
@@ -42,6 +42,7 @@
 #include "tfrt/host_context/kernel_registry.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/profiled_allocator.h"
+#include "tfrt/host_context/thread_caching_allocator.h"
 #include "tfrt/host_context/resource_context.h"
 #include "tfrt/host_context/value.h"
 #include "tfrt/metrics/common_metrics.h"
@@ -77,17 +78,23 @@ int RunBefExecutor(
   TFRT_TRACE_SCOPE(Default, "Bef Executor");
   metrics::AddTFRTVersionMetric();
 
-  // Set up the input file.
-  std::string error_message;
-  auto file = mlir::openInputFile(run_config.input_filename, &error_message);
-  if (!file) {
-    llvm::errs() << error_message << "\n";
-    return 1;
-  }
+  // Regular files are opened with BEFFile::OpenMapped() below, which maps the
+  // file instead of reading it. Only the input from stdin is read here.
+  const bool map_bef_file = run_config.input_filename != "-";
 
-  // Tell source_mgr about this buffer, which is what the parser will pick up.
   llvm::SourceMgr source_mgr;
-  source_mgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+  if (!map_bef_file) {
+    // Set up the input file.
+    std::string error_message;
+    auto file = mlir::openInputFile(run_config.input_filename, &error_message);
+    if (!file) {
+      llvm::errs() << error_message << "\n";
+      return 1;
+    }
+
+    // Tell source_mgr about this buffer, which is what the parser will pick up.
+    source_mgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+  }
 
   // Parse the input file.
   mlir::MLIRContext context;
@@ -97,7 +104,10 @@ int RunBefExecutor(
   auto decoded_diagnostic_handler = [&](const DecodedDiagnostic& diag) {
     std::string message = "runtime error: " + diag.message;
 
-    if (diag.location->is<FileLineColLocation>()) {
+    if (!diag.location) {
+      // E.g. the BEF file could not be opened.
+      emitError(mlir::UnknownLoc::get(&context)) << message;
+    } else if (diag.location->is<FileLineColLocation>()) {
       auto decoded_loc = diag.location->get<FileLineColLocation>();
       auto loc = mlir::FileLineColLoc::get(
           &context, decoded_loc.filename, decoded_loc.line, decoded_loc.column);
@@ -132,21 +142,27 @@ int RunBefExecutor(
       host_allocator = CreateMallocAllocator();
       host_allocator = CreateLeakCheckAllocator(std::move(host_allocator));
       tfrt::outs() << "Choosing memory leak check allocator.\n";
+      break;
+    case HostAllocatorType::kThreadCaching:
+      host_allocator = CreateThreadCachingAllocator();
+      tfrt::outs() << "Choosing thread caching allocator.\n";
+      break;
   }
   tfrt::outs().flush();
 
-  // Dig the bytes out of the SourceMgr.
-  auto buffer =
-      source_mgr.getMemoryBuffer(source_mgr.getMainFileID())->getBuffer();
+  // Dig the bytes of the input from stdin out of the SourceMgr.
+  llvm::StringRef buffer;
+  if (!map_bef_file) {
+    buffer =
+        source_mgr.getMemoryBuffer(source_mgr.getMainFileID())->getBuffer();
+  }
 
-  // Handle BefBuffer alignment.
-  //   mlir::openInputFile() should return 4KB aligned buffer when a file is
-  //   memory-mapped. When the returned buffer is not aligned by 4KB, it could
-  //   be from stdin by pipe operator.
-  //   The following logic create an aligned buffer (BefBuffer),
-  //   and copy the buffer contents.
+  // Handle BefBuffer alignment for the input from stdin.
+  //   When the buffer read from stdin is not aligned, the following logic
+  //   create an aligned buffer (BefBuffer), and copy the buffer contents.
   //   The original buffer cannot be released because of source_mgr_handler.
-  llvm::ArrayRef<uint8_t> buffer_arr;
+  llvm::ArrayRef<uint8_t> buffer_arr(
+      reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
   BefBuffer aligned_bef_buffer;
   if (reinterpret_cast<uint64_t>(buffer.data()) % GetRequiredBefAlignment()) {
     aligned_bef_buffer.resize(buffer.size());
@@ -154,9 +170,6 @@ int RunBefExecutor(
     buffer_arr = llvm::ArrayRef<uint8_t>(
         reinterpret_cast<const uint8_t*>(aligned_bef_buffer.data()),
         aligned_bef_buffer.size());
-  } else {
-    buffer_arr = llvm::ArrayRef<uint8_t>(
-        reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
   }
 
   std::unique_ptr<ConcurrentWorkQueue> work_queue =
@@ -208,8 +221,13 @@ int RunBefExecutor(
     }
   }
 
-  auto bef(BEFFile::Open(buffer_arr, host->GetKernelRegistry(),
-                         decoded_diagnostic_handler, host->allocator()));
+  auto bef = map_bef_file
+                 ? BEFFile::OpenMapped(run_config.input_filename,
+                                       host->GetKernelRegistry(),
+                                       decoded_diagnostic_handler,
+                                       host->allocator())
+                 : BEFFile::Open(buffer_arr, host->GetKernelRegistry(),
+                                 decoded_diagnostic_handler, host->allocator());
 
   if (!bef) {
     return mlir::failed(source_mgr_handler.verify());
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This implements FuseCwiseOpsPass that fuses chains of coefficient wise
+// Tensorflow operations executed on the CPU op handler into a single
+// tf._FusedCwise operation.
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Pass/Pass.h"
+#include "tfrt/core_runtime/opdefs/core_runtime.h"
+
+namespace tfrt {
+namespace compiler {
+namespace {
+
+// Coefficient wise operations supported by the tf._FusedCwise CPU kernel.
+enum class CwiseKind { kNotFusible, kUnary, kBinary, kCommutativeBinary };
+
+CwiseKind GetCwiseKind(llvm::StringRef op_name) {
+  return llvm::StringSwitch<CwiseKind>(op_name)
+      .Case("tf.AddV2", CwiseKind::kCommutativeBinary)
+      .Case("tf.Mul", CwiseKind::kCommutativeBinary)
+      .Case("tf.Sub", CwiseKind::kBinary)
+      .Case("tf.RealDiv", CwiseKind::kBinary)
+      .Cases("tf.Relu", "tf.Sigmoid", "tf.Log", "tf.Log1p", "tf.Rsqrt",
+             CwiseKind::kUnary)
+      .Default(CwiseKind::kNotFusible);
+}
+
+// Returns true if the op handler is the one registered as "cpu", because
+// tf._FusedCwise is only implemented by the CPU op handler.
+bool IsCpuOpHandler(mlir::Value op_handler) {
+  mlir::Operation* def = op_handler.getDefiningOp();
+  if (!def || def->getName().getStringRef() != "corert.get_op_handler")
+    return false;
+  auto name = def->getAttrOfType<mlir::StringAttr>("op_handler_name");
+  return name && name.getValue() == "cpu";
+}
+
+// Returns true if the operation has the number of operands of its kind.
+bool HasCwiseArity(corert::ExecuteOp op) {
+  const size_t arity = GetCwiseKind(op.op_name()) == CwiseKind::kUnary ? 1 : 2;
+  return op.operands().size() == arity;
+}
+
+// Returns true if the operation can be fused, and sets `dtype` to its `T`
+// attribute, or to a null attribute if the operation doesn't specify it.
+bool IsFusible(corert::ExecuteOp op, mlir::Attribute* dtype) {
+  if (GetCwiseKind(op.op_name()) == CwiseKind::kNotFusible) return false;
+  if (op.results().size() != 1 || !HasCwiseArity(op)) return false;
+  if (!op.op_func_attrs().empty() || !IsCpuOpHandler(op.op_handler()))
+    return false;
+
+  llvm::SmallVector<std::pair<llvm::StringRef, mlir::Attribute>, 4> attrs;
+  op.getOpAttrs(&attrs);
+  *dtype = nullptr;
+  for (auto& attr : attrs) {
+    if (attr.first != "T") return false;
+    *dtype = attr.second;
+  }
+  return true;
+}
+
+// An operation of a fusion chain, and its operand that is not the result of
+// the previous operation in the chain (none for the first operation and for
+// unary operations).
+struct ChainOp {
+  corert::ExecuteOp op;
+  mlir::Value operand;
+};
+
+// Returns true if the `next` operation can take `value` as its lhs, and sets
+// `operand` to its other operand.
+bool CanTakeAsLhs(corert::ExecuteOp next, mlir::Value value,
+                  mlir::Value* operand) {
+  auto operands = next.operands();
+  switch (GetCwiseKind(next.op_name())) {
+    case CwiseKind::kNotFusible:
+      return false;
+    case CwiseKind::kUnary:
+      *operand = nullptr;
+      return true;
+    case CwiseKind::kBinary:
+      if (operands[0] != value || operands[1] == value) return false;
+      *operand = operands[1];
+      return true;
+    case CwiseKind::kCommutativeBinary:
+      // Operands are swapped if the value is the rhs.
+      if (operands[0] == operands[1]) return false;
+      *operand = operands[0] == value ? operands[1] : operands[0];
+      return true;
+  }
+  return false;
+}
+
+class FuseCwiseOpsPass
+    : public mlir::PassWrapper<FuseCwiseOpsPass,
+                               mlir::OperationPass<mlir::FuncOp>> {
+ public:
+  llvm::StringRef getArgument() const final { return "tfrt-fuse-cwise"; }
+
+  llvm::StringRef getDescription() const final {
+    return "Fuse chains of coefficient wise operations executed on the CPU op "
+           "handler into tf._FusedCwise operations";
+  }
+
+  void runOnOperation() override {
+    llvm::SmallVector<corert::ExecuteOp, 16> ops;
+    getOperation().walk([&](corert::ExecuteOp op) { ops.push_back(op); });
+
+    // Operations that are already part of a fusion chain.
+    llvm::SmallPtrSet<mlir::Operation*, 16> fused;
+
+    for (corert::ExecuteOp head : ops) {
+      if (fused.count(head.getOperation())) continue;
+
+      mlir::Attribute dtype;
+      if (!IsFusible(head, &dtype)) continue;
+
+      llvm::SmallVector<ChainOp, 4> chain = {{head, nullptr}};
+
+      // Extend the chain while the result of the last operation is used only
+      // by the next fusible operation with the same op handler and dtype.
+      while (true) {
+        mlir::Value value = chain.back().op->getResult(0);
+        if (!value.hasOneUse()) break;
+
+        auto next = llvm::dyn_cast<corert::ExecuteOp>(*value.user_begin());
+        if (!next || next->getBlock() != head->getBlock() ||
+            next.op_handler() != head.op_handler())
+          break;
+
+        mlir::Attribute next_dtype;
+        if (!IsFusible(next, &next_dtype) || next_dtype != dtype) break;
+
+        mlir::Value operand;
+        if (!CanTakeAsLhs(next, value, &operand)) break;
+
+        chain.push_back({next, operand});
+      }
+
+      if (chain.size() < 2) continue;
+
+      for (auto& chain_op : chain) fused.insert(chain_op.op.getOperation());
+      Fuse(chain, dtype);
+    }
+  }
+
+ private:
+  // Replaces the chain with a tf._FusedCwise operation at the position of the
+  // last operation. All operands of the chain are defined before the last
+  // operation, because they are defined in the same block before their users.
+  void Fuse(llvm::ArrayRef<ChainOp> chain, mlir::Attribute dtype) {
+    corert::ExecuteOp head = chain.front().op;
+    corert::ExecuteOp last = chain.back().op;
+
+    mlir::OpBuilder builder(last);
+
+    llvm::SmallVector<mlir::Value, 4> operands(head.operands().begin(),
+                                               head.operands().end());
+    llvm::SmallVector<mlir::Attribute, 4> fused_ops;
+    for (auto& chain_op : chain) {
+      if (chain_op.operand) operands.push_back(chain_op.operand);
+      llvm::StringRef op_name = chain_op.op.op_name();
+      op_name.consume_front("tf.");
+      fused_ops.push_back(builder.getStringAttr(op_name));
+    }
+
+    llvm::SmallVector<std::pair<llvm::StringRef, mlir::Attribute>, 2> op_attrs;
+    if (dtype) op_attrs.emplace_back("T", dtype);
+    op_attrs.emplace_back("fused_ops", builder.getArrayAttr(fused_ops));
+
+    auto fused_op = builder.create<corert::ExecuteOp>(
+        last.getLoc(), last->getResultTypes(), head.op_handler(), operands,
+        op_attrs, llvm::ArrayRef<std::pair<llvm::StringRef, mlir::Attribute>>(),
+        "tf._FusedCwise");
+
+    last->getResult(0).replaceAllUsesWith(fused_op->getResult(0));
+    for (auto& chain_op : llvm::reverse(chain)) chain_op.op->erase();
+  }
+};
+
+static mlir::PassRegistration<FuseCwiseOpsPass> fuse_cwise_ops;
+
+}  // namespace
+}  // namespace compiler
+}  // namespace tfrt
@@ -16,7 +16,9 @@
 
 // This implements PrintStreamPass for testing StreamAnalysis.
 
+#include "llvm/ADT/Optional.h"
 #include "mlir/Pass/Pass.h"
+#include "tfrt/bef/kernel_profile.h"
 #include "tfrt/compiler/stream_analysis.h"
 
 namespace tfrt {
@@ -27,6 +29,9 @@ class PrintStreamPass
     : public mlir::PassWrapper<PrintStreamPass,
                                mlir::OperationPass<mlir::FuncOp>> {
  public:
+  PrintStreamPass() = default;
+  PrintStreamPass(const PrintStreamPass& pass) {}
+
   llvm::StringRef getArgument() const final { return "tfrt-print-stream"; }
 
   llvm::StringRef getDescription() const final {
@@ -36,7 +41,18 @@ class PrintStreamPass
   void runOnOperation() override {
     auto func_op = getOperation();
 
-    const auto& stream_analysis = getAnalysis<StreamAnalysis>();
+    llvm::Optional<KernelProfile> profile;
+    if (!kernel_profile_.empty()) {
+      auto profile_or = KernelProfile::ReadFromFile(kernel_profile_);
+      if (!profile_or) {
+        func_op.emitError(llvm::toString(profile_or.takeError()));
+        return signalPassFailure();
+      }
+      profile = std::move(*profile_or);
+    }
+
+    StreamAnalysis stream_analysis(func_op,
+                                   profile ? profile.getPointer() : nullptr);
 
     auto emit_stream = [&](mlir::Operation* op, mlir::Location loc) {
       const auto& stream = stream_analysis.GetStream(op);
@@ -51,6 +67,12 @@ class PrintStreamPass
       emit_stream(&op, op.getLoc());
     }
   }
+
+ private:
+  Option<std::string> kernel_profile_{
+      *this, "kernel-profile",
+      llvm::cl::desc("Use the kernel costs from the specified kernel profile."),
+      llvm::cl::init("")};
 };
 
 // TODO(chky): Consider not using static initializers and register this pass
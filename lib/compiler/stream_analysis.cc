@@ -18,6 +18,9 @@
 
 #include "tfrt/compiler/stream_analysis.h"
 
+#include <string>
+
+#include "llvm/Support/raw_ostream.h"
 #include "tfrt/basic_kernels/opdefs/basic_kernels.h"
 #include "tfrt/basic_kernels/opdefs/types.h"
 #include "tfrt/compiler/opdefs/tfrt_op_interfaces.h"
@@ -80,6 +83,63 @@ bool GetMergeInterDependentStreams(mlir::Block& block) {
   return false;
 }
 
+// Prints `loc` the same way as the BEF executor prints the decoded location of
+// a kernel (see DecodeBefLocation), which is the key of the kernel in a
+// KernelProfile. Returns false if `loc` can't be encoded in BEF, or if it is
+// unknown and so it does not identify the kernel.
+bool PrintProfileLocation(mlir::Location loc, bool top_level,
+                          llvm::raw_ostream& os) {
+  if (loc.isa<mlir::UnknownLoc>()) {
+    if (top_level) return false;
+    os << "(unknown)";
+    return true;
+  }
+
+  if (auto file_loc = loc.dyn_cast<mlir::FileLineColLoc>()) {
+    // Only the top-level file locations are decoded to FileLineColLocation.
+    const char* separator = top_level ? ":" : ";";
+    os << file_loc.getFilename() << separator << file_loc.getLine()
+       << separator << file_loc.getColumn();
+    return true;
+  }
+
+  if (auto name_loc = loc.dyn_cast<mlir::NameLoc>()) {
+    auto child = name_loc.getChildLoc();
+    bool has_child = !child.isa<mlir::UnknownLoc>();
+    if (has_child) {
+      if (!PrintProfileLocation(child, /*top_level=*/false, os)) return false;
+      os << "(";
+    }
+    os << name_loc.getName().strref();
+    if (has_child) os << ")";
+    return true;
+  }
+
+  if (auto call_loc = loc.dyn_cast<mlir::CallSiteLoc>()) {
+    if (!PrintProfileLocation(call_loc.getCallee(), /*top_level=*/false, os))
+      return false;
+    os << "<-";
+    return PrintProfileLocation(call_loc.getCaller(), /*top_level=*/false, os);
+  }
+
+  if (auto fused_loc = loc.dyn_cast<mlir::FusedLoc>()) {
+    // Locations that can't be encoded in BEF are dropped from fused locations.
+    bool printed = false;
+    for (auto location : fused_loc.getLocations()) {
+      std::string str;
+      llvm::raw_string_ostream location_os(str);
+      if (!PrintProfileLocation(location, /*top_level=*/false, location_os))
+        continue;
+      if (printed) os << ",";
+      os << location_os.str();
+      printed = true;
+    }
+    return printed;
+  }
+
+  return false;
+}
+
 }  // namespace
 
 int64_t StreamAnalysis::GetOperationCost(mlir::Operation* op) const {
@@ -89,6 +149,16 @@ int64_t StreamAnalysis::GetOperationCost(mlir::Operation* op) const {
   // A few TFRT kernels are guaranteed to be cheap.
   if (llvm::isa<ReturnOp, MergeChainsOp>(op)) return 1;
 
+  // Use the measured cost if the operation was profiled.
+  if (profile_ != nullptr) {
+    std::string location;
+    llvm::raw_string_ostream os(location);
+    if (PrintProfileLocation(op->getLoc(), /*top_level=*/true, os)) {
+      if (const auto* entry = profile_->Find(os.str()))
+        return std::max<int64_t>(1, entry->MeanNs());
+    }
+  }
+
   // Check if operations defines a cost function.
   if (auto cost_function = mlir::dyn_cast<CostFunctionInterface>(op)) {
     int64_t cost = cost_function.cost();
@@ -16,6 +16,7 @@
 
 #include "tfrt/core_runtime/core_runtime.h"
 
+#include <atomic>
 #include <string>
 
 #include "tfrt/core_runtime/core_runtime_op.h"
@@ -71,6 +72,18 @@ class OpHandlerRegistry {
 
 }  // namespace
 
+static uint64_t NextOpHandlerId() {
+  static std::atomic<uint64_t> id{0};
+  return id.fetch_add(1, std::memory_order_relaxed);
+}
+
+OpHandler::OpHandler(string_view name, CoreRuntime* runtime,
+                     OpHandler* fallback)
+    : name_(name),
+      runtime_(runtime),
+      fallback_(fallback),
+      id_(NextOpHandlerId()) {}
+
 OpHandler::~OpHandler() {}
 
 class CoreRuntime::Impl {
@@ -150,6 +150,21 @@ void ExecuteOpImpl(CoreRuntimeOp op, ArrayRef<AsyncValue *> args,
                    AggregateAttr op_attr_array,
                    AggregateAttr op_func_attr_array,
                    const ExecutionContext &exec_ctx) {
+  // Set up OpAttrs.
+  OpAttrs op_attrs;
+  SetUpOpAttrs(op_attr_array, &op_attrs);
+
+  // Set up OpAttrs specifically for function attributes.
+  SetUpOpFuncAttrs(op_func_attr_array, &op_attrs);
+
+  ExecuteOpImpl(op, args, op_chain, results, OpAttrsRef(op_attrs), exec_ctx);
+}
+
+void ExecuteOpImpl(const CoreRuntimeOp &op, ArrayRef<AsyncValue *> args,
+                   AsyncValueRef<Chain> *op_chain,
+                   MutableArrayRef<RCReference<AsyncValue>> results,
+                   const OpAttrsRef &op_attrs,
+                   const ExecutionContext &exec_ctx) {
   SmallVector<TensorHandle, 8> th_args;
   th_args.reserve(args.size());
 
@@ -167,22 +182,27 @@ void ExecuteOpImpl(CoreRuntimeOp op, ArrayRef<AsyncValue *> args,
   SmallVector<TensorHandle, 8> result_ths;
   result_ths.resize(results.size());
 
+  op(exec_ctx, th_args, op_attrs, result_ths, op_chain);
+
+  AsyncWaitForResultsFromTensorHandles(results, result_ths);
+}
+
+void ExecuteOpImplSync(const CoreRuntimeOp &op,
+                       RepeatedSyncArguments<TensorHandle> args,
+                       AsyncValueRef<Chain> *op_chain, SyncKernelFrame *frame,
+                       AggregateAttr op_attr_array,
+                       const ExecutionContext &exec_ctx) {
   // Set up OpAttrs.
   OpAttrs op_attrs;
   SetUpOpAttrs(op_attr_array, &op_attrs);
 
-  // Set up OpAttrs specifically for function attributes.
-  SetUpOpFuncAttrs(op_func_attr_array, &op_attrs);
-
-  op(exec_ctx, th_args, OpAttrsRef(op_attrs), result_ths, op_chain);
-
-  AsyncWaitForResultsFromTensorHandles(results, result_ths);
+  ExecuteOpImplSync(op, args, op_chain, frame, OpAttrsRef(op_attrs), exec_ctx);
 }
 
 void ExecuteOpImplSync(const CoreRuntimeOp &op,
                        RepeatedSyncArguments<TensorHandle> args,
                        AsyncValueRef<Chain> *op_chain, SyncKernelFrame *frame,
-                       AggregateAttr op_attr_array,
+                       const OpAttrsRef &op_attrs,
                        const ExecutionContext &exec_ctx) {
   SmallVector<TensorHandle, 8> th_args;
   th_args.reserve(args.size());
@@ -194,11 +214,7 @@ void ExecuteOpImplSync(const CoreRuntimeOp &op,
   SmallVector<TensorHandle, 8> result_ths;
   result_ths.resize(frame->GetNumResults());
 
-  // Set up OpAttrs.
-  OpAttrs op_attrs;
-  SetUpOpAttrs(op_attr_array, &op_attrs);
-
-  op(exec_ctx, th_args, OpAttrsRef(op_attrs), result_ths, op_chain);
+  op(exec_ctx, th_args, op_attrs, result_ths, op_chain);
 
   // Return all of the TensorHandles in AsyncValue's.
   for (size_t i = 0, e = result_ths.size(); i != e; ++i) {
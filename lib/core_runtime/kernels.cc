@@ -31,6 +31,7 @@
 #include "tfrt/host_context/attribute_utils.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/function.h"
+#include "tfrt/host_context/kernel_cache.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/host_context/sync_kernel_utils.h"
 #include "tfrt/support/error_util.h"
@@ -221,22 +222,102 @@ static llvm::Expected<CoreRuntimeOp> GetCoreRuntimeOp(
   return core_rt->MakeOp(op_name, op_handler);
 }
 
-// ExecuteOp executes the `op_name` operation on the `op_handler`.
-static void ExecuteOp(Argument<OpHandler *> op_handler, RemainingArguments args,
-                      RemainingResults results, AggregateAttr op_attr_array,
-                      AggregateAttr op_func_attr_array, StringAttr op_name,
-                      KernelErrorHandler handler,
-                      const ExecutionContext &exec_ctx) {
+// The op resolved by the op handler and the frozen op attributes of an
+// executeop kernel. They are cached in the KernelCache of the kernel, so that
+// its later executions skip the op registry lookup and the rebuilding of the op
+// attributes from the BEF attributes.
+struct CachedCoreRuntimeOp : KernelCache::CachedValue {
+  CachedCoreRuntimeOp(uint64_t op_handler_id, CoreRuntimeOp op,
+                      OpAttrsRef attrs)
+      : op_handler_id(op_handler_id),
+        op(std::move(op)),
+        attrs(std::move(attrs)) {}
+
+  // The id of the op handler which resolved the op.
+  const uint64_t op_handler_id;
+  const CoreRuntimeOp op;
+  const OpAttrsRef attrs;
+};
+
+// Returns the op and attributes cached in `cache`, which are resolved and set
+// up by the first execution of the kernel. Returns nullptr if there is no
+// cache, or if the cached op belongs to another op handler, e.g. when the
+// function of the kernel is called with different op handlers. These
+// executions do not use the cache.
+static Expected<const CachedCoreRuntimeOp *> GetCachedCoreRuntimeOp(
+    KernelCache *cache, OpHandler *op_handler, StringAttr op_name,
+    AggregateAttr op_attr_array, AggregateAttr op_func_attr_array,
+    const ExecutionContext &exec_ctx) {
+  const CachedCoreRuntimeOp *cached = nullptr;
+  if (!cache) return cached;
+
+  cached = cache->Get<CachedCoreRuntimeOp>();
+  if (!cached) {
+    auto op = GetCoreRuntimeOp(op_name.GetValue(), op_handler, exec_ctx);
+    if (!op) return op.takeError();
+
+    OpAttrs op_attrs;
+    SetUpOpAttrs(op_attr_array, &op_attrs);
+    SetUpOpFuncAttrs(op_func_attr_array, &op_attrs);
+
+    // If another execution has cached its op concurrently, the new op is
+    // dropped.
+    cached = cache->Set(std::make_unique<CachedCoreRuntimeOp>(
+        op_handler->id(), std::move(op.get()), op_attrs.freeze()));
+  }
+  if (cached->op_handler_id != op_handler->id()) return nullptr;
+  return cached;
+}
+
+// Executes the `op_name` operation on the `op_handler`, using the op and op
+// attributes cached in `cache` if possible. Returns an error if the op can't be
+// resolved.
+static Error ExecuteOpWithCache(KernelCache *cache, OpHandler *op_handler,
+                                StringAttr op_name,
+                                ArrayRef<AsyncValue *> args,
+                                AsyncValueRef<Chain> *op_chain,
+                                RemainingResults results,
+                                AggregateAttr op_attr_array,
+                                AggregateAttr op_func_attr_array,
+                                const ExecutionContext &exec_ctx) {
+  auto cached = GetCachedCoreRuntimeOp(cache, op_handler, op_name,
+                                       op_attr_array, op_func_attr_array,
+                                       exec_ctx);
+  if (!cached) return cached.takeError();
+
+  if (*cached) {
+    for (int b = 0, e = results.size(); b < e; ++b)
+      results.AllocateAt<TensorHandle>(b);
+
+    ExecuteOpImpl((*cached)->op, args, op_chain, results.values(),
+                  (*cached)->attrs, exec_ctx);
+    return Error::success();
+  }
+
   auto expected_op =
-      GetCoreRuntimeOp(op_name.GetValue(), op_handler.get(), exec_ctx);
-  if (!expected_op) return handler.ReportError(StrCat(expected_op.takeError()));
+      GetCoreRuntimeOp(op_name.GetValue(), op_handler, exec_ctx);
+  if (!expected_op) return expected_op.takeError();
 
   for (int b = 0, e = results.size(); b < e; ++b)
     results.AllocateAt<TensorHandle>(b);
 
-  ExecuteOpImpl(std::move(expected_op.get()), args.values(),
-                /*op_chain=*/nullptr, results.values(), op_attr_array,
-                op_func_attr_array, exec_ctx);
+  ExecuteOpImpl(std::move(expected_op.get()), args, op_chain, results.values(),
+                op_attr_array, op_func_attr_array, exec_ctx);
+  return Error::success();
+}
+
+// ExecuteOp executes the `op_name` operation on the `op_handler`.
+static void ExecuteOp(Argument<OpHandler *> op_handler, RemainingArguments args,
+                      RemainingResults results, AggregateAttr op_attr_array,
+                      AggregateAttr op_func_attr_array, StringAttr op_name,
+                      KernelErrorHandler handler,
+                      const ExecutionContext &exec_ctx,
+                      AsyncKernelFrame *frame) {
+  if (auto error = ExecuteOpWithCache(
+          frame->GetKernelCache(), op_handler.get(), op_name, args.values(),
+          /*op_chain=*/nullptr, results, op_attr_array, op_func_attr_array,
+          exec_ctx))
+    handler.ReportError(StrCat(error));
 }
 
 // ExecuteOpSeq executes the `op_name` operation on the `op_handler`. It takes
@@ -249,17 +330,13 @@ static void ExecuteOpSeq(Argument<OpHandler *> op_handler,
                          AggregateAttr op_attr_array,
                          AggregateAttr op_func_attr_array, StringAttr op_name,
                          KernelErrorHandler handler,
-                         const ExecutionContext &exec_ctx) {
-  auto expected_op =
-      GetCoreRuntimeOp(op_name.GetValue(), op_handler.get(), exec_ctx);
-  if (!expected_op) return handler.ReportError(StrCat(expected_op.takeError()));
-
-  for (int b = 0, e = results.size(); b < e; ++b)
-    results.AllocateAt<TensorHandle>(b);
-
+                         const ExecutionContext &exec_ctx,
+                         AsyncKernelFrame *frame) {
   auto op_chain = in_op_chain.ValueRef();
-  ExecuteOpImpl(std::move(expected_op.get()), args.values(), &op_chain,
-                results.values(), op_attr_array, op_func_attr_array, exec_ctx);
+  if (auto error = ExecuteOpWithCache(
+          frame->GetKernelCache(), op_handler.get(), op_name, args.values(),
+          &op_chain, results, op_attr_array, op_func_attr_array, exec_ctx))
+    return handler.ReportError(StrCat(error));
   out_op_chain.Set(std::move(op_chain));
 }
 
@@ -269,6 +346,16 @@ static Error ExecuteOpSync(SyncArgument<OpHandler *> op_handler,
                            SyncKernelFrame *frame, AggregateAttr op_attr_array,
                            StringAttr op_name,
                            const ExecutionContext &exec_ctx) {
+  auto cached = GetCachedCoreRuntimeOp(
+      frame->GetKernelCache(), op_handler.get(), op_name, op_attr_array,
+      /*op_func_attr_array=*/AggregateAttr(), exec_ctx);
+  if (!cached) return MakeStringError(cached.takeError());
+  if (*cached) {
+    ExecuteOpImplSync((*cached)->op, args, /*op_chain=*/nullptr, frame,
+                      (*cached)->attrs, exec_ctx);
+    return Error::success();
+  }
+
   auto expected_op =
       GetCoreRuntimeOp(op_name.GetValue(), op_handler.get(), exec_ctx);
 
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements the autotuning model of the data pipeline.
+
+#include "tfrt/data/autotune.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/host_context/async_dispatch.h"
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+// The consumer is considered to wait for an iterator if it waited for more than
+// this fraction of the period.
+static constexpr double kWaitThreshold = 0.01;
+
+// A parameter is shrunk after the consumer did not wait for its iterator during
+// this many consecutive periods.
+static constexpr int64_t kIdlePeriodsBeforeShrink = 8;
+
+static int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Returns the number of bytes of the values of `element`, or -1 if the size of
+// any of the values is unknown.
+static int64_t EstimateBytes(const IterationResult& element) {
+  int64_t bytes = 0;
+  for (const auto& value : element.values) {
+    if (!value->IsConcrete()) return -1;
+    if (value->IsType<std::string>()) {
+      bytes += value->get<std::string>().size();
+    } else if (value->IsType<DenseHostTensor>()) {
+      bytes += value->get<DenseHostTensor>().DataSizeInBytes();
+    } else if (value->IsType<RCReference<HostBuffer>>()) {
+      bytes += value->get<RCReference<HostBuffer>>()->size();
+    } else {
+      return -1;
+    }
+  }
+  return bytes;
+}
+
+//===----------------------------------------------------------------------===//
+// TunableParameter methods
+//===----------------------------------------------------------------------===//
+
+TunableParameter::TunableParameter(AutotuneModel* model, string_view name,
+                                   TunableKind kind, int64_t value,
+                                   int64_t min, int64_t max)
+    : model_(FormRef(model)),
+      name_(name),
+      kind_(kind),
+      min_(min),
+      max_(std::max(min, max)),
+      value_(std::min(std::max(value, min_), max_)) {
+  model_->AddParameter(this);
+}
+
+TunableParameter::~TunableParameter() { model_->RemoveParameter(this); }
+
+void TunableParameter::RecordProduction(const IterationResult& element,
+                                        std::chrono::nanoseconds duration) {
+  num_productions_.fetch_add(1, std::memory_order_relaxed);
+  production_ns_.fetch_add(duration.count(), std::memory_order_relaxed);
+
+  int64_t bytes = EstimateBytes(element);
+  if (bytes >= 0) {
+    num_sized_elements_.fetch_add(1, std::memory_order_relaxed);
+    element_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+}
+
+void TunableParameter::RecordProduction(
+    const IterationResult& element,
+    std::chrono::steady_clock::time_point start) {
+  RunWhenReady(element.AsyncValues(), [parameter = FormRef(this),
+                                       element = element.CopyRef(), start]() {
+    parameter->RecordProduction(element,
+                                std::chrono::steady_clock::now() - start);
+  });
+}
+
+void TunableParameter::RecordOutput(const IterationResult& output) {
+  num_outputs_.fetch_add(1, std::memory_order_relaxed);
+
+  auto values = output.AsyncValues();
+  if (llvm::all_of(values, [](AsyncValue* v) { return v->IsAvailable(); }))
+    return;
+
+  RunWhenReady(values, [parameter = FormRef(this), start = NowNs()]() {
+    parameter->wait_ns_.fetch_add(NowNs() - start, std::memory_order_relaxed);
+  });
+}
+
+//===----------------------------------------------------------------------===//
+// AutotuneModel methods
+//===----------------------------------------------------------------------===//
+
+AutotuneModel::AutotuneModel(AutotuneOptions options)
+    : options_(std::move(options)), last_optimization_ns_(NowNs()) {}
+
+void AutotuneModel::AddParameter(TunableParameter* parameter) {
+  mutex_lock lock(mu_);
+  parameters_.push_back(parameter);
+}
+
+void AutotuneModel::RemoveParameter(TunableParameter* parameter) {
+  mutex_lock lock(mu_);
+  parameters_.erase(llvm::find(parameters_, parameter));
+}
+
+void AutotuneModel::RecordPipelineOutput() {
+  num_pipeline_outputs_.fetch_add(1, std::memory_order_relaxed);
+
+  int64_t now = NowNs();
+  int64_t last = last_optimization_ns_.load(std::memory_order_relaxed);
+  if (now - last < options_.period.count()) return;
+  // Only the thread that updates the time of the last adjustment adjusts the
+  // parameters for this period.
+  if (!last_optimization_ns_.compare_exchange_strong(last, now)) return;
+  Optimize(std::chrono::nanoseconds(now - last));
+}
+
+// Returns the mean size of the elements, or 0 if unknown.
+static int64_t MeanElementBytes(int64_t num_sized_elements,
+                                int64_t element_bytes) {
+  return num_sized_elements > 0 ? element_bytes / num_sized_elements : 0;
+}
+
+void AutotuneModel::Optimize(std::chrono::nanoseconds elapsed) {
+  const double elapsed_ns = std::max<int64_t>(elapsed.count(), 1);
+
+  mutex_lock lock(mu_);
+
+  int64_t num_pipeline_outputs =
+      num_pipeline_outputs_.load(std::memory_order_relaxed);
+  elements_per_second_ =
+      (num_pipeline_outputs - last_num_pipeline_outputs_) * 1e9 / elapsed_ns;
+  last_num_pipeline_outputs_ = num_pipeline_outputs;
+
+  // Update the statistics of the period, and compute the resources used by the
+  // current values of the parameters.
+  int64_t cpu_used = 0;
+  int64_t ram_used = 0;
+  llvm::SmallVector<int64_t, 8> element_bytes;
+  llvm::SmallVector<int64_t, 8> new_outputs;
+  for (TunableParameter* p : parameters_) {
+    int64_t num_outputs = p->num_outputs_.load(std::memory_order_relaxed);
+    int64_t num_productions =
+        p->num_productions_.load(std::memory_order_relaxed);
+    int64_t production_ns = p->production_ns_.load(std::memory_order_relaxed);
+    int64_t wait_ns = p->wait_ns_.load(std::memory_order_relaxed);
+
+    new_outputs.push_back(num_outputs - p->last_num_outputs_);
+    p->elements_per_second_ = new_outputs.back() * 1e9 / elapsed_ns;
+    // Waits for concurrently pending elements overlap, and might sum up to
+    // more than the period.
+    p->wait_fraction_ =
+        std::min(1.0, (wait_ns - p->last_wait_ns_) / elapsed_ns);
+    if (num_productions > p->last_num_productions_) {
+      p->mean_production_ns_ = (production_ns - p->last_production_ns_) /
+                               (num_productions - p->last_num_productions_);
+    }
+    p->last_num_outputs_ = num_outputs;
+    p->last_num_productions_ = num_productions;
+    p->last_production_ns_ = production_ns;
+    p->last_wait_ns_ = wait_ns;
+
+    element_bytes.push_back(MeanElementBytes(
+        p->num_sized_elements_.load(std::memory_order_relaxed),
+        p->element_bytes_.load(std::memory_order_relaxed)));
+
+    if (p->kind_ == TunableKind::kParallelism) {
+      cpu_used += p->value();
+    } else {
+      ram_used += p->value() * element_bytes.back();
+    }
+  }
+
+  // Grow the parameters of the iterators that the consumer waited for, starting
+  // with the iterator it waited for the longest. Growing geometrically reaches
+  // the required value in a logarithmic number of periods.
+  llvm::SmallVector<size_t, 8> waited;
+  for (size_t i = 0; i < parameters_.size(); ++i) {
+    if (parameters_[i]->wait_fraction_ > kWaitThreshold) waited.push_back(i);
+  }
+  llvm::sort(waited, [&](size_t a, size_t b) {
+    return parameters_[a]->wait_fraction_ > parameters_[b]->wait_fraction_;
+  });
+  for (size_t i : waited) {
+    TunableParameter* p = parameters_[i];
+    p->idle_periods_ = 0;
+
+    int64_t value = p->value();
+    int64_t target = std::min(p->max_, value + std::max<int64_t>(1, value / 2));
+    if (p->kind_ == TunableKind::kParallelism) {
+      target = std::min(target, value + options_.cpu_budget - cpu_used);
+    } else if (options_.ram_budget > 0 && element_bytes[i] > 0) {
+      target = std::min(
+          target, value + (options_.ram_budget - ram_used) / element_bytes[i]);
+    }
+    if (target <= value) continue;
+
+    if (p->kind_ == TunableKind::kParallelism) {
+      cpu_used += target - value;
+    } else {
+      ram_used += (target - value) * element_bytes[i];
+    }
+    p->value_.store(target, std::memory_order_relaxed);
+  }
+
+  // Shrink the parameters of the iterators that stayed ahead of the consumer
+  // for several periods, to release resources for the other iterators. By
+  // Little's law, the iterator needs at least elements_per_second *
+  // mean_production_time elements in flight to sustain its throughput.
+  for (size_t i = 0; i < parameters_.size(); ++i) {
+    TunableParameter* p = parameters_[i];
+    if (p->wait_fraction_ > kWaitThreshold || new_outputs[i] == 0) continue;
+    if (++p->idle_periods_ < kIdlePeriodsBeforeShrink) continue;
+    p->idle_periods_ = 0;
+
+    int64_t value = p->value();
+    int64_t required = static_cast<int64_t>(
+        std::ceil(p->elements_per_second_ * p->mean_production_ns_ / 1e9));
+    if (value - 1 < std::max(p->min_, required)) continue;
+
+    if (p->kind_ == TunableKind::kParallelism) {
+      cpu_used -= 1;
+    } else {
+      ram_used -= element_bytes[i];
+    }
+    p->value_.store(value - 1, std::memory_order_relaxed);
+  }
+
+  // The size of the elements may have grown since the buffers were grown. Keep
+  // the buffered bytes within the budget by shrinking the largest buffers.
+  while (options_.ram_budget > 0 && ram_used > options_.ram_budget) {
+    TunableParameter* largest = nullptr;
+    int64_t largest_bytes = 0;
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+      TunableParameter* p = parameters_[i];
+      if (p->kind_ != TunableKind::kBufferSize || p->value() <= p->min_)
+        continue;
+      int64_t bytes = p->value() * element_bytes[i];
+      if (bytes > largest_bytes) {
+        largest = p;
+        largest_bytes = bytes;
+      }
+    }
+    if (!largest) break;
+
+    int64_t value = largest->value();
+    ram_used -= largest_bytes / value;
+    largest->value_.store(value - 1, std::memory_order_relaxed);
+  }
+}
+
+std::vector<AutotuneStats> AutotuneModel::GetStats() const {
+  std::vector<AutotuneStats> stats;
+
+  mutex_lock lock(mu_);
+  for (const TunableParameter* p : parameters_) {
+    stats.push_back(
+        {p->name_, p->kind_, p->value(), p->elements_per_second_,
+         p->wait_fraction_, p->mean_production_ns_,
+         MeanElementBytes(
+             p->num_sized_elements_.load(std::memory_order_relaxed),
+             p->element_bytes_.load(std::memory_order_relaxed))});
+  }
+  return stats;
+}
+
+double AutotuneModel::GetElementsPerSecond() const {
+  mutex_lock lock(mu_);
+  return elements_per_second_;
+}
+
+void AutotuneModel::Print(raw_ostream& os) const {
+  os << "pipeline: " << llvm::format("%.1f", GetElementsPerSecond())
+     << " elements/s\n";
+  for (const auto& stats : GetStats()) {
+    os << stats.name << ": "
+       << (stats.kind == TunableKind::kParallelism ? "parallelism"
+                                                   : "buffer_size")
+       << " = " << stats.value << ", "
+       << llvm::format("%.1f", stats.elements_per_second) << " elements/s, "
+       << llvm::format("%.1f%%", stats.wait_fraction * 100) << " waited, "
+       << stats.mean_production_ns << " ns/element, "
+       << stats.mean_element_bytes << " bytes/element\n";
+  }
+}
+
+}  // namespace data
+}  // namespace tfrt
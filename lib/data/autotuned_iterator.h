@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares the AutotunedIterator class.
+
+#ifndef TFRT_LIB_DATA_AUTOTUNED_ITERATOR_H_
+#define TFRT_LIB_DATA_AUTOTUNED_ITERATOR_H_
+
+#include <string>
+
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/data/autotune.h"
+#include "tfrt/data/dataset.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/logging.h"
+
+namespace tfrt {
+namespace data {
+
+// AutotunedIterator iterates over a dataset with autotuning enabled. It owns
+// the autotuning model shared by all iterators of the input pipeline, and
+// reports the values returned by the pipeline to the model. If `log_stats` is
+// true, the chosen values and their stats are logged when the iterator is
+// destroyed.
+class AutotunedIterator : public Iterator {
+ public:
+  explicit AutotunedIterator(Dataset* dataset, AutotuneOptions options,
+                             HostContext* host, bool log_stats = false)
+      : Iterator(),
+        model_(TakeRef(new AutotuneModel(std::move(options)))),
+        host_(host),
+        log_stats_(log_stats) {
+    IteratorContext context;
+    context.autotune_model = model_.get();
+    input_iterator_ = dataset->MakeIterator(context);
+  }
+
+  ~AutotunedIterator() override {
+    if (!log_stats_) return;
+    std::string stats;
+    llvm::raw_string_ostream os(stats);
+    model_->Print(os);
+    TFRT_LOG(INFO) << "Autotuned input pipeline:\n" << os.str();
+  }
+
+  // This class is not copyable or movable.
+  AutotunedIterator(const AutotunedIterator&) = delete;
+  AutotunedIterator& operator=(const AutotunedIterator&) = delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override {
+    auto result = input_iterator_->GetNext(exec_ctx);
+    model_->RecordPipelineOutput();
+    return result;
+  }
+
+  // Returns the model, e.g. to inspect the chosen values.
+  const AutotuneModel& model() const { return *model_; }
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<AutotunedIterator>(this, host_->allocator());
+  }
+
+  RCReference<AutotuneModel> model_;
+  HostContext* host_;
+  const bool log_stats_;
+  RCReference<Iterator> input_iterator_;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_AUTOTUNED_ITERATOR_H_
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements CacheDataset class which wraps around another Dataset
+// instance and caches its elements in memory.
+
+#include "cache_dataset.h"
+
+namespace tfrt {
+namespace data {
+
+//===----------------------------------------------------------------------===//
+// CacheDataset methods
+//===----------------------------------------------------------------------===//
+RCReference<Iterator> CacheDataset::MakeIterator(
+    const IteratorContext& context) {
+  {
+    mutex_lock lock(mu_);
+    if (completed_) {
+      return TakeRef(
+          host_->Construct<CacheDatasetReaderIterator>(FormRef(this)));
+    }
+    if (has_writer_) {
+      // Another iterator is filling the cache. Iterate over the input dataset
+      // without caching.
+      return input_dataset_->MakeIterator(context);
+    }
+    has_writer_ = true;
+  }
+  return TakeRef(
+      host_->Construct<CacheDatasetWriterIterator>(FormRef(this), context));
+}
+
+void CacheDataset::CompleteCache(std::vector<IterationResult> elements) {
+  mutex_lock lock(mu_);
+  assert(!completed_ && has_writer_);
+  cache_ = std::move(elements);
+  completed_ = true;
+  has_writer_ = false;
+}
+
+void CacheDataset::ReleaseWriter() {
+  mutex_lock lock(mu_);
+  has_writer_ = false;
+}
+
+//===----------------------------------------------------------------------===//
+// CacheDatasetWriterIterator methods
+//===----------------------------------------------------------------------===//
+CacheDatasetWriterIterator::~CacheDatasetWriterIterator() {
+  mutex_lock lock(mu_);
+  if (!done_) {
+    parent_dataset_->ReleaseWriter();
+    done_event_.SetStateConcrete();
+  }
+}
+
+IterationResult CacheDatasetWriterIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  auto input = input_iterator_->GetNext(exec_ctx);
+  {
+    mutex_lock lock(mu_);
+    if (done_) return input;
+    elements_.push_back(input.CopyRef());
+  }
+
+  if (input.eof.IsAvailable() && (input.eof.IsError() || !input.eof.get())) {
+    MaybeCompleteCache();
+    return input;
+  }
+
+  // Forward the end of iteration to the consumer only after the eofs of all
+  // preceding elements are available and the cache is completed, so that the
+  // iterator created by the consumer at the end of iteration, e.g. by
+  // RepeatDataset, reads from the cache.
+  auto eof = MakeUnconstructedAsyncValueRef<bool>(exec_ctx.host());
+  input.eof.AndThen([iterator = FormRef(this), input_eof = input.eof.CopyRef(),
+                     eof = eof.CopyRef()]() {
+    iterator->MaybeCompleteCache();
+    if (input_eof.IsError()) {
+      eof.SetError(input_eof.GetError());
+    } else if (!input_eof.get()) {
+      eof.emplace(false);
+    } else {
+      iterator->done_event_.AndThen([eof = eof.CopyRef()]() {
+        eof.emplace(true);
+      });
+    }
+  });
+  return IterationResult::Pending(std::move(input.values), std::move(eof));
+}
+
+void CacheDatasetWriterIterator::MaybeCompleteCache() {
+  std::vector<IterationResult> elements;
+  {
+    mutex_lock lock(mu_);
+    if (done_) return;
+    for (; num_checked_ < elements_.size(); ++num_checked_) {
+      const auto& eof = elements_[num_checked_].eof;
+      if (!eof.IsAvailable()) return;
+      if (eof.IsError()) {
+        // Do not cache a partial iteration. The next iterator fills the cache
+        // again.
+        done_ = true;
+        elements_.clear();
+        break;
+      }
+      if (eof.get()) {
+        done_ = true;
+        // Keep the first end of iteration, which is returned repeatedly by the
+        // readers.
+        elements_.erase(elements_.begin() + num_checked_ + 1, elements_.end());
+        elements = std::move(elements_);
+        break;
+      }
+    }
+    if (!done_) return;
+  }
+
+  if (elements.empty()) {
+    parent_dataset_->ReleaseWriter();
+  } else {
+    parent_dataset_->CompleteCache(std::move(elements));
+  }
+  done_event_.SetStateConcrete();
+}
+
+}  // namespace data
+}  // namespace tfrt
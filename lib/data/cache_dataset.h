@@ -0,0 +1,173 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares CacheDataset class which wraps around another Dataset
+// instance and caches its elements in memory.
+
+#ifndef TFRT_LIB_DATA_CACHE_DATASET_H_
+#define TFRT_LIB_DATA_CACHE_DATASET_H_
+
+#include <vector>
+
+#include "tfrt/data/dataset.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace data {
+
+class CacheDatasetWriterIterator;
+class CacheDatasetReaderIterator;
+
+// CacheDataset wraps around another Dataset instance and caches the elements
+// of the first complete iteration of the input dataset in memory. Iterators
+// created after the cache is complete, e.g. the later epochs of a
+// RepeatDataset, return the cached elements without iterating over the input
+// dataset again.
+//
+// Unlike MemoryDataset, the elements can be of any type. The cached values are
+// shared by all iterators instead of being copied, so the consumer must not
+// mutate them.
+//
+// Only one iterator fills the cache at a time. Iterators created while the
+// cache is being filled iterate over the input dataset without caching. If the
+// iteration that fills the cache fails or is abandoned before the end, the
+// elements are discarded and the next iterator fills the cache again.
+class CacheDataset : public Dataset {
+ public:
+  explicit CacheDataset(RCReference<Dataset> input_dataset, HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        host_(host),
+        allocator_(host->allocator()) {}
+
+  // This class is not copyable or movable.
+  CacheDataset(const CacheDataset&) = delete;
+  CacheDataset& operator=(const CacheDataset&) = delete;
+
+  RCReference<Iterator> MakeIterator(const IteratorContext& context) override;
+
+ private:
+  friend class CacheDatasetWriterIterator;
+  friend class CacheDatasetReaderIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<CacheDataset>(this, allocator_);
+  }
+
+  // Called by the writer iterator when it has produced all elements of the
+  // input dataset. The last element of `elements` is the end of iteration.
+  void CompleteCache(std::vector<IterationResult> elements) TFRT_EXCLUDES(mu_);
+
+  // Called by the writer iterator when it stops filling the cache without
+  // completing it.
+  void ReleaseWriter() TFRT_EXCLUDES(mu_);
+
+  RCReference<Dataset> input_dataset_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+
+  mutex mu_;
+  // Whether an iterator is filling the cache.
+  bool has_writer_ TFRT_GUARDED_BY(mu_) = false;
+  bool completed_ TFRT_GUARDED_BY(mu_) = false;
+  // The cached elements, followed by the end of iteration. It is not modified
+  // after `completed_` is set, so that readers can access it without locking.
+  std::vector<IterationResult> cache_;
+};
+
+// CacheDatasetWriterIterator iterates over the input dataset and records the
+// returned elements. When the eofs of the elements up to the end of iteration
+// become available, it passes the elements to the dataset before forwarding
+// the end of iteration to the consumer, so that the next iterator created by
+// the consumer reads from the cache.
+class CacheDatasetWriterIterator : public Iterator {
+ public:
+  explicit CacheDatasetWriterIterator(RCReference<CacheDataset> dataset,
+                                      const IteratorContext& context)
+      : Iterator(),
+        parent_dataset_(std::move(dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(context)),
+        done_event_(
+            MakeConstructedAsyncValueRef<Chain>(parent_dataset_->host_)) {}
+
+  ~CacheDatasetWriterIterator() override;
+
+  // This class is not copyable or movable.
+  CacheDatasetWriterIterator(const CacheDatasetWriterIterator&) = delete;
+  CacheDatasetWriterIterator& operator=(const CacheDatasetWriterIterator&) =
+      delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<CacheDatasetWriterIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  // Checks the eofs of the recorded elements in order, and completes the cache
+  // if all elements before the first end of iteration are values.
+  void MaybeCompleteCache() TFRT_EXCLUDES(mu_);
+
+  RCReference<CacheDataset> parent_dataset_;
+  RCReference<Iterator> input_iterator_;
+  // Becomes available when the cache is completed or abandoned by this
+  // iterator. The end of iteration is forwarded to the consumer after it.
+  AsyncValueRef<Chain> done_event_;
+
+  mutex mu_;
+  // The elements returned by the input iterator.
+  std::vector<IterationResult> elements_ TFRT_GUARDED_BY(mu_);
+  // The number of leading elements whose eof is available and false.
+  size_t num_checked_ TFRT_GUARDED_BY(mu_) = 0;
+  // Whether the cache is completed or abandoned by this iterator.
+  bool done_ TFRT_GUARDED_BY(mu_) = false;
+};
+
+// CacheDatasetReaderIterator returns the elements of a completed cache.
+class CacheDatasetReaderIterator : public Iterator {
+ public:
+  explicit CacheDatasetReaderIterator(RCReference<CacheDataset> dataset)
+      : Iterator(), parent_dataset_(std::move(dataset)) {}
+
+  // This class is not copyable or movable.
+  CacheDatasetReaderIterator(const CacheDatasetReaderIterator&) = delete;
+  CacheDatasetReaderIterator& operator=(const CacheDatasetReaderIterator&) =
+      delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override {
+    const auto& cache = parent_dataset_->cache_;
+    // The last element is the end of iteration, which is returned repeatedly.
+    const auto& element = cache[next_index_];
+    if (next_index_ + 1 < cache.size()) ++next_index_;
+    return element.CopyRef();
+  }
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<CacheDatasetReaderIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  RCReference<CacheDataset> parent_dataset_;
+  size_t next_index_ = 0;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_CACHE_DATASET_H_
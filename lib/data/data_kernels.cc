@@ -14,18 +14,28 @@
 
 // This file implements data kernels.
 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "autotuned_iterator.h"
 #include "batch_dataset.h"
+#include "cache_dataset.h"
 #include "filter_dataset.h"
 #include "interleave_dataset.h"
 #include "log_dataset.h"
 #include "map_dataset.h"
 #include "memory_dataset.h"
+#include "padded_batch_dataset.h"
 #include "prefetch_dataset.h"
 #include "range_dataset.h"
 #include "repeat_dataset.h"
+#include "shard_dataset.h"
 #include "shuffle_dataset.h"
 #include "skip_dataset.h"
 #include "slice_dataset.h"
+#include "snapshot_dataset.h"
+#include "take_dataset.h"
 #include "tf_record_dataset.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/host_context/kernel_utils.h"
@@ -34,6 +44,7 @@
 #include "tfrt/support/ref_count.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/tensor_serialize_utils.h"
+#include "zip_dataset.h"
 
 namespace tfrt {
 namespace data {
@@ -100,6 +111,23 @@ RCReference<MapDataset> MakeMapDataset(RCReference<Dataset>* dataset,
       exec_ctx.host()));
 }
 
+llvm::Expected<RCReference<MapDataset>> MakeParallelMapDataset(
+    RCReference<Dataset>* dataset, int64_t num_parallel_calls,
+    RemainingArguments args, Attribute<bool> is_deterministic,
+    Attribute<Function> fn, const ExecutionContext& exec_ctx) {
+  if (num_parallel_calls <= 0 && num_parallel_calls != -1) {
+    return MakeStringError("num_parallel_calls must be positive or -1, got ",
+                           num_parallel_calls);
+  }
+  HostContext* host = exec_ctx.host();
+  if (num_parallel_calls == -1) {
+    num_parallel_calls = host->GetNumWorkerThreads();
+  }
+  return TakeRef(host->Construct<MapDataset>(
+      *dataset, RCArray<AsyncValue>(args.values()), FormRef(&fn.get()),
+      num_parallel_calls, is_deterministic.get(), host));
+}
+
 //===----------------------------------------------------------------------===//
 // FilterDataset
 //===----------------------------------------------------------------------===//
@@ -133,15 +161,62 @@ RCReference<InterleaveDataset> MakeInterleaveDataset(
 // TFRecordDataset
 //===----------------------------------------------------------------------===//
 
-RCReference<TFRecordDataset> MakeTFRecordDataset(
-    std::string path, const ExecutionContext& exec_ctx) {
+// Parses the optional compression_type attribute, which is the only attribute
+// of the TFRecordDataset kernels. It is absent in programs which predate it.
+static llvm::Expected<::tfrt::io::CompressionType> GetCompressionType(
+    const RemainingAttributes& attributes) {
+  if (attributes.size() == 0) return ::tfrt::io::CompressionType::kNone;
+  return ::tfrt::io::ParseCompressionType(
+      attributes.GetStringAttribute(0).get());
+}
+
+llvm::Expected<RCReference<TFRecordDataset>> MakeTFRecordDataset(
+    std::string path, RemainingAttributes attributes,
+    const ExecutionContext& exec_ctx) {
+  auto type = GetCompressionType(attributes);
+  if (!type) return type.takeError();
   // Default buffer size to 256 KB.
   int64_t buffer_size = 256 * 1024;
   int64_t max_prefetch_num = 80;
   int64_t prefetch_threshold = 20;
   return TakeRef(exec_ctx.host()->Construct<TFRecordDataset>(
       std::move(path), buffer_size, max_prefetch_num, prefetch_threshold,
-      exec_ctx.host()));
+      /*zero_copy=*/false, /*max_read_batch_size=*/1, *type, exec_ctx.host()));
+}
+
+llvm::Expected<RCReference<TFRecordDataset>> MakeZeroCopyTFRecordDataset(
+    std::string path, int64_t max_read_batch_size,
+    RemainingAttributes attributes, const ExecutionContext& exec_ctx) {
+  if (max_read_batch_size <= 0) {
+    return MakeStringError("max_read_batch_size must be positive, got ",
+                           max_read_batch_size);
+  }
+  auto type = GetCompressionType(attributes);
+  if (!type) return type.takeError();
+  // Default chunk size to 256 KB.
+  int64_t buffer_size = 256 * 1024;
+  int64_t max_prefetch_num = 80;
+  int64_t prefetch_threshold = 20;
+  return TakeRef(exec_ctx.host()->Construct<TFRecordDataset>(
+      std::move(path), buffer_size, max_prefetch_num, prefetch_threshold,
+      /*zero_copy=*/true, max_read_batch_size, *type, exec_ctx.host()));
+}
+
+//===----------------------------------------------------------------------===//
+// SnapshotDataset
+//===----------------------------------------------------------------------===//
+
+llvm::Expected<RCReference<SnapshotDataset>> MakeSnapshotDataset(
+    RCReference<Dataset>* dataset, std::string path, int64_t num_shards,
+    StringAttribute fingerprint, const ExecutionContext& exec_ctx) {
+  if (num_shards <= 0) {
+    return MakeStringError("num_shards must be positive, got ", num_shards);
+  }
+  int64_t max_prefetch_num = 80;
+  int64_t prefetch_threshold = 20;
+  return TakeRef(exec_ctx.host()->Construct<SnapshotDataset>(
+      *dataset, std::move(path), fingerprint.get(), num_shards,
+      max_prefetch_num, prefetch_threshold, exec_ctx.host()));
 }
 
 //===----------------------------------------------------------------------===//
@@ -166,6 +241,16 @@ RCReference<RepeatDataset> MakeRepeatDataset(RCReference<Dataset>* dataset,
   return TakeRef(host->Construct<RepeatDataset>(*dataset, count, host));
 }
 
+//===----------------------------------------------------------------------===//
+// CacheDataset
+//===----------------------------------------------------------------------===//
+
+RCReference<CacheDataset> MakeCacheDataset(RCReference<Dataset>* dataset,
+                                           const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  return TakeRef(host->Construct<CacheDataset>(*dataset, host));
+}
+
 //===----------------------------------------------------------------------===//
 // SkipDataset
 //===----------------------------------------------------------------------===//
@@ -177,6 +262,51 @@ RCReference<SkipDataset> MakeSkipDataset(RCReference<Dataset>* dataset,
   return TakeRef(host->Construct<SkipDataset>(*dataset, count, host));
 }
 
+//===----------------------------------------------------------------------===//
+// ShardDataset
+//===----------------------------------------------------------------------===//
+
+llvm::Expected<RCReference<ShardDataset>> MakeShardDataset(
+    RCReference<Dataset>* dataset, int64_t num_shards, int64_t index,
+    const ExecutionContext& exec_ctx) {
+  if (num_shards <= 0) {
+    return MakeStringError("num_shards must be positive, got ", num_shards);
+  }
+  if (index < 0 || index >= num_shards) {
+    return MakeStringError("index must be in [0, ", num_shards, "), got ",
+                           index);
+  }
+  HostContext* host = exec_ctx.host();
+  return TakeRef(
+      host->Construct<ShardDataset>(*dataset, num_shards, index, host));
+}
+
+//===----------------------------------------------------------------------===//
+// TakeDataset
+//===----------------------------------------------------------------------===//
+
+RCReference<TakeDataset> MakeTakeDataset(RCReference<Dataset>* dataset,
+                                         int64_t count,
+                                         Attribute<int64_t> arity,
+                                         const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  return TakeRef(
+      host->Construct<TakeDataset>(*dataset, count, arity.get(), host));
+}
+
+//===----------------------------------------------------------------------===//
+// ZipDataset
+//===----------------------------------------------------------------------===//
+
+RCReference<ZipDataset> MakeZipDataset(RemainingArguments args,
+                                       const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  SmallVector<RCReference<Dataset>, 4> datasets;
+  for (int i = 0, e = args.size(); i < e; ++i)
+    datasets.push_back(args[i]->get<RCReference<Dataset>>());
+  return TakeRef(host->Construct<ZipDataset>(std::move(datasets), host));
+}
+
 //===----------------------------------------------------------------------===//
 // MemoryDataset
 //===----------------------------------------------------------------------===//
@@ -201,6 +331,27 @@ RCReference<BatchDataset<T...>> MakeBatchDataset(
       *dataset, batch_size, same_input_metadata.get(), host));
 }
 
+//===----------------------------------------------------------------------===//
+// PaddedBatchDataset
+//===----------------------------------------------------------------------===//
+
+llvm::Expected<RCReference<PaddedBatchDataset>> MakePaddedBatchDataset(
+    RCReference<Dataset>* dataset, int64_t batch_size,
+    ArrayAttribute<int64_t> bucket_boundaries,
+    const ExecutionContext& exec_ctx) {
+  if (batch_size <= 0) {
+    return MakeStringError("batch_size must be positive, got ", batch_size);
+  }
+  auto boundaries = bucket_boundaries.data();
+  if (!std::is_sorted(boundaries.begin(), boundaries.end())) {
+    return MakeStringError("bucket_boundaries must be sorted");
+  }
+  HostContext* host = exec_ctx.host();
+  return TakeRef(host->Construct<PaddedBatchDataset>(
+      *dataset, batch_size,
+      std::vector<int64_t>(boundaries.begin(), boundaries.end()), host));
+}
+
 //===----------------------------------------------------------------------===//
 // PrefetchDataset
 //===----------------------------------------------------------------------===//
@@ -226,6 +377,36 @@ RCReference<Iterator> MakeIteratorFromDataset(RCReference<Dataset>* dataset) {
   return (*dataset)->MakeIterator(context);
 }
 
+// Create an iterator that points to the first element in the dataset, and
+// adjusts the buffer sizes and the parallelism of the input pipeline at
+// runtime. The total parallelism is bounded by `cpu_budget`, where -1 means the
+// number of worker threads, and the buffered bytes are bounded by `ram_budget`,
+// where 0 means unlimited. If the TFRT_DATA_LOG_AUTOTUNE_STATS environment
+// variable is set, the chosen values are logged when the iterator is destroyed.
+llvm::Expected<RCReference<Iterator>> MakeAutotunedIterator(
+    RCReference<Dataset>* dataset, Attribute<int64_t> cpu_budget,
+    Attribute<int64_t> ram_budget, const ExecutionContext& exec_ctx) {
+  if (cpu_budget.get() <= 0 && cpu_budget.get() != -1) {
+    return MakeStringError("cpu_budget must be positive or -1, got ",
+                           cpu_budget.get());
+  }
+  if (ram_budget.get() < 0) {
+    return MakeStringError("ram_budget must be non-negative, got ",
+                           ram_budget.get());
+  }
+  HostContext* host = exec_ctx.host();
+  AutotuneOptions options;
+  options.cpu_budget = cpu_budget.get();
+  if (options.cpu_budget == -1) {
+    options.cpu_budget = host->GetNumWorkerThreads();
+  }
+  options.ram_budget = ram_budget.get();
+  const char* log_stats = std::getenv("TFRT_DATA_LOG_AUTOTUNE_STATS");
+  return TakeRef(host->Construct<AutotunedIterator>(
+      dataset->get(), std::move(options), host,
+      /*log_stats=*/log_stats != nullptr && *log_stats != '\0'));
+}
+
 // Get the next element from the iterator and advance iterator.
 // The returned AsyncValueRef will contain error if the iterator has reached
 // end prior to the method invocation.
@@ -457,6 +638,8 @@ RCReference<LogDataset> MakeLogDataset(RCReference<Dataset>* dataset,
 void RegisterDataKernels(KernelRegistry* registry) {
   registry->AddKernel("tfrt_data.make_iterator",
                       TFRT_KERNEL(MakeIteratorFromDataset));
+  registry->AddKernel("tfrt_data.make_autotuned_iterator",
+                      TFRT_KERNEL(MakeAutotunedIterator));
   registry->AddKernel("tfrt_data.iterator_get_next",
                       TFRT_KERNEL(IteratorGetNext));
   registry->AddKernel("tfrt_data.enumerate.iterator",
@@ -484,24 +667,37 @@ void RegisterDataKernels(KernelRegistry* registry) {
                       TFRT_KERNEL(MakeBatchDataset<DenseHostTensor, int64_t>));
   registry->AddKernel("tfrt_data.batch_dataset.i64_and_i64",
                       TFRT_KERNEL(MakeBatchDataset<int64_t, int64_t>));
+  registry->AddKernel("tfrt_data.padded_batch_dataset",
+                      TFRT_KERNEL(MakePaddedBatchDataset));
 
   registry->AddKernel("tfrt_data.memory_dataset.i64",
                       TFRT_KERNEL(MakeMemoryDataset<int64_t>));
   registry->AddKernel("tfrt_data.memory_dataset.str",
                       TFRT_KERNEL(MakeMemoryDataset<std::string>));
 
+  registry->AddKernel("tfrt_data.cache_dataset", TFRT_KERNEL(MakeCacheDataset));
   registry->AddKernel("tfrt_data.filter_dataset",
                       TFRT_KERNEL(MakeFilterDataset));
   registry->AddKernel("tfrt_data.interleave_dataset",
                       TFRT_KERNEL(MakeInterleaveDataset));
   registry->AddKernel("tfrt_data.map_dataset", TFRT_KERNEL(MakeMapDataset));
+  registry->AddKernel("tfrt_data.parallel_map_dataset",
+                      TFRT_KERNEL(MakeParallelMapDataset));
   registry->AddKernel("tfrt_data.prefetch_dataset",
                       TFRT_KERNEL(MakePrefetchDataset));
   registry->AddKernel("tfrt_data.repeat_dataset",
                       TFRT_KERNEL(MakeRepeatDataset));
   registry->AddKernel("tfrt_data.skip_dataset", TFRT_KERNEL(MakeSkipDataset));
+  registry->AddKernel("tfrt_data.shard_dataset",
+                      TFRT_KERNEL(MakeShardDataset));
+  registry->AddKernel("tfrt_data.take_dataset", TFRT_KERNEL(MakeTakeDataset));
+  registry->AddKernel("tfrt_data.zip_dataset", TFRT_KERNEL(MakeZipDataset));
+  registry->AddKernel("tfrt_data.snapshot_dataset",
+                      TFRT_KERNEL(MakeSnapshotDataset));
   registry->AddKernel("tfrt_data.tf_record_dataset",
                       TFRT_KERNEL(MakeTFRecordDataset));
+  registry->AddKernel("tfrt_data.tf_record_dataset.zero_copy",
+                      TFRT_KERNEL(MakeZeroCopyTFRecordDataset));
   registry->AddKernel("tfrt_data.shuffle_dataset",
                       TFRT_KERNEL(MakeShuffleDataset));
   registry->AddKernel("tfrt_data.log_dataset", TFRT_KERNEL(MakeLogDataset));
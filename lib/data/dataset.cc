@@ -25,5 +25,12 @@ bool IsConcreteAndEmpty(const IterationResult& result) {
 }
 
 }  // namespace internal
+
+void Iterator::Skip(int64_t count, const ExecutionContext& exec_ctx) {
+  for (int64_t i = 0; i < count; ++i) {
+    auto result = GetNext(exec_ctx);
+    if (internal::IsConcreteAndEmpty(result)) return;
+  }
+}
 }  // namespace data
 }  // namespace tfrt
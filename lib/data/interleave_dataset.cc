@@ -62,6 +62,7 @@ IterationResult InterleaveDatasetIterator::GetNext(
   }
 
   MaybeScheduleBackgroundTask(exec_ctx, false, 0);
+  if (prefetch_iterator_num_) prefetch_iterator_num_->RecordOutput(result);
   return result;
 }
 
@@ -70,9 +71,12 @@ void InterleaveDatasetIterator::PreInitializeIntermediateIterators(
   if (is_input_iterator_eof_) return;
   auto* host = exec_ctx.host();
 
-  auto fetch_num = parent_dataset_->cycle_length_ +
-                   parent_dataset_->prefetch_iterator_num_ -
-                   num_open_iterators_;
+  // The number of open iterators might exceed the target if the autotuning
+  // model has reduced the number of pre-initialized iterators.
+  int64_t fetch_num = parent_dataset_->cycle_length_ +
+                      GetTunableValue(prefetch_iterator_num_,
+                                      parent_dataset_->prefetch_iterator_num_) -
+                      static_cast<int64_t>(num_open_iterators_);
   for (int i = 0; i < fetch_num; i++) {
     // Read value from the input iterator.
     auto input_value = input_iterator_->GetNext(exec_ctx);
@@ -23,6 +23,7 @@
 
 #include <queue>
 
+#include "tfrt/data/autotune.h"
 #include "tfrt/data/dataset.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/support/forward_decls.h"
@@ -105,6 +106,10 @@ class InterleaveDatasetIterator : public Iterator {
         parent_dataset_(std::move(parent_dataset)),
         input_iterator_(parent_dataset_->input_dataset_->MakeIterator(context)),
         context_(context),
+        prefetch_iterator_num_(MakeTunableParameter(
+            context, "interleave_dataset/prefetch_iterator_num",
+            TunableKind::kParallelism, parent_dataset_->prefetch_iterator_num_,
+            /*min=*/0)),
         token_owned_(false) {
     for (int i = 0; i < parent_dataset_->cycle_length_; ++i) {
       iterator_and_queues_.push_back(
@@ -244,6 +249,10 @@ class InterleaveDatasetIterator : public Iterator {
   RCReference<InterleaveDataset> parent_dataset_;
   RCReference<Iterator> input_iterator_;
   const IteratorContext context_;
+  // Set if the number of pre-initialized intermediate iterators is autotuned.
+  // The cycle length and the block length determine the order of the values,
+  // and are not tuned.
+  RCReference<TunableParameter> prefetch_iterator_num_;
   bool is_input_iterator_eof_ = false;
 
   // List of intermediate iterators and their states. The positions of those
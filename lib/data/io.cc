@@ -34,7 +34,7 @@ IterationResult PrefetchingIterator::GetNext(const ExecutionContext& exec_ctx) {
     // values has dropped below the threshold.
     if (!token_owned_ && !reached_eof_ &&
         prefetch_buffer_.size() <
-            prefetch_threshold_ + output_buffer_.size() + 1) {
+            PrefetchThreshold() + output_buffer_.size() + 1) {
       auto task = [iterator = FormRef(this), exec_ctx]() {
         TFRT_TRACE_SCOPE(Default, "ReadIOSource");
         iterator->ReadIOSource(exec_ctx);
@@ -66,15 +66,19 @@ IterationResult PrefetchingIterator::GetNext(const ExecutionContext& exec_ctx) {
             exec_ctx.location().Decode());
         host->EmitError(input.eof.GetError());
       }
+      if (tunable_max_prefetch_num_)
+        tunable_max_prefetch_num_->RecordOutput(input);
       return input;
     }
   }
 
-  llvm::SmallVector<RCReference<AsyncValue>, 1> result_values;
-  result_values.resize(1);
-  // The IndirectAsyncValue might be filled later by the background blocking
+  llvm::SmallVector<RCReference<AsyncValue>, 4> result_values;
+  result_values.reserve(num_values_);
+  // The IndirectAsyncValues might be filled later by the background blocking
   // thread.
-  result_values[0] = MakeIndirectAsyncValue(host);
+  for (size_t i = 0; i < num_values_; ++i) {
+    result_values.push_back(MakeIndirectAsyncValue(host));
+  }
   auto result_eof = MakeUnconstructedAsyncValueRef<bool>(host);
   auto result =
       IterationResult::Pending(std::move(result_values), std::move(result_eof));
@@ -93,15 +97,90 @@ IterationResult PrefetchingIterator::GetNext(const ExecutionContext& exec_ctx) {
       assert(output_buffer_.size() == 1);
       // Read the next element from IO source directly so that
       // output_buffer_size == prefetch_buffer_size.
-      auto input = GetNextElement(exec_ctx);
+      if (num_to_skip_ > 0)
+        SkipElements(exec_ctx, std::exchange(num_to_skip_, 0));
+      auto input = ReadNextElement(exec_ctx);
       prefetch_buffer_.push(std::move(input));
     }
   }
 
   MaterializeOutputs(exec_ctx);
+  if (tunable_max_prefetch_num_)
+    tunable_max_prefetch_num_->RecordOutput(result);
   return result;
 }
 
+void PrefetchingIterator::Skip(int64_t count,
+                               const ExecutionContext& exec_ctx) {
+  {
+    mutex_lock lock(mu_);
+    // The pending outputs have to be materialized before the elements after
+    // them, so skip through GetNext() in that case.
+    if (output_buffer_.empty()) {
+      while (count > 0 && !prefetch_buffer_.empty()) {
+        prefetch_buffer_.pop();
+        --count;
+      }
+      // Only the token owner can access the IO source. The elements are
+      // skipped before the next read, or dropped when a read in progress adds
+      // them to the prefetch buffer.
+      if (count > 0 && !reached_eof_) num_to_skip_ += count;
+      return;
+    }
+  }
+  Iterator::Skip(count, exec_ctx);
+}
+
+void PrefetchingIterator::SkipElements(const ExecutionContext& exec_ctx,
+                                       size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    auto element = GetNextElement(exec_ctx);
+    if (element.eof.IsConcrete() && element.eof.get()) return;
+  }
+}
+
+IterationResult PrefetchingIterator::ReadNextElement(
+    const ExecutionContext& exec_ctx) {
+  if (!tunable_max_prefetch_num_) return GetNextElement(exec_ctx);
+
+  auto start = std::chrono::steady_clock::now();
+  auto element = GetNextElement(exec_ctx);
+  tunable_max_prefetch_num_->RecordProduction(
+      element, std::chrono::steady_clock::now() - start);
+  return element;
+}
+
+void PrefetchingIterator::GetNextElements(
+    const ExecutionContext& exec_ctx, size_t max_count,
+    SmallVectorImpl<IterationResult>* elements) {
+  for (size_t i = 0; i < max_count; ++i) {
+    elements->push_back(GetNextElement(exec_ctx));
+    const auto& eof = elements->back().eof;
+    if (eof.IsError() || eof.get()) return;
+  }
+}
+
+void PrefetchingIterator::ReadNextElements(
+    const ExecutionContext& exec_ctx, size_t max_count,
+    SmallVectorImpl<IterationResult>* elements) {
+  if (max_count == 1) {
+    elements->push_back(ReadNextElement(exec_ctx));
+    return;
+  }
+  if (!tunable_max_prefetch_num_) {
+    GetNextElements(exec_ctx, max_count, elements);
+    return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  GetNextElements(exec_ctx, max_count, elements);
+  if (elements->empty()) return;
+  auto duration = (std::chrono::steady_clock::now() - start) / elements->size();
+  for (const auto& element : *elements) {
+    tunable_max_prefetch_num_->RecordProduction(element, duration);
+  }
+}
+
 void PrefetchingIterator::ReadIOSource(const ExecutionContext& exec_ctx) {
   while (true) {
     int64_t fetch_num;
@@ -111,30 +190,47 @@ void PrefetchingIterator::ReadIOSource(const ExecutionContext& exec_ctx) {
       // The caller is the token owner, there are enough prefetched values and
       // there is no output value to update. Release the token and return.
       if (output_buffer_.empty() &&
-          (prefetch_buffer_.size() >= prefetch_threshold_ || reached_eof_)) {
+          (prefetch_buffer_.size() >= PrefetchThreshold() || reached_eof_)) {
         token_owned_ = false;
         return;
       }
+      // The prefetch buffer might exceed the maximum if the autotuning model
+      // has reduced it.
       fetch_num =
-          max_prefetch_num_ + output_buffer_.size() - prefetch_buffer_.size();
+          static_cast<int64_t>(MaxPrefetchNum() + output_buffer_.size()) -
+          static_cast<int64_t>(prefetch_buffer_.size());
     }
-    for (int32_t i = 0; i < fetch_num; ++i) {
+    llvm::SmallVector<IterationResult, 16> inputs;
+    for (int64_t i = 0; i < fetch_num; i += inputs.size()) {
       if (exec_ctx.IsCancelled()) return;
       // Since only one thread can own the token, we can access the underlying
       // IO source without a lock.
-      auto input = GetNextElement(exec_ctx);
-      if (input.eof.IsConcrete() && input.eof.get()) {
-        mutex_lock lock(mu_);
-        reached_eof_ = true;
-        break;
-      }
+      inputs.clear();
+      if (size_t num_to_skip = TakeNumToSkip())
+        SkipElements(exec_ctx, num_to_skip);
+      ReadNextElements(
+          exec_ctx,
+          std::min<size_t>(fetch_num - i, max_read_batch_size_), &inputs);
       bool need_to_materialize_output = false;
+      bool reached_eof = false;
       {
         mutex_lock lock(mu_);
         need_to_materialize_output =
             prefetch_buffer_.empty() && !output_buffer_.empty();
-        prefetch_buffer_.push(std::move(input));
+        for (auto& input : inputs) {
+          if (input.eof.IsConcrete() && input.eof.get()) {
+            reached_eof_ = reached_eof = true;
+            break;
+          }
+          // Drop the elements skipped while they were being read.
+          if (num_to_skip_ > 0) {
+            --num_to_skip_;
+            continue;
+          }
+          prefetch_buffer_.push(std::move(input));
+        }
       }
+      if (reached_eof) break;
       // If prefetch_buffer was empty and output_buffer is not empty, it is
       // possible that data pipeline's control flow is blocked waiting for the
       // value in the output_buffer to be updated. For example, the
@@ -203,7 +299,8 @@ void PrefetchingIterator::MaterializeOutputs(const ExecutionContext& exec_ctx) {
     pairs.clear();
   }
   if (reached_eof && prefetch_buffer_size == 0) {
-    IterationResult eof_result = IterationResult::Eof(exec_ctx.host(), 1);
+    IterationResult eof_result =
+        IterationResult::Eof(exec_ctx.host(), num_values_);
     while (auto output = DequeueOutputBuffer()) {
       ForwardInputToOutput(eof_result.CopyRef(), std::move(output.getValue()),
                            exec_ctx);
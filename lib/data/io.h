@@ -19,10 +19,13 @@
 #ifndef TFRT_LIB_DATA_IO_H_
 #define TFRT_LIB_DATA_IO_H_
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <queue>
+#include <utility>
 
+#include "tfrt/data/autotune.h"
 #include "tfrt/data/dataset.h"
 #include "tfrt/host_context/execution_context.h"
 #include "tfrt/support/forward_decls.h"
@@ -55,14 +58,31 @@ namespace io {
 //
 // TODO(ezhulenev): Add flexible prefetching policy based not only on the number
 // of prefetched records, but also on the memory consumption.
+//
+// The prefetch policy can be adjusted at runtime by the autotuning model, see
+// IteratorContext.
 class PrefetchingIterator : public Iterator {
  public:
-  explicit PrefetchingIterator(int64_t max_prefetch_num,
+  // Each element read from the IO source has `num_values` values. The
+  // blocking tasks read up to `max_read_batch_size` elements at a time, and
+  // add them to the prefetch buffer at once.
+  //
+  // If autotuning is enabled in `context`, the maximum number of prefetched
+  // values is registered with the autotuning model under `name`, and the
+  // prefetch threshold is scaled with it.
+  explicit PrefetchingIterator(string_view name, size_t num_values,
+                               int64_t max_prefetch_num,
                                int64_t prefetch_threshold,
-                               const IteratorContext& context)
+                               const IteratorContext& context,
+                               int64_t max_read_batch_size = 1)
       : Iterator(),
+        num_values_(num_values),
         max_prefetch_num_(max_prefetch_num),
         prefetch_threshold_(prefetch_threshold),
+        max_read_batch_size_(std::max<int64_t>(1, max_read_batch_size)),
+        tunable_max_prefetch_num_(MakeTunableParameter(
+            context, name, TunableKind::kBufferSize, max_prefetch_num,
+            /*min=*/1)),
         token_owned_(false),
         reached_eof_(false) {}
 
@@ -77,6 +97,10 @@ class PrefetchingIterator : public Iterator {
   // before it completes.
   IterationResult GetNext(const ExecutionContext& exec_ctx) final;
 
+  // Drops the prefetched elements first. The rest of the elements are skipped
+  // in the IO source by SkipElements() before the next elements are read.
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) final;
+
  protected:
   // Reads the next element from the underlying IO source. Prefetching iterator
   // guarantees that all calls to this function will be properly synchronized.
@@ -89,6 +113,24 @@ class PrefetchingIterator : public Iterator {
   // forwards the error to an output value.
   virtual IterationResult GetNextElement(const ExecutionContext& exec_cxt) = 0;
 
+  // Reads up to `max_count` elements from the underlying IO source into
+  // `elements`, and stops after an element which is the end of iteration or an
+  // error. The same guarantees and requirements as for GetNextElement() apply.
+  // The default implementation calls GetNextElement() repeatedly. Iterators
+  // which can decode several elements at a lower cost per element can override
+  // it.
+  virtual void GetNextElements(const ExecutionContext& exec_ctx,
+                               size_t max_count,
+                               SmallVectorImpl<IterationResult>* elements);
+
+  // Skips up to `count` elements in the underlying IO source, and stops at the
+  // end of iteration, which is then returned by the next GetNextElement() call.
+  // Errors of the skipped elements are dropped. The same synchronization
+  // guarantees as for GetNextElement() apply. The default implementation calls
+  // GetNextElement() repeatedly. Iterators which can skip elements without
+  // decoding them override it.
+  virtual void SkipElements(const ExecutionContext& exec_ctx, size_t count);
+
  private:
   // Read data from IO source if there is more data to fetch. And it forwards
   // values from the prefetch_buffer_ to those values in the output_buffer_.
@@ -102,6 +144,33 @@ class PrefetchingIterator : public Iterator {
   // output_buffer_.
   void MaterializeOutputs(const ExecutionContext& exec_ctx);
 
+  // Reads the next element from the underlying IO source and records its
+  // production time if autotuning is enabled.
+  IterationResult ReadNextElement(const ExecutionContext& exec_ctx);
+
+  // Reads up to `max_count` elements from the underlying IO source and records
+  // their production time if autotuning is enabled.
+  void ReadNextElements(const ExecutionContext& exec_ctx, size_t max_count,
+                        SmallVectorImpl<IterationResult>* elements);
+
+  // Takes the number of elements to skip in the IO source before the next
+  // read.
+  size_t TakeNumToSkip() TFRT_EXCLUDES(mu_) {
+    mutex_lock lock(mu_);
+    return std::exchange(num_to_skip_, 0);
+  }
+
+  size_t MaxPrefetchNum() const {
+    return GetTunableValue(tunable_max_prefetch_num_, max_prefetch_num_);
+  }
+
+  size_t PrefetchThreshold() const {
+    if (!tunable_max_prefetch_num_ || max_prefetch_num_ == 0)
+      return prefetch_threshold_;
+    return tunable_max_prefetch_num_->value() * prefetch_threshold_ /
+           max_prefetch_num_;
+  }
+
   llvm::Optional<IterationResult> DequeueOutputBuffer() TFRT_EXCLUDES(mu_) {
     mutex_lock lock(mu_);
     if (output_buffer_.empty()) return llvm::None;
@@ -117,6 +186,8 @@ class PrefetchingIterator : public Iterator {
   // GetNext(...) caller.
   std::queue<IterationResult> output_buffer_ TFRT_GUARDED_BY(mu_);
 
+  // The number of values of each element.
+  const size_t num_values_;
   // Maximum number of values to prefetch from the underlying IO source
   // in addition to meeting the number of output values already requested in the
   // output_buffer_. The total number of values in the queues of the open
@@ -125,6 +196,10 @@ class PrefetchingIterator : public Iterator {
   // Schedule background blocking thread to prefetch from the underlying IO
   // source if the number of prefetched values dropped below this threadhold.
   const size_t prefetch_threshold_;
+  // Maximum number of elements read from the underlying IO source at a time.
+  const size_t max_read_batch_size_;
+  // Set if the maximum number of prefetched values is autotuned.
+  RCReference<TunableParameter> tunable_max_prefetch_num_;
 
   // This is a unique logical token for this iterator instance. It effectively
   // acts as a lock to ensure in-order delivery of results by guaranteeing that
@@ -134,6 +209,9 @@ class PrefetchingIterator : public Iterator {
   bool token_owned_ TFRT_GUARDED_BY(mu_);
   // Whether the iterator has reached eof.
   bool reached_eof_ TFRT_GUARDED_BY(mu_);
+  // The number of elements to drop from the IO source because of Skip() calls.
+  // The prefetch buffer is empty while it is not zero.
+  size_t num_to_skip_ TFRT_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace io
@@ -26,6 +26,9 @@ namespace data {
 // MapDataset methods
 //===----------------------------------------------------------------------===//
 RCReference<Iterator> MapDataset::MakeIterator(const IteratorContext& context) {
+  if (num_parallel_calls_ > 1)
+    return TakeRef(
+        host_->Construct<ParallelMapDatasetIterator>(FormRef(this), context));
   return TakeRef(host_->Construct<MapDatasetIterator>(FormRef(this), context));
 }
 
@@ -49,5 +52,173 @@ IterationResult MapDatasetIterator::GetNext(const ExecutionContext& exec_ctx) {
   return IterationResult::Pending(std::move(result), std::move(eof));
 }
 
+//===----------------------------------------------------------------------===//
+// ParallelMapDatasetIterator methods
+//===----------------------------------------------------------------------===//
+IterationResult ParallelMapDatasetIterator::MapNextInput(
+    const ExecutionContext& exec_ctx) {
+  auto input = input_iterator_->GetNext(exec_ctx);
+  const auto& map_fn = parent_dataset_->map_fn_;
+
+  // Do not run the function for the end of iteration, and stop taking elements
+  // from the input iterator.
+  if (input.eof.IsConcrete() && input.eof.get()) {
+    input_eof_ = true;
+    return IterationResult::Eof(exec_ctx.host(), map_fn->result_types().size());
+  }
+
+  SmallVector<RCReference<AsyncValue>, 4> arguments;
+  for (auto* value : parent_dataset_->additional_fn_args_.values())
+    arguments.push_back(FormRef(value));
+  for (auto& value : input.values) arguments.push_back(std::move(value));
+  auto result = EnqueueFunctionWhenReady(RCReference<const Function>(map_fn),
+                                         std::move(arguments), exec_ctx);
+  return IterationResult::Pending(std::move(result), std::move(input.eof));
+}
+
+// Forwards the values and the eof of the available `result` to `output`, which
+// was returned to the consumer before `result` became available.
+static void ForwardResult(IterationResult result,
+                          const IterationResult& output) {
+  for (size_t i = 0; i < output.values.size(); ++i) {
+    cast<IndirectAsyncValue>(output.values[i].get())
+        ->ForwardTo(std::move(result.values[i]));
+  }
+  if (result.eof.IsError()) {
+    output.eof.SetError(result.eof.GetError());
+  } else {
+    output.eof.emplace(result.eof.get());
+  }
+}
+
+IterationResult ParallelMapDatasetIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  if (!parent_dataset_->is_deterministic_) return GetNextCompleted(exec_ctx);
+
+  const int64_t num_parallel_calls = GetTunableValue(
+      num_parallel_calls_, parent_dataset_->num_parallel_calls_);
+  while (!input_eof_ &&
+         static_cast<int64_t>(buffer_.size()) < num_parallel_calls) {
+    auto start = std::chrono::steady_clock::now();
+    buffer_.push_back(MapNextInput(exec_ctx));
+    if (num_parallel_calls_)
+      num_parallel_calls_->RecordProduction(buffer_.back(), start);
+  }
+
+  if (buffer_.empty()) {
+    return IterationResult::Eof(
+        exec_ctx.host(), parent_dataset_->map_fn_->result_types().size());
+  }
+
+  auto result = std::move(buffer_.front());
+  buffer_.pop_front();
+  if (num_parallel_calls_) num_parallel_calls_->RecordOutput(result);
+  return result;
+}
+
+IterationResult ParallelMapDatasetIterator::GetNextCompleted(
+    const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+  const size_t num_results = parent_dataset_->map_fn_->result_types().size();
+  const int64_t num_parallel_calls = GetTunableValue(
+      num_parallel_calls_, parent_dataset_->num_parallel_calls_);
+  while (!input_eof_ && num_unclaimed_ < num_parallel_calls) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = MapNextInput(exec_ctx);
+    if (input_eof_) {
+      mutex_lock lock(mu_);
+      if (!eof_) eof_.emplace(std::move(result));
+      break;
+    }
+    ++num_unclaimed_;
+    if (num_parallel_calls_)
+      num_parallel_calls_->RecordProduction(result, start);
+    {
+      mutex_lock lock(mu_);
+      ++num_in_flight_;
+    }
+    auto values = result.AsyncValues();
+    RunWhenReady(values, [iterator = FormRef(this),
+                          result = std::move(result)]() mutable {
+      iterator->OnInvocationCompleted(std::move(result));
+    });
+  }
+  if (num_unclaimed_ > 0) --num_unclaimed_;
+
+  auto result = [&]() {
+    mutex_lock lock(mu_);
+    if (!completed_.empty()) {
+      auto result = std::move(completed_.front());
+      completed_.pop_front();
+      return result;
+    }
+    if (num_in_flight_ == 0) {
+      return eof_ ? eof_->CopyRef() : IterationResult::Eof(host, num_results);
+    }
+    SmallVector<RCReference<AsyncValue>, 4> values;
+    values.resize(num_results);
+    for (auto& value : values) value = MakeIndirectAsyncValue(host);
+    auto result = IterationResult::Pending(
+        std::move(values), MakeUnconstructedAsyncValueRef<bool>(host));
+    waiting_.push_back(result.CopyRef());
+    return result;
+  }();
+  if (num_parallel_calls_) num_parallel_calls_->RecordOutput(result);
+  return result;
+}
+
+void ParallelMapDatasetIterator::OnInvocationCompleted(IterationResult result) {
+  // Pairs of the results returned to the consumer and the available results
+  // they are resolved with. They are resolved without holding the lock, since
+  // resolving them runs the consumer's callbacks.
+  SmallVector<std::pair<IterationResult, IterationResult>, 4> ready;
+  {
+    mutex_lock lock(mu_);
+    --num_in_flight_;
+    if (internal::IsConcreteAndEmpty(result)) {
+      if (!eof_) eof_.emplace(std::move(result));
+    } else if (!waiting_.empty()) {
+      ready.emplace_back(std::move(waiting_.front()), std::move(result));
+      waiting_.pop_front();
+    } else {
+      completed_.push_back(std::move(result));
+    }
+    // No more values can be produced for the waiting consumers.
+    if (num_in_flight_ == 0 && eof_) {
+      while (!waiting_.empty()) {
+        ready.emplace_back(std::move(waiting_.front()), eof_->CopyRef());
+        waiting_.pop_front();
+      }
+    }
+  }
+  for (auto& pair : ready) ForwardResult(std::move(pair.second), pair.first);
+}
+
+void ParallelMapDatasetIterator::Skip(int64_t count,
+                                      const ExecutionContext& exec_ctx) {
+  if (!parent_dataset_->is_deterministic_) {
+    {
+      mutex_lock lock(mu_);
+      while (count > 0 && !completed_.empty()) {
+        completed_.pop_front();
+        --num_unclaimed_;
+        --count;
+      }
+    }
+    if (count > 0 && !input_eof_) input_iterator_->Skip(count, exec_ctx);
+    return;
+  }
+
+  // Keep the end of iteration in the buffer, so that it is returned by the next
+  // GetNext() call.
+  while (count > 0 && !buffer_.empty() &&
+         !internal::IsConcreteAndEmpty(buffer_.front())) {
+    buffer_.pop_front();
+    --count;
+  }
+  if (count > 0 && buffer_.empty() && !input_eof_)
+    input_iterator_->Skip(count, exec_ctx);
+}
+
 }  // namespace data
 }  // namespace tfrt
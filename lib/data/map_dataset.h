@@ -20,28 +20,53 @@
 #ifndef TFRT_LIB_DATA_MAP_DATASET_H_
 #define TFRT_LIB_DATA_MAP_DATASET_H_
 
+#include <deque>
+#include <list>
+
+#include "llvm/ADT/Optional.h"
+#include "tfrt/data/autotune.h"
 #include "tfrt/data/dataset.h"
 #include "tfrt/host_context/async_dispatch.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
 
 namespace tfrt {
 namespace data {
 
 class MapDatasetIterator;
+class ParallelMapDatasetIterator;
 
 // MapDataset maps a user-defined function over the elements in its input
 // dataset.
+//
+// If `num_parallel_calls` is greater than 1, up to `num_parallel_calls`
+// invocations of the function are kept in flight ahead of the consumer, and
+// each of them is executed on the work queue of the host. The number of
+// parallel calls is then adjusted at runtime if autotuning is enabled.
 class MapDataset : public Dataset {
  public:
   explicit MapDataset(RCReference<Dataset> input_dataset,
                       RCArray<AsyncValue> additional_fn_args,
                       RCReference<const Function> map_fn, HostContext* host)
+      : MapDataset(std::move(input_dataset), std::move(additional_fn_args),
+                   std::move(map_fn), /*num_parallel_calls=*/1,
+                   /*is_deterministic=*/true, host) {}
+
+  explicit MapDataset(RCReference<Dataset> input_dataset,
+                      RCArray<AsyncValue> additional_fn_args,
+                      RCReference<const Function> map_fn,
+                      int64_t num_parallel_calls, bool is_deterministic,
+                      HostContext* host)
       : input_dataset_(std::move(input_dataset)),
         host_(host),
         allocator_(host->allocator()),
         additional_fn_args_(std::move(additional_fn_args)),
-        map_fn_(std::move(map_fn)) {}
+        map_fn_(std::move(map_fn)),
+        num_parallel_calls_(num_parallel_calls),
+        is_deterministic_(is_deterministic) {
+    assert(num_parallel_calls_ > 0);
+  }
 
   // This class is not copyable or movable.
   MapDataset(const MapDataset&) = delete;
@@ -52,6 +77,7 @@ class MapDataset : public Dataset {
  private:
   // Allow iterator to rely on private data members of this dataset.
   friend class MapDatasetIterator;
+  friend class ParallelMapDatasetIterator;
 
   void Destroy() override {
     internal::DestroyImpl<MapDataset>(this, allocator_);
@@ -62,6 +88,12 @@ class MapDataset : public Dataset {
   HostAllocator* allocator_;
   RCArray<AsyncValue> additional_fn_args_;
   RCReference<const Function> map_fn_;
+  // The maximum number of function invocations in flight.
+  const int64_t num_parallel_calls_;
+  // If this is set to true, the dataset returns values in the order of the
+  // input elements. Otherwise, it might return the values in the order in which
+  // the function invocations complete.
+  const bool is_deterministic_;
 };
 
 // If all AsyncValue's in `arguments` are available at the time this method is
@@ -125,6 +157,49 @@ inline llvm::SmallVector<RCReference<AsyncValue>, 4> RunFunctionWhenReady(
   return results_copy;
 }
 
+// Similar to RunFunctionWhenReady(), but the function is always executed on the
+// work queue of the host when `arguments` are all available, so that multiple
+// invocations of the function can run in parallel. Returns a set of
+// IndirectAsyncValue's that are resolved with the function's execution
+// results.
+inline llvm::SmallVector<RCReference<AsyncValue>, 4> EnqueueFunctionWhenReady(
+    RCReference<const Function> function,
+    llvm::SmallVector<RCReference<AsyncValue>, 4> arguments,
+    const ExecutionContext& exec_ctx) {
+  auto num_results = function->result_types().size();
+  llvm::SmallVector<RCReference<IndirectAsyncValue>, 4> results;
+  llvm::SmallVector<RCReference<AsyncValue>, 4> results_copy;
+  results.resize(num_results);
+  results_copy.resize(num_results);
+  for (size_t i = 0; i < num_results; ++i) {
+    results[i] = MakeIndirectAsyncValue(exec_ctx.host());
+    results_copy[i] = results[i];
+  }
+
+  llvm::SmallVector<AsyncValue*, 4> argument_ptrs;
+  for (const auto& argument : arguments)
+    argument_ptrs.push_back(argument.get());
+
+  RunWhenReady(argument_ptrs, [function = std::move(function),
+                               arguments = std::move(arguments),
+                               results = std::move(results),
+                               argument_ptrs, exec_ctx]() mutable {
+    EnqueueWork(exec_ctx, [function = std::move(function),
+                           arguments = std::move(arguments),
+                           results = std::move(results), argument_ptrs,
+                           exec_ctx]() {
+      SmallVector<RCReference<AsyncValue>, 4> fn_results;
+      fn_results.resize(results.size());
+      function->Execute(exec_ctx, argument_ptrs, fn_results);
+      for (size_t i = 0; i < results.size(); ++i) {
+        results[i]->ForwardTo(std::move(fn_results[i]));
+      }
+    });
+  });
+
+  return results_copy;
+}
+
 class MapDatasetIterator : public Iterator {
  public:
   explicit MapDatasetIterator(RCReference<MapDataset> parent_dataset,
@@ -136,6 +211,11 @@ class MapDatasetIterator : public Iterator {
 
   IterationResult GetNext(const ExecutionContext& exec_ctx) override;
 
+  // Skips the input elements without running the map function on them.
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) override {
+    input_iterator_->Skip(count, exec_ctx);
+  }
+
  private:
   // This class is not copyable or movable.
   MapDatasetIterator(const MapDatasetIterator&) = delete;
@@ -150,6 +230,79 @@ class MapDatasetIterator : public Iterator {
   RCReference<Iterator> input_iterator_;
 };
 
+// ParallelMapDatasetIterator keeps up to `num_parallel_calls` invocations of
+// the map function in flight. The invocations are started in the order of the
+// input elements, and a new one is started whenever the consumer takes a
+// result. If the dataset is not deterministic, the results are returned in the
+// order in which the invocations complete.
+class ParallelMapDatasetIterator : public Iterator {
+ public:
+  explicit ParallelMapDatasetIterator(RCReference<MapDataset> parent_dataset,
+                                      const IteratorContext& context)
+      : Iterator(),
+        parent_dataset_(std::move(parent_dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(context)),
+        num_parallel_calls_(MakeTunableParameter(
+            context, "parallel_map_dataset/num_parallel_calls",
+            TunableKind::kParallelism, parent_dataset_->num_parallel_calls_,
+            /*min=*/1)) {}
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override;
+
+  // Drops the buffered invocations first, and skips the rest of the elements
+  // in the input iterator without running the map function on them.
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) override;
+
+ private:
+  // This class is not copyable or movable.
+  ParallelMapDatasetIterator(const ParallelMapDatasetIterator&) = delete;
+  ParallelMapDatasetIterator& operator=(const ParallelMapDatasetIterator&) =
+      delete;
+
+  void Destroy() override {
+    internal::DestroyImpl<ParallelMapDatasetIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  // Takes the next element from the input iterator and starts the map function
+  // invocation for it.
+  IterationResult MapNextInput(const ExecutionContext& exec_ctx);
+
+  // Returns the next result in the order in which the invocations complete. If
+  // no invocation has completed yet, the returned result is resolved by the
+  // next invocation that completes.
+  IterationResult GetNextCompleted(const ExecutionContext& exec_ctx);
+
+  // Hands the available `result` of an invocation to the oldest consumer that
+  // is waiting for one, or keeps it for the next GetNext() call.
+  void OnInvocationCompleted(IterationResult result) TFRT_EXCLUDES(mu_);
+
+  RCReference<MapDataset> parent_dataset_;
+  RCReference<Iterator> input_iterator_;
+  // Set if the number of parallel calls is autotuned.
+  RCReference<TunableParameter> num_parallel_calls_;
+  // Results of the function invocations in flight, in the input order. Only
+  // used if the dataset is deterministic.
+  std::list<IterationResult> buffer_;
+  // True if the input iterator is known to have reached the end.
+  bool input_eof_ = false;
+
+  // The members below are only used if the dataset is not deterministic.
+  //
+  // Number of invocations started but not yet claimed by a GetNext() call.
+  int64_t num_unclaimed_ = 0;
+  mutex mu_;
+  // Number of invocations whose results are not available yet.
+  int64_t num_in_flight_ TFRT_GUARDED_BY(mu_) = 0;
+  // Results of the completed invocations not yet returned, in completion order.
+  std::deque<IterationResult> completed_ TFRT_GUARDED_BY(mu_);
+  // Results returned to the consumer before any invocation completed for them.
+  std::deque<IterationResult> waiting_ TFRT_GUARDED_BY(mu_);
+  // The end of iteration. It is returned only after all invocations in flight
+  // have completed, since any of them might still produce a value.
+  llvm::Optional<IterationResult> eof_ TFRT_GUARDED_BY(mu_);
+};
+
 }  // namespace data
 }  // namespace tfrt
 
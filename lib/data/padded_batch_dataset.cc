@@ -0,0 +1,381 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements PaddedBatchDataset class which wraps around another
+// Dataset instance and batches tensors of different shapes by padding them.
+
+#include "padded_batch_dataset.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "tfrt/host_context/async_dispatch.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+// The minimum number of bytes copied by a parallel task.
+static constexpr size_t kMinBytesPerTask = 256 * 1024;
+
+// Copies `src` into the `index`-th slot of `dst`, whose dimensions are at least
+// as large as the dimensions of `src`. The padding is filled with zeros.
+static void CopyToSlot(const DenseHostTensor& src, DenseHostTensor* dst,
+                       size_t index) {
+  const size_t slot_size =
+      dst->DataSizeInBytes() / dst->shape().GetDimensionSize(0);
+  char* slot = static_cast<char*>(dst->data()) + index * slot_size;
+  // The shapes are the same if the sizes are.
+  if (src.DataSizeInBytes() == slot_size) {
+    std::memcpy(slot, src.data(), slot_size);
+    return;
+  }
+  std::memset(slot, 0, slot_size);
+  if (src.NumElements() == 0) return;
+
+  // Copy the innermost rows of `src` one by one. `dst_strides` are the strides
+  // of the slot in bytes.
+  const int rank = src.shape().GetRank();
+  SmallVector<Index, 4> src_dims;
+  src.shape().GetDimensions(&src_dims);
+  SmallVector<size_t, 4> dst_strides(rank);
+  dst_strides[rank - 1] = GetHostSize(src.dtype());
+  for (int i = rank - 2; i >= 0; --i)
+    dst_strides[i] = dst_strides[i + 1] * dst->shape().GetDimensionSize(i + 2);
+
+  const size_t row_size = src_dims[rank - 1] * dst_strides[rank - 1];
+  const char* src_row = static_cast<const char*>(src.data());
+  SmallVector<Index, 4> row_index(rank - 1, 0);
+  size_t dst_offset = 0;
+  while (true) {
+    std::memcpy(slot + dst_offset, src_row, row_size);
+    src_row += row_size;
+    // Advance to the next row, like an odometer.
+    int i = rank - 2;
+    for (; i >= 0; --i) {
+      dst_offset += dst_strides[i];
+      if (++row_index[i] < src_dims[i]) break;
+      dst_offset -= row_index[i] * dst_strides[i];
+      row_index[i] = 0;
+    }
+    if (i < 0) return;
+  }
+}
+
+// Batches the available `elements` into DenseHostTensors, and forwards the
+// IndirectAsyncValues in `outputs` to them. Returns the error which is
+// forwarded to `outputs` if the elements have an error or incompatible shapes,
+// or nullptr otherwise.
+static RCReference<AsyncValue> MakePaddedBatch(
+    SmallVector<IterationResult, 4> elements,
+    ArrayRef<RCReference<AsyncValue>> outputs,
+    const ExecutionContext& exec_ctx) {
+  auto forward_error = [&](RCReference<AsyncValue> error) {
+    for (auto& output : outputs)
+      cast<IndirectAsyncValue>(output.get())->ForwardTo(error);
+    return error;
+  };
+  if (elements.empty()) {
+    return forward_error(
+        MakeErrorAsyncValueRef(exec_ctx.host(), "iterator reached end"));
+  }
+  for (auto& element : elements) {
+    if (element.eof.IsError()) return forward_error(element.eof.CopyRCRef());
+    for (auto& value : element.values) {
+      if (value->IsError()) return forward_error(value);
+    }
+  }
+  for (auto& element : elements) {
+    if (element.values.size() != outputs.size()) {
+      return forward_error(EmitErrorAsync(
+          exec_ctx, StrCat("padded batch elements must have ", outputs.size(),
+                           " components, got ", element.values.size())));
+    }
+    for (size_t i = 0, e = element.values.size(); i < e; ++i) {
+      if (!element.values[i]->IsType<DenseHostTensor>()) {
+        return forward_error(EmitErrorAsync(
+            exec_ctx, StrCat("padded batch component ", i,
+                             " must be a DenseHostTensor")));
+      }
+    }
+  }
+
+  // The dimensions of each component are the maximum dimensions of the
+  // component in the batch.
+  const size_t batch_size = elements.size();
+  SmallVector<DenseHostTensor, 4> tensors;
+  size_t element_size = 0;
+  for (size_t i = 0, e = outputs.size(); i < e; ++i) {
+    const auto& first = elements[0].values[i]->get<DenseHostTensor>();
+    SmallVector<Index, 4> dims;
+    dims.push_back(batch_size);
+    for (int d = 0, rank = first.shape().GetRank(); d < rank; ++d)
+      dims.push_back(first.shape().GetDimensionSize(d));
+    for (auto& element : elements) {
+      const auto& tensor = element.values[i]->get<DenseHostTensor>();
+      if (tensor.dtype() != first.dtype() ||
+          static_cast<size_t>(tensor.shape().GetRank()) + 1 != dims.size()) {
+        return forward_error(EmitErrorAsync(
+            exec_ctx, StrCat("padded batch component ", i,
+                             " has incompatible tensors ", first.metadata(),
+                             " and ", tensor.metadata())));
+      }
+      for (size_t d = 1; d < dims.size(); ++d)
+        dims[d] = std::max(dims[d], tensor.shape().GetDimensionSize(d - 1));
+    }
+
+    auto tensor = DenseHostTensor::CreateUninitialized(
+        TensorMetadata(first.dtype(), dims), exec_ctx.host());
+    if (!tensor) {
+      return forward_error(
+          EmitErrorAsync(exec_ctx, "failed to create uninitialized tensor"));
+    }
+    element_size += tensor->DataSizeInBytes() / batch_size;
+    tensors.push_back(std::move(*tensor));
+  }
+
+  SmallVector<AsyncValueRef<DenseHostTensor>, 4> results;
+  for (auto& output : outputs) {
+    results.push_back(
+        MakeUnconstructedAsyncValueRef<DenseHostTensor>(exec_ctx.host()));
+    cast<IndirectAsyncValue>(output.get())
+        ->ForwardTo(results.back().CopyRCRef());
+  }
+
+  // Copy the elements into the preallocated tensors in parallel.
+  struct PaddedBatch {
+    SmallVector<IterationResult, 4> elements;
+    SmallVector<DenseHostTensor, 4> tensors;
+  };
+  auto batch = std::make_shared<PaddedBatch>(
+      PaddedBatch{std::move(elements), std::move(tensors)});
+  ParallelFor(exec_ctx).Execute(
+      batch_size,
+      ParallelFor::BlockSizes::Min(
+          std::max<size_t>(1, kMinBytesPerTask / std::max<size_t>(
+                                                     1, element_size))),
+      [batch](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          auto& values = batch->elements[i].values;
+          for (size_t j = 0, e = values.size(); j < e; ++j) {
+            CopyToSlot(values[j]->get<DenseHostTensor>(), &batch->tensors[j],
+                       i);
+          }
+        }
+      },
+      [batch, results = std::move(results)]() {
+        for (size_t i = 0, e = results.size(); i < e; ++i)
+          results[i].emplace(std::move(batch->tensors[i]));
+      });
+  return {};
+}
+
+//===----------------------------------------------------------------------===//
+// PaddedBatchDataset methods
+//===----------------------------------------------------------------------===//
+RCReference<Iterator> PaddedBatchDataset::MakeIterator(
+    const IteratorContext& context) {
+  return TakeRef(
+      host_->Construct<PaddedBatchDatasetIterator>(FormRef(this), context));
+}
+
+//===----------------------------------------------------------------------===//
+// PaddedBatchDatasetIterator methods
+//===----------------------------------------------------------------------===//
+IterationResult PaddedBatchDatasetIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  if (!parent_dataset_->bucket_boundaries_.empty())
+    return GetNextBucketed(exec_ctx);
+
+  HostContext* host = exec_ctx.host();
+  Batch inputs;
+  // Get up to batch_size values from the underlying iterator.
+  for (int i = 0; i < parent_dataset_->batch_size_; ++i)
+    inputs.push_back(input_iterator_->GetNext(exec_ctx));
+
+  SmallVector<RCReference<AsyncValue>, 4> values;
+  for (size_t i = 0, e = inputs[0].values.size(); i < e; ++i)
+    values.push_back(MakeIndirectAsyncValue(host));
+  // result's eof should be exactly the same as the eof of the first input.
+  auto result =
+      IterationResult::Pending(std::move(values), inputs[0].eof.CopyRef());
+
+  // The shapes of the batch are only known when all the inputs are available.
+  SmallVector<AsyncValue*, 8> async_values;
+  for (const auto& input : inputs) {
+    auto input_async_values = input.AsyncValues();
+    async_values.append(input_async_values.begin(), input_async_values.end());
+  }
+  RunWhenReady(async_values, [inputs = std::move(inputs),
+                              result = result.CopyRef(), exec_ctx]() mutable {
+    // Drop the inputs after the end of iteration.
+    auto eof = std::find_if(inputs.begin(), inputs.end(), [](auto& input) {
+      return internal::IsConcreteAndEmpty(input);
+    });
+    inputs.erase(eof, inputs.end());
+    MakePaddedBatch(std::move(inputs), result.values, exec_ctx);
+  });
+  return result;
+}
+
+IterationResult PaddedBatchDatasetIterator::GetNextBucketed(
+    const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  if (!is_initialized_) {
+    is_initialized_ = true;
+    first_input_ = input_iterator_->GetNext(exec_ctx);
+    num_components_ = first_input_->values.size();
+  }
+
+  SmallVector<RCReference<AsyncValue>, 4> values;
+  for (size_t i = 0; i < num_components_; ++i)
+    values.push_back(MakeIndirectAsyncValue(host));
+  auto result = IterationResult::Pending(
+      std::move(values), MakeUnconstructedAsyncValueRef<bool>(host));
+  {
+    mutex_lock lock(mu_);
+    output_buffer_.push(result.CopyRef());
+  }
+  FillOutputs(exec_ctx, /*is_token_owner=*/false);
+  return result;
+}
+
+void PaddedBatchDatasetIterator::FillOutputs(const ExecutionContext& exec_ctx,
+                                             bool is_token_owner) {
+  while (true) {
+    {
+      mutex_lock lock(mu_);
+      // There is no more output value to update. Release the token if the
+      // caller owns the token and then return.
+      if (output_buffer_.empty()) {
+        if (is_token_owner) token_owned_ = false;
+        return;
+      }
+      // Return since the token is already owned by another thread.
+      if (!is_token_owner && token_owned_) return;
+      token_owned_ = is_token_owner = true;
+    }
+
+    // Only the token owner removes outputs, so there is an output to fill.
+    if (!ready_batches_.empty()) {
+      auto output = std::move(*DequeueOutputBuffer());
+      auto batch = std::move(ready_batches_.front());
+      ready_batches_.pop();
+      auto error = MakePaddedBatch(std::move(batch), output.values, exec_ctx);
+      if (error) {
+        output.eof.SetError(error->GetError());
+      } else {
+        output.eof.emplace(false);
+      }
+      continue;
+    }
+
+    if (input_eof_) {
+      // Return the partial batches of the buckets, and then the end of
+      // iteration.
+      auto bucket = std::find_if(buckets_.begin(), buckets_.end(),
+                                 [](const Batch& b) { return !b.empty(); });
+      if (bucket != buckets_.end()) {
+        ready_batches_.push(std::move(*bucket));
+        bucket->clear();
+        continue;
+      }
+      auto eof = IterationResult::Eof(exec_ctx.host(), num_components_);
+      while (auto output = DequeueOutputBuffer()) {
+        for (size_t i = 0; i < num_components_; ++i) {
+          cast<IndirectAsyncValue>(output->values[i].get())
+              ->ForwardTo(eof.values[i]);
+        }
+        output->eof.emplace(true);
+      }
+      continue;
+    }
+
+    // Get as many inputs as needed to fill a bucket, and add them to the
+    // buckets when they are available.
+    Batch inputs;
+    if (first_input_) {
+      inputs.push_back(std::move(*first_input_));
+      first_input_.reset();
+    }
+    while (static_cast<int64_t>(inputs.size()) < parent_dataset_->batch_size_)
+      inputs.push_back(input_iterator_->GetNext(exec_ctx));
+
+    SmallVector<AsyncValue*, 8> async_values;
+    for (const auto& input : inputs) {
+      auto input_async_values = input.AsyncValues();
+      async_values.append(input_async_values.begin(), input_async_values.end());
+    }
+    if (std::all_of(async_values.begin(), async_values.end(),
+                    [](AsyncValue* value) { return value->IsAvailable(); })) {
+      AddToBuckets(&inputs);
+      continue;
+    }
+    RunWhenReady(async_values, [iterator = FormRef(this),
+                                inputs = std::move(inputs),
+                                exec_ctx]() mutable {
+      iterator->AddToBuckets(&inputs);
+      iterator->FillOutputs(exec_ctx, /*is_token_owner=*/true);
+    });
+    return;
+  }
+}
+
+void PaddedBatchDatasetIterator::AddToBuckets(
+    SmallVectorImpl<IterationResult>* inputs) {
+  const auto& boundaries = parent_dataset_->bucket_boundaries_;
+  for (auto& input : *inputs) {
+    if (internal::IsConcreteAndEmpty(input)) {
+      input_eof_ = true;
+      return;
+    }
+    const bool has_error =
+        input.eof.IsError() ||
+        std::any_of(input.values.begin(), input.values.end(),
+                    [](const auto& value) { return value->IsError(); });
+    const bool is_tensor = input.values.empty() ||
+                           input.values[0]->IsType<DenseHostTensor>();
+    if (has_error || !is_tensor) {
+      // The error is returned in order, as a batch of its own. The batch of
+      // an invalid element reports the error.
+      Batch batch;
+      batch.push_back(std::move(input));
+      ready_batches_.push(std::move(batch));
+      continue;
+    }
+
+    // The length of a scalar is 0.
+    Index length = 0;
+    if (!input.values.empty()) {
+      const auto& shape = input.values[0]->get<DenseHostTensor>().shape();
+      if (shape.GetRank() > 0) length = shape.GetDimensionSize(0);
+    }
+    auto& bucket = buckets_[std::upper_bound(boundaries.begin(),
+                                             boundaries.end(), length) -
+                            boundaries.begin()];
+    bucket.push_back(std::move(input));
+    if (static_cast<int64_t>(bucket.size()) == parent_dataset_->batch_size_) {
+      ready_batches_.push(std::move(bucket));
+      bucket.clear();
+    }
+  }
+}
+
+}  // namespace data
+}  // namespace tfrt
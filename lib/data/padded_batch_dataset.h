@@ -0,0 +1,169 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares PaddedBatchDataset class which wraps around another
+// Dataset instance and batches tensors of different shapes by padding them.
+
+#ifndef TFRT_DATA_PADDED_BATCH_DATASET_H_
+#define TFRT_DATA_PADDED_BATCH_DATASET_H_
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/data/dataset.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace data {
+
+class PaddedBatchDatasetIterator;
+
+// PaddedBatchDataset wraps around another Dataset instance whose elements are
+// DenseHostTensors, and batches up to `batch_size` elements. Unlike
+// BatchDataset, the tensors of a component can have different shapes, e.g.
+// sequences of different lengths. Each dimension of a component is padded with
+// zeros to its maximum size in the batch.
+//
+// The output tensor of each component is allocated once per batch, after all
+// the elements of the batch are available, and the elements are copied into
+// their slots in parallel.
+//
+// If `bucket_boundaries` is not empty, the elements are grouped by the size of
+// the first dimension of their first component, which is their length. The
+// bucket i holds the lengths in [bucket_boundaries[i-1], bucket_boundaries[i]),
+// and a batch is returned when a bucket has `batch_size` elements, so that the
+// elements of a batch have similar lengths and less padding is copied. The
+// partial batches of the buckets are returned at the end of the input, in the
+// order of the buckets.
+class PaddedBatchDataset : public Dataset {
+ public:
+  explicit PaddedBatchDataset(RCReference<Dataset> input_dataset,
+                              int64_t batch_size,
+                              std::vector<int64_t> bucket_boundaries,
+                              HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        batch_size_(batch_size),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        host_(host),
+        allocator_(host->allocator()) {
+    assert(batch_size_ > 0);
+    assert(std::is_sorted(bucket_boundaries_.begin(),
+                          bucket_boundaries_.end()));
+  }
+
+  // This class is not copyable or movable.
+  PaddedBatchDataset(const PaddedBatchDataset&) = delete;
+  PaddedBatchDataset& operator=(const PaddedBatchDataset&) = delete;
+
+  RCReference<Iterator> MakeIterator(const IteratorContext& context) override;
+
+ private:
+  // Allow iterator to rely on private data members of this dataset.
+  friend class PaddedBatchDatasetIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<PaddedBatchDataset>(this, allocator_);
+  }
+
+  RCReference<Dataset> input_dataset_;
+  const int64_t batch_size_;
+  const std::vector<int64_t> bucket_boundaries_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+class PaddedBatchDatasetIterator : public Iterator {
+ public:
+  explicit PaddedBatchDatasetIterator(
+      RCReference<PaddedBatchDataset> parent_dataset,
+      const IteratorContext& context)
+      : Iterator(),
+        parent_dataset_(std::move(parent_dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(context)),
+        buckets_(parent_dataset_->bucket_boundaries_.size() + 1) {}
+
+  // This class is not copyable or movable.
+  PaddedBatchDatasetIterator(const PaddedBatchDatasetIterator&) = delete;
+  PaddedBatchDatasetIterator& operator=(const PaddedBatchDatasetIterator&) =
+      delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override;
+
+ private:
+  using Batch = SmallVector<IterationResult, 4>;
+
+  void Destroy() override {
+    internal::DestroyImpl<PaddedBatchDatasetIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  // Returns an element with pending values, which are forwarded to a batch by
+  // FillOutputs().
+  IterationResult GetNextBucketed(const ExecutionContext& exec_ctx);
+
+  // Fills the pending outputs with the batches of the buckets, and gets more
+  // elements from the input iterator while there are pending outputs. Only the
+  // thread which holds the token runs it, which guarantees in-order delivery
+  // without blocking GetNext().
+  void FillOutputs(const ExecutionContext& exec_ctx, bool is_token_owner)
+      TFRT_EXCLUDES(mu_);
+
+  // Adds available input elements to the buckets, and moves the full buckets
+  // to ready_batches_.
+  void AddToBuckets(SmallVectorImpl<IterationResult>* inputs);
+
+  // Dequeues the first pending output, or returns llvm::None if there is none.
+  llvm::Optional<IterationResult> DequeueOutputBuffer() TFRT_EXCLUDES(mu_) {
+    mutex_lock lock(mu_);
+    if (output_buffer_.empty()) return llvm::None;
+    auto output = std::move(output_buffer_.front());
+    output_buffer_.pop();
+    return std::move(output);
+  }
+
+  RCReference<PaddedBatchDataset> parent_dataset_;
+  RCReference<Iterator> input_iterator_;
+  // The number of components of each element, which is known once an element
+  // has been returned by the input iterator.
+  size_t num_components_ = 0;
+  bool is_initialized_ = false;
+
+  // The state below is only used in the bucketing mode.
+  mutex mu_;
+  // The outputs which have been returned to the GetNext() caller.
+  std::queue<IterationResult> output_buffer_ TFRT_GUARDED_BY(mu_);
+  // Whether a thread is running FillOutputs().
+  bool token_owned_ TFRT_GUARDED_BY(mu_) = false;
+  // The state below is only accessed by the token owner, except for
+  // first_input_ which is set by the first GetNext() call.
+  // The first element, which is taken to learn the number of components.
+  llvm::Optional<IterationResult> first_input_;
+  std::vector<Batch> buckets_;
+  // The batches which are ready to be returned, in order. A batch whose only
+  // element has an error forwards the error.
+  std::queue<Batch> ready_batches_;
+  bool input_eof_ = false;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_DATA_PADDED_BATCH_DATASET_H_
@@ -39,11 +39,16 @@ RCReference<Iterator> PrefetchDataset::MakeIterator(
 //===----------------------------------------------------------------------===//
 IterationResult PrefetchDatasetIterator::GetNext(
     const ExecutionContext& exec_ctx) {
-  while (buffer_.size() < parent_dataset_->prefetch_num_ + 1) {
+  const int64_t prefetch_num =
+      GetTunableValue(prefetch_num_, parent_dataset_->prefetch_num_);
+  while (buffer_.size() < prefetch_num + 1) {
+    auto start = std::chrono::steady_clock::now();
     buffer_.push(input_iterator_->GetNext(exec_ctx));
+    if (prefetch_num_) prefetch_num_->RecordProduction(buffer_.back(), start);
   }
   auto result = std::move(buffer_.front());
   buffer_.pop();
+  if (prefetch_num_) prefetch_num_->RecordOutput(result);
   return result;
 }
 
@@ -62,19 +67,25 @@ static bool AvailableAndNotEof(const IterationResult& result) {
 
 IterationResult NonDeterministicPrefetchDatasetIterator::GetNext(
     const ExecutionContext& exec_ctx) {
-  while (buffer_.size() < parent_dataset_->prefetch_num_ + 1) {
+  const int64_t prefetch_num =
+      GetTunableValue(prefetch_num_, parent_dataset_->prefetch_num_);
+  while (buffer_.size() < prefetch_num + 1) {
+    auto start = std::chrono::steady_clock::now();
     buffer_.push_back(input_iterator_->GetNext(exec_ctx));
+    if (prefetch_num_) prefetch_num_->RecordProduction(buffer_.back(), start);
   }
   for (auto it = buffer_.begin(), e = buffer_.end(); it != e; ++it) {
     if (AvailableAndNotEof(*it)) {
       auto value = std::move(*it);
       buffer_.erase(it);
+      if (prefetch_num_) prefetch_num_->RecordOutput(value);
       return value;
     }
   }
 
   auto result = std::move(buffer_.front());
   buffer_.pop_front();
+  if (prefetch_num_) prefetch_num_->RecordOutput(result);
   return result;
 }
 
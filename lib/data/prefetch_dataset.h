@@ -24,6 +24,7 @@
 #include <list>
 #include <queue>
 
+#include "tfrt/data/autotune.h"
 #include "tfrt/data/dataset.h"
 #include "tfrt/support/forward_decls.h"
 
@@ -75,8 +76,10 @@ class PrefetchDatasetIterator : public Iterator {
                                    const IteratorContext& context)
       : Iterator(),
         parent_dataset_(std::move(parent_dataset)),
-        input_iterator_(
-            parent_dataset_->input_dataset_->MakeIterator(context)) {}
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(context)),
+        prefetch_num_(MakeTunableParameter(
+            context, "prefetch_dataset/prefetch_num", TunableKind::kBufferSize,
+            parent_dataset_->prefetch_num_, /*min=*/0)) {}
 
   // This class is not copyable or movable.
   PrefetchDatasetIterator(const PrefetchDatasetIterator&) = delete;
@@ -92,6 +95,8 @@ class PrefetchDatasetIterator : public Iterator {
 
   RCReference<PrefetchDataset> parent_dataset_;
   RCReference<Iterator> input_iterator_;
+  // Set if the prefetch buffer size is autotuned.
+  RCReference<TunableParameter> prefetch_num_;
   std::queue<IterationResult> buffer_;
 };
 
@@ -103,8 +108,10 @@ class NonDeterministicPrefetchDatasetIterator : public Iterator {
       const IteratorContext& context)
       : Iterator(),
         parent_dataset_(std::move(parent_dataset)),
-        input_iterator_(
-            parent_dataset_->input_dataset_->MakeIterator(context)) {}
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(context)),
+        prefetch_num_(MakeTunableParameter(
+            context, "prefetch_dataset/prefetch_num", TunableKind::kBufferSize,
+            parent_dataset_->prefetch_num_, /*min=*/0)) {}
 
   // This class is not copyable or movable.
   NonDeterministicPrefetchDatasetIterator(const PrefetchDatasetIterator&) =
@@ -122,6 +129,8 @@ class NonDeterministicPrefetchDatasetIterator : public Iterator {
 
   RCReference<PrefetchDataset> parent_dataset_;
   RCReference<Iterator> input_iterator_;
+  // Set if the prefetch buffer size is autotuned.
+  RCReference<TunableParameter> prefetch_num_;
   std::list<IterationResult> buffer_;
 };
 
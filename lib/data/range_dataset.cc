@@ -55,6 +55,18 @@ IterationResult RangeDatasetIterator::GetNext(
   return IterationResult::Values(std::move(values), host);
 }
 
+void RangeDatasetIterator::Skip(int64_t count,
+                                const ExecutionContext& exec_ctx) {
+  const int64_t step = dataset_->step_;
+  const int64_t stop = dataset_->stop_;
+  // The number of elements left, rounded up. Computing next_ + count * step
+  // directly could overflow.
+  const int64_t remaining =
+      step > 0 ? (next_ < stop ? (stop - next_ + step - 1) / step : 0)
+               : (next_ > stop ? (next_ - stop - step - 1) / -step : 0);
+  next_ = count < remaining ? next_ + count * step : stop;
+}
+
 //===----------------------------------------------------------------------===//
 // RangeDataset methods
 //===----------------------------------------------------------------------===//
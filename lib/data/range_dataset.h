@@ -74,6 +74,8 @@ class RangeDatasetIterator : public Iterator {
 
   IterationResult GetNext(const ExecutionContext& exec_ctx) override;
 
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) override;
+
  private:
   void Destroy() override {
     internal::DestroyImpl<RangeDatasetIterator>(this, dataset_->allocator_);
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements ShardDataset class which wraps around another Dataset
+// instance and yields one out of every `num_shards` elements of that dataset.
+
+#include "shard_dataset.h"
+
+namespace tfrt {
+namespace data {
+
+//===----------------------------------------------------------------------===//
+// ShardDataset methods
+//===----------------------------------------------------------------------===//
+RCReference<Iterator> ShardDataset::MakeIterator(
+    const IteratorContext& context) {
+  return TakeRef(
+      host_->Construct<ShardDatasetIterator>(FormRef(this), context));
+}
+
+//===----------------------------------------------------------------------===//
+// ShardDatasetIterator methods
+//===----------------------------------------------------------------------===//
+IterationResult ShardDatasetIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  // The IterationResult returned to the caller will provide the correct EOF
+  // information if the input iterator reaches the end while skipping.
+  input_iterator_->Skip(NumToSkip(), exec_ctx);
+  is_first_ = false;
+  return input_iterator_->GetNext(exec_ctx);
+}
+
+void ShardDatasetIterator::Skip(int64_t count,
+                                const ExecutionContext& exec_ctx) {
+  if (count <= 0) return;
+  // Skip the elements in between the shard elements too, except for the ones
+  // after the last skipped element which are skipped by the next GetNext().
+  const int64_t num_shards = parent_dataset_->num_shards_;
+  input_iterator_->Skip(NumToSkip() + 1 + (count - 1) * num_shards, exec_ctx);
+  is_first_ = false;
+}
+
+}  // namespace data
+}  // namespace tfrt
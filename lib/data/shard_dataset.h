@@ -0,0 +1,106 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares ShardDataset class which wraps around another Dataset
+// instance and yields one out of every `num_shards` elements of that dataset.
+
+#ifndef TFRT_DATA_SHARD_DATASET_H_
+#define TFRT_DATA_SHARD_DATASET_H_
+
+#include "tfrt/data/dataset.h"
+
+namespace tfrt {
+namespace data {
+
+class ShardDatasetIterator;
+
+// ShardDataset wraps around another Dataset instance and yields the elements
+// whose index in that dataset is `index` modulo `num_shards`. The other
+// elements are skipped with Iterator::Skip(), so that e.g. the records of a
+// TFRecordDataset which belong to the other shards are not decoded.
+class ShardDataset : public Dataset {
+ public:
+  explicit ShardDataset(RCReference<Dataset> input_dataset, int64_t num_shards,
+                        int64_t index, HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        num_shards_(num_shards),
+        index_(index),
+        host_(host),
+        allocator_(host->allocator()) {
+    assert(num_shards_ > 0);
+    assert(index_ >= 0 && index_ < num_shards_);
+  }
+
+  // This class is not copyable or movable.
+  ShardDataset(const ShardDataset&) = delete;
+  ShardDataset& operator=(const ShardDataset&) = delete;
+
+  RCReference<Iterator> MakeIterator(const IteratorContext& context) override;
+
+ private:
+  friend class ShardDatasetIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<ShardDataset>(this, allocator_);
+  }
+
+  RCReference<Dataset> input_dataset_;
+  const int64_t num_shards_;
+  const int64_t index_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+class ShardDatasetIterator : public Iterator {
+ public:
+  explicit ShardDatasetIterator(RCReference<ShardDataset> dataset,
+                                const IteratorContext& context)
+      : Iterator(),
+        parent_dataset_(std::move(dataset)),
+        input_iterator_(
+            parent_dataset_->input_dataset_->MakeIterator(context)) {}
+
+  // This class is not copyable or movable.
+  ShardDatasetIterator(const ShardDatasetIterator&) = delete;
+  ShardDatasetIterator& operator=(const ShardDatasetIterator&) = delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override;
+
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) override;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<ShardDatasetIterator>(this,
+                                                parent_dataset_->allocator_);
+  }
+
+  // Returns the number of input elements to skip before the next element of
+  // the shard.
+  int64_t NumToSkip() const {
+    return is_first_ ? parent_dataset_->index_
+                     : parent_dataset_->num_shards_ - 1;
+  }
+
+  RCReference<ShardDataset> parent_dataset_;
+  RCReference<Iterator> input_iterator_;
+  // Whether no element of the shard has been returned or skipped yet.
+  bool is_first_ = true;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_DATA_SHARD_DATASET_H_
@@ -36,14 +36,21 @@ RCReference<Iterator> SkipDataset::MakeIterator(
 IterationResult SkipDatasetIterator::GetNext(const ExecutionContext& exec_ctx) {
   if (!is_skip_done_) {
     is_skip_done_ = true;
-    for (int i = 0, e = parent_dataset_->count_; i < e; ++i) {
-      // Skip the first `count` values. The IterationResult returned to the
-      // caller will provide the correct EOF information.
-      input_iterator_->GetNext(exec_ctx);
-    }
+    // Skip the first `count` values. The IterationResult returned to the
+    // caller will provide the correct EOF information.
+    input_iterator_->Skip(parent_dataset_->count_, exec_ctx);
   }
   return input_iterator_->GetNext(exec_ctx);
 }
 
+void SkipDatasetIterator::Skip(int64_t count,
+                               const ExecutionContext& exec_ctx) {
+  if (!is_skip_done_) {
+    is_skip_done_ = true;
+    count += parent_dataset_->count_;
+  }
+  input_iterator_->Skip(count, exec_ctx);
+}
+
 }  // namespace data
 }  // namespace tfrt
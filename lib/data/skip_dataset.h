@@ -72,6 +72,8 @@ class SkipDatasetIterator : public Iterator {
 
   IterationResult GetNext(const ExecutionContext& exec_ctx) override;
 
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) override;
+
  private:
   void Destroy() override {
     internal::DestroyImpl<SkipDatasetIterator>(this,
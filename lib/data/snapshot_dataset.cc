@@ -0,0 +1,487 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements SnapshotDataset class which wraps around another Dataset
+// instance and materializes its elements in files on the local disk.
+
+#include "snapshot_dataset.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "tfrt/host_context/async_dispatch.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/logging.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/tensor/btf.h"
+#include "tfrt/tensor/btf_util.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+namespace fs = ::llvm::sys::fs;
+
+//===----------------------------------------------------------------------===//
+// Snapshot file format
+//===----------------------------------------------------------------------===//
+
+// The version of the snapshot file format. Snapshots of other versions are
+// ignored and rewritten.
+static constexpr uint64_t kSnapshotVersion = 1;
+
+// The metadata of a complete snapshot. This struct directly maps to the
+// on-disk structure of the metadata file.
+struct SnapshotMetadata {
+  uint64_t version;
+  // The hash of the fingerprint of the dataset which wrote the snapshot.
+  uint64_t fingerprint;
+  uint64_t num_shards;
+  uint64_t num_elements;
+  // The number of values of each element.
+  uint64_t num_values;
+};
+
+// The kind of a value stored in a snapshot element. Do not change the enum
+// values: The enum values are persisted in snapshots.
+enum class SnapshotValueKind : uint8_t {
+  kDenseHostTensor = 0,
+  kString = 1,
+  kScalar = 2,
+};
+
+static std::string MetadataPath(string_view path) {
+  return StrCat(path, "/snapshot.metadata");
+}
+
+static std::string ShardPath(string_view path, int64_t index) {
+  return StrCat(path, "/shard_", index, ".snapshot");
+}
+
+static llvm::Expected<SnapshotMetadata> ReadSnapshotMetadata(
+    string_view path, uint64_t fingerprint) {
+  std::ifstream stream(MetadataPath(path), std::ios_base::binary);
+  SnapshotMetadata metadata;
+  if (!stream || !ReadStream(&stream, &metadata)) {
+    return MakeStringError("no complete snapshot in ", path);
+  }
+  if (metadata.version != kSnapshotVersion) {
+    return MakeStringError("unsupported snapshot version ", metadata.version);
+  }
+  if (metadata.fingerprint != fingerprint) {
+    return MakeStringError("snapshot in ", path,
+                           " was written by another input pipeline");
+  }
+  return metadata;
+}
+
+// Writes the metadata to a temporary file, and then atomically renames it, so
+// that readers never observe a partially written metadata file.
+static llvm::Error WriteSnapshotMetadata(string_view path,
+                                         const SnapshotMetadata& metadata) {
+  const std::string metadata_path = MetadataPath(path);
+  const std::string tmp_path = StrCat(metadata_path, ".tmp");
+  {
+    std::ofstream stream(tmp_path, std::ios_base::binary);
+    if (!WriteStream(&stream, &metadata) || (stream.close(), stream.fail())) {
+      return MakeStringError("failed to write ", tmp_path);
+    }
+  }
+  if (std::error_code ec = fs::rename(tmp_path, metadata_path)) {
+    return MakeStringError("failed to rename ", tmp_path, ": ", ec.message());
+  }
+  return llvm::Error::success();
+}
+
+// Recursive base case: `value` is not a scalar of a supported type.
+template <int N>
+static llvm::Error WriteScalar(std::ostream* stream, const AsyncValue& value) {
+  return MakeStringError("unsupported value type in snapshot element");
+}
+
+// Writes `value` if it is a scalar of type T or of one of RemainingT.
+template <int N, typename T, typename... RemainingT>
+static llvm::Error WriteScalar(std::ostream* stream, const AsyncValue& value) {
+  if (!value.IsType<T>()) return WriteScalar<N, RemainingT...>(stream, value);
+  const auto kind = SnapshotValueKind::kScalar;
+  const auto dtype = btf::GetTensorDType(T());
+  if (!WriteStream(stream, &kind) || !WriteStream(stream, &dtype) ||
+      !WriteStream(stream, &value.get<T>())) {
+    return MakeStringError("failed to write scalar");
+  }
+  return llvm::Error::success();
+}
+
+static llvm::Error WriteValue(std::ostream* stream, const AsyncValue& value) {
+  if (value.IsType<DenseHostTensor>()) {
+    const auto kind = SnapshotValueKind::kDenseHostTensor;
+    if (!WriteStream(stream, &kind)) {
+      return MakeStringError("failed to write value kind");
+    }
+    const Tensor* tensor = &value.get<DenseHostTensor>();
+    return WriteTensorsToBTF(stream, tensor);
+  }
+  if (value.IsType<std::string>()) {
+    const auto kind = SnapshotValueKind::kString;
+    const auto& str = value.get<std::string>();
+    const uint64_t size = str.size();
+    if (!WriteStream(stream, &kind) || !WriteStream(stream, &size) ||
+        !WriteStream(stream, str.data(), size)) {
+      return MakeStringError("failed to write string");
+    }
+    return llvm::Error::success();
+  }
+  return WriteScalar<0, int8_t, int16_t, int32_t, int64_t, uint8_t, uint16_t,
+                     uint32_t, uint64_t, float, double>(stream, value);
+}
+
+static llvm::Error WriteSnapshotElement(
+    std::ostream* stream, ArrayRef<RCReference<AsyncValue>> values) {
+  const uint64_t num_values = values.size();
+  if (!WriteStream(stream, &num_values)) {
+    return MakeStringError("failed to write number of values");
+  }
+  for (const auto& value : values) {
+    if (auto error = WriteValue(stream, *value)) return error;
+  }
+  return llvm::Error::success();
+}
+
+template <typename T>
+static llvm::Expected<RCReference<AsyncValue>> ReadScalar(std::istream* stream,
+                                                          HostContext* host) {
+  T value;
+  if (!ReadStream(stream, &value)) {
+    return MakeStringError("failed to read scalar");
+  }
+  return MakeAvailableAsyncValueRef<T>(host, value).ReleaseRCRef();
+}
+
+static llvm::Expected<RCReference<AsyncValue>> ReadValue(std::istream* stream,
+                                                         HostContext* host) {
+  SnapshotValueKind kind;
+  if (!ReadStream(stream, &kind)) {
+    return MakeStringError("failed to read value kind");
+  }
+  switch (kind) {
+    case SnapshotValueKind::kDenseHostTensor: {
+      // The tensor is stored as a BTF file with a single tensor, whose offsets
+      // are relative to the start of the BTF file.
+      const uint64_t start = stream->tellg();
+      auto offsets = ReadBTFOffsets(stream);
+      if (!offsets) return offsets.takeError();
+      if (offsets->size() != 1) {
+        return MakeStringError("unexpected number of tensors ",
+                               offsets->size());
+      }
+      auto dht = ReadDHTFromBTF(stream, start + offsets->front(), host);
+      if (!dht) return dht.takeError();
+      // Skip the padding of the tensor data to the BTF alignment.
+      const size_t remainder = dht->DataSizeInBytes() % 8;
+      if (remainder != 0) stream->seekg(8 - remainder, std::ios_base::cur);
+      return MakeAvailableAsyncValueRef<DenseHostTensor>(host, std::move(*dht))
+          .ReleaseRCRef();
+    }
+    case SnapshotValueKind::kString: {
+      uint64_t size;
+      if (!ReadStream(stream, &size)) {
+        return MakeStringError("failed to read string size");
+      }
+      std::string str(size, '\0');
+      if (!ReadStream(stream, &str[0], size)) {
+        return MakeStringError("failed to read string");
+      }
+      return MakeAvailableAsyncValueRef<std::string>(host, std::move(str))
+          .ReleaseRCRef();
+    }
+    case SnapshotValueKind::kScalar: {
+      btf::TensorDType dtype;
+      if (!ReadStream(stream, &dtype)) {
+        return MakeStringError("failed to read scalar dtype");
+      }
+      switch (dtype) {
+        case btf::TensorDType::kInt8:
+          return ReadScalar<int8_t>(stream, host);
+        case btf::TensorDType::kInt16:
+          return ReadScalar<int16_t>(stream, host);
+        case btf::TensorDType::kInt32:
+          return ReadScalar<int32_t>(stream, host);
+        case btf::TensorDType::kInt64:
+          return ReadScalar<int64_t>(stream, host);
+        case btf::TensorDType::kFloat32:
+          return ReadScalar<float>(stream, host);
+        case btf::TensorDType::kFloat64:
+          return ReadScalar<double>(stream, host);
+        case btf::TensorDType::kUInt8:
+          return ReadScalar<uint8_t>(stream, host);
+        case btf::TensorDType::kUInt16:
+          return ReadScalar<uint16_t>(stream, host);
+        case btf::TensorDType::kUInt32:
+          return ReadScalar<uint32_t>(stream, host);
+        case btf::TensorDType::kUInt64:
+          return ReadScalar<uint64_t>(stream, host);
+      }
+      return MakeStringError("unexpected scalar dtype ", dtype);
+    }
+  }
+  return MakeStringError("unexpected value kind ", static_cast<int>(kind));
+}
+
+static llvm::Expected<SmallVector<RCReference<AsyncValue>, 4>>
+ReadSnapshotElement(std::istream* stream, HostContext* host) {
+  uint64_t num_values;
+  if (!ReadStream(stream, &num_values)) {
+    return MakeStringError("failed to read number of values");
+  }
+  SmallVector<RCReference<AsyncValue>, 4> values;
+  values.reserve(num_values);
+  for (uint64_t i = 0; i < num_values; ++i) {
+    auto value = ReadValue(stream, host);
+    if (!value) return value.takeError();
+    values.push_back(std::move(*value));
+  }
+  return std::move(values);
+}
+
+//===----------------------------------------------------------------------===//
+// SnapshotDataset methods
+//===----------------------------------------------------------------------===//
+RCReference<Iterator> SnapshotDataset::MakeIterator(
+    const IteratorContext& context) {
+  auto metadata = ReadSnapshotMetadata(path_, fingerprint_);
+  if (metadata) {
+    return TakeRef(host_->Construct<SnapshotDatasetReaderIterator>(
+        FormRef(this), metadata->num_shards, metadata->num_elements,
+        metadata->num_values, context));
+  }
+  llvm::consumeError(metadata.takeError());
+
+  {
+    mutex_lock lock(mu_);
+    if (has_writer_) {
+      // Another iterator is writing the snapshot. Iterate over the input
+      // dataset without writing.
+      return input_dataset_->MakeIterator(context);
+    }
+    has_writer_ = true;
+  }
+  return TakeRef(
+      host_->Construct<SnapshotDatasetWriterIterator>(FormRef(this), context));
+}
+
+void SnapshotDataset::ReleaseWriter() {
+  mutex_lock lock(mu_);
+  has_writer_ = false;
+}
+
+//===----------------------------------------------------------------------===//
+// SnapshotDatasetWriterIterator methods
+//===----------------------------------------------------------------------===//
+static bool IsAvailable(const IterationResult& result) {
+  return llvm::all_of(result.AsyncValues(),
+                      [](AsyncValue* value) { return value->IsAvailable(); });
+}
+
+SnapshotDatasetWriterIterator::~SnapshotDatasetWriterIterator() {
+  if (!done_) Abandon();
+}
+
+IterationResult SnapshotDatasetWriterIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  auto input = input_iterator_->GetNext(exec_ctx);
+  auto output = input.CopyRef();
+  {
+    mutex_lock lock(mu_);
+    if (reached_eof_) return input;
+    PendingElement element{input.CopyRef(), AsyncValueRef<bool>()};
+    // The end of iteration is forwarded to the consumer only after the snapshot
+    // is complete, so that the iterator created by the consumer at the end of
+    // iteration, e.g. by RepeatDataset, reads from the snapshot.
+    if (!input.eof.IsConcrete() || input.eof.get()) {
+      element.output_eof = MakeUnconstructedAsyncValueRef<bool>(host);
+      output.eof = element.output_eof.CopyRef();
+    }
+    if (input.eof.IsConcrete() && input.eof.get()) reached_eof_ = true;
+    queue_.push(std::move(element));
+  }
+
+  RunWhenReady(input.AsyncValues(), [iterator = FormRef(this), host]() {
+    iterator->MaybeScheduleWrite(host);
+  });
+  return output;
+}
+
+void SnapshotDatasetWriterIterator::MaybeScheduleWrite(HostContext* host) {
+  {
+    mutex_lock lock(mu_);
+    if (writing_ || queue_.empty() || !IsAvailable(queue_.front().input))
+      return;
+    writing_ = true;
+  }
+  // Writing to the files might block, so it is done in a blocking task. If the
+  // task can not be enqueued, the elements are written by the caller.
+  if (!EnqueueBlockingWork(host, [iterator = FormRef(this)]() {
+        iterator->WriteAvailableElements();
+      })) {
+    WriteAvailableElements();
+  }
+}
+
+void SnapshotDatasetWriterIterator::WriteAvailableElements() {
+  while (true) {
+    llvm::Optional<PendingElement> element;
+    {
+      mutex_lock lock(mu_);
+      if (queue_.empty() || !IsAvailable(queue_.front().input)) {
+        writing_ = false;
+        return;
+      }
+      element.emplace(std::move(queue_.front()));
+      queue_.pop();
+    }
+
+    const auto& input_eof = element->input.eof;
+    if (!done_) {
+      if (auto error = WriteElement(element->input)) {
+        // The snapshot is an optimization, so the elements are still returned
+        // to the consumer.
+        TFRT_LOG(WARNING) << "Abandoning snapshot in "
+                          << parent_dataset_->path_ << ": "
+                          << llvm::toString(std::move(error));
+        Abandon();
+      }
+    }
+    if (!element->output_eof) continue;
+
+    if (input_eof.IsError()) {
+      element->output_eof.SetError(input_eof.GetError());
+    } else {
+      element->output_eof.emplace(input_eof.get());
+    }
+  }
+}
+
+llvm::Error SnapshotDatasetWriterIterator::WriteElement(
+    const IterationResult& element) {
+  if (element.eof.IsError()) {
+    // Do not complete a snapshot of a partial iteration. The error is
+    // forwarded to the consumer by the element itself.
+    Abandon();
+    return llvm::Error::success();
+  }
+
+  const auto& path = parent_dataset_->path_;
+  if (shards_.empty()) {
+    // Overwrite the shards of a previously abandoned snapshot or of a snapshot
+    // of another input pipeline, if any. The metadata of the latter is removed
+    // first, so that it never describes the shards being written.
+    if (std::error_code ec = fs::create_directories(path)) {
+      return MakeStringError("failed to create ", path, ": ", ec.message());
+    }
+    if (std::error_code ec = fs::remove(MetadataPath(path))) {
+      return MakeStringError("failed to remove ", MetadataPath(path), ": ",
+                             ec.message());
+    }
+    for (int64_t i = 0; i < parent_dataset_->num_shards_; ++i) {
+      shards_.emplace_back(ShardPath(path, i),
+                           std::ios_base::binary | std::ios_base::trunc);
+      if (!shards_.back()) {
+        return MakeStringError("failed to open ", ShardPath(path, i));
+      }
+    }
+  }
+
+  if (!element.eof.get()) {
+    auto& shard = shards_[num_elements_ % shards_.size()];
+    if (auto error = WriteSnapshotElement(&shard, element.values)) return error;
+    ++num_elements_;
+    return llvm::Error::success();
+  }
+
+  // The end of iteration completes the snapshot.
+  for (auto& shard : shards_) {
+    shard.close();
+    if (shard.fail()) return MakeStringError("failed to close shard");
+  }
+  SnapshotMetadata metadata;
+  metadata.version = kSnapshotVersion;
+  metadata.fingerprint = parent_dataset_->fingerprint_;
+  metadata.num_shards = shards_.size();
+  metadata.num_elements = num_elements_;
+  metadata.num_values = element.values.size();
+  if (auto error = WriteSnapshotMetadata(path, metadata)) return error;
+
+  done_ = true;
+  shards_.clear();
+  parent_dataset_->ReleaseWriter();
+  return llvm::Error::success();
+}
+
+void SnapshotDatasetWriterIterator::Abandon() {
+  done_ = true;
+  if (!shards_.empty()) {
+    shards_.clear();
+    const auto& path = parent_dataset_->path_;
+    for (int64_t i = 0; i < parent_dataset_->num_shards_; ++i)
+      fs::remove(ShardPath(path, i));
+    fs::remove(StrCat(MetadataPath(path), ".tmp"));
+  }
+  parent_dataset_->ReleaseWriter();
+}
+
+//===----------------------------------------------------------------------===//
+// SnapshotDatasetReaderIterator methods
+//===----------------------------------------------------------------------===//
+IterationResult SnapshotDatasetReaderIterator::GetNextElement(
+    const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  if (next_index_ == num_elements_) {
+    return IterationResult::Eof(host, num_values_);
+  }
+  if (auto error = MaybeOpenShards()) {
+    // Do not decode location or emit error because the local handler might have
+    // been freed.
+    auto async_error = MakeErrorAsyncValueRef(host, StrCat(error));
+    return IterationResult::Error(std::move(async_error), num_values_);
+  }
+
+  auto values =
+      ReadSnapshotElement(&shards_[next_index_ % num_shards_], host);
+  if (!values) {
+    auto error = MakeErrorAsyncValueRef(
+        host, StrCat("failed to read snapshot element ", next_index_, ": ",
+                     values.takeError()));
+    return IterationResult::Error(std::move(error), num_values_);
+  }
+  ++next_index_;
+  return IterationResult::Values(std::move(*values), host);
+}
+
+llvm::Error SnapshotDatasetReaderIterator::MaybeOpenShards() {
+  if (!shards_.empty()) return llvm::Error::success();
+  for (int64_t i = 0; i < num_shards_; ++i) {
+    const auto shard_path = ShardPath(parent_dataset_->path_, i);
+    shards_.emplace_back(shard_path, std::ios_base::binary);
+    if (!shards_.back()) {
+      shards_.clear();
+      return MakeStringError("failed to open ", shard_path);
+    }
+  }
+  return llvm::Error::success();
+}
+
+}  // namespace data
+}  // namespace tfrt
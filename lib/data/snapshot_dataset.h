@@ -0,0 +1,226 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares SnapshotDataset class which wraps around another Dataset
+// instance and materializes its elements in files on the local disk.
+
+#ifndef TFRT_LIB_DATA_SNAPSHOT_DATASET_H_
+#define TFRT_LIB_DATA_SNAPSHOT_DATASET_H_
+
+#include <fstream>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "io.h"
+#include "llvm/Support/xxhash.h"
+#include "tfrt/data/dataset.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace data {
+
+class SnapshotDatasetWriterIterator;
+class SnapshotDatasetReaderIterator;
+
+// SnapshotDataset wraps around another Dataset instance and writes the
+// elements of the first complete iteration of the input dataset to a snapshot
+// directory on the local disk. If the directory contains a complete snapshot
+// when an iterator is created, e.g. in the later epochs of a RepeatDataset or
+// in a later run of the program, the iterator reads the elements from the
+// snapshot with prefetching instead of iterating over the input dataset.
+//
+// `fingerprint` identifies the input pipeline and the spec of its elements,
+// e.g. it is a hash of the graph the pipeline is lowered from. A snapshot
+// written with another fingerprint is ignored and overwritten.
+//
+// The elements are distributed round-robin over `num_shards` shard files. Each
+// element is stored as its number of values followed by the values, where a
+// DenseHostTensor is stored in the Binary Tensor Format (BTF), a string as its
+// length followed by its bytes, and a scalar as its BTF dtype followed by its
+// bytes. A metadata file is written after all shards are complete, so that an
+// abandoned snapshot is never read.
+//
+// Only one iterator writes the snapshot at a time. Iterators created while the
+// snapshot is being written iterate over the input dataset without writing. If
+// writing fails, the partial snapshot is removed and the elements are still
+// returned to the consumer.
+class SnapshotDataset : public Dataset {
+ public:
+  explicit SnapshotDataset(RCReference<Dataset> input_dataset, std::string path,
+                           string_view fingerprint, int64_t num_shards,
+                           int64_t max_prefetch_num, int64_t prefetch_threshold,
+                           HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        path_(std::move(path)),
+        fingerprint_(llvm::xxHash64(fingerprint)),
+        num_shards_(num_shards),
+        max_prefetch_num_(max_prefetch_num),
+        prefetch_threshold_(prefetch_threshold),
+        host_(host),
+        allocator_(host->allocator()) {
+    assert(num_shards_ > 0);
+  }
+
+  // This class is not copyable or movable.
+  SnapshotDataset(const SnapshotDataset&) = delete;
+  SnapshotDataset& operator=(const SnapshotDataset&) = delete;
+
+  RCReference<Iterator> MakeIterator(const IteratorContext& context) override;
+
+ private:
+  friend class SnapshotDatasetWriterIterator;
+  friend class SnapshotDatasetReaderIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<SnapshotDataset>(this, allocator_);
+  }
+
+  // Called by the writer iterator when it stops writing the snapshot.
+  void ReleaseWriter() TFRT_EXCLUDES(mu_);
+
+  RCReference<Dataset> input_dataset_;
+  const std::string path_;
+  // The hash of the fingerprint, which is stored in the snapshot metadata.
+  const uint64_t fingerprint_;
+  const int64_t num_shards_;
+  const int64_t max_prefetch_num_;
+  const int64_t prefetch_threshold_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+
+  mutex mu_;
+  // Whether an iterator is writing the snapshot.
+  bool has_writer_ TFRT_GUARDED_BY(mu_) = false;
+};
+
+// SnapshotDatasetWriterIterator returns the elements of the input iterator,
+// and writes them to the snapshot in blocking tasks in the order they are
+// returned. The end of iteration is forwarded to the consumer after the
+// snapshot is complete or abandoned.
+class SnapshotDatasetWriterIterator : public Iterator {
+ public:
+  explicit SnapshotDatasetWriterIterator(RCReference<SnapshotDataset> dataset,
+                                         const IteratorContext& context)
+      : Iterator(),
+        parent_dataset_(std::move(dataset)),
+        input_iterator_(
+            parent_dataset_->input_dataset_->MakeIterator(context)) {}
+
+  ~SnapshotDatasetWriterIterator() override;
+
+  // This class is not copyable or movable.
+  SnapshotDatasetWriterIterator(const SnapshotDatasetWriterIterator&) = delete;
+  SnapshotDatasetWriterIterator& operator=(
+      const SnapshotDatasetWriterIterator&) = delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override;
+
+ private:
+  // An element returned to the consumer which is not written yet.
+  struct PendingElement {
+    IterationResult input;
+    // If set, the eof returned to the consumer, which is set after the element
+    // is written.
+    AsyncValueRef<bool> output_eof;
+  };
+
+  void Destroy() override {
+    internal::DestroyImpl<SnapshotDatasetWriterIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  // Enqueues a blocking task to write the available elements at the front of
+  // the queue, unless a task is already running.
+  void MaybeScheduleWrite(HostContext* host) TFRT_EXCLUDES(mu_);
+
+  // Writes the available elements at the front of the queue.
+  void WriteAvailableElements() TFRT_EXCLUDES(mu_);
+
+  // Writes `element` to the snapshot, or completes the snapshot if `element`
+  // is the end of iteration. Returns the error which made writing fail, if
+  // any.
+  llvm::Error WriteElement(const IterationResult& element);
+
+  // Stops writing the snapshot, e.g. because of an error, and removes the
+  // shards written so far. The remaining elements are forwarded to the
+  // consumer without being written.
+  void Abandon();
+
+  RCReference<SnapshotDataset> parent_dataset_;
+  RCReference<Iterator> input_iterator_;
+
+  mutex mu_;
+  std::queue<PendingElement> queue_ TFRT_GUARDED_BY(mu_);
+  // Whether a blocking task is writing the elements of the queue.
+  bool writing_ TFRT_GUARDED_BY(mu_) = false;
+  // Whether an element whose eof is known to be true has been enqueued. The
+  // later elements are forwarded without being written.
+  bool reached_eof_ TFRT_GUARDED_BY(mu_) = false;
+
+  // The state below is only accessed by the task which writes the queue.
+  bool done_ = false;
+  std::vector<std::ofstream> shards_;
+  int64_t num_elements_ = 0;
+};
+
+// SnapshotDatasetReaderIterator reads the elements of a complete snapshot.
+class SnapshotDatasetReaderIterator : public io::PrefetchingIterator {
+ public:
+  explicit SnapshotDatasetReaderIterator(RCReference<SnapshotDataset> dataset,
+                                         int64_t num_shards,
+                                         int64_t num_elements,
+                                         int64_t num_values,
+                                         const IteratorContext& context)
+      : io::PrefetchingIterator("snapshot_dataset/max_prefetch_num",
+                                num_values, dataset->max_prefetch_num_,
+                                dataset->prefetch_threshold_, context),
+        parent_dataset_(std::move(dataset)),
+        num_shards_(num_shards),
+        num_elements_(num_elements),
+        num_values_(num_values) {}
+
+  // This class is not copyable or movable.
+  SnapshotDatasetReaderIterator(const SnapshotDatasetReaderIterator&) = delete;
+  SnapshotDatasetReaderIterator& operator=(
+      const SnapshotDatasetReaderIterator&) = delete;
+
+ protected:
+  // Reads the next element from the shard it is stored in.
+  IterationResult GetNextElement(const ExecutionContext& exec_ctx) final;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<SnapshotDatasetReaderIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  llvm::Error MaybeOpenShards();
+
+  RCReference<SnapshotDataset> parent_dataset_;
+  const int64_t num_shards_;
+  const int64_t num_elements_;
+  const int64_t num_values_;
+  std::vector<std::ifstream> shards_;
+  int64_t next_index_ = 0;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_SNAPSHOT_DATASET_H_
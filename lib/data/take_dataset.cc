@@ -0,0 +1,56 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements TakeDataset class which wraps around another Dataset
+// instance and yields at most a specified number of elements of that dataset.
+
+#include "take_dataset.h"
+
+#include <algorithm>
+
+namespace tfrt {
+namespace data {
+
+//===----------------------------------------------------------------------===//
+// TakeDataset methods
+//===----------------------------------------------------------------------===//
+RCReference<Iterator> TakeDataset::MakeIterator(
+    const IteratorContext& context) {
+  return TakeRef(host_->Construct<TakeDatasetIterator>(FormRef(this), context));
+}
+
+//===----------------------------------------------------------------------===//
+// TakeDatasetIterator methods
+//===----------------------------------------------------------------------===//
+IterationResult TakeDatasetIterator::GetNext(const ExecutionContext& exec_ctx) {
+  const int64_t count = parent_dataset_->count_;
+  if (count >= 0 && num_taken_ >= count)
+    return IterationResult::Eof(exec_ctx.host(), parent_dataset_->arity_);
+  ++num_taken_;
+  return input_iterator_->GetNext(exec_ctx);
+}
+
+void TakeDatasetIterator::Skip(int64_t count,
+                               const ExecutionContext& exec_ctx) {
+  if (parent_dataset_->count_ >= 0)
+    count = std::min(count, parent_dataset_->count_ - num_taken_);
+  if (count <= 0) return;
+  num_taken_ += count;
+  input_iterator_->Skip(count, exec_ctx);
+}
+
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares TakeDataset class which wraps around another Dataset
+// instance and yields at most a specified number of elements of that dataset.
+
+#ifndef TFRT_DATA_TAKE_DATASET_H_
+#define TFRT_DATA_TAKE_DATASET_H_
+
+#include "tfrt/data/dataset.h"
+
+namespace tfrt {
+namespace data {
+
+class TakeDatasetIterator;
+
+// TakeDataset wraps around another Dataset instance and yields the first
+// `count` elements of that dataset. If `count` is negative, it yields all the
+// elements. The input dataset is not iterated after the first `count`
+// elements. `arity` is the number of values of each element.
+class TakeDataset : public Dataset {
+ public:
+  explicit TakeDataset(RCReference<Dataset> input_dataset, int64_t count,
+                       int64_t arity, HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        count_(count),
+        arity_(arity),
+        host_(host),
+        allocator_(host->allocator()) {}
+
+  // This class is not copyable or movable.
+  TakeDataset(const TakeDataset&) = delete;
+  TakeDataset& operator=(const TakeDataset&) = delete;
+
+  RCReference<Iterator> MakeIterator(const IteratorContext& context) override;
+
+ private:
+  friend class TakeDatasetIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<TakeDataset>(this, allocator_);
+  }
+
+  RCReference<Dataset> input_dataset_;
+  const int64_t count_;
+  const int64_t arity_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+class TakeDatasetIterator : public Iterator {
+ public:
+  explicit TakeDatasetIterator(RCReference<TakeDataset> dataset,
+                               const IteratorContext& context)
+      : Iterator(),
+        parent_dataset_(std::move(dataset)),
+        input_iterator_(
+            parent_dataset_->input_dataset_->MakeIterator(context)) {}
+
+  // This class is not copyable or movable.
+  TakeDatasetIterator(const TakeDatasetIterator&) = delete;
+  TakeDatasetIterator& operator=(const TakeDatasetIterator&) = delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override;
+
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) override;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<TakeDatasetIterator>(this,
+                                               parent_dataset_->allocator_);
+  }
+
+  RCReference<TakeDataset> parent_dataset_;
+  RCReference<Iterator> input_iterator_;
+  // The number of elements returned or skipped so far.
+  int64_t num_taken_ = 0;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_DATA_TAKE_DATASET_H_
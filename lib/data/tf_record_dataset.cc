@@ -13,10 +13,14 @@
 // limitations under the License.
 
 // This file implements TFRecordDataset class which reads records from TFRecord
-// files into strings.
+// files into strings or into slices of HostBuffer chunks.
 
 #include "tf_record_dataset.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
 #include "tfrt/io/buffered_input_stream.h"
 #include "tfrt/io/file_input_stream.h"
 #include "tfrt/io/file_system.h"
@@ -47,8 +51,28 @@ IterationResult TFRecordDatasetIterator::GetNextElement(
     auto async_error = MakeErrorAsyncValueRef(host, StrCat(error));
     return IterationResult::Error(std::move(async_error), 1);
   }
+  if (!skip_error_.empty()) {
+    auto error = MakeErrorAsyncValueRef(host, skip_error_);
+    skip_error_.clear();
+    return IterationResult::Error(std::move(error), 1);
+  }
 
   bool eof = false;
+  if (parent_dataset_->zero_copy_) {
+    auto result = ReadRecordSlice(&eof);
+    if (eof) {
+      return IterationResult::Eof(host, 1);
+    }
+    if (!result) {
+      auto error = MakeErrorAsyncValueRef(host, StrCat(result.takeError()));
+      return IterationResult::Error(std::move(error), 1);
+    }
+    llvm::SmallVector<RCReference<AsyncValue>, 4> values;
+    values.push_back(MakeAvailableAsyncValueRef<RCReference<HostBuffer>>(
+        host, std::move(*result)));
+    return IterationResult::Values(std::move(values), host);
+  }
+
   auto result = ReadRecord(&eof);
 
   if (eof) {
@@ -116,6 +140,146 @@ llvm::Expected<std::string> TFRecordDatasetIterator::ReadRecord(bool* eof) {
   return body;
 }
 
+void TFRecordDatasetIterator::SkipElements(const ExecutionContext& exec_ctx,
+                                           size_t count) {
+  if (auto error = MaybeInitializeStream()) {
+    // The error is returned by the next GetNextElement() call.
+    llvm::consumeError(std::move(error));
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    bool eof = false;
+    if (auto error = SkipRecord(&eof)) {
+      if (eof) {
+        llvm::consumeError(std::move(error));
+      } else {
+        // The error is returned by the next GetNextElement() call, in place of
+        // the elements which are not skipped.
+        skip_error_ = llvm::toString(std::move(error));
+      }
+      return;
+    }
+  }
+}
+
+llvm::Error TFRecordDatasetIterator::SkipRecord(bool* eof) {
+  const bool zero_copy = parent_dataset_->zero_copy_;
+
+  // Read header.
+  uint64_t length;
+  if (zero_copy) {
+    const size_t pos = stream_offset_ - (chunk_limit_ - chunk_pos_);
+    auto length_or_error = ReadHeaderFromChunk(pos, eof);
+    if (!length_or_error) return length_or_error.takeError();
+    length = *length_or_error;
+  } else {
+    auto stream_pos = stream_->Tell();
+    if (!stream_pos) return stream_pos.takeError();
+    auto header = ReadChecksummed(*stream_pos, sizeof(uint64_t), eof);
+    if (!header) return header.takeError();
+    length = DecodeFixed64(header->data());
+  }
+
+  // Skip body, starting with the bytes already in chunk_.
+  size_t count = length + sizeof(uint32_t);
+  if (zero_copy) {
+    const size_t buffered = std::min(chunk_limit_ - chunk_pos_, count);
+    chunk_pos_ += buffered;
+    count -= buffered;
+    if (count == 0) return llvm::Error::success();
+  }
+  auto skipped = stream_->Skip(count);
+  if (!skipped) return skipped.takeError();
+  if (zero_copy) stream_offset_ += *skipped;
+  if (*skipped < count) return MakeStringError("truncated record");
+  return llvm::Error::success();
+}
+
+llvm::Expected<uint64_t> TFRecordDatasetIterator::ReadHeaderFromChunk(
+    size_t pos, bool* eof) {
+  // The header holds the record length followed by its masked crc.
+  constexpr size_t kHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+  *eof = false;
+
+  auto available = FillChunk(kHeaderSize);
+  if (!available) return available.takeError();
+  if (*available < kHeaderSize) {
+    *eof = true;
+    return MakeStringError("end of file");
+  }
+  const char* header = static_cast<const char*>(chunk_->data()) + chunk_pos_;
+  if (crc32c::Unmask(DecodeFixed32(header + sizeof(uint64_t))) !=
+      crc32c::Value(header, sizeof(uint64_t))) {
+    return MakeStringError("data corruption at position ", pos);
+  }
+  chunk_pos_ += kHeaderSize;
+  return DecodeFixed64(header);
+}
+
+llvm::Expected<RCReference<HostBuffer>>
+TFRecordDatasetIterator::ReadRecordSlice(bool* eof) {
+  const size_t pos = stream_offset_ - (chunk_limit_ - chunk_pos_);
+
+  // Read header.
+  auto length = ReadHeaderFromChunk(pos, eof);
+  if (!length) return length.takeError();
+
+  // Read body.
+  const size_t count = *length + sizeof(uint32_t);
+  auto available = FillChunk(count);
+  if (!available) return available.takeError();
+  if (*available < count) {
+    return MakeStringError("truncated record at position ", pos);
+  }
+  const char* body = static_cast<const char*>(chunk_->data()) + chunk_pos_;
+  if (crc32c::Unmask(DecodeFixed32(body + *length)) !=
+      crc32c::Value(body, *length)) {
+    return MakeStringError("data corruption at position ", pos);
+  }
+  auto record = HostBuffer::CreateFromExternal(chunk_, chunk_pos_, *length);
+  chunk_pos_ += count;
+  return std::move(record);
+}
+
+llvm::Expected<size_t> TFRecordDatasetIterator::FillChunk(size_t n) {
+  const size_t available = chunk_limit_ - chunk_pos_;
+  if (available >= n) return available;
+
+  const size_t size = std::max<size_t>(parent_dataset_->buffer_size_, n);
+  RCReference<HostBuffer> chunk;
+  // A chunk grown for an oversized record is not reused, so that the next
+  // chunks are back to the default size.
+  if (chunk_ && chunk_->IsUnique() && chunk_->size() == size) {
+    // No record references the current chunk. Reuse it.
+    chunk = std::move(chunk_);
+    std::memmove(chunk->data(), static_cast<char*>(chunk->data()) + chunk_pos_,
+                 available);
+  } else {
+    chunk = HostBuffer::CreateUninitialized(size, alignof(std::max_align_t),
+                                            parent_dataset_->allocator_);
+    if (!chunk) return MakeStringError("failed to allocate ", size, " bytes");
+    // The unread bytes are copied to the new chunk, because records returned
+    // earlier might still reference the current chunk.
+    if (available > 0) {
+      std::memcpy(chunk->data(),
+                  static_cast<const char*>(chunk_->data()) + chunk_pos_,
+                  available);
+    }
+  }
+
+  chunk_ = std::move(chunk);
+  chunk_pos_ = 0;
+  chunk_limit_ = available;
+
+  auto count_or_error =
+      stream_->Read(static_cast<char*>(chunk_->data()) + available,
+                    chunk_->size() - available);
+  if (!count_or_error) return count_or_error.takeError();
+  stream_offset_ += *count_or_error;
+  chunk_limit_ += *count_or_error;
+  return chunk_limit_;
+}
+
 llvm::Error TFRecordDatasetIterator::MaybeInitializeStream() {
   if (initialization_error_) {
     return MakeStringError(initialization_error_);
@@ -139,7 +303,18 @@ llvm::Error TFRecordDatasetIterator::MaybeInitializeStream() {
   }
 
   stream_ = std::make_unique<::tfrt::io::FileInputStream>(std::move(file));
-  if (parent_dataset_->buffer_size_ > 0) {
+  if (parent_dataset_->compression_type_ !=
+      ::tfrt::io::CompressionType::kNone) {
+    // Default the size of the compressed blocks to 256 KB.
+    const size_t input_buffer_size = parent_dataset_->buffer_size_ > 0
+                                         ? parent_dataset_->buffer_size_
+                                         : 256 * 1024;
+    stream_ = std::make_unique<::tfrt::io::ZlibInputStream>(
+        std::move(stream_), parent_dataset_->compression_type_,
+        input_buffer_size, parent_dataset_->allocator_);
+  }
+  // The chunks are the buffer in the zero copy mode.
+  if (parent_dataset_->buffer_size_ > 0 && !parent_dataset_->zero_copy_) {
     stream_ = std::make_unique<::tfrt::io::BufferedInputStream>(
         std::move(stream_), parent_dataset_->buffer_size_,
         parent_dataset_->allocator_);
@@ -15,14 +15,16 @@
  */
 
 // This file declares TFRecordDataset class which reads records from TFRecord
-// files into strings.
+// files into strings or into slices of HostBuffer chunks.
 
 #ifndef TFRT_LIB_DATA_TF_RECORD_DATASET_H_
 #define TFRT_LIB_DATA_TF_RECORD_DATASET_H_
 
 #include "io.h"
 #include "tfrt/data/dataset.h"
+#include "tfrt/host_context/host_buffer.h"
 #include "tfrt/io/input_stream.h"
+#include "tfrt/io/zlib_input_stream.h"
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
@@ -30,22 +32,35 @@ namespace data {
 
 // TFRecordDataset reads TFRecord bytes from a file.
 //
-// TODO(rachelim): Consider using a custom data type to represent the
-// bytes read from a TFRecord file. This will make the code more type safe
-// and allow for future optimizations to use mmap instead of copying bytes
-// from the file onto the heap.
+// By default each record is copied into a std::string. If `zero_copy` is
+// true, the file is read into ref-counted HostBuffer chunks of `buffer_size`
+// bytes, and each record is returned as a RCReference<HostBuffer> which slices
+// the chunk it was read into. A chunk is freed when all its records are freed.
+//
+// If `compression_type` is not kNone, the file is decompressed while it is
+// read. Like reading, decompression happens on the prefetching thread ahead of
+// the consumer.
+//
+// The prefetching thread reads up to `max_read_batch_size` records each time
+// it takes the lock of the prefetch buffer.
 class TFRecordDataset : public Dataset {
  public:
   explicit TFRecordDataset(std::string path, int64_t buffer_size,
                            int64_t max_prefetch_num, int64_t prefetch_threshold,
+                           bool zero_copy, int64_t max_read_batch_size,
+                           ::tfrt::io::CompressionType compression_type,
                            HostContext* host)
       : path_(std::move(path)),
         buffer_size_(buffer_size),
         max_prefetch_num_(max_prefetch_num),
         prefetch_threshold_(prefetch_threshold),
+        zero_copy_(zero_copy),
+        max_read_batch_size_(max_read_batch_size),
+        compression_type_(compression_type),
         host_(host),
         allocator_(host->allocator()) {
     assert(buffer_size_ >= 0);
+    assert(max_read_batch_size_ > 0);
   }
 
   // This class is not copyable or movable.
@@ -65,6 +80,9 @@ class TFRecordDataset : public Dataset {
   const int64_t buffer_size_;
   const int64_t max_prefetch_num_;
   const int64_t prefetch_threshold_;
+  const bool zero_copy_;
+  const int64_t max_read_batch_size_;
+  const ::tfrt::io::CompressionType compression_type_;
   HostContext* host_;
   HostAllocator* allocator_;
 };
@@ -73,8 +91,11 @@ class TFRecordDatasetIterator : public io::PrefetchingIterator {
  public:
   explicit TFRecordDatasetIterator(RCReference<TFRecordDataset> parent_dataset,
                                    const IteratorContext& context)
-      : io::PrefetchingIterator(parent_dataset->max_prefetch_num_,
-                                parent_dataset->prefetch_threshold_, context),
+      : io::PrefetchingIterator("tf_record_dataset/max_prefetch_num",
+                                /*num_values=*/1,
+                                parent_dataset->max_prefetch_num_,
+                                parent_dataset->prefetch_threshold_, context,
+                                parent_dataset->max_read_batch_size_),
         parent_dataset_(std::move(parent_dataset)) {}
 
   // This class is not copyable or movable.
@@ -87,6 +108,10 @@ class TFRecordDatasetIterator : public io::PrefetchingIterator {
   // the next record.
   IterationResult GetNextElement(const ExecutionContext& exec_ctx) final;
 
+  // Reads only the headers of the skipped records, and skips their bodies in
+  // the input stream. The checksums of the bodies are not verified.
+  void SkipElements(const ExecutionContext& exec_ctx, size_t count) final;
+
   llvm::Error MaybeInitializeStream();
 
  private:
@@ -111,9 +136,42 @@ class TFRecordDatasetIterator : public io::PrefetchingIterator {
   // return value.
   llvm::Expected<std::string> ReadRecord(bool* eof);
 
+  // Same as ReadRecord(), except that the record is returned as a slice of
+  // chunk_ without copying it.
+  llvm::Expected<RCReference<HostBuffer>> ReadRecordSlice(bool* eof);
+
+  // Reads the header of a record from chunk_ and returns the record length.
+  // Updates *eof as ReadRecordSlice() does.
+  llvm::Expected<uint64_t> ReadHeaderFromChunk(size_t pos, bool* eof);
+
+  // Advances the input stream to the start of the next record without reading
+  // the body of the current one. Updates *eof as ReadRecord() does.
+  llvm::Error SkipRecord(bool* eof);
+
+  // Makes sure that at least n bytes starting at chunk_pos_ are in chunk_, by
+  // reading a new chunk if needed. Returns the number of bytes available in
+  // chunk_ starting at chunk_pos_, which is less than n only at the end of the
+  // file.
+  llvm::Expected<size_t> FillChunk(size_t n);
+
   RCReference<TFRecordDataset> parent_dataset_;
   std::unique_ptr<::tfrt::io::InputStream> stream_;
+
+  // The state below is only used in the zero copy mode, where stream_ is not
+  // buffered.
+  // The chunk which holds the next record. The chunk is never written after
+  // records which slice it are returned.
+  RCReference<HostBuffer> chunk_;
+  // The range [chunk_pos_, chunk_limit_) of chunk_ holds the bytes which have
+  // not been returned yet.
+  size_t chunk_pos_ = 0;
+  size_t chunk_limit_ = 0;
+  // The position in stream_ of the byte after chunk_limit_.
+  size_t stream_offset_ = 0;
   llvm::Error initialization_error_ = llvm::Error::success();
+  // The error of the last SkipElements() call, e.g. a truncated or corrupt
+  // record. It is returned by the next GetNextElement() call if not empty.
+  std::string skip_error_;
 };
 
 }  // namespace data
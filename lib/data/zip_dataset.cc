@@ -0,0 +1,88 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements ZipDataset class which combines the elements of several
+// Dataset instances.
+
+#include "zip_dataset.h"
+
+#include <utility>
+
+#include "tfrt/host_context/async_dispatch.h"
+
+namespace tfrt {
+namespace data {
+
+//===----------------------------------------------------------------------===//
+// ZipDataset methods
+//===----------------------------------------------------------------------===//
+RCReference<Iterator> ZipDataset::MakeIterator(const IteratorContext& context) {
+  return TakeRef(host_->Construct<ZipDatasetIterator>(FormRef(this), context));
+}
+
+//===----------------------------------------------------------------------===//
+// ZipDatasetIterator methods
+//===----------------------------------------------------------------------===//
+ZipDatasetIterator::ZipDatasetIterator(RCReference<ZipDataset> dataset,
+                                       const IteratorContext& context)
+    : Iterator(), parent_dataset_(std::move(dataset)) {
+  for (auto& input_dataset : parent_dataset_->input_datasets_)
+    input_iterators_.push_back(input_dataset->MakeIterator(context));
+}
+
+IterationResult ZipDatasetIterator::GetNext(const ExecutionContext& exec_ctx) {
+  SmallVector<IterationResult, 4> elements;
+  elements.reserve(input_iterators_.size());
+  for (auto& input_iterator : input_iterators_)
+    elements.push_back(input_iterator->GetNext(exec_ctx));
+  return Combine(&elements, exec_ctx.host());
+}
+
+void ZipDatasetIterator::Skip(int64_t count, const ExecutionContext& exec_ctx) {
+  for (auto& input_iterator : input_iterators_)
+    input_iterator->Skip(count, exec_ctx);
+}
+
+IterationResult ZipDatasetIterator::Combine(
+    SmallVectorImpl<IterationResult>* elements, HostContext* host) {
+  SmallVector<RCReference<AsyncValue>, 4> values;
+  SmallVector<AsyncValue*, 4> eofs;
+  SmallVector<AsyncValueRef<bool>, 4> eof_refs;
+  for (auto& element : *elements) {
+    for (auto& value : element.values) values.push_back(std::move(value));
+    eofs.push_back(element.eof.GetAsyncValue());
+    eof_refs.push_back(std::move(element.eof));
+  }
+
+  // The iteration ends when any of the inputs ends, and fails when any of the
+  // inputs fails.
+  auto eof = MakeUnconstructedAsyncValueRef<bool>(host);
+  RunWhenReady(eofs, [eof_refs = std::move(eof_refs), eof = eof.CopyRef()]() {
+    bool any_eof = false;
+    for (auto& input_eof : eof_refs) {
+      if (input_eof.IsError()) {
+        eof.SetError(input_eof.GetError());
+        return;
+      }
+      any_eof |= input_eof.get();
+    }
+    eof.emplace(any_eof);
+  });
+  return IterationResult::Pending(std::move(values), std::move(eof));
+}
+
+}  // namespace data
+}  // namespace tfrt
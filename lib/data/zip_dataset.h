@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares ZipDataset class which combines the elements of several
+// Dataset instances.
+
+#ifndef TFRT_DATA_ZIP_DATASET_H_
+#define TFRT_DATA_ZIP_DATASET_H_
+
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/data/dataset.h"
+
+namespace tfrt {
+namespace data {
+
+class ZipDatasetIterator;
+
+// ZipDataset wraps around several Dataset instances. The i-th element of
+// ZipDataset has the values of the i-th elements of the input datasets, in the
+// order of the inputs. The iteration ends when any of the inputs reaches the
+// end.
+class ZipDataset : public Dataset {
+ public:
+  explicit ZipDataset(SmallVector<RCReference<Dataset>, 4> input_datasets,
+                      HostContext* host)
+      : input_datasets_(std::move(input_datasets)),
+        host_(host),
+        allocator_(host->allocator()) {
+    assert(!input_datasets_.empty());
+  }
+
+  // This class is not copyable or movable.
+  ZipDataset(const ZipDataset&) = delete;
+  ZipDataset& operator=(const ZipDataset&) = delete;
+
+  RCReference<Iterator> MakeIterator(const IteratorContext& context) override;
+
+ private:
+  friend class ZipDatasetIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<ZipDataset>(this, allocator_);
+  }
+
+  SmallVector<RCReference<Dataset>, 4> input_datasets_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+// ZipDatasetIterator calls the input iterators in the order of the inputs.
+// Since GetNext() of an iterator returns without waiting for its element, the
+// elements of the inputs are still computed concurrently.
+class ZipDatasetIterator : public Iterator {
+ public:
+  explicit ZipDatasetIterator(RCReference<ZipDataset> dataset,
+                              const IteratorContext& context);
+
+  // This class is not copyable or movable.
+  ZipDatasetIterator(const ZipDatasetIterator&) = delete;
+  ZipDatasetIterator& operator=(const ZipDatasetIterator&) = delete;
+
+  IterationResult GetNext(const ExecutionContext& exec_ctx) override;
+
+  void Skip(int64_t count, const ExecutionContext& exec_ctx) override;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<ZipDatasetIterator>(this,
+                                              parent_dataset_->allocator_);
+  }
+
+  // Combines the elements of the inputs into an element of ZipDataset.
+  IterationResult Combine(SmallVectorImpl<IterationResult>* elements,
+                          HostContext* host);
+
+  RCReference<ZipDataset> parent_dataset_;
+  SmallVector<RCReference<Iterator>, 4> input_iterators_;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_DATA_ZIP_DATASET_H_
@@ -0,0 +1,116 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- arena_allocator.cc - Arena Memory Allocator ------------------------===//
+//
+// This file implements ArenaAllocator.
+
+#include "tfrt/host_context/arena_allocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#include "llvm/Support/MathExtras.h"
+
+namespace tfrt {
+
+// Block header, the block memory follows the header.
+struct ArenaAllocator::Block {
+  Block(Block* prev, size_t size, char* begin, char* end)
+      : prev(prev), size(size), cursor(begin), end(end) {}
+
+  Block* const prev;
+  // Size of the block including the header.
+  const size_t size;
+  std::atomic<char*> cursor;
+  char* const end;
+};
+
+ArenaAllocator::ArenaAllocator(HostAllocator* fallback, size_t block_size,
+                               size_t max_allocation_size)
+    : fallback_(fallback),
+      block_size_(block_size),
+      max_allocation_size_(max_allocation_size) {
+  assert(fallback_ != nullptr);
+  assert(max_allocation_size_ <= block_size_);
+}
+
+ArenaAllocator::~ArenaAllocator() {
+  Block* block = current_.load(std::memory_order_acquire);
+  while (block != nullptr) {
+    Block* prev = block->prev;
+    size_t size = block->size;
+    block->~Block();
+    fallback_->DeallocateBytes(block, size);
+    block = prev;
+  }
+}
+
+void* ArenaAllocator::AllocateBytes(size_t size, size_t alignment) {
+  if (size > max_allocation_size_)
+    return fallback_->AllocateBytes(size, alignment);
+
+  while (true) {
+    Block* block = current_.load(std::memory_order_acquire);
+
+    if (block != nullptr) {
+      char* cursor = block->cursor.load(std::memory_order_relaxed);
+      while (true) {
+        char* aligned = reinterpret_cast<char*>(
+            llvm::alignTo(reinterpret_cast<uintptr_t>(cursor), alignment));
+        if (aligned > block->end ||
+            static_cast<size_t>(block->end - aligned) < size)
+          break;
+        if (block->cursor.compare_exchange_weak(cursor, aligned + size,
+                                                std::memory_order_relaxed))
+          return aligned;
+      }
+    }
+
+    // The current block is exhausted, allocate a new one and try again.
+    if (!AddBlock(block, size, alignment)) return nullptr;
+  }
+}
+
+void ArenaAllocator::DeallocateBytes(void* ptr, size_t size) {
+  // Memory allocated from blocks is released when the arena is destroyed.
+  if (size > max_allocation_size_) fallback_->DeallocateBytes(ptr, size);
+}
+
+bool ArenaAllocator::AddBlock(Block* current, size_t size, size_t alignment) {
+  mutex_lock lock(mu_);
+
+  // Another thread has already replaced the current block.
+  if (current_.load(std::memory_order_relaxed) != current) return true;
+
+  // Blocks are usually `block_size_` bytes, but must be large enough to fit
+  // the allocation even if it has a large alignment requirement.
+  const size_t header_size = llvm::alignTo(sizeof(Block), alignof(Block));
+  const size_t block_size =
+      std::max(block_size_, header_size + size + alignment);
+
+  void* ptr = fallback_->AllocateBytes(block_size, alignof(Block));
+  if (ptr == nullptr) return false;
+
+  char* begin = static_cast<char*>(ptr) + header_size;
+  char* end = static_cast<char*>(ptr) + block_size;
+  Block* block = new (ptr) Block(current, block_size, begin, end);
+
+  num_block_bytes_.fetch_add(block_size, std::memory_order_relaxed);
+  current_.store(block, std::memory_order_release);
+  return true;
+}
+
+}  // namespace tfrt
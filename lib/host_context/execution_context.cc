@@ -29,6 +29,11 @@ RequestContext::~RequestContext() {
   }
 }
 
+HostAllocator* RequestContext::allocator() const {
+  if (arena_) return arena_.get();
+  return host_->allocator();
+}
+
 void RequestContext::Cancel() {
   // Create an AsyncValue in error state for cancel.
   auto* error_value = MakeErrorAsyncValueRef(host_, "Cancelled").release();
@@ -46,8 +51,16 @@ void RequestContext::Cancel() {
 }
 
 Expected<RCReference<RequestContext>> RequestContextBuilder::build() && {
+  std::unique_ptr<ArenaAllocator> arena;
+  if (request_options_.enable_arena) {
+    arena = std::make_unique<ArenaAllocator>(
+        host_->allocator(), request_options_.arena_block_size,
+        request_options_.arena_max_allocation_size);
+  }
   return TakeRef(new RequestContext(host_, resource_context_,
-                                    std::move(context_data_), id_));
+                                    std::move(context_data_), id_,
+                                    request_options_.priority,
+                                    std::move(arena)));
 };
 
 ExecutionContext::ExecutionContext(RCReference<RequestContext> req_ctx,
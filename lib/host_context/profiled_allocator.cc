@@ -24,6 +24,7 @@
 #include <cstdint>
 
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/metrics/metrics.h"
 
 namespace tfrt {
 
@@ -38,6 +39,29 @@ void AtomicUpdateMax(T const& value, std::atomic<T>* max_value) noexcept {
   }
 }
 
+// The number of bytes currently allocated from all profiled allocators.
+std::atomic<int64_t> total_num_bytes_allocated{0};
+
+// Adds `delta` to the number of allocated bytes and publishes it to the
+// /tfrt/host_allocator/allocated_bytes gauge.
+void UpdateAllocatedBytes(int64_t delta) {
+  static metrics::Gauge<int64_t>* gauge =
+      metrics::NewGauge<int64_t>("/tfrt/host_allocator/allocated_bytes");
+
+  total_num_bytes_allocated.fetch_add(delta);
+
+  // Concurrent updates can publish their values out of order. Every thread
+  // re-reads the counter after publishing and publishes again if it changed,
+  // so the last value written to the gauge is always the current one.
+  int64_t value = total_num_bytes_allocated.load();
+  while (true) {
+    gauge->Set(value);
+    int64_t current = total_num_bytes_allocated.load();
+    if (current == value) break;
+    value = current;
+  }
+}
+
 }  // namespace
 
 class ProfiledAllocator : public HostAllocator {
@@ -55,6 +79,7 @@ class ProfiledAllocator : public HostAllocator {
     ++curr_num_allocations_;
     ++cum_num_allocations_;
     curr_num_bytes_allocated_.fetch_add(size);
+    UpdateAllocatedBytes(size);
     AtomicUpdateMax<int64_t>(curr_num_allocations_, &max_num_allocations_);
     AtomicUpdateMax<int64_t>(curr_num_bytes_allocated_,
                              &max_num_bytes_allocated_);
@@ -65,6 +90,7 @@ class ProfiledAllocator : public HostAllocator {
   void DeallocateBytes(void* ptr, size_t size) override {
     --curr_num_allocations_;
     curr_num_bytes_allocated_.fetch_sub(size);
+    UpdateAllocatedBytes(-static_cast<int64_t>(size));
 
     allocator_->DeallocateBytes(ptr, size);
   }
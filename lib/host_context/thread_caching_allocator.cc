@@ -0,0 +1,488 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- thread_caching_allocator.cc - Thread Caching Memory Allocator ------===//
+//
+// This file implements a host memory allocator with per-thread caches of size
+// classed blocks and a lock-free global pool.
+
+#include "tfrt/host_context/thread_caching_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/support/alloc.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/support/thread_local.h"
+
+namespace tfrt {
+
+namespace {
+
+// Block sizes of all size classes. Every block size is a multiple of 16, so all
+// blocks are at least 16 byte aligned.
+constexpr std::array<size_t, 16> kBlockSizes = {
+    16,  32,  48,  64,   96,   128,  192,  256,
+    384, 512, 768, 1024, 1536, 2048, 3072, 4096,
+};
+constexpr int kNumSizeClasses = kBlockSizes.size();
+constexpr size_t kMaxBlockSize = kBlockSizes.back();
+constexpr size_t kMinBlockSize = kBlockSizes.front();
+
+// Blocks are carved from chunks aligned to the chunk size. The size class of a
+// block is found by looking up its chunk in the chunk registry.
+constexpr size_t kChunkSize = 256 * 1024;
+
+// Number of blocks moved between a thread cache and the global pool at once is
+// chosen to move approximately `kBatchBytes` of memory.
+constexpr size_t kBatchBytes = 8 * 1024;
+constexpr size_t kMinBatchSize = 4;
+constexpr size_t kMaxBatchSize = 64;
+
+// Capacity of the chunk registry. The registry is kept at most half full, which
+// limits the memory served from size classes to 2GB.
+constexpr size_t kRegistryCapacity = 16384;
+constexpr size_t kMaxNumChunks = kRegistryCapacity / 2;
+
+static_assert((kRegistryCapacity & (kRegistryCapacity - 1)) == 0,
+              "Registry capacity must be a power of two");
+static_assert(kNumSizeClasses < kChunkSize,
+              "Size class index must fit into the chunk alignment bits");
+
+// The global pool is a Treiber stack of batches. The head pointer is tagged
+// with a modification counter in the upper bits to prevent the ABA problem.
+constexpr uint64_t kTagShift = 48;
+constexpr uint64_t kPointerMask = (1ull << kTagShift) - 1;
+
+static_assert(sizeof(void*) == sizeof(uint64_t),
+              "ThreadCachingAllocator requires 64-bit pointers");
+
+// Alignment guaranteed for the blocks of the given size. Blocks are carved at
+// offsets that are multiples of the block size from a chunk that is aligned to
+// the chunk size.
+constexpr size_t BlockAlignment(size_t block_size) {
+  return block_size & (~block_size + 1);
+}
+
+// A free block. The first block of a batch in the global pool links to the
+// next batch, all blocks in a batch are linked through `next`.
+struct FreeBlock {
+  FreeBlock* next;
+  std::atomic<FreeBlock*> next_batch;
+};
+
+static_assert(sizeof(FreeBlock) <= kMinBlockSize,
+              "Free block must fit into the smallest size class");
+
+FreeBlock* UntagPointer(uint64_t tagged) {
+  return reinterpret_cast<FreeBlock*>(tagged & kPointerMask);
+}
+
+uint64_t TagPointer(FreeBlock* ptr, uint64_t prev_tagged) {
+  uint64_t bits = reinterpret_cast<uint64_t>(ptr);
+  assert((bits & ~kPointerMask) == 0 && "Unexpected pointer bits");
+  uint64_t tag = (prev_tagged >> kTagShift) + 1;
+  return (tag << kTagShift) | bits;
+}
+
+// Counters that are written only by the owning thread, and read concurrently by
+// the stats reporting. Owner does not need an atomic read-modify-write.
+void IncrementOwnedCounter(std::atomic<int64_t>* counter) {
+  counter->store(counter->load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+}
+
+}  // namespace
+
+void ThreadCachingAllocator::PrintStats(raw_ostream& os) const {
+  os << "ThreadCachingAllocator profile:\n";
+  for (const SizeClassStats& stats : GetSizeClassStats()) {
+    if (stats.num_allocations == 0 && stats.num_chunks == 0) continue;
+    os << "  size class " << stats.block_size
+       << ": allocations = " << stats.num_allocations
+       << ", deallocations = " << stats.num_deallocations
+       << ", batches from pool = " << stats.num_batches_from_pool
+       << ", batches to pool = " << stats.num_batches_to_pool
+       << ", batches carved = " << stats.num_batches_carved
+       << ", chunks = " << stats.num_chunks << "\n";
+  }
+  os << "  large allocations = " << GetNumLargeAllocations() << "\n";
+  os.flush();
+}
+
+class ThreadCachingAllocatorImpl : public ThreadCachingAllocator {
+ public:
+  ThreadCachingAllocatorImpl();
+  ~ThreadCachingAllocatorImpl() override;
+
+  void* AllocateBytes(size_t size, size_t alignment) override;
+  void DeallocateBytes(void* ptr, size_t size) override;
+
+  std::vector<SizeClassStats> GetSizeClassStats() const override;
+  int64_t GetNumLargeAllocations() const override {
+    return num_large_allocations_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Per-thread cache of free blocks for all size classes.
+  struct ThreadCache {
+    struct FreeList {
+      FreeBlock* head = nullptr;
+      size_t size = 0;
+    };
+
+    std::array<FreeList, kNumSizeClasses> free_lists;
+    std::array<std::atomic<int64_t>, kNumSizeClasses> num_allocations{};
+    std::array<std::atomic<int64_t>, kNumSizeClasses> num_deallocations{};
+  };
+
+  // Creates thread caches on the first access from a thread. Thread caches are
+  // owned by the allocator, which also uses them for stats reporting.
+  struct ThreadCacheConstructor {
+    explicit ThreadCacheConstructor(ThreadCachingAllocatorImpl* allocator)
+        : allocator(allocator) {}
+
+    ThreadCache* Construct() {
+      auto cache = std::make_unique<ThreadCache>();
+      mutex_lock lock(allocator->caches_mu_);
+      allocator->caches_.push_back(std::move(cache));
+      return allocator->caches_.back().get();
+    }
+
+    ThreadCachingAllocatorImpl* allocator;
+  };
+
+  // Global state of a size class shared by all threads.
+  struct SizeClass {
+    size_t block_size = 0;
+    size_t batch_size = 0;
+
+    // Tagged pointer to the first batch in the global pool.
+    std::atomic<uint64_t> pool{0};
+
+    std::atomic<int64_t> num_batches_from_pool{0};
+    std::atomic<int64_t> num_batches_to_pool{0};
+    std::atomic<int64_t> num_batches_carved{0};
+    std::atomic<int64_t> num_chunks{0};
+
+    // Unused part of the last chunk allocated for this size class.
+    mutex mu;
+    char* chunk_ptr TFRT_GUARDED_BY(mu) = nullptr;
+    char* chunk_end TFRT_GUARDED_BY(mu) = nullptr;
+  };
+
+  // Returns the index of the smallest size class that can serve an allocation
+  // of the given size and alignment, or -1 if there is no such size class.
+  int FindSizeClass(size_t size, size_t alignment) const {
+    if (size > kMaxBlockSize) return -1;
+    int index = size_to_class_[(size + kMinBlockSize - 1) / kMinBlockSize];
+    for (; index < kNumSizeClasses; ++index) {
+      if (BlockAlignment(kBlockSizes[index]) >= alignment) return index;
+    }
+    return -1;
+  }
+
+  ThreadCache& LocalCache() { return *thread_caches_.Local(); }
+
+  // Moves a batch of blocks from the global pool, or from a chunk, into the
+  // free list. Returns false if a new chunk can't be allocated.
+  bool Refill(int size_class, ThreadCache::FreeList* free_list);
+
+  // Moves a batch of blocks from the free list into the global pool.
+  void Flush(int size_class, ThreadCache::FreeList* free_list);
+
+  // Carves a batch of blocks from the current chunk of the size class.
+  FreeBlock* CarveBatch(int size_class);
+
+  // Registers a chunk owned by the given size class in the chunk registry.
+  bool RegisterChunk(char* chunk, int size_class);
+
+  // Returns the size class of the chunk that owns `ptr`, or -1 if `ptr` was
+  // not allocated from a chunk.
+  int LookupSizeClass(void* ptr) const;
+
+  static size_t RegistryIndex(uintptr_t chunk) {
+    return ((chunk / kChunkSize) * 0x9E3779B97F4A7C15ull) %
+           kRegistryCapacity;
+  }
+
+  // Lookup table from the allocation size (in kMinBlockSize units) to the
+  // smallest size class that can hold it.
+  std::array<uint8_t, kMaxBlockSize / kMinBlockSize + 1> size_to_class_;
+
+  std::array<SizeClass, kNumSizeClasses> size_classes_;
+
+  // Open addressing hash set of chunk addresses. The size class index + 1 is
+  // stored in the low bits of the chunk address.
+  std::array<std::atomic<uintptr_t>, kRegistryCapacity> registry_;
+
+  mutex chunks_mu_;
+  std::vector<void*> chunks_ TFRT_GUARDED_BY(chunks_mu_);
+
+  std::atomic<int64_t> num_large_allocations_{0};
+
+  mutable mutex caches_mu_;
+  std::vector<std::unique_ptr<ThreadCache>> caches_
+      TFRT_GUARDED_BY(caches_mu_);
+
+  ThreadLocal<ThreadCache*, ThreadCacheConstructor> thread_caches_;
+};
+
+ThreadCachingAllocatorImpl::ThreadCachingAllocatorImpl()
+    : thread_caches_(ThreadLocal<ThreadCache*>::Capacity(
+                         4 * std::max(1u, std::thread::hardware_concurrency())),
+                     this) {
+  int size_class = 0;
+  for (size_t i = 0; i < size_to_class_.size(); ++i) {
+    while (kBlockSizes[size_class] < i * kMinBlockSize) ++size_class;
+    size_to_class_[i] = size_class;
+  }
+
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    size_classes_[i].block_size = kBlockSizes[i];
+    size_classes_[i].batch_size = std::min(
+        kMaxBatchSize, std::max(kMinBatchSize, kBatchBytes / kBlockSizes[i]));
+  }
+
+  for (auto& entry : registry_) entry.store(0, std::memory_order_relaxed);
+}
+
+ThreadCachingAllocatorImpl::~ThreadCachingAllocatorImpl() {
+  mutex_lock lock(chunks_mu_);
+  for (void* chunk : chunks_) AlignedFree(chunk);
+}
+
+void* ThreadCachingAllocatorImpl::AllocateBytes(size_t size,
+                                                size_t alignment) {
+  int size_class = FindSizeClass(size, alignment);
+  if (size_class < 0) {
+    num_large_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return AlignedAlloc(alignment, size);
+  }
+
+  ThreadCache& cache = LocalCache();
+  ThreadCache::FreeList& free_list = cache.free_lists[size_class];
+
+  if (free_list.head == nullptr && !Refill(size_class, &free_list)) {
+    num_large_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return AlignedAlloc(alignment, size);
+  }
+
+  FreeBlock* block = free_list.head;
+  free_list.head = block->next;
+  --free_list.size;
+  IncrementOwnedCounter(&cache.num_allocations[size_class]);
+
+  return block;
+}
+
+void ThreadCachingAllocatorImpl::DeallocateBytes(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+
+  // Allocations larger than the largest size class are never served from
+  // chunks, so we can skip the registry lookup.
+  int size_class = size > kMaxBlockSize ? -1 : LookupSizeClass(ptr);
+  if (size_class < 0) {
+    AlignedFree(ptr);
+    return;
+  }
+
+  ThreadCache& cache = LocalCache();
+  ThreadCache::FreeList& free_list = cache.free_lists[size_class];
+
+  FreeBlock* block = new (ptr) FreeBlock;
+  block->next = free_list.head;
+  free_list.head = block;
+  ++free_list.size;
+  IncrementOwnedCounter(&cache.num_deallocations[size_class]);
+
+  // Keep at most two batches in the thread cache, so that the blocks freed by
+  // one thread can be reused by the other threads.
+  if (free_list.size > 2 * size_classes_[size_class].batch_size)
+    Flush(size_class, &free_list);
+}
+
+bool ThreadCachingAllocatorImpl::Refill(int size_class,
+                                        ThreadCache::FreeList* free_list) {
+  assert(free_list->head == nullptr);
+  SizeClass& sc = size_classes_[size_class];
+
+  // Try to pop a batch from the global pool first. Batches in the pool are
+  // never released back to the system, so it is safe to read `next_batch` of
+  // a batch that was concurrently popped by another thread; the tag in the
+  // pool pointer makes the following compare-exchange fail in this case.
+  uint64_t pool = sc.pool.load(std::memory_order_acquire);
+  while (FreeBlock* batch = UntagPointer(pool)) {
+    FreeBlock* next = batch->next_batch.load(std::memory_order_relaxed);
+    if (sc.pool.compare_exchange_weak(pool, TagPointer(next, pool),
+                                      std::memory_order_acquire,
+                                      std::memory_order_acquire)) {
+      free_list->head = batch;
+      free_list->size = sc.batch_size;
+      sc.num_batches_from_pool.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // The global pool is empty, carve a new batch from a chunk.
+  FreeBlock* batch = CarveBatch(size_class);
+  if (batch == nullptr) return false;
+
+  free_list->head = batch;
+  free_list->size = sc.batch_size;
+  return true;
+}
+
+void ThreadCachingAllocatorImpl::Flush(int size_class,
+                                       ThreadCache::FreeList* free_list) {
+  SizeClass& sc = size_classes_[size_class];
+  assert(free_list->size > sc.batch_size);
+
+  // Detach the first `batch_size` blocks from the free list.
+  FreeBlock* batch = free_list->head;
+  FreeBlock* last = batch;
+  for (size_t i = 1; i < sc.batch_size; ++i) last = last->next;
+  free_list->head = last->next;
+  free_list->size -= sc.batch_size;
+  last->next = nullptr;
+
+  // Push the batch into the global pool.
+  uint64_t pool = sc.pool.load(std::memory_order_relaxed);
+  do {
+    batch->next_batch.store(UntagPointer(pool), std::memory_order_relaxed);
+  } while (!sc.pool.compare_exchange_weak(pool, TagPointer(batch, pool),
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+  sc.num_batches_to_pool.fetch_add(1, std::memory_order_relaxed);
+}
+
+FreeBlock* ThreadCachingAllocatorImpl::CarveBatch(int size_class) {
+  SizeClass& sc = size_classes_[size_class];
+  const size_t batch_bytes = sc.block_size * sc.batch_size;
+
+  mutex_lock lock(sc.mu);
+
+  if (sc.chunk_end - sc.chunk_ptr < static_cast<ptrdiff_t>(batch_bytes)) {
+    // The remainder of the current chunk is too small for a batch, and is
+    // wasted. It is always smaller than kBatchBytes.
+    {
+      mutex_lock chunks_lock(chunks_mu_);
+      if (chunks_.size() >= kMaxNumChunks) return nullptr;
+    }
+
+    char* chunk = static_cast<char*>(AlignedAlloc(kChunkSize, kChunkSize));
+    if (chunk == nullptr) return nullptr;
+
+    if (!RegisterChunk(chunk, size_class)) {
+      AlignedFree(chunk);
+      return nullptr;
+    }
+
+    {
+      mutex_lock chunks_lock(chunks_mu_);
+      chunks_.push_back(chunk);
+    }
+
+    sc.chunk_ptr = chunk;
+    sc.chunk_end = chunk + kChunkSize;
+    sc.num_chunks.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  char* begin = sc.chunk_ptr;
+  sc.chunk_ptr += batch_bytes;
+
+  FreeBlock* head = nullptr;
+  for (size_t i = sc.batch_size; i > 0; --i) {
+    FreeBlock* block = new (begin + (i - 1) * sc.block_size) FreeBlock;
+    block->next = head;
+    head = block;
+  }
+
+  sc.num_batches_carved.fetch_add(1, std::memory_order_relaxed);
+  return head;
+}
+
+bool ThreadCachingAllocatorImpl::RegisterChunk(char* chunk, int size_class) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(chunk);
+  assert(address % kChunkSize == 0);
+  uintptr_t entry = address | static_cast<uintptr_t>(size_class + 1);
+
+  size_t index = RegistryIndex(address);
+  for (size_t i = 0; i < kRegistryCapacity; ++i) {
+    uintptr_t empty = 0;
+    if (registry_[index].compare_exchange_strong(empty, entry,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed))
+      return true;
+    index = (index + 1) % kRegistryCapacity;
+  }
+
+  return false;
+}
+
+int ThreadCachingAllocatorImpl::LookupSizeClass(void* ptr) const {
+  uintptr_t address = reinterpret_cast<uintptr_t>(ptr) & ~(kChunkSize - 1);
+
+  // Chunks are never removed from the registry, so the probe sequence ends at
+  // the first empty entry.
+  size_t index = RegistryIndex(address);
+  for (size_t i = 0; i < kRegistryCapacity; ++i) {
+    uintptr_t entry = registry_[index].load(std::memory_order_acquire);
+    if (entry == 0) return -1;
+    if ((entry & ~(kChunkSize - 1)) == address)
+      return static_cast<int>(entry & (kChunkSize - 1)) - 1;
+    index = (index + 1) % kRegistryCapacity;
+  }
+
+  return -1;
+}
+
+std::vector<ThreadCachingAllocator::SizeClassStats>
+ThreadCachingAllocatorImpl::GetSizeClassStats() const {
+  std::vector<SizeClassStats> stats(kNumSizeClasses);
+
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    const SizeClass& sc = size_classes_[i];
+    stats[i].block_size = sc.block_size;
+    stats[i].num_batches_from_pool = sc.num_batches_from_pool.load();
+    stats[i].num_batches_to_pool = sc.num_batches_to_pool.load();
+    stats[i].num_batches_carved = sc.num_batches_carved.load();
+    stats[i].num_chunks = sc.num_chunks.load();
+  }
+
+  mutex_lock lock(caches_mu_);
+  for (const auto& cache : caches_) {
+    for (int i = 0; i < kNumSizeClasses; ++i) {
+      stats[i].num_allocations +=
+          cache->num_allocations[i].load(std::memory_order_relaxed);
+      stats[i].num_deallocations +=
+          cache->num_deallocations[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  return stats;
+}
+
+std::unique_ptr<ThreadCachingAllocator> CreateThreadCachingAllocator() {
+  return std::make_unique<ThreadCachingAllocatorImpl>();
+}
+
+}  // namespace tfrt
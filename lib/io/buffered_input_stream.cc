@@ -52,5 +52,23 @@ llvm::Expected<size_t> BufferedInputStream::Read(char* buf, size_t max_count) {
 
 llvm::Expected<size_t> BufferedInputStream::Tell() { return stream_pos_; }
 
+llvm::Expected<size_t> BufferedInputStream::Skip(size_t count) {
+  if (!buffer_limit_) {
+    auto error = buffer_limit_.takeError();
+    buffer_limit_ = 0;
+    return std::move(error);
+  }
+
+  const size_t buffered = std::min(*buffer_limit_ - buffer_pos_, count);
+  buffer_pos_ += buffered;
+  stream_pos_ += buffered;
+  if (buffered == count) return count;
+
+  auto skipped = input_stream_->Skip(count - buffered);
+  if (!skipped) return skipped.takeError();
+  stream_pos_ += *skipped;
+  return buffered + *skipped;
+}
+
 }  // namespace io
 }  // namespace tfrt
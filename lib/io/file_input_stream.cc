@@ -27,5 +27,18 @@ llvm::Expected<size_t> FileInputStream::Read(char* buf, size_t max_count) {
 
 llvm::Expected<size_t> FileInputStream::Tell() { return offset_; }
 
+llvm::Expected<size_t> FileInputStream::Skip(size_t count) {
+  if (count == 0) return 0;
+  char last;
+  auto result = file_->Read(&last, 1, offset_ + count - 1);
+  if (!result) return result.takeError();
+  if (*result == 1) {
+    offset_ += count;
+    return count;
+  }
+  // The file ends before the last skipped byte. Find out where.
+  return InputStream::Skip(count);
+}
+
 }  // namespace io
 }  // namespace tfrt
@@ -18,9 +18,22 @@
 
 #include "tfrt/io/file_system.h"
 
+#include "tfrt/host_context/async_dispatch.h"
+
 namespace tfrt {
 namespace io {
 
+AsyncValueRef<size_t> RandomAccessFile::ReadAsync(char* buf, size_t max_count,
+                                                  size_t offset,
+                                                  HostContext* host) const {
+  auto result = MakeUnconstructedAsyncValueRef<size_t>(host);
+  auto read = [this, buf, max_count, offset, result = result.CopyRef()]() {
+    result.emplace(Read(buf, max_count, offset));
+  };
+  if (!EnqueueBlockingWork(host, read)) read();
+  return result;
+}
+
 void FileSystemRegistry::Register(const std::string& scheme,
                                   std::unique_ptr<FileSystem> file_system) {
   assert(file_system);
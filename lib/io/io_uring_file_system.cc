@@ -0,0 +1,536 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file implements the IoUringFileSystem class. The io_uring system calls
+// are used directly, so that no additional library is needed.
+
+#include "io_uring_file_system.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "llvm_derived/Support/raw_ostream.h"
+#include "tfrt/support/string_util.h"
+
+namespace tfrt {
+namespace io {
+
+// IoUring owns an io_uring instance with a thread which handles its
+// completions.
+class IoUring {
+ public:
+  // Returns nullptr if the kernel does not support io_uring.
+  static std::unique_ptr<IoUring> Create(unsigned max_in_flight);
+
+  // Waits for the pending reads and stops the completion thread.
+  ~IoUring();
+
+  // Reads up to `max_count` bytes at `offset` from `fd` into `buf`, and sets
+  // `result` to the number of bytes read in the completion thread. Blocks if
+  // there are too many reads in flight, except in the completion thread, whose
+  // reads are queued until a read in flight completes.
+  void Read(int fd, const std::string* path, char* buf, size_t max_count,
+            size_t offset, AsyncValueRef<size_t> result) TFRT_EXCLUDES(mu_);
+
+ private:
+  struct Request {
+    int fd;
+    const std::string* path;
+    char* buf;
+    size_t max_count;
+    size_t offset;
+    AsyncValueRef<size_t> result;
+    // The number of bytes read so far. The remaining bytes are read by
+    // resubmitting the request after a short read.
+    size_t count = 0;
+    struct iovec iov;
+  };
+
+  explicit IoUring(int ring_fd, const io_uring_params& params);
+
+  bool MapRings(const io_uring_params& params);
+
+  // Adds READV entries for the queued requests to the submission queue, while
+  // fewer than `max_in_flight_` requests are in flight and the queue has room.
+  // Returns whether the caller should submit the pending entries.
+  bool PushQueuedRequests() TFRT_REQUIRES(mu_);
+
+  // Adds an entry to the submission queue. Returns false if the queue is full.
+  bool PushEntry(uint8_t opcode, int fd, const void* addr, unsigned len,
+                 uint64_t offset, uint64_t user_data) TFRT_REQUIRES(mu_);
+
+  // Returns whether the caller should submit the pending entries, i.e. there
+  // are some and no other thread is submitting them.
+  bool StartSubmitting() TFRT_REQUIRES(mu_);
+
+  // Submits the pending entries, including those added concurrently by other
+  // threads while submitting, with as few system calls as possible. Returns
+  // false if the completion thread left them to its next iteration because the
+  // kernel was busy.
+  bool SubmitPendingEntries() TFRT_EXCLUDES(mu_);
+
+  // Removes the pending entries from the submission queue after the kernel
+  // failed to submit them with `error`, and fails their requests.
+  void FailPendingEntries(int error) TFRT_EXCLUDES(mu_);
+
+  void HandleCompletion(Request* request, int result);
+
+  void RunCompletionLoop();
+
+  const int ring_fd_;
+  const unsigned max_in_flight_;
+
+  // The memory shared with the kernel.
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // Pointers into the submission queue ring.
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_ring_mask_ = 0;
+  unsigned sq_ring_entries_ = 0;
+  unsigned* sq_array_ = nullptr;
+
+  // Pointers into the completion queue ring.
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_ring_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  mutex mu_;
+  condition_variable in_flight_cv_;
+  // The requests which wait for a slot or for room in the submission queue.
+  std::deque<Request*> queued_ TFRT_GUARDED_BY(mu_);
+  // The number of requests added to the submission queue and not completed.
+  // It is bounded by the size of the submission queue, so that neither queue
+  // can overflow.
+  unsigned num_in_flight_ TFRT_GUARDED_BY(mu_) = 0;
+  // The number of entries added to the submission queue and not submitted.
+  unsigned num_unsubmitted_ TFRT_GUARDED_BY(mu_) = 0;
+  // Whether a thread is submitting the pending entries.
+  bool submitting_ TFRT_GUARDED_BY(mu_) = false;
+
+  // Set by the destructor before it adds the entry which stops the completion
+  // thread.
+  std::atomic<bool> stopping_{false};
+  std::thread completion_thread_;
+};
+
+// The user data of the entry which stops the completion thread.
+static constexpr uint64_t kStopUserData = 0;
+
+// The bounds of the delay between the retries of a system call which fails
+// with a transient or persistent error.
+static constexpr std::chrono::microseconds kMinRetryDelay(10);
+static constexpr std::chrono::microseconds kMaxRetryDelay(10000);
+
+// Sleeps for `delay`, which starts at zero, after doubling it within the
+// bounds above.
+static void BackOff(std::chrono::microseconds* delay) {
+  *delay = std::min(std::max(*delay * 2, kMinRetryDelay), kMaxRetryDelay);
+  std::this_thread::sleep_for(*delay);
+}
+
+static int IoUringSetup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                        unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+std::unique_ptr<IoUring> IoUring::Create(unsigned max_in_flight) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  const int ring_fd = IoUringSetup(max_in_flight, &params);
+  if (ring_fd < 0) return nullptr;
+
+  std::unique_ptr<IoUring> ring(new IoUring(ring_fd, params));
+  if (!ring->MapRings(params)) return nullptr;
+  ring->completion_thread_ = std::thread([ring = ring.get()]() {
+    ring->RunCompletionLoop();
+  });
+  return ring;
+}
+
+IoUring::IoUring(int ring_fd, const io_uring_params& params)
+    : ring_fd_(ring_fd), max_in_flight_(params.sq_entries) {}
+
+bool IoUring::MapRings(const io_uring_params& params) {
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+  auto map = [this](size_t size, off_t offset) -> void* {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  };
+  sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+  cq_ring_ = map(cq_ring_size_, IORING_OFF_CQ_RING);
+  sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+  if (!sq_ring_ || !cq_ring_ || !sqes_) return false;
+
+  auto* sq_ring = static_cast<char*>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+  sq_ring_mask_ =
+      *reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+  sq_ring_entries_ =
+      *reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_entries);
+  sq_array_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+
+  auto* cq_ring = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+  cq_ring_mask_ =
+      *reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+  return true;
+}
+
+IoUring::~IoUring() {
+  if (completion_thread_.joinable()) {
+    bool submit;
+    {
+      mutex_lock lock(mu_);
+      in_flight_cv_.wait(lock, [this]() TFRT_REQUIRES(mu_) {
+        return num_in_flight_ == 0 && queued_.empty();
+      });
+      stopping_.store(true);
+      // Without requests in flight, the submission queue is empty.
+      PushEntry(IORING_OP_NOP, -1, nullptr, 0, 0, kStopUserData);
+      submit = StartSubmitting();
+    }
+    if (submit) SubmitPendingEntries();
+    completion_thread_.join();
+  }
+
+  if (sqes_) munmap(sqes_, sqes_size_);
+  if (cq_ring_) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_) munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+void IoUring::Read(int fd, const std::string* path, char* buf,
+                   size_t max_count, size_t offset,
+                   AsyncValueRef<size_t> result) {
+  if (max_count == 0) {
+    result.emplace(0);
+    return;
+  }
+  auto* request = new Request{fd, path, buf, max_count, offset,
+                              std::move(result)};
+  bool submit;
+  {
+    mutex_lock lock(mu_);
+    // The waiters of the results run in the completion thread, which must not
+    // block if they read more, since it is the thread which releases the
+    // slots. Its reads stay queued until a slot is released instead.
+    if (std::this_thread::get_id() != completion_thread_.get_id()) {
+      in_flight_cv_.wait(lock, [this]() TFRT_REQUIRES(mu_) {
+        return num_in_flight_ + queued_.size() < max_in_flight_;
+      });
+    }
+    queued_.push_back(request);
+    submit = PushQueuedRequests();
+  }
+  if (submit) SubmitPendingEntries();
+}
+
+bool IoUring::PushQueuedRequests() {
+  while (!queued_.empty() && num_in_flight_ < max_in_flight_) {
+    Request* request = queued_.front();
+    // The kernel returns the number of bytes read as a 32-bit integer.
+    const size_t len =
+        std::min<size_t>(request->max_count - request->count,
+                         std::numeric_limits<std::int32_t>::max());
+    request->iov.iov_base = request->buf + request->count;
+    request->iov.iov_len = len;
+    if (!PushEntry(IORING_OP_READV, request->fd, &request->iov, 1,
+                   request->offset + request->count,
+                   reinterpret_cast<uint64_t>(request))) {
+      break;
+    }
+    queued_.pop_front();
+    ++num_in_flight_;
+  }
+  return StartSubmitting();
+}
+
+bool IoUring::PushEntry(uint8_t opcode, int fd, const void* addr,
+                        unsigned len, uint64_t offset, uint64_t user_data) {
+  // Only this class writes the tail, under mu_. The kernel advances the head
+  // when it consumes the entries.
+  const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  const unsigned tail = *sq_tail_;
+  if (tail - head >= sq_ring_entries_) return false;
+
+  const unsigned index = tail & sq_ring_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(addr);
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  // Publish the entry to the kernel.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++num_unsubmitted_;
+  return true;
+}
+
+bool IoUring::StartSubmitting() {
+  if (submitting_ || num_unsubmitted_ == 0) return false;
+  submitting_ = true;
+  return true;
+}
+
+bool IoUring::SubmitPendingEntries() {
+  std::chrono::microseconds delay(0);
+  while (true) {
+    unsigned to_submit;
+    {
+      mutex_lock lock(mu_);
+      // The entries submitted below make room for the requests queued when
+      // the submission queue was full.
+      PushQueuedRequests();
+      if (num_unsubmitted_ == 0) {
+        submitting_ = false;
+        return true;
+      }
+      to_submit = num_unsubmitted_;
+    }
+    // The entries added by other threads while this thread submits are
+    // submitted by the next iteration, in a single system call.
+    const int submitted = IoUringEnter(ring_fd_, to_submit, 0, 0);
+    if (submitted > 0) {
+      delay = std::chrono::microseconds(0);
+      mutex_lock lock(mu_);
+      num_unsubmitted_ -= submitted;
+      continue;
+    }
+    if (submitted < 0 && errno == EINTR) continue;
+    if (submitted == 0 || errno == EAGAIN || errno == EBUSY) {
+      // The kernel is short of resources or the completion queue is full, so
+      // give the completion thread time to make progress. That thread must not
+      // wait for itself.
+      if (std::this_thread::get_id() == completion_thread_.get_id()) {
+        mutex_lock lock(mu_);
+        submitting_ = false;
+        return false;
+      }
+      BackOff(&delay);
+      continue;
+    }
+    FailPendingEntries(errno);
+  }
+}
+
+void IoUring::FailPendingEntries(int error) {
+  std::vector<Request*> failed;
+  {
+    mutex_lock lock(mu_);
+    // The kernel consumes the entries only in the io_uring_enter() calls of
+    // the submitting thread, so the entries it did not consume can be taken
+    // back by resetting the tail.
+    const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    for (unsigned i = head; i != *sq_tail_; ++i) {
+      const uint64_t user_data = sqes_[sq_array_[i & sq_ring_mask_]].user_data;
+      // If the entry which stops the completion thread is dropped, that thread
+      // stops when it fails to wait for completions.
+      if (user_data == kStopUserData) continue;
+      failed.push_back(reinterpret_cast<Request*>(user_data));
+    }
+    __atomic_store_n(sq_tail_, head, __ATOMIC_RELEASE);
+    num_unsubmitted_ = 0;
+    num_in_flight_ -= failed.size();
+    in_flight_cv_.notify_all();
+  }
+  for (Request* request : failed) {
+    std::unique_ptr<Request> done(request);
+    done->result.SetError(StrCat("failed to submit read of file ",
+                                 *done->path,
+                                 " due to error: ", strerror(error)));
+  }
+}
+
+void IoUring::HandleCompletion(Request* request, int result) {
+  bool resubmit = result == -EINTR || result == -EAGAIN;
+  if (result > 0) {
+    request->count += result;
+    // A short read which is not at the end of the file reads the remaining
+    // bytes, like pread in PosixRandomAccessFile::Read().
+    resubmit = request->count < request->max_count;
+  }
+
+  // Release the slot before setting the result, whose waiters might read more.
+  // A resubmitted request goes back to the front of the queue.
+  bool submit;
+  {
+    mutex_lock lock(mu_);
+    --num_in_flight_;
+    if (resubmit) queued_.push_front(request);
+    submit = PushQueuedRequests();
+    if (!resubmit) in_flight_cv_.notify_all();
+  }
+  if (submit) SubmitPendingEntries();
+  if (resubmit) return;
+
+  std::unique_ptr<Request> done(request);
+  if (result < 0) {
+    done->result.SetError(StrCat("failed to read file ", *done->path,
+                                 " due to error: ", strerror(-result)));
+  } else {
+    done->result.emplace(done->count);
+  }
+}
+
+void IoUring::RunCompletionLoop() {
+  std::chrono::microseconds submit_delay(0);
+  std::chrono::microseconds wait_delay(0);
+  while (true) {
+    // Retry the entries which this thread left when the kernel was busy. Until
+    // they are submitted, poll for completions instead of waiting for them, as
+    // there might be none in flight.
+    bool submit;
+    {
+      mutex_lock lock(mu_);
+      submit = StartSubmitting();
+    }
+    if (submit && !SubmitPendingEntries()) {
+      BackOff(&submit_delay);
+    } else if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+               errno != EINTR) {
+      submit_delay = std::chrono::microseconds(0);
+      // The kernel still posts the completions, so poll for them with a
+      // growing delay until waiting works again. Only the first error of a
+      // series is reported.
+      if (wait_delay.count() == 0) {
+        tfrt::errs() << "failed to wait for io_uring completions due to error: "
+                     << strerror(errno) << "\n";
+      }
+      if (stopping_.load()) return;
+      BackOff(&wait_delay);
+    } else {
+      submit_delay = std::chrono::microseconds(0);
+      wait_delay = std::chrono::microseconds(0);
+    }
+
+    // Only this thread writes the head.
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    bool stop = false;
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes_[head & cq_ring_mask_];
+      const uint64_t user_data = cqe.user_data;
+      const int result = cqe.res;
+      // Release the entry before handling it, since a resubmission could
+      // otherwise wait for the space.
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      if (user_data == kStopUserData) {
+        stop = true;
+      } else {
+        HandleCompletion(reinterpret_cast<Request*>(user_data), result);
+      }
+    }
+    if (stop) return;
+  }
+}
+
+namespace {
+
+class IoUringRandomAccessFile : public PosixRandomAccessFile {
+ public:
+  explicit IoUringRandomAccessFile(int fd, const std::string& path,
+                                   IoUringFileSystem* file_system)
+      : PosixRandomAccessFile(fd, path), file_system_(file_system) {}
+
+  AsyncValueRef<size_t> ReadAsync(char* buf, size_t max_count, size_t offset,
+                                  HostContext* host) const override {
+    IoUring* ring = file_system_->GetRing();
+    if (!ring || fd_ < 0) {
+      return PosixRandomAccessFile::ReadAsync(buf, max_count, offset, host);
+    }
+    auto result = MakeUnconstructedAsyncValueRef<size_t>(host);
+    ring->Read(fd_, &path_, buf, max_count, offset, result.CopyRef());
+    return result;
+  }
+
+ private:
+  IoUringFileSystem* file_system_;
+};
+
+}  // namespace
+
+IoUringFileSystem::IoUringFileSystem(unsigned max_in_flight)
+    : max_in_flight_(max_in_flight) {
+  assert(max_in_flight_ > 0);
+}
+
+IoUringFileSystem::~IoUringFileSystem() = default;
+
+IoUring* IoUringFileSystem::GetRing() {
+  mutex_lock lock(mu_);
+  if (!ring_initialized_) {
+    ring_ = IoUring::Create(max_in_flight_);
+    ring_initialized_ = true;
+  }
+  return ring_.get();
+}
+
+llvm::Error IoUringFileSystem::NewRandomAccessFile(
+    const std::string& path, std::unique_ptr<RandomAccessFile>* file) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    file->reset();
+    return MakeStringError("failed to open file ", path,
+                           " due to error: ", strerror(errno));
+  }
+  *file = std::make_unique<IoUringRandomAccessFile>(fd, path, this);
+  return llvm::Error::success();
+}
+
+}  // namespace io
+}  // namespace tfrt
+
+#endif  // __linux__
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2021 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file declares the IoUringFileSystem class, which reads files
+// asynchronously with io_uring on Linux.
+
+#ifndef TFRT_LIB_IO_IO_URING_FILE_SYSTEM_H_
+#define TFRT_LIB_IO_IO_URING_FILE_SYSTEM_H_
+
+#include <memory>
+
+#include "posix_file_system.h"
+#include "tfrt/io/file_system.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace io {
+
+class IoUring;
+
+// This class is used to manage files in a POSIX file system, whose
+// RandomAccessFile::ReadAsync() is implemented with io_uring.
+//
+// All the files share one ring. Reads submitted concurrently are submitted to
+// the kernel in batches, and their completions are handled by a single thread
+// instead of a blocking thread per read, so that one thread can drive hundreds
+// of concurrent reads. The values returned by ReadAsync() are set in that
+// thread, so their waiters should not block.
+//
+// The ring is created by the first ReadAsync(). If the kernel does not support
+// io_uring, e.g. before Linux 5.1 or in sandboxes which disallow it, the files
+// fall back to pread in blocking tasks.
+class IoUringFileSystem : public FileSystem {
+ public:
+  // At most `max_in_flight` reads are submitted to the kernel at a time.
+  explicit IoUringFileSystem(unsigned max_in_flight = 256);
+
+  ~IoUringFileSystem() override;
+
+  // This class is not copyable or movable.
+  IoUringFileSystem(const IoUringFileSystem&) = delete;
+  IoUringFileSystem& operator=(const IoUringFileSystem&) = delete;
+
+  llvm::Error NewRandomAccessFile(
+      const std::string& path,
+      std::unique_ptr<RandomAccessFile>* file) override;
+
+  FileSystemPriority GetPriority() override {
+    return FileSystemPriority::kHigh;
+  }
+
+  // Returns the ring, which is created on the first call, or nullptr if the
+  // kernel does not support io_uring.
+  IoUring* GetRing() TFRT_EXCLUDES(mu_);
+
+ private:
+  const unsigned max_in_flight_;
+
+  mutex mu_;
+  bool ring_initialized_ TFRT_GUARDED_BY(mu_) = false;
+  std::unique_ptr<IoUring> ring_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace io
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_IO_IO_URING_FILE_SYSTEM_H_
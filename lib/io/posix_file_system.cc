@@ -26,29 +26,12 @@
 
 #include "llvm_derived/Support/raw_ostream.h"
 
+#ifdef __linux__
+#include "io_uring_file_system.h"
+#endif
+
 namespace tfrt {
 namespace io {
-namespace {
-
-// This class is used to read data from a random access file.
-class PosixRandomAccessFile : public RandomAccessFile {
- public:
-  explicit PosixRandomAccessFile(int fd, const std::string& path)
-      : fd_(fd), path_(path) {}
-
-  ~PosixRandomAccessFile() override;
-
-  // This class is not copyable or movable.
-  PosixRandomAccessFile(const PosixRandomAccessFile&) = delete;
-  PosixRandomAccessFile operator=(const PosixRandomAccessFile&) = delete;
-
-  llvm::Expected<size_t> Read(char* buf, size_t max_count,
-                              size_t offset) const override;
-
- private:
-  int fd_;
-  const std::string path_;
-};
 
 PosixRandomAccessFile::~PosixRandomAccessFile() {
   if (fd_ < 0) return;
@@ -81,7 +64,6 @@ llvm::Expected<size_t> PosixRandomAccessFile::Read(char* buf, size_t max_count,
 
   return actual_count;
 }
-}  // namespace
 
 llvm::Error PosixFileSystem::NewRandomAccessFile(
     const std::string& path, std::unique_ptr<RandomAccessFile>* file) {
@@ -99,6 +81,11 @@ void RegisterFileSystem(FileSystemRegistry* registry) {
   auto file_system = std::make_unique<PosixFileSystem>();
   // The scheme is an empty string to be backward-compatible with TF.
   registry->Register("", std::move(file_system));
+#ifdef __linux__
+  // IoUringFileSystem has a higher priority, and falls back to pread if the
+  // kernel does not support io_uring.
+  registry->Register("", std::make_unique<IoUringFileSystem>());
+#endif
 }
 
 }  // namespace io
@@ -24,6 +24,26 @@
 namespace tfrt {
 namespace io {
 
+// This class is used to read data from a random access file.
+class PosixRandomAccessFile : public RandomAccessFile {
+ public:
+  explicit PosixRandomAccessFile(int fd, const std::string& path)
+      : fd_(fd), path_(path) {}
+
+  ~PosixRandomAccessFile() override;
+
+  // This class is not copyable or movable.
+  PosixRandomAccessFile(const PosixRandomAccessFile&) = delete;
+  PosixRandomAccessFile operator=(const PosixRandomAccessFile&) = delete;
+
+  llvm::Expected<size_t> Read(char* buf, size_t max_count,
+                              size_t offset) const override;
+
+ protected:
+  int fd_;
+  const std::string path_;
+};
+
 // This class is used to manage files in a POSIX file system.
 class PosixFileSystem : public FileSystem {
  public:
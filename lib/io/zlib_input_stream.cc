@@ -0,0 +1,113 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file implements the ZlibInputStream class.
+
+#include "tfrt/io/zlib_input_stream.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tfrt/support/string_util.h"
+#include "zlib.h"
+
+namespace tfrt {
+namespace io {
+
+llvm::Expected<CompressionType> ParseCompressionType(string_view name) {
+  if (name.empty()) return CompressionType::kNone;
+  if (name == "ZLIB") return CompressionType::kZlib;
+  if (name == "GZIP") return CompressionType::kGzip;
+  return MakeStringError("unsupported compression type: ", name);
+}
+
+ZlibInputStream::ZlibInputStream(std::unique_ptr<InputStream> input_stream,
+                                 CompressionType compression_type,
+                                 size_t input_buffer_size,
+                                 HostAllocator* allocator)
+    : input_stream_(std::move(input_stream)),
+      allocator_(allocator),
+      input_buffer_size_(input_buffer_size),
+      z_stream_(std::make_unique<z_stream_s>()) {
+  assert(compression_type != CompressionType::kNone);
+  assert(input_buffer_size_ > 0);
+  input_buffer_ = allocator_->Allocate<char>(input_buffer_size_);
+
+  // Adding 16 to the window bits makes zlib decode the GZIP header and footer
+  // instead of the ZLIB ones.
+  const int window_bits =
+      compression_type == CompressionType::kGzip ? MAX_WBITS + 16 : MAX_WBITS;
+  z_stream_->zalloc = Z_NULL;
+  z_stream_->zfree = Z_NULL;
+  z_stream_->opaque = Z_NULL;
+  z_stream_->next_in = Z_NULL;
+  z_stream_->avail_in = 0;
+  const int status = inflateInit2(z_stream_.get(), window_bits);
+  if (status != Z_OK) {
+    init_error_ = StrCat("failed to initialize zlib: ", status);
+  }
+}
+
+ZlibInputStream::~ZlibInputStream() {
+  if (init_error_.empty()) inflateEnd(z_stream_.get());
+  allocator_->Deallocate(input_buffer_, input_buffer_size_);
+}
+
+llvm::Expected<size_t> ZlibInputStream::Read(char* buf, size_t max_count) {
+  if (!init_error_.empty()) return MakeStringError(init_error_);
+
+  z_stream_->next_out = reinterpret_cast<Bytef*>(buf);
+  size_t actual_count = 0;
+  while (actual_count < max_count) {
+    if (z_stream_->avail_in == 0 && !input_eof_) {
+      auto count_or_error =
+          input_stream_->Read(input_buffer_, input_buffer_size_);
+      if (!count_or_error) return count_or_error.takeError();
+      input_eof_ = *count_or_error < input_buffer_size_;
+      z_stream_->next_in = reinterpret_cast<Bytef*>(input_buffer_);
+      z_stream_->avail_in = *count_or_error;
+    }
+    if (z_stream_->avail_in == 0) {
+      if (in_stream_) return MakeStringError("truncated compressed stream");
+      break;
+    }
+
+    // avail_out is a 32-bit integer in zlib.
+    const uInt avail_out = static_cast<uInt>(
+        std::min<size_t>(max_count - actual_count, UINT32_MAX));
+    z_stream_->avail_out = avail_out;
+    const int status = inflate(z_stream_.get(), Z_NO_FLUSH);
+    actual_count += avail_out - z_stream_->avail_out;
+    if (status == Z_STREAM_END) {
+      // Continue with the next stream, if any.
+      in_stream_ = false;
+      if (inflateReset(z_stream_.get()) != Z_OK) {
+        return MakeStringError("failed to reset zlib stream");
+      }
+    } else if (status == Z_OK) {
+      in_stream_ = true;
+    } else {
+      return MakeStringError(
+          "failed to decompress data at position ", stream_pos_ + actual_count,
+          ": ", z_stream_->msg ? z_stream_->msg : "unknown zlib error");
+    }
+  }
+  stream_pos_ += actual_count;
+  return actual_count;
+}
+
+llvm::Expected<size_t> ZlibInputStream::Tell() { return stream_pos_; }
+
+}  // namespace io
+}  // namespace tfrt
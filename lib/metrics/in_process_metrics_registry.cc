@@ -0,0 +1,261 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- in_process_metrics_registry.cc - In-process Metrics Registry -------===//
+//
+// This file implements a metrics registry that keeps all metrics in memory.
+
+#include "tfrt/metrics/in_process_metrics_registry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace tfrt {
+namespace metrics {
+
+//===----------------------------------------------------------------------===//
+// Metric implementations
+//===----------------------------------------------------------------------===//
+
+class InProcessMetricsRegistry::StringGauge : public Gauge<std::string> {
+ public:
+  void Set(std::string value) override {
+    mutex_lock lock(mu_);
+    value_ = std::move(value);
+  }
+
+  std::string Get() const {
+    mutex_lock lock(mu_);
+    return value_;
+  }
+
+ private:
+  mutable mutex mu_;
+  std::string value_ TFRT_GUARDED_BY(mu_);
+};
+
+class InProcessMetricsRegistry::IntGauge : public Gauge<int64_t> {
+ public:
+  void Set(int64_t value) override {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  int64_t Get() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// Counter that is incremented by multiple threads concurrently. Each thread
+// updates one of the shards, so that the threads do not contend on the same
+// cache line.
+class InProcessMetricsRegistry::ShardedCounter : public Counter {
+ public:
+  void IncrementBy(int64_t value) override {
+    shards_[ShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  int64_t Get() const {
+    int64_t value = 0;
+    for (const Shard& shard : shards_)
+      value += shard.value.load(std::memory_order_relaxed);
+    return value;
+  }
+
+ private:
+  static constexpr int kNumShards = 16;
+
+  struct alignas(64) Shard {
+    std::atomic<int64_t> value{0};
+  };
+
+  static int ShardIndex() {
+    static std::atomic<int> next_index{0};
+    static thread_local int index =
+        next_index.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+    return index;
+  }
+
+  Shard shards_[kNumShards];
+};
+
+class InProcessMetricsRegistry::AtomicHistogram : public Histogram {
+ public:
+  explicit AtomicHistogram(const Buckets& buckets)
+      : bounds_(buckets.explicit_bounds()),
+        bucket_counts_(bounds_.size() + 1) {}
+
+  void Record(double value) override {
+    // Bucket 0 is the underflow bucket, bucket `i` holds values in the
+    // [bounds_[i - 1], bounds_[i]) range.
+    size_t bucket =
+        std::upper_bound(bounds_.begin(), bounds_.end(), value) -
+        bounds_.begin();
+    bucket_counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + value,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  const std::vector<double>& bounds() const { return bounds_; }
+
+  HistogramSnapshot Get() const {
+    HistogramSnapshot snapshot;
+    snapshot.bounds = bounds_;
+    for (const auto& count : bucket_counts_) {
+      snapshot.bucket_counts.push_back(count.load(std::memory_order_relaxed));
+      snapshot.count += snapshot.bucket_counts.back();
+    }
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    return snapshot;
+  }
+
+ private:
+  const std::vector<double> bounds_;
+  std::vector<std::atomic<int64_t>> bucket_counts_;
+  std::atomic<double> sum_{0};
+};
+
+//===----------------------------------------------------------------------===//
+// InProcessMetricsRegistry
+//===----------------------------------------------------------------------===//
+
+InProcessMetricsRegistry::InProcessMetricsRegistry() = default;
+InProcessMetricsRegistry::~InProcessMetricsRegistry() = default;
+
+// Returns the metric with the given name, creating it if it does not exist.
+template <typename T, typename... Args>
+static T* GetOrCreate(llvm::StringMap<std::unique_ptr<T>>& metrics,
+                      const std::string& name, Args&&... args) {
+  auto it = metrics.try_emplace(name);
+  if (it.second)
+    it.first->second = std::make_unique<T>(std::forward<Args>(args)...);
+  return it.first->second.get();
+}
+
+Gauge<std::string>* InProcessMetricsRegistry::NewStringGauge(
+    std::string name) {
+  mutex_lock lock(mu_);
+  return GetOrCreate(string_gauges_, name);
+}
+
+Gauge<int64_t>* InProcessMetricsRegistry::NewIntGauge(std::string name) {
+  mutex_lock lock(mu_);
+  return GetOrCreate(int_gauges_, name);
+}
+
+Counter* InProcessMetricsRegistry::NewCounter(std::string name) {
+  mutex_lock lock(mu_);
+  return GetOrCreate(counters_, name);
+}
+
+Histogram* InProcessMetricsRegistry::NewHistogram(std::string name,
+                                                  const Buckets& buckets) {
+  mutex_lock lock(mu_);
+  AtomicHistogram* histogram = GetOrCreate(histograms_, name, buckets);
+  assert(histogram->bounds() == buckets.explicit_bounds() &&
+         "histogram with the same name has different buckets");
+  return histogram;
+}
+
+InProcessMetricsRegistry::Snapshot InProcessMetricsRegistry::GetSnapshot()
+    const {
+  mutex_lock lock(mu_);
+
+  Snapshot snapshot;
+  for (const auto& it : counters_)
+    snapshot.counters[it.getKey().str()] = it.getValue()->Get();
+  for (const auto& it : int_gauges_)
+    snapshot.int_gauges[it.getKey().str()] = it.getValue()->Get();
+  for (const auto& it : string_gauges_)
+    snapshot.string_gauges[it.getKey().str()] = it.getValue()->Get();
+  for (const auto& it : histograms_)
+    snapshot.histograms[it.getKey().str()] = it.getValue()->Get();
+  return snapshot;
+}
+
+//===----------------------------------------------------------------------===//
+// Snapshot printing
+//===----------------------------------------------------------------------===//
+
+void InProcessMetricsRegistry::Snapshot::PrintText(raw_ostream& os) const {
+  for (const auto& it : counters) os << it.first << ": " << it.second << "\n";
+  for (const auto& it : int_gauges) os << it.first << ": " << it.second << "\n";
+  for (const auto& it : string_gauges)
+    os << it.first << ": \"" << it.second << "\"\n";
+
+  for (const auto& it : histograms) {
+    const HistogramSnapshot& histogram = it.second;
+    os << it.first << ": count=" << histogram.count
+       << " sum=" << llvm::format("%g", histogram.sum);
+
+    // Print only the non-empty buckets.
+    for (size_t i = 0; i < histogram.bucket_counts.size(); ++i) {
+      if (histogram.bucket_counts[i] == 0) continue;
+      os << " [";
+      if (i == 0)
+        os << "-inf";
+      else
+        os << llvm::format("%g", histogram.bounds[i - 1]);
+      os << ", ";
+      if (i == histogram.bounds.size())
+        os << "inf";
+      else
+        os << llvm::format("%g", histogram.bounds[i]);
+      os << "):" << histogram.bucket_counts[i];
+    }
+    os << "\n";
+  }
+}
+
+void InProcessMetricsRegistry::Snapshot::PrintJson(raw_ostream& os) const {
+  llvm::json::OStream json(os, /*IndentSize=*/2);
+  json.object([&] {
+    json.attributeObject("counters", [&] {
+      for (const auto& it : counters) json.attribute(it.first, it.second);
+    });
+
+    json.attributeObject("gauges", [&] {
+      for (const auto& it : int_gauges) json.attribute(it.first, it.second);
+      for (const auto& it : string_gauges) json.attribute(it.first, it.second);
+    });
+
+    json.attributeObject("histograms", [&] {
+      for (const auto& it : histograms) {
+        const HistogramSnapshot& histogram = it.second;
+        json.attributeObject(it.first, [&] {
+          json.attribute("count", histogram.count);
+          json.attribute("sum", histogram.sum);
+          json.attributeArray("bounds", [&] {
+            for (double bound : histogram.bounds) json.value(bound);
+          });
+          json.attributeArray("bucket_counts", [&] {
+            for (int64_t count : histogram.bucket_counts) json.value(count);
+          });
+        });
+      }
+    });
+  });
+  os << "\n";
+}
+
+}  // namespace metrics
+}  // namespace tfrt
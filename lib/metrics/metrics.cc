@@ -21,6 +21,14 @@
 namespace tfrt {
 namespace metrics {
 
+// A dummy implementation of the Counter metric interface.
+class DummyCounter : public Counter {
+ public:
+  DummyCounter() {}
+
+  void IncrementBy(int64_t value) override {}
+};
+
 // A dummy implementation of the Gauge metric interface.
 template <typename T>
 class DummyGauge : public Gauge<T> {
@@ -38,6 +46,14 @@ class DummyHistogram : public Histogram {
   void Record(double value) override {}
 };
 
+Counter* NewCounter(std::string name) {
+  if (internal::kMetricsRegistry != nullptr) {
+    if (auto* counter = internal::kMetricsRegistry->NewCounter(name))
+      return counter;
+  }
+  return new DummyCounter();
+}
+
 template <>
 Gauge<std::string>* NewGauge(std::string name) {
   if (internal::kMetricsRegistry != nullptr)
@@ -45,6 +61,15 @@ Gauge<std::string>* NewGauge(std::string name) {
   return new DummyGauge<std::string>();
 }
 
+template <>
+Gauge<int64_t>* NewGauge(std::string name) {
+  if (internal::kMetricsRegistry != nullptr) {
+    if (auto* gauge = internal::kMetricsRegistry->NewIntGauge(name))
+      return gauge;
+  }
+  return new DummyGauge<int64_t>();
+}
+
 Histogram* NewHistogram(std::string name, const Buckets& buckets) {
   if (internal::kMetricsRegistry != nullptr)
     return internal::kMetricsRegistry->NewHistogram(name, buckets);
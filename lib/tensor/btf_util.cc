@@ -16,7 +16,23 @@
 
 #include "tfrt/tensor/btf_util.h"
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <system_error>
+
+#include "llvm/Support/FileSystem.h"
+#include "tfrt/support/crc32c.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 namespace {
@@ -51,6 +67,148 @@ Error WriteDHTToBTF(std::ostream* stream, const DenseHostTensor& dht) {
   return Error::success();
 }
 
+// Returns the size of the TENSOR_RECORD of `dht`, without the padding.
+size_t GetDHTRecordSize(const DenseHostTensor& dht) {
+  return sizeof(btf::TensorHeader) + dht.shape().GetRank() * sizeof(uint64_t) +
+         dht.DataSizeInBytes();
+}
+
+// Writes `size` bytes of `data` at `offset` in the file `fd`.
+Error WriteAt(int fd, const void* data, size_t size, uint64_t offset) {
+#ifdef _WIN32
+  return MakeStringError("pwrite is not supported on this platform");
+#else
+  const char* ptr = static_cast<const char*>(data);
+  while (size > 0) {
+    const ssize_t written = pwrite(fd, ptr, size, offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return MakeStringError("failed to write at offset ", offset, ": ",
+                             std::strerror(errno));
+    }
+    ptr += written;
+    size -= written;
+    offset += written;
+  }
+  return Error::success();
+#endif
+}
+
+// BTFFileWriter holds the state of WriteTensorsToBTFFile() which is shared by
+// the tasks writing the tensor records. The last task to finish writes the file
+// header, which includes the checksums of all records.
+class BTFFileWriter {
+ public:
+  BTFFileWriter(int fd, std::vector<DenseHostTensor> tensors,
+                std::vector<btf::TensorDType> dtypes,
+                std::vector<uint64_t> offsets, AsyncValueRef<Chain> done)
+      : fd_(fd),
+        tensors_(std::move(tensors)),
+        dtypes_(std::move(dtypes)),
+        offsets_(std::move(offsets)),
+        checksums_(tensors_.size()),
+        num_pending_(tensors_.size()),
+        done_(std::move(done)) {}
+
+  // Writes the `index`-th tensor record, and finishes the file if it is the
+  // last record to be written.
+  void WriteRecord(size_t index) {
+    const DenseHostTensor& dht = tensors_[index];
+    const int rank = dht.shape().GetRank();
+    SmallVector<char, 64> record_header(sizeof(btf::TensorHeader) +
+                                        rank * sizeof(uint64_t));
+    btf::TensorHeader header = {};
+    header.rank = rank;
+    header.dtype = dtypes_[index];
+    header.layout = btf::TensorLayout::kRMD;
+    std::memcpy(record_header.data(), &header, sizeof(header));
+    for (int i = 0; i < rank; ++i) {
+      const uint64_t dim = dht.shape().GetDimensionSize(i);
+      std::memcpy(record_header.data() + sizeof(header) + i * sizeof(dim),
+                  &dim, sizeof(dim));
+    }
+
+    const char* data = static_cast<const char*>(dht.data());
+    const size_t nbytes = dht.DataSizeInBytes();
+    uint32_t crc = crc32c::Value(record_header.data(), record_header.size());
+    checksums_[index] = crc32c::Mask(crc32c::Extend(crc, data, nbytes));
+
+    uint64_t offset = offsets_[index];
+    Error error = WriteAt(fd_, record_header.data(), record_header.size(),
+                          offset);
+    offset += record_header.size();
+    if (!error) error = WriteAt(fd_, data, nbytes, offset);
+    offset += nbytes;
+    constexpr std::array<uint8_t, 7> pad_value{0, 0, 0, 0, 0, 0, 0};
+    if (!error) error = WriteAt(fd_, pad_value.data(), Pad(nbytes), offset);
+    if (error) SetError(std::move(error));
+
+    if (num_pending_.fetch_sub(1) == 1) Finish();
+  }
+
+  // Writes the file header and closes the file.
+  void Finish() {
+    const size_t num_tensors = tensors_.size();
+    std::vector<char> file_header(GetFileHeaderSize(num_tensors));
+    char* ptr = file_header.data();
+    const uint64_t num_tensors_u64 = num_tensors;
+    std::memcpy(ptr, &num_tensors_u64, sizeof(uint64_t));
+    ptr += sizeof(uint64_t);
+    std::memcpy(ptr, offsets_.data(), num_tensors * sizeof(uint64_t));
+    ptr += num_tensors * sizeof(uint64_t);
+    std::memcpy(ptr, &btf::kChecksumTableMagic, sizeof(uint64_t));
+    ptr += sizeof(uint64_t);
+    std::memcpy(ptr, checksums_.data(), num_tensors * sizeof(uint32_t));
+
+    Error error = WriteAt(fd_, file_header.data(), file_header.size(), 0);
+    if (error) SetError(std::move(error));
+    namespace fs = ::llvm::sys::fs;
+    fs::file_t file = fs::convertFDToNativeFile(fd_);
+    if (std::error_code ec = fs::closeFile(file)) {
+      SetError(MakeStringError("failed to close file: ", ec.message()));
+    }
+
+    mutex_lock lock(mu_);
+    if (error_.empty()) {
+      done_.emplace();
+    } else {
+      done_.SetError(error_);
+    }
+  }
+
+  // Returns the size of the file header, including the checksum table and its
+  // padding.
+  static size_t GetFileHeaderSize(size_t num_tensors) {
+    const size_t checksums_size = num_tensors * sizeof(uint32_t);
+    return (num_tensors + 2) * sizeof(uint64_t) + checksums_size +
+           Pad(checksums_size);
+  }
+
+ private:
+  void SetError(Error error) {
+    mutex_lock lock(mu_);
+    // Only keep the first error.
+    if (error_.empty()) {
+      error_ = llvm::toString(std::move(error));
+    } else {
+      llvm::consumeError(std::move(error));
+    }
+  }
+
+  const int fd_;
+  const std::vector<DenseHostTensor> tensors_;
+  const std::vector<btf::TensorDType> dtypes_;
+  const std::vector<uint64_t> offsets_;
+  // The masked crc32c of each tensor record. Each is set by the task which
+  // writes the record.
+  std::vector<uint32_t> checksums_;
+  std::atomic<size_t> num_pending_;
+  AsyncValueRef<Chain> done_;
+
+  mutex mu_;
+  std::string error_ TFRT_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 Expected<std::vector<uint64_t>> ReadBTFOffsets(std::istream* stream) {
@@ -98,6 +256,126 @@ Expected<DenseHostTensor> ReadDHTFromBTF(std::istream* stream, uint64_t offset,
   return std::move(dht);
 }
 
+Expected<MappedBTFFile> MappedBTFFile::Open(string_view path) {
+  namespace fs = ::llvm::sys::fs;
+
+  int fd;
+  if (std::error_code ec = fs::openFileForRead(path, fd)) {
+    return MakeStringError("failed to open file ", path, ": ", ec.message());
+  }
+  fs::file_t file = fs::convertFDToNativeFile(fd);
+
+  fs::file_status status;
+  if (std::error_code ec = fs::status(fd, status)) {
+    fs::closeFile(file);
+    return MakeStringError("failed to stat file ", path, ": ", ec.message());
+  }
+  if (status.getSize() < sizeof(uint64_t)) {
+    fs::closeFile(file);
+    return MakeStringError("failed to read num_tensors from path ", path);
+  }
+
+  // The mapping stays valid after the file is closed. It is private so that
+  // the returned tensors can be written to.
+  std::error_code ec;
+  auto region = std::make_unique<fs::mapped_file_region>(
+      file, fs::mapped_file_region::priv, status.getSize(), /*offset=*/0, ec);
+  fs::closeFile(file);
+  if (ec) {
+    return MakeStringError("failed to mmap file ", path, ": ", ec.message());
+  }
+
+  void* data = region->data();
+  const size_t size = region->size();
+  auto buffer = HostBuffer::CreateFromExternal(
+      data, size, [region = std::move(region)](void*, size_t) mutable {
+        region.reset();
+      });
+
+  // Mappings are page aligned, so the offset table can be used in place.
+  const auto* header = static_cast<const uint64_t*>(data);
+  const uint64_t num_tensors = header[0];
+  if (num_tensors > size / sizeof(uint64_t) - 1) {
+    return MakeStringError("failed to read tensor record offsets from path ",
+                           path, " which contains ", num_tensors, " tensors");
+  }
+  ArrayRef<uint64_t> offsets(header + 1, num_tensors);
+
+  // The checksum table follows the offsets if there is room for it before the
+  // first tensor record.
+  ArrayRef<uint32_t> checksums;
+  const uint64_t table_offset = (num_tensors + 1) * sizeof(uint64_t);
+  const uint64_t table_end =
+      table_offset + sizeof(uint64_t) + num_tensors * sizeof(uint32_t);
+  if (num_tensors > 0 && table_end <= size &&
+      *std::min_element(offsets.begin(), offsets.end()) >= table_end &&
+      header[num_tensors + 1] == btf::kChecksumTableMagic) {
+    checksums = ArrayRef<uint32_t>(
+        reinterpret_cast<const uint32_t*>(header + num_tensors + 2),
+        num_tensors);
+  }
+  return MappedBTFFile(std::move(buffer), offsets, checksums);
+}
+
+Expected<DenseHostTensor> MappedBTFFile::ReadDHT(size_t index,
+                                                 HostContext* host,
+                                                 bool verify_checksum) const {
+  if (index >= offsets_.size()) {
+    return MakeStringError("invalid tensor index ", index, " in file with ",
+                           offsets_.size(), " tensors");
+  }
+  const uint64_t offset = offsets_[index];
+  const size_t size = buffer_->size();
+  const char* base = static_cast<const char*>(buffer_->data());
+
+  btf::TensorHeader header;
+  if (offset > size || size - offset < sizeof(header)) {
+    return MakeStringError("failed to read tensor header at offset ", offset);
+  }
+  std::memcpy(&header, base + offset, sizeof(header));
+  if (header.layout != btf::TensorLayout::kRMD) {
+    return MakeStringError("unexpected tensor layout ", header.layout);
+  }
+
+  uint64_t data_offset = offset + sizeof(header);
+  if (header.rank > (size - data_offset) / sizeof(uint64_t)) {
+    return MakeStringError("failed to read tensor dims at offset ", offset);
+  }
+  SmallVector<Index, 4> dims;
+  dims.resize(header.rank);
+  std::memcpy(dims.data(), base + data_offset, header.rank * sizeof(uint64_t));
+  data_offset += header.rank * sizeof(uint64_t);
+
+  const TensorMetadata metadata(DType(ToDTypeKind(header.dtype)),
+                                TensorShape(dims));
+  const size_t nbytes = metadata.GetHostSizeInBytes();
+  if (size - data_offset < nbytes) {
+    return MakeStringError("failed to read tensor data at offset ", offset);
+  }
+
+  if (verify_checksum && has_checksums()) {
+    const uint32_t crc =
+        crc32c::Value(base + offset, data_offset + nbytes - offset);
+    if (crc32c::Mask(crc) != checksums_[index]) {
+      return MakeStringError("checksum mismatch for tensor ", index,
+                             " at offset ", offset);
+    }
+  }
+
+  // The mapping is page aligned, so the data is aligned if its offset is.
+  if (data_offset % GetHostAlignment(metadata.dtype) == 0) {
+    return DenseHostTensor(
+        metadata, HostBuffer::CreateFromExternal(buffer_, data_offset, nbytes));
+  }
+
+  auto dht = DenseHostTensor::CreateUninitialized(metadata, host);
+  if (!dht.hasValue()) {
+    return MakeStringError("cannot allocate result tensor");
+  }
+  std::memcpy(dht->data(), base + data_offset, nbytes);
+  return std::move(*dht);
+}
+
 Error WriteTensorsToBTF(std::ostream* stream, ArrayRef<const Tensor*> tensors) {
   const uint64_t num_tensors = tensors.size();
   if (!WriteStream(stream, &num_tensors, 1)) {
@@ -110,9 +388,7 @@ Error WriteTensorsToBTF(std::ostream* stream, ArrayRef<const Tensor*> tensors) {
     offsets.push_back(offset);
     if (tensor->tensor_type() == DenseHostTensor::kTensorType) {
       const auto& dht = reinterpret_cast<const DenseHostTensor&>(*tensor);
-      const size_t nbytes = dht.DataSizeInBytes();
-      offset += sizeof(btf::TensorHeader) +
-                dht.shape().GetRank() * sizeof(uint64_t) + nbytes + Pad(nbytes);
+      offset += GetDHTRecordSize(dht) + Pad(dht.DataSizeInBytes());
     } else {
       return MakeStringError("unhandled tensor type when writing btf");
     }
@@ -141,4 +417,41 @@ Error WriteTensorsToBTF(std::ostream* stream, ArrayRef<const Tensor*> tensors) {
   return Error::success();
 }
 
+AsyncValueRef<Chain> WriteTensorsToBTFFile(std::string path,
+                                           std::vector<DenseHostTensor> tensors,
+                                           HostContext* host) {
+  std::vector<btf::TensorDType> dtypes;
+  std::vector<uint64_t> offsets;
+  dtypes.reserve(tensors.size());
+  offsets.reserve(tensors.size());
+  uint64_t offset = BTFFileWriter::GetFileHeaderSize(tensors.size());
+  for (const DenseHostTensor& dht : tensors) {
+    auto dtype_or = btf::ToTensorDType(dht.dtype());
+    if (!dtype_or) {
+      return MakeErrorAsyncValueRef(llvm::toString(dtype_or.takeError()));
+    }
+    dtypes.push_back(*dtype_or);
+    offsets.push_back(offset);
+    offset += GetDHTRecordSize(dht) + Pad(dht.DataSizeInBytes());
+  }
+
+  int fd;
+  if (std::error_code ec = llvm::sys::fs::openFileForWrite(path, fd)) {
+    return MakeErrorAsyncValueRef(
+        StrCat("failed to open file ", path, ": ", ec.message()));
+  }
+
+  auto done = MakeUnconstructedAsyncValueRef<Chain>();
+  const size_t num_tensors = tensors.size();
+  auto writer = std::make_shared<BTFFileWriter>(
+      fd, std::move(tensors), std::move(dtypes), std::move(offsets),
+      done.CopyRef());
+  if (num_tensors == 0) writer->Finish();
+  for (size_t i = 0; i < num_tensors; ++i) {
+    if (!EnqueueBlockingWork(host, [writer, i]() { writer->WriteRecord(i); }))
+      writer->WriteRecord(i);
+  }
+  return done;
+}
+
 }  // namespace tfrt
@@ -0,0 +1,224 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- chrome_tracing_sink.cc - Chrome Trace Event Format Tracing Sink ----===//
+//
+// This file implements a tracing sink which records activities into per-thread
+// ring buffers and exports them as Chrome trace event JSON.
+
+#include "tfrt/tracing/chrome_tracing_sink/chrome_tracing_sink.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
+#include "tfrt/support/error_util.h"
+
+namespace tfrt {
+namespace tracing {
+
+namespace {
+// Chrome trace event phases.
+constexpr char kInstantPhase = 'i';
+constexpr char kBeginPhase = 'B';
+constexpr char kEndPhase = 'E';
+}  // namespace
+
+// PRE-C++17: Static constexpr class members are required to have a definition.
+constexpr size_t ChromeTracingSink::kMaxNameSize;
+
+// Ring buffer entry. Names are stored inline to keep the recording free of
+// memory allocations and the entries trivially copyable.
+struct ChromeTracingSink::Entry {
+  int64_t time_ns;
+  char phase;
+  uint8_t name_size;
+  char name[kMaxNameSize];
+};
+
+// Ring buffer written only by its owning thread and read by Flush().
+struct ChromeTracingSink::ThreadBuffer {
+  explicit ThreadBuffer(size_t size)
+      : thread_id(llvm::get_threadid()), entries(size) {}
+
+  const uint64_t thread_id;
+  std::vector<Entry> entries;
+
+  // Total number of entries written into the buffer.
+  std::atomic<uint64_t> num_written{0};
+  // Total number of entries exported by Flush(), guarded by the sink mutex.
+  uint64_t num_flushed = 0;
+};
+
+static uint64_t NextSinkId() {
+  static std::atomic<uint64_t> id{0};
+  return id.fetch_add(1, std::memory_order_relaxed);
+}
+
+ChromeTracingSink::ChromeTracingSink() : ChromeTracingSink(Options()) {}
+
+ChromeTracingSink::ChromeTracingSink(Options options)
+    : options_(std::move(options)),
+      id_(NextSinkId()),
+      start_(std::chrono::steady_clock::now()) {
+  assert(options_.buffer_size > 1);
+}
+
+ChromeTracingSink::~ChromeTracingSink() = default;
+
+Error ChromeTracingSink::RequestTracing(bool enable) {
+  if (enable || options_.output_file.empty()) return Error::success();
+  return Flush(options_.output_file);
+}
+
+ChromeTracingSink::ThreadBuffer* ChromeTracingSink::GetThreadBuffer() {
+  // Cache the buffers of all sinks used by the thread, so that a thread that
+  // alternates between sinks keeps writing into the same buffers. Sinks are
+  // identified by a unique id rather than by address, so that a stale buffer
+  // of a destroyed sink is never used by a new sink allocated at the same
+  // address.
+  static thread_local llvm::SmallDenseMap<uint64_t, ThreadBuffer*, 4> cached;
+
+  ThreadBuffer*& buffer = cached[id_];
+  if (buffer == nullptr) buffer = AddThreadBuffer();
+  return buffer;
+}
+
+ChromeTracingSink::ThreadBuffer* ChromeTracingSink::AddThreadBuffer() {
+  mutex_lock lock(mu_);
+  buffers_.push_back(std::make_unique<ThreadBuffer>(options_.buffer_size));
+  return buffers_.back().get();
+}
+
+void ChromeTracingSink::Record(char phase, NameGenerator gen_name) {
+  auto now = std::chrono::steady_clock::now();
+  ThreadBuffer* buffer = GetThreadBuffer();
+
+  uint64_t index = buffer->num_written.load(std::memory_order_relaxed);
+  Entry& entry = buffer->entries[index % buffer->entries.size()];
+  entry.time_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_)
+          .count();
+  entry.phase = phase;
+  entry.name_size = 0;
+  if (gen_name) {
+    std::string name = gen_name();
+    entry.name_size = std::min(name.size(), kMaxNameSize);
+    std::memcpy(entry.name, name.data(), entry.name_size);
+  }
+
+  // Publish the entry to Flush().
+  buffer->num_written.store(index + 1, std::memory_order_release);
+}
+
+void ChromeTracingSink::RecordTracingEvent(NameGenerator gen_name) {
+  Record(kInstantPhase, gen_name);
+}
+
+void ChromeTracingSink::PushTracingScope(NameGenerator gen_name) {
+  Record(kBeginPhase, gen_name);
+}
+
+void ChromeTracingSink::PopTracingScope() { Record(kEndPhase, nullptr); }
+
+void ChromeTracingSink::Flush(llvm::raw_ostream& os) {
+  mutex_lock lock(mu_);
+
+  const int64_t pid = llvm::sys::Process::getProcessId();
+
+  llvm::json::OStream json(os);
+  json.objectBegin();
+  json.attribute("displayTimeUnit", "ns");
+  json.attributeBegin("traceEvents");
+  json.arrayBegin();
+
+  std::vector<Entry> entries;
+  for (auto& buffer : buffers_) {
+    const uint64_t size = buffer->entries.size();
+
+    // Copy the entries that were not exported yet and are still in the buffer.
+    // The owning thread might be writing the entry `end` right now, which
+    // reuses the slot of the entry `end - size`, so it is never exported.
+    uint64_t end = buffer->num_written.load(std::memory_order_acquire);
+    uint64_t begin =
+        std::max(buffer->num_flushed, end >= size ? end - size + 1 : 0);
+    entries.clear();
+    for (uint64_t i = begin; i < end; ++i)
+      entries.push_back(buffer->entries[i % size]);
+    buffer->num_flushed = end;
+
+    // Drop the entries that were overwritten by the owning thread while they
+    // were being copied.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t written = buffer->num_written.load(std::memory_order_relaxed);
+    uint64_t first_valid = written >= size ? written - size + 1 : 0;
+    size_t num_overwritten = std::min<uint64_t>(
+        entries.size(), std::max(first_valid, begin) - begin);
+
+    // Scope depth of the exported entries. End events of the scopes that began
+    // before the first exported entry are dropped to keep the scopes nested.
+    int depth = 0;
+    for (size_t i = num_overwritten; i < entries.size(); ++i) {
+      const Entry& entry = entries[i];
+      if (entry.phase == kBeginPhase) ++depth;
+      if (entry.phase == kEndPhase) {
+        if (depth == 0) continue;
+        --depth;
+      }
+
+      json.object([&] {
+        json.attribute("ph", llvm::StringRef(&entry.phase, 1));
+        json.attribute("pid", pid);
+        json.attribute("tid", static_cast<int64_t>(buffer->thread_id));
+        json.attribute("ts", entry.time_ns / 1000.0);
+        if (entry.phase != kEndPhase)
+          json.attribute("name", llvm::json::fixUTF8(llvm::StringRef(
+                                     entry.name, entry.name_size)));
+        if (entry.phase == kInstantPhase) json.attribute("s", "t");
+      });
+    }
+  }
+
+  json.arrayEnd();
+  json.attributeEnd();
+  json.objectEnd();
+  os.flush();
+}
+
+Error ChromeTracingSink::Flush(string_view path) {
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path, ec);
+  if (ec)
+    return MakeStringError("failed to open trace file ", path, ": ",
+                           ec.message());
+
+  Flush(os);
+  os.close();
+  if (os.has_error()) {
+    ec = os.error();
+    os.clear_error();
+    return MakeStringError("failed to write trace file ", path, ": ",
+                           ec.message());
+  }
+  return Error::success();
+}
+
+}  // namespace tracing
+}  // namespace tfrt
@@ -0,0 +1,36 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file uses a static constructor to automatically register the Chrome
+// tracing sink if the TFRT_CHROME_TRACE_FILE environment variable is set. The
+// trace is written to that file when the tracing is disabled.
+
+#include <cstdlib>
+
+#include "tfrt/tracing/chrome_tracing_sink/chrome_tracing_sink.h"
+#include "tfrt/tracing/tracing.h"
+
+namespace tfrt {
+namespace tracing {
+static const bool kRegisterTracingSink = [] {
+  const char* output_file = std::getenv("TFRT_CHROME_TRACE_FILE");
+  if (output_file == nullptr || *output_file == '\0') return false;
+
+  ChromeTracingSink::Options options;
+  options.output_file = output_file;
+  RegisterTracingSink(new ChromeTracingSink(std::move(options)));
+  return true;
+}();
+}  // namespace tracing
+}  // namespace tfrt
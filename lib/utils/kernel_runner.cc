@@ -84,6 +84,7 @@ void KernelRunner::Run(size_t num_results) {
   frame.SetAttributeSection(bef_attr_encoder_.result());
   frame.SetAttributes(attr_offsets_);
   frame.SetNumResults(num_results);
+  frame.SetKernelCache(&kernel_cache_);
   kernel_fn_(&frame);
 
   for (auto& result : frame.GetResults()) {
@@ -132,7 +132,7 @@ def main():
   parser.add_argument(
       '--host_allocator_type',
       default='malloc',
-      help='Type of host allocator (malloc, ...)')
+      help='Type of host allocator (malloc(default), thread_caching, ...)')
   parser.add_argument(
       '--work_queue_type',
       default='s',
@@ -15,7 +15,12 @@
 
 
 tf_runtime=$TEST_SRCDIR/tf_runtime
-$tf_runtime/mlir_tests/bef_perf/bef_perf \
-  --tfrt_translate=$tf_runtime/tools/tfrt_translate \
-  --bef_executor=$tf_runtime/tools/bef_executor \
-  $tf_runtime/mlir_tests/bef_perf/*.mlir
+
+# Compare the default malloc allocator with the thread caching allocator.
+for host_allocator_type in malloc thread_caching; do
+  $tf_runtime/mlir_tests/bef_perf/bef_perf \
+    --tfrt_translate=$tf_runtime/tools/tfrt_translate \
+    --bef_executor=$tf_runtime/tools/bef_executor \
+    --host_allocator_type=$host_allocator_type \
+    $tf_runtime/mlir_tests/bef_perf/*.mlir
+done
@@ -0,0 +1,106 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: tfrt_opt -tfrt-fuse-cwise %s | FileCheck %s -dump-input=fail
+
+// CHECK-LABEL: func @fuse_chain
+// CHECK-SAME: ([[x:%.*]]: !corert.tensorhandle, [[y:%.*]]: !corert.tensorhandle, [[z:%.*]]: !corert.tensorhandle)
+func @fuse_chain(%x: !corert.tensorhandle, %y: !corert.tensorhandle,
+                 %z: !corert.tensorhandle) -> !corert.tensorhandle {
+  %ch = tfrt.new.chain
+  // CHECK: [[cpu:%.*]] = corert.get_op_handler
+  %cpu = corert.get_op_handler %ch "cpu"
+
+  // CHECK-NOT: "tf.Mul"
+  // CHECK-NOT: "tf.AddV2"
+  // CHECK: [[r:%.*]] = corert.executeop([[cpu]]) "tf._FusedCwise"([[x]], [[y]], [[z]])
+  // CHECK-SAME: {T = f32, fused_ops = ["Mul", "AddV2", "Relu"]} : 1
+  // CHECK-NEXT: tfrt.return [[r]]
+  %0 = corert.executeop(%cpu) "tf.Mul"(%x, %y) { T = f32 } : 1
+  %1 = corert.executeop(%cpu) "tf.AddV2"(%z, %0) { T = f32 } : 1
+  %2 = corert.executeop(%cpu) "tf.Relu"(%1) { T = f32 } : 1
+  tfrt.return %2 : !corert.tensorhandle
+}
+
+// CHECK-LABEL: func @fuse_unary_head
+func @fuse_unary_head(%x: !corert.tensorhandle,
+                      %y: !corert.tensorhandle) -> !corert.tensorhandle {
+  %ch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch "cpu"
+
+  // CHECK: corert.executeop({{.*}}) "tf._FusedCwise"(%arg0, %arg1)
+  // CHECK-SAME: {fused_ops = ["Log", "Sub", "Sigmoid"]} : 1
+  %0 = corert.executeop(%cpu) "tf.Log"(%x) : 1
+  %1 = corert.executeop(%cpu) "tf.Sub"(%0, %y) : 1
+  %2 = corert.executeop(%cpu) "tf.Sigmoid"(%1) : 1
+  tfrt.return %2 : !corert.tensorhandle
+}
+
+// Intermediate results with multiple uses are materialized.
+// CHECK-LABEL: func @multiple_uses
+func @multiple_uses(%x: !corert.tensorhandle, %y: !corert.tensorhandle)
+    -> (!corert.tensorhandle, !corert.tensorhandle) {
+  %ch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch "cpu"
+
+  // CHECK: [[r0:%.*]] = corert.executeop({{.*}}) "tf.Mul"(%arg0, %arg1)
+  // CHECK: corert.executeop({{.*}}) "tf._FusedCwise"([[r0]])
+  // CHECK-SAME: {fused_ops = ["Relu", "Rsqrt"]} : 1
+  %0 = corert.executeop(%cpu) "tf.Mul"(%x, %y) : 1
+  %1 = corert.executeop(%cpu) "tf.Relu"(%0) : 1
+  %2 = corert.executeop(%cpu) "tf.Rsqrt"(%1) : 1
+  tfrt.return %0, %2 : !corert.tensorhandle, !corert.tensorhandle
+}
+
+// Non commutative operations must take the fused value as the lhs.
+// CHECK-LABEL: func @non_commutative_rhs
+func @non_commutative_rhs(%x: !corert.tensorhandle,
+                          %y: !corert.tensorhandle) -> !corert.tensorhandle {
+  %ch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch "cpu"
+
+  // CHECK-NOT: "tf._FusedCwise"
+  // CHECK: "tf.Relu"
+  // CHECK: "tf.RealDiv"
+  %0 = corert.executeop(%cpu) "tf.Relu"(%x) : 1
+  %1 = corert.executeop(%cpu) "tf.RealDiv"(%y, %0) : 1
+  tfrt.return %1 : !corert.tensorhandle
+}
+
+// Operations with different dtypes or attributes are not fused.
+// CHECK-LABEL: func @not_fusible
+func @not_fusible(%x: !corert.tensorhandle,
+                  %y: !corert.tensorhandle) -> !corert.tensorhandle {
+  %ch = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch "cpu"
+
+  // CHECK-NOT: "tf._FusedCwise"
+  %0 = corert.executeop(%cpu) "tf.AddV2"(%x, %y) { T = f32 } : 1
+  %1 = corert.executeop(%cpu) "tf.Relu"(%0) { T = f64 } : 1
+  %2 = corert.executeop(%cpu) "tf.Mul"(%1, %y) { foo = 1 : i32 } : 1
+  tfrt.return %2 : !corert.tensorhandle
+}
+
+// Only operations on the CPU op handler are fused.
+// CHECK-LABEL: func @gpu_op_handler
+func @gpu_op_handler(%x: !corert.tensorhandle,
+                     %y: !corert.tensorhandle) -> !corert.tensorhandle {
+  %ch = tfrt.new.chain
+  %gpu = corert.get_op_handler %ch "gpu"
+
+  // CHECK-NOT: "tf._FusedCwise"
+  %0 = corert.executeop(%gpu) "tf.AddV2"(%x, %y) : 1
+  %1 = corert.executeop(%gpu) "tf.Relu"(%0) : 1
+  tfrt.return %1 : !corert.tensorhandle
+}
@@ -0,0 +1,48 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: printf '# tfrt kernel profile v1\n3 60 cheap0\n3 60 cheap1\n3 60 cheap2\n2 1000 expensive0\n2 1000 expensive1\n2 1000 expensive2\n' > %t.profile
+// RUN: tfrt_opt -tfrt-print-stream="kernel-profile=%t.profile" %s 2>&1 | FileCheck %s
+
+// Costs are measured in nanoseconds when a kernel profile is used.
+module attributes {tfrt.cost_threshold = 100 : i64} {
+
+// Without the profile, each constant costs the threshold and gets its own
+// stream. The profile shows that they take 20ns each, so they are merged.
+// CHECK: stream id: 0, stream cost: 62, parent stream: -1
+func @cheap() -> (i32, i32, i32) {
+  // CHECK: stream id: 0, stream cost: 62, parent stream: -1
+  %0 = tfrt.constant.i32 0 loc("cheap0")
+  // CHECK: stream id: 0, stream cost: 62, parent stream: -1
+  %1 = tfrt.constant.i32 1 loc("cheap1")
+  // CHECK: stream id: 0, stream cost: 62, parent stream: -1
+  %2 = tfrt.constant.i32 2 loc("cheap2")
+  // CHECK: stream id: 0, stream cost: 62, parent stream: -1
+  tfrt.return %0, %1, %2 : i32, i32, i32
+}
+
+// Kernels that take 500ns each are above the threshold and are not merged.
+// CHECK: stream id: 0, stream cost: 502, parent stream: -1
+func @expensive() -> (i32, i32, i32) {
+  // CHECK: stream id: 0, stream cost: 502, parent stream: -1
+  %0 = tfrt.constant.i32 0 loc("expensive0")
+  // CHECK: stream id: 2, stream cost: 500, parent stream: 0
+  %1 = tfrt.constant.i32 1 loc("expensive1")
+  // CHECK: stream id: 1, stream cost: 500, parent stream: 0
+  %2 = tfrt.constant.i32 2 loc("expensive2")
+  // CHECK: stream id: 0, stream cost: 502, parent stream: -1
+  tfrt.return %0, %1, %2 : i32, i32, i32
+}
+
+}
@@ -52,6 +52,48 @@ func @BM_corert.matmul() {
   tfrt.return
 }
 
+// Measures the per-op dispatch overhead of corert.executeop with many small ops
+// in a single function.
+// CHECK-LABEL: --- Running 'BM_corert.small_ops_dispatch'
+func @BM_corert.small_ops_dispatch() {
+  // CHECK: BM:BM_corert.small_ops_dispatch:Duration(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:Count: 1000
+  // CHECK: BM:BM_corert.small_ops_dispatch:Time Min(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:Time 50%(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:Time 95%(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:Time 99%(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:CPU Min(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:CPU 50%(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:CPU 95%(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:CPU 99%(ns):
+  // CHECK: BM:BM_corert.small_ops_dispatch:CPU utilization(percent):
+
+  // Prepare input.
+  %ch0 = tfrt.new.chain
+  %cpu = corert.get_op_handler %ch0 "cpu"
+  %a_handle = corert.executeop(%cpu)
+    "tfrt_test.create_dense_tensor"() { shape = [1, 1], values = [2.0 : f32] } : 1
+
+  tfrt_test.benchmark "BM_corert.small_ops_dispatch"(%cpu : !corert.ophandler, %a_handle : !corert.tensorhandle, %ch0 : !tfrt.chain) duration_secs = 1, max_count = 1000
+  {
+    %r0 = corert.executeop(%cpu) "tfrt_test.matmul"(%a_handle, %a_handle)
+      {transpose_a = false, transpose_b = false}: 1
+    %r1 = corert.executeop(%cpu) "tfrt_test.add"(%r0, %a_handle) : 1
+    %r2 = corert.executeop(%cpu) "tfrt_test.matmul"(%r1, %a_handle)
+      {transpose_a = false, transpose_b = false}: 1
+    %r3 = corert.executeop(%cpu) "tfrt_test.add"(%r2, %a_handle) : 1
+    %r4 = corert.executeop(%cpu) "tfrt_test.matmul"(%r3, %a_handle)
+      {transpose_a = false, transpose_b = false}: 1
+    %r5 = corert.executeop(%cpu) "tfrt_test.add"(%r4, %a_handle) : 1
+    %r6 = corert.executeop(%cpu) "tfrt_test.matmul"(%r5, %a_handle)
+      {transpose_a = false, transpose_b = false}: 1
+    %r7 = corert.executeop(%cpu) "tfrt_test.add"(%r6, %a_handle) : 1
+    tfrt.return %r7 : !corert.tensorhandle
+  }
+
+  tfrt.return
+}
+
 func @matmul_sync(%cpu : !corert.ophandler, %a_handle : !corert.tensorhandle) -> () attributes {tfrt.sync} {
   %result = corert_sync.executeop(%cpu) "tfrt_test.matmul"(%a_handle, %a_handle)
     {transpose_a = false, transpose_b = false}: 1
@@ -0,0 +1,41 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor %s.bef | FileCheck %s
+
+// CHECK-LABEL: --- Running 'autotuned_iterator_invalid_cpu_budget'
+func @autotuned_iterator_invalid_cpu_budget() -> !tfrt_data.iterator {
+  %start = tfrt.constant.i64 0
+  %stop = tfrt.constant.i64 8
+  %step = tfrt.constant.i64 1
+  %range = tfrt_data.range_dataset %start, %stop, %step { element_type = i64 }
+
+  %iterator = tfrt_data.make_autotuned_iterator %range { cpu_budget = 0 : i64, ram_budget = 0 : i64 }
+
+  tfrt.return %iterator : !tfrt_data.iterator
+}
+// CHECK: 'autotuned_iterator_invalid_cpu_budget' returned <<error: cpu_budget must be positive or -1, got 0>>
+
+// CHECK-LABEL: --- Running 'autotuned_iterator_invalid_ram_budget'
+func @autotuned_iterator_invalid_ram_budget() -> !tfrt_data.iterator {
+  %start = tfrt.constant.i64 0
+  %stop = tfrt.constant.i64 8
+  %step = tfrt.constant.i64 1
+  %range = tfrt_data.range_dataset %start, %stop, %step { element_type = i64 }
+
+  %iterator = tfrt_data.make_autotuned_iterator %range { cpu_budget = -1 : i64, ram_budget = -1 : i64 }
+
+  tfrt.return %iterator : !tfrt_data.iterator
+}
+// CHECK: 'autotuned_iterator_invalid_ram_budget' returned <<error: ram_budget must be non-negative, got -1>>
@@ -0,0 +1,49 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor %s.bef | FileCheck %s
+
+func @identity(%x: i64) -> i64 {
+  tfrt.return %x : i64
+}
+
+// CHECK-LABEL: --- Running 'parallel_map_zero_parallel_calls'
+func @parallel_map_zero_parallel_calls() -> !tfrt_data.dataset {
+  %start = tfrt.constant.i64 0
+  %stop = tfrt.constant.i64 8
+  %step = tfrt.constant.i64 1
+  %range = tfrt_data.range_dataset %start, %stop, %step { element_type = i64 }
+
+  %num_parallel_calls = tfrt.constant.i64 0
+  %dataset = tfrt_data.parallel_map_dataset %range, %num_parallel_calls
+    { function = @identity, is_deterministic = true }
+
+  tfrt.return %dataset : !tfrt_data.dataset
+}
+// CHECK: 'parallel_map_zero_parallel_calls' returned <<error: num_parallel_calls must be positive or -1, got 0>>
+
+// CHECK-LABEL: --- Running 'parallel_map_negative_parallel_calls'
+func @parallel_map_negative_parallel_calls() -> !tfrt_data.dataset {
+  %start = tfrt.constant.i64 0
+  %stop = tfrt.constant.i64 8
+  %step = tfrt.constant.i64 1
+  %range = tfrt_data.range_dataset %start, %stop, %step { element_type = i64 }
+
+  %num_parallel_calls = tfrt.constant.i64 -5
+  %dataset = tfrt_data.parallel_map_dataset %range, %num_parallel_calls
+    { function = @identity, is_deterministic = false }
+
+  tfrt.return %dataset : !tfrt_data.dataset
+}
+// CHECK: 'parallel_map_negative_parallel_calls' returned <<error: num_parallel_calls must be positive or -1, got -5>>
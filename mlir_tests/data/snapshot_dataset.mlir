@@ -0,0 +1,30 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor %s.bef | FileCheck %s
+
+// CHECK-LABEL: --- Running 'snapshot_zero_shards'
+func @snapshot_zero_shards() -> !tfrt_data.dataset {
+  %start = tfrt.constant.i64 0
+  %stop = tfrt.constant.i64 8
+  %step = tfrt.constant.i64 1
+  %range = tfrt_data.range_dataset %start, %stop, %step { element_type = i64 }
+
+  %path = "tfrt_test.get_string"() { value = "snapshot_zero_shards" } : () -> !tfrt.string
+  %num_shards = tfrt.constant.i64 0
+  %dataset = tfrt_data.snapshot_dataset %range, %path, %num_shards { fingerprint = "range" }
+
+  tfrt.return %dataset : !tfrt_data.dataset
+}
+// CHECK: 'snapshot_zero_shards' returned <<error: num_shards must be positive, got 0>>
@@ -0,0 +1,94 @@
+// Copyright 2021 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: bef_executor %s.bef | FileCheck %s
+
+// The test_data files hold the records "hello", "compressed" and "records".
+
+// CHECK-LABEL: --- Running 'tf_record_uncompressed'
+func @tf_record_uncompressed() -> !tfrt.chain {
+  %ch0 = tfrt.new.chain
+  %path = "tfrt_test.get_string"() { value = "mlir_tests/data/test_data/records.tfrecord" } : () -> !tfrt.string
+
+  // compression_type defaults to "".
+  %dataset = tfrt_data.tf_record_dataset %path
+  %iterator = tfrt_data.make_iterator %dataset
+
+  %ch1, %record0 = tfrt_data.iterator_get_next %iterator, %ch0 : !tfrt.string
+  // CHECK: string = hello
+  %ch2 = "tfrt_test.print_string"(%record0, %ch1) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  %ch3, %record1 = tfrt_data.iterator_get_next %iterator, %ch2 : !tfrt.string
+  // CHECK: string = compressed
+  %ch4 = "tfrt_test.print_string"(%record1, %ch3) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  tfrt.return %ch4 : !tfrt.chain
+}
+
+// CHECK-LABEL: --- Running 'tf_record_gzip'
+func @tf_record_gzip() -> !tfrt.chain {
+  %ch0 = tfrt.new.chain
+  %path = "tfrt_test.get_string"() { value = "mlir_tests/data/test_data/records.tfrecord.gz" } : () -> !tfrt.string
+
+  %dataset = tfrt_data.tf_record_dataset %path { compression_type = "GZIP" }
+  %iterator = tfrt_data.make_iterator %dataset
+
+  %ch1, %record0 = tfrt_data.iterator_get_next %iterator, %ch0 : !tfrt.string
+  // CHECK: string = hello
+  %ch2 = "tfrt_test.print_string"(%record0, %ch1) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  %ch3, %record1 = tfrt_data.iterator_get_next %iterator, %ch2 : !tfrt.string
+  // CHECK: string = compressed
+  %ch4 = "tfrt_test.print_string"(%record1, %ch3) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  %ch5, %record2 = tfrt_data.iterator_get_next %iterator, %ch4 : !tfrt.string
+  // CHECK: string = records
+  %ch6 = "tfrt_test.print_string"(%record2, %ch5) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  tfrt.return %ch6 : !tfrt.chain
+}
+
+// CHECK-LABEL: --- Running 'tf_record_zlib'
+func @tf_record_zlib() -> !tfrt.chain {
+  %ch0 = tfrt.new.chain
+  %path = "tfrt_test.get_string"() { value = "mlir_tests/data/test_data/records.tfrecord.zlib" } : () -> !tfrt.string
+
+  %dataset = tfrt_data.tf_record_dataset %path { compression_type = "ZLIB" }
+  %iterator = tfrt_data.make_iterator %dataset
+
+  %ch1, %record0 = tfrt_data.iterator_get_next %iterator, %ch0 : !tfrt.string
+  // CHECK: string = hello
+  %ch2 = "tfrt_test.print_string"(%record0, %ch1) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  %ch3, %record1 = tfrt_data.iterator_get_next %iterator, %ch2 : !tfrt.string
+  // CHECK: string = compressed
+  %ch4 = "tfrt_test.print_string"(%record1, %ch3) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  %ch5, %record2 = tfrt_data.iterator_get_next %iterator, %ch4 : !tfrt.string
+  // CHECK: string = records
+  %ch6 = "tfrt_test.print_string"(%record2, %ch5) : (!tfrt.string, !tfrt.chain) -> (!tfrt.chain)
+
+  tfrt.return %ch6 : !tfrt.chain
+}
+
+// CHECK-LABEL: --- Running 'tf_record_zero_copy_invalid_batch_size'
+func @tf_record_zero_copy_invalid_batch_size() -> !tfrt_data.dataset {
+  %path = "tfrt_test.get_string"() { value = "mlir_tests/data/test_data/records.tfrecord" } : () -> !tfrt.string
+  %max_read_batch_size = tfrt.constant.i64 0
+
+  %dataset = tfrt_data.tf_record_dataset.zero_copy %path, %max_read_batch_size
+
+  tfrt.return %dataset : !tfrt_data.dataset
+}
+// CHECK: 'tf_record_zero_copy_invalid_batch_size' returned <<error: max_read_batch_size must be positive, got 0>>
@@ -0,0 +1,197 @@
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Unit tests and benchmarks for PriorityNonBlockingWorkQueue.
+
+#include "priority_non_blocking_work_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "tfrt/host_context/task_function.h"
+#include "tfrt/support/latch.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_environment.h"
+
+namespace tfrt {
+namespace {
+
+using WorkQueue =
+    ::tfrt::internal::PriorityNonBlockingWorkQueue<ThreadingEnvironment>;
+using TaskPriority = ::tfrt::internal::TaskPriority;
+
+TEST(PriorityNonBlockingWorkQueueTest, HighPriorityTasksJumpAhead) {
+  auto qstate = std::make_unique<internal::QuiescingState>();
+  WorkQueue work_queue(qstate.get(), /*num_threads=*/1);
+
+  // Block the only worker thread, so that all the tasks below are queued.
+  ::tfrt::latch started(1);
+  ::tfrt::latch release(1);
+  work_queue.AddTask(TaskFunction([&]() {
+    started.count_down();
+    release.wait();
+  }));
+  started.wait();
+
+  const int num_tasks = 8;
+  ::tfrt::latch done(2 * num_tasks);
+
+  mutex mu;
+  std::vector<TaskPriority> executed;
+
+  auto add_task = [&](TaskPriority priority) {
+    work_queue.AddTask(TaskFunction([&, priority]() {
+                         {
+                           mutex_lock lock(mu);
+                           executed.push_back(priority);
+                         }
+                         done.count_down();
+                       }),
+                       priority);
+  };
+
+  // Interleave low and high priority tasks.
+  for (int i = 0; i < num_tasks; ++i) {
+    add_task(TaskPriority::kLow);
+    add_task(TaskPriority::kHigh);
+  }
+
+  release.count_down();
+  done.wait();
+
+  mutex_lock lock(mu);
+  ASSERT_EQ(executed.size(), 2 * num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    EXPECT_EQ(executed[i], TaskPriority::kHigh);
+    EXPECT_EQ(executed[num_tasks + i], TaskPriority::kLow);
+  }
+}
+
+TEST(PriorityNonBlockingWorkQueueTest, LowPriorityTaskIsNotStarved) {
+  auto qstate = std::make_unique<internal::QuiescingState>();
+  WorkQueue work_queue(qstate.get(), /*num_threads=*/1);
+
+  const int max_high_priority_tasks = 10000;
+
+  std::atomic<bool> low_priority_done{false};
+  std::atomic<int> num_high_priority_tasks{0};
+  ::tfrt::latch done(2);
+
+  // High priority task that keeps resubmitting itself until the low priority
+  // task is completed.
+  llvm::unique_function<void()> high_priority_task;
+  high_priority_task = [&]() {
+    if (low_priority_done.load() ||
+        ++num_high_priority_tasks == max_high_priority_tasks) {
+      done.count_down();
+      return;
+    }
+    work_queue.AddTask(TaskFunction([&]() { high_priority_task(); }),
+                       TaskPriority::kHigh);
+  };
+
+  work_queue.AddTask(TaskFunction([&]() {
+                       low_priority_done = true;
+                       done.count_down();
+                     }),
+                     TaskPriority::kLow);
+  work_queue.AddTask(TaskFunction([&]() { high_priority_task(); }),
+                     TaskPriority::kHigh);
+
+  done.wait();
+  EXPECT_TRUE(low_priority_done.load());
+  EXPECT_LE(num_high_priority_tasks.load(),
+            2 * WorkQueue::kStarvationPreventionInterval);
+}
+
+// -------------------------------------------------------------------------- //
+// Performance benchmarks.
+// -------------------------------------------------------------------------- //
+
+// Benchmark latency of the latency critical tasks under mixed load.
+//
+// In every iteration submits a burst of `state.range(0)` background tasks per
+// worker thread at `background_priority`, each running for 10 microseconds,
+// followed by a single latency critical task at `critical_priority`, and
+// measures the time from submission to the start of the latency critical task.
+// All background tasks are completed before the next iteration.
+//
+// Reports the 50th, 99th percentile and max latency in microseconds.
+void MixedLoad(WorkQueue& work_queue, int num_threads,
+               TaskPriority background_priority,
+               TaskPriority critical_priority, benchmark::State& state) {
+  using Clock = std::chrono::steady_clock;
+
+  const auto background_task_duration = std::chrono::microseconds(10);
+  const int num_background_tasks = state.range(0) * num_threads;
+
+  std::vector<double> latencies;
+  for (auto _ : state) {
+    ::tfrt::latch background_done(num_background_tasks);
+    for (int i = 0; i < num_background_tasks; ++i) {
+      work_queue.AddTask(TaskFunction([&]() {
+                           auto deadline =
+                               Clock::now() + background_task_duration;
+                           while (Clock::now() < deadline) {
+                           }
+                           background_done.count_down();
+                         }),
+                         background_priority);
+    }
+
+    ::tfrt::latch started(1);
+    Clock::time_point start_time;
+
+    auto submit_time = Clock::now();
+    work_queue.AddTask(TaskFunction([&]() {
+                         start_time = Clock::now();
+                         started.count_down();
+                       }),
+                       critical_priority);
+    started.wait();
+
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(start_time - submit_time)
+            .count());
+
+    background_done.wait();
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) -> double {
+    if (latencies.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * (latencies.size() - 1));
+    return latencies[idx];
+  };
+
+  state.counters["p50_us"] = percentile(0.50);
+  state.counters["p99_us"] = percentile(0.99);
+  state.counters["max_us"] = percentile(1.0);
+}
+
+#define BM_MixedLoad(NAME, num_threads, background, critical)                \
+  static void BM_MixedLoad_##NAME##_##num_threads(benchmark::State& state) { \
+    auto qstate = std::make_unique<internal::QuiescingState>();              \
+    WorkQueue work_queue(qstate.get(), num_threads);                         \
+    MixedLoad(work_queue, num_threads, background, critical, state);         \
+  }                                                                          \
+  BENCHMARK(BM_MixedLoad_##NAME##_##num_threads)                             \
+      ->UseRealTime()                                                        \
+      ->Arg(8)                                                               \
+      ->Arg(64)
+
+// Baseline: all tasks have the same priority (same as "mstd" work queue).
+BM_MixedLoad(SamePriority, 4, TaskPriority::kDefault, TaskPriority::kDefault);
+BM_MixedLoad(SamePriority, 8, TaskPriority::kDefault, TaskPriority::kDefault);
+
+// Latency critical tasks have a higher priority than the background tasks.
+BM_MixedLoad(HighPriority, 4, TaskPriority::kLow, TaskPriority::kHigh);
+BM_MixedLoad(HighPriority, 8, TaskPriority::kLow, TaskPriority::kHigh);
+
+}  // namespace
+}  // namespace tfrt
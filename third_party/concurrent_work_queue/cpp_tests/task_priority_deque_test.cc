@@ -83,6 +83,26 @@ TEST(TaskPriorityDequeTest, PushAndPopFrontWithPriority) {
   ASSERT_EQ(queue.Size(), 0);
 }
 
+TEST(TaskPriorityDequeTest, PopFrontFromPriorityLevel) {
+  TaskFunctions fn;
+  TaskPriorityDeque queue;
+
+  ASSERT_EQ(queue.PushFront(fn.Next(1), TaskPriority::kLow), llvm::None);
+  ASSERT_EQ(queue.PushFront(fn.Next(2), TaskPriority::kLow), llvm::None);
+  ASSERT_EQ(queue.PushFront(fn.Next(3), TaskPriority::kHigh), llvm::None);
+  ASSERT_EQ(queue.Size(), 3);
+
+  ASSERT_EQ(queue.PopFront(TaskPriority::kDefault), llvm::None);
+  ASSERT_EQ(queue.PopFront(TaskPriority::kCritical), llvm::None);
+
+  ASSERT_EQ(fn.Run(queue.PopFront(TaskPriority::kLow)), 2);
+  ASSERT_EQ(queue.Size(), 2);
+  ASSERT_EQ(fn.Run(queue.PopFront()), 3);
+  ASSERT_EQ(fn.Run(queue.PopFront(TaskPriority::kLow)), 1);
+  ASSERT_EQ(queue.PopFront(TaskPriority::kLow), llvm::None);
+  ASSERT_EQ(queue.Size(), 0);
+}
+
 TEST(TaskPriorityDequeTest, PushAndPopBackDefaultPriority) {
   TaskFunctions fn;
   TaskPriorityDeque queue;
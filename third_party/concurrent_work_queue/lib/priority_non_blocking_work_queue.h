@@ -0,0 +1,159 @@
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Work queue implementation based on non-blocking concurrency primitives
+// optimized for CPU intensive non-blocking compute tasks with different
+// priorities.
+//
+// This work queue is the same as NonBlockingWorkQueue, except that it uses
+// TaskPriorityDeque for storing pending tasks. Thread pops tasks from the front
+// of its own queue and steals tasks from the back of other threads queues in
+// the priority order, so a high priority task jumps ahead of all the pending
+// tasks with a lower priority.
+//
+// To prevent starvation of the low priority tasks, every
+// `kStarvationPreventionInterval`-th task that a worker thread takes from its
+// own queue is taken from the lowest non-empty priority level.
+
+#ifndef TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_PRIORITY_NON_BLOCKING_WORK_QUEUE_H_
+#define TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_PRIORITY_NON_BLOCKING_WORK_QUEUE_H_
+
+#include "llvm/Support/Compiler.h"
+#include "task_priority_deque.h"
+#include "tfrt/host_context/task_function.h"
+#include "work_queue_base.h"
+
+namespace tfrt {
+namespace internal {
+
+template <typename ThreadingEnvironment>
+class PriorityNonBlockingWorkQueue;
+
+template <typename ThreadingEnvironmentTy>
+struct WorkQueueTraits<PriorityNonBlockingWorkQueue<ThreadingEnvironmentTy>> {
+  using ThreadingEnvironment = ThreadingEnvironmentTy;
+  using Thread = typename ThreadingEnvironment::Thread;
+  using Queue = ::tfrt::internal::TaskPriorityDeque;
+};
+
+template <typename ThreadingEnvironment>
+class PriorityNonBlockingWorkQueue
+    : public WorkQueueBase<PriorityNonBlockingWorkQueue<ThreadingEnvironment>> {
+  using Base =
+      WorkQueueBase<PriorityNonBlockingWorkQueue<ThreadingEnvironment>>;
+
+  using Queue = typename Base::Queue;
+  using Thread = typename Base::Thread;
+  using PerThread = typename Base::PerThread;
+  using ThreadData = typename Base::ThreadData;
+
+ public:
+  // Every `kStarvationPreventionInterval`-th task popped by the worker thread
+  // from its own queue is taken from the lowest non-empty priority level.
+  static constexpr unsigned kStarvationPreventionInterval = 32;
+
+  explicit PriorityNonBlockingWorkQueue(QuiescingState* quiescing_state,
+                                        int num_threads);
+  ~PriorityNonBlockingWorkQueue() = default;
+
+  void AddTask(TaskFunction task, TaskPriority priority);
+  void AddTask(TaskFunction task) {
+    AddTask(std::move(task), TaskPriority::kDefault);
+  }
+
+  using Base::Steal;
+
+ private:
+  static constexpr char const* kThreadNamePrefix =
+      "tfrt-priority-non-blocking-queue";
+
+  template <typename WorkQueue>
+  friend class WorkQueueBase;
+
+  using Base::GetPerThread;
+  using Base::IsNotifyParkedThreadRequired;
+  using Base::IsQuiescing;
+  using Base::WithPendingTaskCounter;
+
+  using Base::coprimes_;
+  using Base::event_count_;
+  using Base::num_threads_;
+  using Base::thread_data_;
+
+  LLVM_NODISCARD Optional<TaskFunction> NextTask(Queue* queue);
+  LLVM_NODISCARD Optional<TaskFunction> Steal(Queue* queue);
+  LLVM_NODISCARD bool Empty(Queue* queue);
+};
+
+template <typename ThreadingEnvironment>
+PriorityNonBlockingWorkQueue<ThreadingEnvironment>::
+    PriorityNonBlockingWorkQueue(QuiescingState* quiescing_state,
+                                 int num_threads)
+    : WorkQueueBase<PriorityNonBlockingWorkQueue>(
+          quiescing_state, kThreadNamePrefix, num_threads) {}
+
+template <typename ThreadingEnvironment>
+void PriorityNonBlockingWorkQueue<ThreadingEnvironment>::AddTask(
+    TaskFunction task, TaskPriority priority) {
+  // Keep track of the number of pending tasks.
+  if (IsQuiescing()) task = WithPendingTaskCounter(std::move(task));
+
+  // If the worker queue is full, we will execute `task` in the current thread.
+  llvm::Optional<TaskFunction> inline_task;
+
+  // See NonBlockingWorkQueue::AddTask() for the queue selection rationale.
+  PerThread* pt = GetPerThread();
+  if (pt->parent == this) {
+    // Worker thread of this pool, push onto the thread's queue.
+    Queue& q = thread_data_[pt->thread_id].queue;
+    inline_task = q.PushFront(std::move(task), priority);
+  } else {
+    // A free-standing thread (or worker of another pool).
+    unsigned rnd = FastReduce(pt->rng(), num_threads_);
+    Queue& q = thread_data_[rnd].queue;
+    inline_task = q.PushBack(std::move(task), priority);
+  }
+
+  if (!inline_task.hasValue()) {
+    if (IsNotifyParkedThreadRequired())
+      event_count_.Notify(/*notify_all=*/false);
+  } else {
+    (*inline_task)();  // Push failed, execute directly.
+  }
+}
+
+template <typename ThreadingEnvironment>
+LLVM_NODISCARD Optional<TaskFunction>
+PriorityNonBlockingWorkQueue<ThreadingEnvironment>::NextTask(Queue* queue) {
+  // NextTask() is called only from the worker thread that owns the `queue`, so
+  // a thread local counter is enough to track how many tasks it has popped.
+  static thread_local unsigned num_popped_tasks = 0;
+
+  if (++num_popped_tasks % kStarvationPreventionInterval == 0) {
+    for (TaskPriority priority :
+         {TaskPriority::kLow, TaskPriority::kDefault, TaskPriority::kHigh}) {
+      Optional<TaskFunction> task = queue->PopFront(priority);
+      if (task.hasValue()) return task;
+    }
+  }
+
+  return queue->PopFront();
+}
+
+template <typename ThreadingEnvironment>
+LLVM_NODISCARD Optional<TaskFunction>
+PriorityNonBlockingWorkQueue<ThreadingEnvironment>::Steal(Queue* queue) {
+  return queue->PopBack();
+}
+
+template <typename ThreadingEnvironment>
+LLVM_NODISCARD bool PriorityNonBlockingWorkQueue<ThreadingEnvironment>::Empty(
+    Queue* queue) {
+  return queue->Empty();
+}
+
+}  // namespace internal
+}  // namespace tfrt
+
+#endif  // TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_PRIORITY_NON_BLOCKING_WORK_QUEUE_H_
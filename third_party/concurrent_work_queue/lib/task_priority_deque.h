@@ -150,6 +150,33 @@ class TaskPriorityDeque {
     return llvm::None;
   }
 
+  // PopFront() removes and returns the first element from the queue of the
+  // specified priority, ignoring tasks at all other priority levels. Must be
+  // called only by the thread that owns the queue front (same as PopFront()).
+  //
+  // If the queue for the given priority is empty returns empty optional.
+  LLVM_NODISCARD llvm::Optional<TaskFunction> PopFront(TaskPriority priority) {
+    assert(static_cast<int>(priority) < kNumTaskPriorities);
+
+    PointerState front(front_.load(std::memory_order_relaxed));
+    uint64_t index = front.IndexExt(priority);
+
+    Elem* e = elem(priority, (index - 1) & kIndexMask);
+    uint8_t s = e->state.load(std::memory_order_relaxed);
+
+    if (s != kReady || !e->state.compare_exchange_strong(
+                           s, kBusy, std::memory_order_acquire)) {
+      return llvm::None;
+    }
+
+    TaskFunction task = std::move(e->task);
+    e->state.store(kEmpty, std::memory_order_release);
+    front_.store(front.WithIndexExt((index - 1) & kIndexMaskExt, priority),
+                 std::memory_order_relaxed);
+
+    return llvm::Optional<TaskFunction>(std::move(task));
+  }
+
   // PushBack() inserts task `w` at the end of the queue for the specified
   // priority.
   //
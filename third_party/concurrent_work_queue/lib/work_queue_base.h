@@ -58,6 +58,7 @@
 #include "llvm/Support/Compiler.h"
 #include "task_queue.h"
 #include "tfrt/host_context/task_function.h"
+#include "tfrt/metrics/metrics.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/logging.h"
 #include "tfrt/support/mutex.h"
@@ -87,6 +88,27 @@ inline uint32_t FastReduce(uint32_t x, uint32_t size) {
   return (static_cast<uint64_t>(x) * static_cast<uint64_t>(size)) >> 32u;
 }
 
+//===----------------------------------------------------------------------===//
+// Metrics shared by all work queue implementations.
+//===----------------------------------------------------------------------===//
+
+// The number of tasks stolen from the queues of other worker threads.
+inline metrics::Counter* GetWorkQueueStealsCounter() {
+  static metrics::Counter* counter =
+      metrics::NewCounter("/tfrt/work_queue/steals");
+  return counter;
+}
+
+// The number of pending tasks in a worker thread queue, sampled when the
+// worker thread takes the next task from its own queue.
+inline metrics::Histogram* GetWorkQueueDepthHistogram() {
+  static metrics::Histogram* histogram = metrics::NewHistogram(
+      "/tfrt/work_queue/depth",
+      metrics::Buckets::Exponential(/*scale=*/1, /*growth_factor=*/2,
+                                    /*bucket_count=*/16));
+  return histogram;
+}
+
 template <typename Derived>
 struct WorkQueueTraits;
 
@@ -248,6 +270,9 @@ class WorkQueueBase {
   template <typename ThreadingEnvironment>
   friend class NonBlockingWorkQueue;
 
+  template <typename ThreadingEnvironment>
+  friend class PriorityNonBlockingWorkQueue;
+
   struct PerThread {
     constexpr PerThread() : parent(nullptr), rng(0), thread_id(-1) {}
     Derived* parent;
@@ -278,6 +303,10 @@ class WorkQueueBase {
   // divided by the number of threads, to get spin count for each thread).
   static constexpr int kSpinCount = 5000;
 
+  // The worker queue depth is recorded for one in `kQueueDepthSampleMask + 1`
+  // tasks taken from the worker own queue.
+  static constexpr unsigned kQueueDepthSampleMask = 63;
+
   // If there are enough active threads with an empty pending task queues, there
   // is no need for spinning before parking a thread that is out of work to do,
   // because these active threads will go into a steal loop after finishing with
@@ -511,7 +540,10 @@ LLVM_NODISCARD llvm::Optional<TaskFunction> WorkQueueBase<Derived>::Steal() {
   for (unsigned i = 0; i < num_threads_; i++) {
     llvm::Optional<TaskFunction> t =
         derived_.Steal(&(thread_data_[victim].queue));
-    if (t.hasValue()) return t;
+    if (t.hasValue()) {
+      GetWorkQueueStealsCounter()->Increment();
+      return t;
+    }
 
     victim += inc;
     if (victim >= num_threads_) {
@@ -539,6 +571,8 @@ void WorkQueueBase<Derived>::WorkerLoop(int thread_id) {
 
   while (!cancelled_) {
     Optional<TaskFunction> t = derived_.NextTask(q);
+    if (t.hasValue() && (pt->rng() & kQueueDepthSampleMask) == 0)
+      GetWorkQueueDepthHistogram()->Record(q->Size() + 1);
     if (!t.hasValue()) {
       t = Steal();
       if (!t.hasValue()) {
@@ -20,8 +20,11 @@
 #include <string>
 
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/bef_executor/kernel_profiler.h"
 #include "tfrt/bef_executor_driver/bef_executor_driver.h"
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/metrics/in_process_metrics_registry.h"
 #include "tfrt/tracing/tracing.h"
 
 static llvm::cl::opt<std::string> cl_input_filename(  // NOLINT
@@ -60,7 +63,9 @@ static llvm::cl::opt<tfrt::HostAllocatorType> cl_host_allocator_type(  // NOLINT
         clEnumValN(tfrt::HostAllocatorType::kProfiledMalloc,
                    "profiled_allocator", "Malloc with metric profiling."),
         clEnumValN(tfrt::HostAllocatorType::kLeakCheckMalloc,
-                   "leak_check_allocator", "Malloc with memory leak check.")),
+                   "leak_check_allocator", "Malloc with memory leak check."),
+        clEnumValN(tfrt::HostAllocatorType::kThreadCaching, "thread_caching",
+                   "Size classed allocator with per-thread caches.")),
     llvm::cl::init(tfrt::HostAllocatorType::kLeakCheckMalloc));
 
 // Enable aggregate op handler types to be specified on the command line.
@@ -82,6 +87,23 @@ static llvm::cl::opt<bool> cl_print_error_code(  // NOLINT
     llvm::cl::desc("Print error code if there's any error."),
     llvm::cl::Optional, llvm::cl::ValueDisallowed);
 
+enum class MetricsFormat { kNone, kText, kJson };
+
+// Collect runtime metrics and print them when the program completes.
+static llvm::cl::opt<MetricsFormat> cl_print_metrics(  // NOLINT
+    "print_metrics", llvm::cl::desc("Print the runtime metrics in format:"),
+    llvm::cl::values(clEnumValN(MetricsFormat::kNone, "none", "Do not print."),
+                     clEnumValN(MetricsFormat::kText, "text", "Plain text."),
+                     clEnumValN(MetricsFormat::kJson, "json", "JSON.")),
+    llvm::cl::init(MetricsFormat::kNone));
+
+// Profile the kernels and write their wall times to a file, which can be passed
+// to the MLIR to BEF converter to optimize the stream assignment.
+static llvm::cl::opt<std::string> cl_kernel_profile(  // NOLINT
+    "kernel_profile",
+    llvm::cl::desc("Write the kernel profile to the specified file"),
+    llvm::cl::init(""));
+
 //===----------------------------------------------------------------------===//
 // Driver main
 //===----------------------------------------------------------------------===//
@@ -103,5 +125,38 @@ int main(int argc, char** argv) {
   if (cl_enable_tracing) tracing.emplace();
   tfrt::tracing::SetTracingLevel(cl_tracing_level);
 
-  return RunBefExecutor(run_config);
+  // The registry must be registered before any metric is created, and it is
+  // intentionally leaked because metrics are accessed until the program exits.
+  tfrt::metrics::InProcessMetricsRegistry* metrics_registry = nullptr;
+  if (cl_print_metrics != MetricsFormat::kNone) {
+    metrics_registry = new tfrt::metrics::InProcessMetricsRegistry;
+    tfrt::metrics::RegisterMetricsRegistry(metrics_registry);
+  }
+
+  llvm::Optional<tfrt::KernelProfiler> kernel_profiler;
+  if (!cl_kernel_profile.empty()) {
+    kernel_profiler.emplace();
+    tfrt::SetKernelProfiler(kernel_profiler.getPointer());
+  }
+
+  int result = RunBefExecutor(run_config);
+
+  if (kernel_profiler) {
+    tfrt::SetKernelProfiler(nullptr);
+    if (auto error =
+            kernel_profiler->GetProfile().WriteToFile(cl_kernel_profile)) {
+      llvm::errs() << llvm::toString(std::move(error)) << "\n";
+      if (result == 0) result = 1;
+    }
+  }
+
+  if (metrics_registry) {
+    auto snapshot = metrics_registry->GetSnapshot();
+    if (cl_print_metrics == MetricsFormat::kText)
+      snapshot.PrintText(llvm::outs());
+    else
+      snapshot.PrintJson(llvm::outs());
+  }
+
+  return result;
 }